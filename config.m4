@@ -16,6 +16,15 @@ dnl Internal
   src/ds/ds_pair.c                     \
   src/ds/ds_priority_queue.c           \
   src/ds/ds_queue.c                    \
+  src/ds/ds_persistent_vector.c        \
+  src/ds/ds_persistent_map.c           \
+  src/ds/ds_stream.c                   \
+  src/ds/ds_slab.c                     \
+  src/ds/ds_map_view.c                 \
+  src/ds/ds_mapped.c                   \
+  src/ds/ds_binary.c                   \
+  src/ds/ds_json.c                     \
+  src/ds/ds_counter.c                  \
                                                   \
   src/php/objects/php_vector.c                    \
   src/php/objects/php_deque.c                     \
@@ -25,6 +34,14 @@ dnl Internal
   src/php/objects/php_queue.c                     \
   src/php/objects/php_set.c                       \
   src/php/objects/php_stack.c                     \
+  src/php/objects/php_immutable_vector.c          \
+  src/php/objects/php_immutable_map.c             \
+  src/php/objects/php_persistent_vector.c         \
+  src/php/objects/php_persistent_map.c            \
+  src/php/objects/php_stream.c                    \
+  src/php/objects/php_map_view.c                  \
+  src/php/objects/php_mapped.c                    \
+  src/php/objects/php_counter.c                   \
                                                   \
 dnl Iterators
   src/php/iterators/php_vector_iterator.c         \
@@ -35,6 +52,11 @@ dnl Iterators
   src/php/iterators/php_htable_iterator.c         \
   src/php/iterators/php_priority_queue_iterator.c \
   src/php/iterators/php_queue_iterator.c          \
+  src/php/iterators/php_persistent_vector_iterator.c \
+  src/php/iterators/php_persistent_map_iterator.c \
+  src/php/iterators/php_map_view_iterator.c       \
+  src/php/iterators/php_mapped_iterator.c         \
+  src/php/iterators/php_counter_iterator.c        \
                                                   \
 dnl Handlers
   src/php/handlers/php_common_handlers.c          \
@@ -46,6 +68,15 @@ dnl Handlers
   src/php/handlers/php_pair_handlers.c            \
   src/php/handlers/php_priority_queue_handlers.c  \
   src/php/handlers/php_queue_handlers.c           \
+  src/php/handlers/php_immutable_vector_handlers.c \
+  src/php/handlers/php_immutable_map_handlers.c   \
+  src/php/handlers/php_persistent_vector_handlers.c \
+  src/php/handlers/php_persistent_map_handlers.c  \
+  src/php/handlers/php_stream_handlers.c          \
+  src/php/handlers/php_map_view_handlers.c        \
+  src/php/handlers/php_mapped_handlers.c          \
+  src/php/handlers/php_counter_handlers.c         \
+  src/php/handlers/php_opcode_handlers.c          \
                                                   \
 dnl Interfaces
   src/php/classes/php_hashable_ce.c               \
@@ -61,6 +92,15 @@ dnl Classes
   src/php/classes/php_pair_ce.c                   \
   src/php/classes/php_priority_queue_ce.c         \
   src/php/classes/php_queue_ce.c                  \
+  src/php/classes/php_immutable_vector_ce.c       \
+  src/php/classes/php_immutable_map_ce.c          \
+  src/php/classes/php_persistent_vector_ce.c      \
+  src/php/classes/php_persistent_map_ce.c         \
+  src/php/classes/php_stream_ce.c                 \
+  src/php/classes/php_map_view_ce.c               \
+  src/php/classes/php_mapped_map_ce.c             \
+  src/php/classes/php_mapped_vector_ce.c          \
+  src/php/classes/php_counter_ce.c                \
                                                   \
   php_ds.c                                        \
                                                   \
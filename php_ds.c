@@ -17,8 +17,18 @@
 #include "src/php/classes/php_map_ce.h"
 #include "src/php/classes/php_stack_ce.h"
 #include "src/php/classes/php_pair_ce.h"
+#include "src/php/classes/php_counter_ce.h"
 #include "src/php/classes/php_priority_queue_ce.h"
 #include "src/php/classes/php_queue_ce.h"
+#include "src/php/classes/php_immutable_vector_ce.h"
+#include "src/php/classes/php_immutable_map_ce.h"
+#include "src/php/classes/php_persistent_vector_ce.h"
+#include "src/php/classes/php_persistent_map_ce.h"
+#include "src/php/classes/php_stream_ce.h"
+#include "src/php/classes/php_map_view_ce.h"
+#include "src/php/classes/php_mapped_vector_ce.h"
+#include "src/php/classes/php_mapped_map_ce.h"
+#include "src/php/handlers/php_opcode_handlers.h"
 
 ZEND_DECLARE_MODULE_GLOBALS(ds);
 
@@ -26,9 +36,54 @@ static inline void php_ds_init_globals(zend_ds_globals *dsg) {
 	memset(dsg, 0, sizeof(zend_ds_globals));
 }
 
+/**
+ * A factor of 1 or less would reallocate on every push, and one that isn't
+ * finite would make every capacity meaningless.
+ */
+static ZEND_INI_MH(php_ds_update_grow_factor)
+{
+    double factor = zend_strtod(ZSTR_VAL(new_value), NULL);
+
+    if ( ! zend_finite(factor) || factor <= 1) {
+        return FAILURE;
+    }
+
+    return OnUpdateReal(ZEND_INI_MH_PASSTHRU);
+}
+
+/**
+ * A threshold of 0 never shrinks, so a negative threshold has no meaning. A
+ * buffer that is halved at 1/2 or more of its capacity is full again, or
+ * could not even hold its values, so the next push would grow it right back.
+ */
+static ZEND_INI_MH(php_ds_update_shrink_threshold)
+{
+    zend_long threshold = zend_atol(ZSTR_VAL(new_value), ZSTR_LEN(new_value));
+
+    if (threshold < 0 || threshold == 1 || threshold == 2) {
+        return FAILURE;
+    }
+
+    return OnUpdateLong(ZEND_INI_MH_PASSTHRU);
+}
+
+PHP_INI_BEGIN()
+    STD_PHP_INI_BOOLEAN("ds.array_snapshots", "0", PHP_INI_ALL, OnUpdateBool,
+        array_snapshots, zend_ds_globals, ds_globals)
+    STD_PHP_INI_ENTRY("ds.shrink_threshold", "4", PHP_INI_ALL, php_ds_update_shrink_threshold,
+        shrink_threshold, zend_ds_globals, ds_globals)
+    STD_PHP_INI_ENTRY("ds.grow_factor", "1.5", PHP_INI_ALL, php_ds_update_grow_factor,
+        grow_factor, zend_ds_globals, ds_globals)
+    STD_PHP_INI_BOOLEAN("ds.opcode_handlers", "0", PHP_INI_SYSTEM, OnUpdateBool,
+        opcode_handlers, zend_ds_globals, ds_globals)
+PHP_INI_END()
+
 PHP_MINIT_FUNCTION(ds)
 {
 	ZEND_INIT_MODULE_GLOBALS(ds, php_ds_init_globals, NULL);
+    REGISTER_INI_ENTRIES();
+
+    ds_register_shared_buffers();
 
     // Interfaces
     php_ds_register_hashable();
@@ -44,16 +99,45 @@ PHP_MINIT_FUNCTION(ds)
     php_ds_register_set();
     php_ds_register_priority_queue();
     php_ds_register_pair();
+    php_ds_register_counter();
+
+    // Immutable classes share handlers with their mutable counterparts.
+    php_ds_register_immutable_vector();
+    php_ds_register_immutable_map();
+
+    // Persistent classes
+    php_ds_register_persistent_vector();
+    php_ds_register_persistent_map();
+
+    php_ds_register_stream();
+    php_ds_register_map_view();
+    php_ds_register_mapped_vector();
+    php_ds_register_mapped_map();
+
+    // Opcode handlers apply to every array access, so they are opt-in.
+    if (DSG(opcode_handlers)) {
+        php_ds_register_opcode_handlers();
+    }
 
     return SUCCESS;
 }
 
+PHP_MSHUTDOWN_FUNCTION(ds)
+{
+    php_ds_unregister_opcode_handlers();
+    UNREGISTER_INI_ENTRIES();
+    return SUCCESS;
+}
+
 PHP_RINIT_FUNCTION(ds)
 {
 #if defined(COMPILE_DL_DS) && defined(ZTS)
     ZEND_TSRMLS_CACHE_UPDATE();
 #endif
 
+    ds_slab_init(&DSG(pair_slab),  sizeof(ds_pair_t));
+    ds_slab_init(&DSG(table_slab), sizeof(ds_htable_t));
+
     return SUCCESS;
 }
 
@@ -62,12 +146,26 @@ PHP_RSHUTDOWN_FUNCTION(ds)
     return SUCCESS;
 }
 
+ZEND_MODULE_POST_ZEND_DEACTIVATE_D(ds)
+{
+    ds_free_mapped_buffers();
+
+    // Objects are only freed after RSHUTDOWN, so the slabs have to be kept
+    // until now.
+    ds_slab_destroy(&DSG(pair_slab));
+    ds_slab_destroy(&DSG(table_slab));
+
+    return SUCCESS;
+}
+
 PHP_MINFO_FUNCTION(ds)
 {
     php_info_print_table_start();
     php_info_print_table_row(2, "ds support", "enabled");
     php_info_print_table_row(2, "ds version", PHP_DS_VERSION);
     php_info_print_table_end();
+
+    DISPLAY_INI_ENTRIES();
 }
 
 static const zend_module_dep ds_deps[] = {
@@ -83,12 +181,14 @@ zend_module_entry ds_module_entry = {
     "ds",
     NULL,
     PHP_MINIT(ds),
-    NULL,
+    PHP_MSHUTDOWN(ds),
     PHP_RINIT(ds),
     PHP_RSHUTDOWN(ds),
     PHP_MINFO(ds),
     PHP_DS_VERSION,
-    STANDARD_MODULE_PROPERTIES
+    NO_MODULE_GLOBALS,
+    ZEND_MODULE_POST_ZEND_DEACTIVATE_N(ds),
+    STANDARD_MODULE_PROPERTIES_EX
 };
 
 #ifdef COMPILE_DL_DS
@@ -34,9 +34,19 @@ extern zend_module_entry ds_module_entry;
 #include "TSRM.h"
 #endif
 
+#include "src/ds/ds_slab.h"
+
 ZEND_BEGIN_MODULE_GLOBALS(ds)
 zend_fcall_info        user_compare_fci;
 zend_fcall_info_cache  user_compare_fci_cache;
+zend_bool              array_snapshots;
+zend_long              shrink_threshold;
+double                 grow_factor;
+zend_bool              opcode_handlers;
+HashTable             *mapped_buffers;
+size_t                 mapped_size;
+ds_slab_t              pair_slab;
+ds_slab_t              table_slab;
 ZEND_END_MODULE_GLOBALS(ds)
 
 #ifdef ZTS
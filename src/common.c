@@ -1,5 +1,201 @@
+// mremap is a GNU extension, which is only declared if this is defined before
+// the first system header is included.
+#if defined(__linux__) && ! defined(_GNU_SOURCE)
+# define _GNU_SOURCE
+#endif
+
 #include "common.h"
 
+#if defined(__linux__) && defined(HAVE_MREMAP)
+# include <sys/mman.h>
+#endif
+
+#ifdef MREMAP_MAYMOVE
+
+/**
+ * Buffers of at least this many bytes are mapped directly rather than being
+ * allocated by the memory manager, so that they can be grown by remapping
+ * their pages instead of copying them.
+ */
+#define DS_MAPPED_BUFFER_MIN_SIZE ((size_t) 4 * 1024 * 1024)
+
+static inline zend_ulong ds_mapped_buffer_key(void *buffer)
+{
+    return (zend_ulong) (uintptr_t) buffer;
+}
+
+/**
+ * Returns the mapped size of a buffer, or 0 if it was not mapped.
+ */
+static size_t ds_mapped_buffer_size(void *buffer)
+{
+    zval *size;
+
+    if ( ! DSG(mapped_buffers)) {
+        return 0;
+    }
+
+    size = zend_hash_index_find(DSG(mapped_buffers), ds_mapped_buffer_key(buffer));
+    return size ? (size_t) Z_LVAL_P(size) : 0;
+}
+
+static void ds_mapped_buffer_track(void *buffer, size_t size)
+{
+    zval tmp;
+
+    if ( ! DSG(mapped_buffers)) {
+        DSG(mapped_buffers) = pemalloc(sizeof(HashTable), 1);
+        zend_hash_init(DSG(mapped_buffers), 8, NULL, NULL, 1);
+    }
+
+    ZVAL_LONG(&tmp, size);
+    zend_hash_index_update(DSG(mapped_buffers), ds_mapped_buffer_key(buffer), &tmp);
+
+    DSG(mapped_size) += size;
+}
+
+static void ds_mapped_buffer_untrack(void *buffer, size_t size)
+{
+    zend_hash_index_del(DSG(mapped_buffers), ds_mapped_buffer_key(buffer));
+
+    DSG(mapped_size) -= size;
+}
+
+/**
+ * Mapped buffers are not seen by the memory manager, so they are counted
+ * against the memory limit here along with everything else it allocated.
+ */
+static void ds_mapped_buffer_check_limit(size_t grow)
+{
+    zend_long limit = PG(memory_limit);
+
+    if (limit > 0 && zend_memory_usage(1) + DSG(mapped_size) + grow > (size_t) limit) {
+        zend_error_noreturn(E_ERROR,
+            "Allowed memory size of " ZEND_LONG_FMT " bytes exhausted (tried to allocate %zu bytes)",
+            limit, grow);
+    }
+}
+
+static inline void ds_mapped_buffer_advise(void *buffer, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    madvise(buffer, size, MADV_HUGEPAGE);
+#endif
+}
+
+static void *ds_mapped_buffer(size_t size)
+{
+    void *buffer;
+
+    ds_mapped_buffer_check_limit(size);
+
+    buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (buffer == MAP_FAILED) {
+        zend_error_noreturn(E_ERROR, "Out of memory (tried to allocate %zu bytes)", size);
+    }
+
+    ds_mapped_buffer_advise(buffer, size);
+    ds_mapped_buffer_track(buffer, size);
+
+    return buffer;
+}
+
+static void *ds_remapped_buffer(void *buffer, size_t mapped, size_t size)
+{
+    void *remapped;
+
+    if (size > mapped) {
+        ds_mapped_buffer_check_limit(size - mapped);
+    }
+
+    remapped = mremap(buffer, mapped, size, MREMAP_MAYMOVE);
+
+    if (remapped == MAP_FAILED) {
+        zend_error_noreturn(E_ERROR, "Out of memory (tried to allocate %zu bytes)", size);
+    }
+
+    ds_mapped_buffer_untrack(buffer, mapped);
+    ds_mapped_buffer_advise(remapped, size);
+    ds_mapped_buffer_track(remapped, size);
+
+    return remapped;
+}
+
+static void ds_unmap_buffer(void *buffer, size_t mapped)
+{
+    ds_mapped_buffer_untrack(buffer, mapped);
+    munmap(buffer, mapped);
+}
+
+#endif
+
+void *ds_reallocate_buffer(void *buffer, size_t size, size_t current)
+{
+#ifdef MREMAP_MAYMOVE
+    size_t mapped = ds_mapped_buffer_size(buffer);
+
+    if (mapped) {
+        void *copy;
+
+        if (size >= DS_MAPPED_BUFFER_MIN_SIZE) {
+            return ds_remapped_buffer(buffer, mapped, size);
+        }
+
+        // Small enough to be allocated by the memory manager again.
+        copy = emalloc(size);
+        memcpy(copy, buffer, size);
+        ds_unmap_buffer(buffer, mapped);
+        return copy;
+    }
+
+    if (size >= DS_MAPPED_BUFFER_MIN_SIZE && size > current) {
+        void *copy = ds_mapped_buffer(size);
+
+        memcpy(copy, buffer, current);
+        efree(buffer);
+        return copy;
+    }
+#endif
+
+    return erealloc(buffer, size);
+}
+
+void ds_free_buffer(void *buffer)
+{
+#ifdef MREMAP_MAYMOVE
+    size_t mapped = ds_mapped_buffer_size(buffer);
+
+    if (mapped) {
+        ds_unmap_buffer(buffer, mapped);
+        return;
+    }
+#endif
+
+    efree(buffer);
+}
+
+void ds_free_mapped_buffers()
+{
+#ifdef MREMAP_MAYMOVE
+    if (DSG(mapped_buffers)) {
+        zend_ulong key;
+        zval *size;
+
+        ZEND_HASH_FOREACH_NUM_KEY_VAL(DSG(mapped_buffers), key, size) {
+            munmap((void *) (uintptr_t) key, (size_t) Z_LVAL_P(size));
+        }
+        ZEND_HASH_FOREACH_END();
+
+        zend_hash_destroy(DSG(mapped_buffers));
+        pefree(DSG(mapped_buffers), 1);
+
+        DSG(mapped_buffers) = NULL;
+        DSG(mapped_size)    = 0;
+    }
+#endif
+}
+
 zval *ds_allocate_zval_buffer(zend_long length)
 {
     return ecalloc(length, sizeof(zval));
@@ -39,7 +235,7 @@ zval *ds_reallocate_zval_buffer(
         }
     }
 
-    buffer = erealloc(buffer, length * sizeof(zval));
+    buffer = ds_reallocate_buffer(buffer, length * sizeof(zval), current * sizeof(zval));
 
     // Clear out any new memory that was allocated.
     if (length > current) {
@@ -49,6 +245,137 @@ zval *ds_reallocate_zval_buffer(
     return buffer;
 }
 
+static zend_class_entry     ds_shared_ce;
+static zend_object_handlers ds_shared_handlers;
+
+static void ds_shared_free_object(zend_object *object)
+{
+    ds_shared_t *shared = (ds_shared_t *) object;
+
+    // The values belong to the owners, which free them with the buffer.
+    zend_object_std_dtor(&shared->std);
+
+    if (shared->gc_data) {
+        efree(shared->gc_data);
+    }
+}
+
+static HashTable *ds_shared_get_gc(zval *obj, zval **gc_data, int *gc_count)
+{
+    ds_shared_t *shared = (ds_shared_t *) Z_OBJ_P(obj);
+
+    if (shared->blocks) {
+        zend_long mask = (1 << shared->bits) - 1;
+        zend_long end  = shared->head + shared->length;
+        zend_long position;
+        int count = 0;
+
+        if (shared->gc_size < shared->length) {
+            shared->gc_size = (int) shared->length;
+            shared->gc_data = safe_erealloc(shared->gc_data, shared->gc_size, sizeof(zval), 0);
+        }
+
+        for (position = shared->head; position < end; position++) {
+            zval *value = &shared->blocks[position >> shared->bits][position & mask];
+            ZVAL_COPY_VALUE(&shared->gc_data[count++], value);
+        }
+
+        *gc_data  = shared->gc_data;
+        *gc_count = count;
+
+    } else {
+        *gc_data  = shared->length > 0 ? shared->values : NULL;
+        *gc_count = (int) shared->length;
+    }
+
+    return NULL;
+}
+
+void ds_register_shared_buffers()
+{
+    // The class is never registered, so that it can't be used directly.
+    INIT_CLASS_ENTRY(ds_shared_ce, PHP_DS_NS(SharedBuffer), NULL);
+
+    memcpy(&ds_shared_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+
+    ds_shared_handlers.offset   = XtOffsetOf(ds_shared_t, std);
+    ds_shared_handlers.dtor_obj = zend_objects_destroy_object;
+    ds_shared_handlers.free_obj = ds_shared_free_object;
+    ds_shared_handlers.get_gc   = ds_shared_get_gc;
+}
+
+static ds_shared_t *ds_shared_add_owner(uint32_t **refs)
+{
+    ds_shared_t *shared;
+
+    if (*refs == NULL) {
+        shared = ecalloc(1, sizeof(ds_shared_t));
+        zend_object_std_init(&shared->std, &ds_shared_ce);
+        shared->std.handlers = &ds_shared_handlers;
+        shared->refs = 1;
+
+        ZVAL_OBJ(&shared->object, &shared->std);
+
+        *refs = &shared->refs;
+    } else {
+        shared = DS_SHARED_FROM_REFS(*refs);
+    }
+
+    // Every owner holds a reference to the object.
+#if PHP_VERSION_ID >= 70300
+    GC_ADDREF(&shared->std);
+#else
+    ++GC_REFCOUNT(&shared->std);
+#endif
+    shared->refs++;
+
+    return shared;
+}
+
+uint32_t *ds_share_buffer(uint32_t **refs, zval *values, zend_long length)
+{
+    ds_shared_t *shared = ds_shared_add_owner(refs);
+
+    // A buffer that only had one owner left may have changed since.
+    shared->values = values;
+    shared->blocks = NULL;
+    shared->length = length;
+
+    return *refs;
+}
+
+uint32_t *ds_share_blocks(uint32_t **refs, zval **blocks, int bits, zend_long head, zend_long length)
+{
+    ds_shared_t *shared = ds_shared_add_owner(refs);
+
+    shared->values = NULL;
+    shared->blocks = blocks;
+    shared->bits   = bits;
+    shared->head   = head;
+    shared->length = length;
+
+    return *refs;
+}
+
+bool ds_unshare_buffer(uint32_t **refs)
+{
+    ds_shared_t *shared;
+    bool still_shared;
+
+    if (*refs == NULL) {
+        return false;
+    }
+
+    shared = DS_SHARED_FROM_REFS(*refs);
+    *refs  = NULL;
+
+    // The last owner takes the buffer back as its own.
+    still_shared = --shared->refs > 0;
+
+    OBJ_RELEASE(&shared->std);
+    return still_shared;
+}
+
 static int ds_zval_user_compare_func(const void *a, const void *b)
 {
     zval params[2];
@@ -146,6 +473,86 @@ void ds_normalize_slice_args(
     }
 }
 
+void ds_normalize_splice_args(
+    zend_long *offset,
+    zend_long *length,
+    zend_long size
+) {
+    // Unlike a slice, a splice can start at the end, to insert values there.
+    if (*offset >= size) {
+        *offset = size;
+        *length = 0;
+
+    } else {
+        ds_normalize_slice_args(offset, length, size);
+    }
+}
+
+typedef struct ds_zval_buffer_builder {
+    zval       *buffer;
+    zend_long   capacity;
+    zend_long   size;
+} ds_zval_buffer_builder_t;
+
+static int ds_zval_buffer_builder_add(zend_object_iterator *iterator, void *puser)
+{
+    ds_zval_buffer_builder_t *builder = (ds_zval_buffer_builder_t *) puser;
+
+    if (builder->size == builder->capacity) {
+        builder->buffer = ds_reallocate_zval_buffer(
+            builder->buffer, builder->capacity * 2, builder->capacity, builder->size);
+
+        builder->capacity *= 2;
+    }
+
+    ZVAL_COPY(&builder->buffer[builder->size++], iterator->funcs->get_current_data(iterator));
+    return ZEND_HASH_APPLY_KEEP;
+}
+
+zval *ds_values_to_zval_buffer(zval *values, zend_long *size)
+{
+    if (ds_is_array(values)) {
+        HashTable *array = Z_ARRVAL_P(values);
+        zval *buffer = ds_allocate_zval_buffer(MAX(1, zend_hash_num_elements(array)));
+        zval *target = buffer;
+        zval *value;
+
+        ZEND_HASH_FOREACH_VAL(array, value) {
+            ZVAL_COPY(target++, value);
+        }
+        ZEND_HASH_FOREACH_END();
+
+        *size = target - buffer;
+        return buffer;
+    }
+
+    if (ds_is_traversable(values)) {
+        ds_zval_buffer_builder_t builder;
+
+        builder.buffer   = ds_allocate_zval_buffer(8);
+        builder.capacity = 8;
+        builder.size     = 0;
+
+        spl_iterator_apply(values, ds_zval_buffer_builder_add, (void *) &builder);
+
+        // Release whatever was collected before the iterator failed.
+        if (EG(exception)) {
+            while (builder.size > 0) {
+                zval_ptr_dtor(&builder.buffer[--builder.size]);
+            }
+
+            ds_free_buffer(builder.buffer);
+            return NULL;
+        }
+
+        *size = builder.size;
+        return builder.buffer;
+    }
+
+    ARRAY_OR_TRAVERSABLE_REQUIRED();
+    return NULL;
+}
+
 void smart_str_appendz(smart_str *buffer, zval *value)
 {
     switch (Z_TYPE_P(value)) {
@@ -233,6 +640,11 @@ bool ds_php_array_uses_keys(HashTable *ht)
     return false;
 }
 
+bool ds_php_array_is_packed(HashTable *ht)
+{
+    return (ht->u.flags & HASH_FLAG_PACKED) && ht->nNumUsed == ht->nNumOfElements;
+}
+
 void ds_reverse_zval_range(zval *x, zval *y)
 {
     for (; x < --y; ++x) SWAP_ZVAL(*x, *y);
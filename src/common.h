@@ -36,12 +36,24 @@
  */
 #define EXPECTED_BOOL_IS_TRUE(z) (Z_TYPE_P(z) != IS_FALSE && zend_is_true(z))
 
+/**
+ * Hints that memory will be read soon, where the compiler supports it.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define DS_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define DS_PREFETCH(p)
+#endif
+
 /**
  * Combined class, name, and arginfo method entry.
  */
 #define PHP_DS_ME(cls, name) \
     PHP_ME(cls, name, arginfo_##cls##_##name, ZEND_ACC_PUBLIC)
 
+#define PHP_DS_ME_STATIC(cls, name) \
+    PHP_ME(cls, name, arginfo_##cls##_##name, ZEND_ACC_PUBLIC | ZEND_ACC_STATIC)
+
 /**
  *
  */
@@ -96,6 +108,22 @@ do {                                                                    \
     }                                                                   \
 } while (0)
 
+/**
+ * Determines if a buffer should be halved after values were removed, which
+ * is when its size has dropped to 1/N of its capacity for a shrink threshold
+ * of N. A threshold of 0 never shrinks, and thresholds of 1 and 2 are rejected
+ * when set, so a halved buffer always has room left for the next push.
+ */
+#define DS_SHOULD_SHRINK(size, capacity) \
+    (DSG(shrink_threshold) > 0 && (size) <= (capacity) / DSG(shrink_threshold))
+
+/**
+ * Determines if a buffer's shared reference count has more than one owner.
+ * A buffer that has a count is reported to the GC through its shared object,
+ * even if it has only one owner left, see ds_share_buffer.
+ */
+#define DS_BUFFER_IS_SHARED(refs) ((refs) && *(refs) > 1)
+
 /**
  * Used to replace a buffer with a new one.
  */
@@ -119,6 +147,15 @@ do {                                        \
     }                                       \
 } while (0)
 
+/**
+ * Bit set of buffer positions, eg. to record which values a callback kept so
+ * that a buffer can be compacted afterwards without calling back into user
+ * code halfway through.
+ */
+#define DS_BITSET_ALLOCATE(n)  ((uint32_t *) ecalloc(((n) + 31) / 32, sizeof(uint32_t)))
+#define DS_BITSET_SET(b, i)    ((b)[(i) >> 5] |= ((uint32_t) 1 << ((i) & 31)))
+#define DS_BITSET_HAS(b, i)    ((b)[(i) >> 5] &  ((uint32_t) 1 << ((i) & 31)))
+
 /**
  * Used to determine if a string zval is equal to a string literal.
  * Eg. ZVAL_EQUALS_STRING(value, "test")
@@ -156,6 +193,15 @@ int name##_unserialize(                 \
     zend_unserialize_data   *data       \
 )
 
+/**
+ * __serialize and __unserialize, which are used instead of the functions
+ * above from PHP 7.4. Collections are represented by a packed array, so the
+ * engine serializes the values itself and can use back-references.
+ */
+#define PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(name)                          \
+void name##_magic_serialize(zval *object, zval *return_value);          \
+void name##_magic_unserialize(zval *object, HashTable *data)
+
 /** EXCEPTIONS **************************************************************/
 
 #define ARRAY_ACCESS_BY_KEY_NOT_SUPPORTED() ds_throw_exception( \
@@ -214,6 +260,57 @@ int name##_unserialize(                 \
     zend_ce_error, \
     "Failed to unserialize data")
 
+#define INVALID_BINARY_DATA() ds_throw_exception( \
+    spl_ce_UnexpectedValueException, \
+    "Invalid or unsupported binary data")
+
+#define INVALID_MAPPED_FILE() ds_throw_exception( \
+    spl_ce_UnexpectedValueException, \
+    "Invalid or unsupported mapped file")
+
+#define VALUE_CAN_NOT_BE_MAPPED(z) ds_throw_exception( \
+    spl_ce_InvalidArgumentException, \
+    "Only null, bool, int, float and string values can be mapped, %s given", \
+    zend_get_type_by_const(Z_TYPE_P(z)))
+
+#define KEY_CAN_NOT_BE_MAPPED(z) ds_throw_exception( \
+    spl_ce_InvalidArgumentException, \
+    "Only int and string keys can be mapped, %s given", \
+    zend_get_type_by_const(Z_TYPE_P(z)))
+
+#define VALUE_CAN_NOT_BE_APPENDED(z) ds_throw_exception( \
+    spl_ce_UnexpectedValueException, \
+    "Only an array or a Vector can be appended to, %s given", \
+    zend_get_type_by_const(Z_TYPE_P(z)))
+
+#define FILE_NOT_OPENED(path) ds_throw_exception( \
+    spl_ce_RuntimeException, \
+    "Failed to open %s", path)
+
+#define FILE_NOT_WRITTEN(path) ds_throw_exception( \
+    spl_ce_RuntimeException, \
+    "Failed to write %s", path)
+
+#define STREAM_WRITE_FAILED() ds_throw_exception( \
+    spl_ce_RuntimeException, \
+    "Failed to write to the stream")
+
+#define JSON_NOT_DECODED(message) ds_throw_exception( \
+    spl_ce_UnexpectedValueException, \
+    "Failed to decode JSON: %s", message)
+
+#define JSON_NOT_ENCODED(message) ds_throw_exception( \
+    spl_ce_UnexpectedValueException, \
+    "Failed to encode JSON: %s", message)
+
+#define JSON_TYPE_NOT_EXPECTED(type) ds_throw_exception( \
+    spl_ce_UnexpectedValueException, \
+    "Failed to decode JSON: Expected an %s", type)
+
+#define JSON_DEPTH_MUST_BE_POSITIVE() ds_throw_exception( \
+    spl_ce_InvalidArgumentException, \
+    "Depth must be greater than zero")
+
 #define RECONSTRUCTION_NOT_ALLOWED() ds_throw_exception( \
     zend_ce_error, \
     "Immutable objects may not be reconstructed")
@@ -222,6 +319,19 @@ int name##_unserialize(                 \
     zend_ce_error, \
     "Immutable objects may not be changed")
 
+#define MODIFIED_BY_CALLBACK() ds_throw_exception( \
+    spl_ce_RuntimeException, \
+    "Collection was modified by the callback")
+
+#define MODIFIED_DURING_ITERATION() ds_throw_exception( \
+    spl_ce_RuntimeException, \
+    "Collection was modified during iteration")
+
+#define COUNT_OUT_OF_RANGE() ds_throw_exception( \
+    spl_ce_OverflowException, \
+    "Count out of range, the total may not exceed " ZEND_LONG_FMT, \
+    ZEND_LONG_MAX)
+
 /**
  *
  */
@@ -256,6 +366,23 @@ void ds_normalize_slice_args(
     zend_long size
 );
 
+/**
+ * Normalizes input parameters for a splice the same way as for a slice, except
+ * that an offset at or beyond the end is an empty range at the end.
+ */
+void ds_normalize_splice_args(
+    zend_long *offset,
+    zend_long *length,
+    zend_long size
+);
+
+/**
+ * Copies the values of an array or traversable object into a new zval buffer,
+ * and sets 'size' to the number of values. Throws and returns NULL if the
+ * values are neither, or if the traversal fails.
+ */
+zval *ds_values_to_zval_buffer(zval *values, zend_long *size);
+
 /**
  * Allocates a zval buffer of a specified length.
  */
@@ -270,6 +397,77 @@ zval *ds_allocate_zval_buffer(zend_long length);
  */
 zval *ds_reallocate_zval_buffer(zval *buffer, zend_long length, zend_long current, zend_long used);
 
+/**
+ * Reallocates a buffer to a specified size in bytes. Very large buffers are
+ * mapped directly where the platform allows it, so that they can be grown
+ * without copying. Buffers that may have been reallocated this way must be
+ * freed using ds_free_buffer.
+ *
+ * @param  buffer
+ * @param  size    The resulting size of the buffer.
+ * @param  current The current size of the buffer.
+ */
+void *ds_reallocate_buffer(void *buffer, size_t size, size_t current);
+
+/**
+ * Frees a buffer that may have been reallocated by ds_reallocate_buffer.
+ */
+void ds_free_buffer(void *buffer);
+
+/**
+ * Unmaps any buffers that were not freed by the end of the request.
+ */
+void ds_free_mapped_buffers();
+
+/**
+ * A buffer that is shared between copies is held by a hidden object, which
+ * every owner references. The GC then sees the values of the buffer as the
+ * children of a single object that is collected with its last owner, so they
+ * are reported once rather than once for every owner.
+ */
+typedef struct _ds_shared_t {
+    zend_object   std;
+    uint32_t      refs;     // Number of owners
+    zval         *values;   // Values of a contiguous buffer
+    zval        **blocks;   // Blocks of a buffer that isn't contiguous
+    int           bits;     // Log2 of the length of a block
+    zend_long     head;     // Offset of the first value in the first block
+    zend_long     length;   // Number of values, some of which may be undefined
+    zval         *gc_data;  // Values gathered from the blocks for the GC
+    int           gc_size;  // Length of the gc buffer
+    zval          object;   // The object itself, to be reported by the owners
+} ds_shared_t;
+
+#define DS_SHARED_FROM_REFS(r)     ((ds_shared_t *) ((char *) (r) - XtOffsetOf(ds_shared_t, refs)))
+
+/**
+ * Adds an owner to a buffer that is shared using a reference count, creating
+ * the count if the buffer was not shared before. Returns the shared count.
+ * The values are reported to the GC as long as the buffer has an owner, and
+ * may not change until it's unshared.
+ */
+uint32_t *ds_share_buffer(uint32_t **refs, zval *values, zend_long length);
+
+/**
+ * Shares a buffer that is split into blocks of 1 << bits values, where the
+ * values start at offset 'head' in the first block.
+ */
+uint32_t *ds_share_blocks(uint32_t **refs, zval **blocks, int bits, zend_long head, zend_long length);
+
+/**
+ * Removes an owner from a shared buffer. Returns true if the buffer is still
+ * used by another owner, which means that it may not be modified or freed.
+ */
+bool ds_unshare_buffer(uint32_t **refs);
+
+/**
+ * Returns the object that holds a shared buffer, which an owner reports to
+ * the GC instead of the values of the buffer.
+ */
+#define DS_SHARED_BUFFER_GC(r) (&DS_SHARED_FROM_REFS(r)->object)
+
+void ds_register_shared_buffers();
+
 /**
  * Sorts a zval buffer in place using the default internal compare_func.
  */
@@ -300,6 +498,12 @@ bool ds_is_array(zval *value);
  */
 bool ds_php_array_uses_keys(HashTable *ht);
 
+/**
+ * Determines if an array is packed and has no holes, ie. its values can be
+ * read directly from its bucket buffer in order.
+ */
+bool ds_php_array_is_packed(HashTable *ht);
+
 /**
  * Determines if a zval is an object and implements Traversable.
  */
@@ -0,0 +1,872 @@
+#include "../common.h"
+
+#include "ds_binary.h"
+
+typedef struct ds_binary_writer {
+    smart_str               buf;
+    php_stream             *stream;     // Flushed to in chunks, or NULL
+    bool                    failed;     // Whether a write to the stream failed
+    php_serialize_data_t    var_hash;
+} ds_binary_writer_t;
+
+typedef struct ds_binary_reader {
+    const unsigned char    *pos;
+    const unsigned char    *end;
+    php_stream             *stream;     // Read from as needed, or NULL
+    unsigned char          *buffer;     // Bytes read from the stream
+    size_t                  capacity;   // Length of the buffer
+    php_unserialize_data_t  var_hash;
+} ds_binary_reader_t;
+
+/**
+ * Writing
+ */
+static void ds_binary_writer_flush(ds_binary_writer_t *writer)
+{
+    size_t length = writer->buf.s ? ZSTR_LEN(writer->buf.s) : 0;
+
+    if (length > 0) {
+        if (php_stream_write(writer->stream, ZSTR_VAL(writer->buf.s), length) != length) {
+            writer->failed = true;
+        }
+
+        // Keep the allocation for the next chunk.
+        ZSTR_LEN(writer->buf.s) = 0;
+    }
+}
+
+/**
+ * Flushes the buffer to the stream once it's at least a chunk long, so that
+ * writing to a stream never buffers much more than a chunk.
+ */
+static inline void ds_binary_writer_check(ds_binary_writer_t *writer)
+{
+    if (writer->stream && writer->buf.s && ZSTR_LEN(writer->buf.s) >= DS_BINARY_CHUNK_SIZE) {
+        ds_binary_writer_flush(writer);
+    }
+}
+
+static void ds_binary_write_bytes(ds_binary_writer_t *writer, const char *bytes, size_t length)
+{
+    // Large strings are written directly rather than copied into the buffer.
+    if (writer->stream && length >= DS_BINARY_CHUNK_SIZE) {
+        ds_binary_writer_flush(writer);
+
+        if (php_stream_write(writer->stream, bytes, length) != length) {
+            writer->failed = true;
+        }
+
+        return;
+    }
+
+    smart_str_appendl(&writer->buf, bytes, length);
+}
+
+static void ds_binary_write_varint(ds_binary_writer_t *writer, zend_ulong n)
+{
+    while (n >= 0x80) {
+        smart_str_appendc(&writer->buf, (char) ((n & 0x7F) | 0x80));
+        n >>= 7;
+    }
+
+    smart_str_appendc(&writer->buf, (char) n);
+}
+
+static void ds_binary_write_uint64(ds_binary_writer_t *writer, uint64_t n)
+{
+    unsigned char bytes[8];
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        bytes[i] = (unsigned char) (n >> (i * 8));
+    }
+
+    smart_str_appendl(&writer->buf, (const char *) bytes, 8);
+}
+
+static void ds_binary_write_uint32(ds_binary_writer_t *writer, uint32_t n)
+{
+    unsigned char bytes[4];
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        bytes[i] = (unsigned char) (n >> (i * 8));
+    }
+
+    smart_str_appendl(&writer->buf, (const char *) bytes, 4);
+}
+
+static void ds_binary_write_value(ds_binary_writer_t *writer, zval *value)
+{
+    ZVAL_DEREF(value);
+
+    switch (Z_TYPE_P(value)) {
+        case IS_NULL:
+            smart_str_appendc(&writer->buf, DS_BINARY_NULL);
+            break;
+
+        case IS_FALSE:
+            smart_str_appendc(&writer->buf, DS_BINARY_FALSE);
+            break;
+
+        case IS_TRUE:
+            smart_str_appendc(&writer->buf, DS_BINARY_TRUE);
+            break;
+
+        case IS_LONG:
+            smart_str_appendc(&writer->buf, DS_BINARY_LONG);
+            ds_binary_write_uint64(writer, (uint64_t) Z_LVAL_P(value));
+            break;
+
+        case IS_DOUBLE: {
+            uint64_t bits;
+            double   dval = Z_DVAL_P(value);
+
+            memcpy(&bits, &dval, sizeof(bits));
+
+            smart_str_appendc(&writer->buf, DS_BINARY_DOUBLE);
+            ds_binary_write_uint64(writer, bits);
+            break;
+        }
+
+        case IS_STRING:
+            smart_str_appendc(&writer->buf, DS_BINARY_STRING);
+            ds_binary_write_varint(writer, Z_STRLEN_P(value));
+            ds_binary_write_bytes(writer, Z_STRVAL_P(value), Z_STRLEN_P(value));
+            break;
+
+        default: {
+            smart_str serialized = {0};
+
+            // The length comes first so that a reader knows how much to read.
+            php_var_serialize(&serialized, value, &writer->var_hash);
+            smart_str_0(&serialized);
+
+            smart_str_appendc(&writer->buf, DS_BINARY_SERIALIZED);
+            ds_binary_write_varint(writer, ZSTR_LEN(serialized.s));
+            ds_binary_write_bytes(writer, ZSTR_VAL(serialized.s), ZSTR_LEN(serialized.s));
+
+            smart_str_free(&serialized);
+            break;
+        }
+    }
+
+    ds_binary_writer_check(writer);
+}
+
+static void ds_binary_writer_init(ds_binary_writer_t *writer, php_stream *stream)
+{
+    memset(&writer->buf, 0, sizeof(smart_str));
+
+    writer->stream = stream;
+    writer->failed = false;
+
+    PHP_VAR_SERIALIZE_INIT(writer->var_hash);
+}
+
+static void ds_binary_write_header(ds_binary_writer_t *writer, ds_binary_type_t type, zend_long count)
+{
+    // Most values take 9 bytes or more, which avoids most of the reallocations.
+    size_t length = 16 + count * 9;
+
+    if (writer->stream) {
+        length = MIN(length, DS_BINARY_CHUNK_SIZE * 2);
+    }
+
+    smart_str_alloc(&writer->buf, length, 0);
+    smart_str_appendl(&writer->buf, "DS", 2);
+    smart_str_appendc(&writer->buf, DS_BINARY_VERSION);
+    smart_str_appendc(&writer->buf, type);
+
+    ds_binary_write_varint(writer, count);
+}
+
+static zend_string *ds_binary_writer_finish(ds_binary_writer_t *writer)
+{
+    PHP_VAR_SERIALIZE_DESTROY(writer->var_hash);
+
+    smart_str_0(&writer->buf);
+    return writer->buf.s;
+}
+
+/**
+ * Flushes what's left to the stream, throwing if any write failed.
+ */
+static bool ds_binary_writer_close(ds_binary_writer_t *writer)
+{
+    PHP_VAR_SERIALIZE_DESTROY(writer->var_hash);
+
+    ds_binary_writer_flush(writer);
+    smart_str_free(&writer->buf);
+
+    if (writer->failed && ! EG(exception)) {
+        STREAM_WRITE_FAILED();
+    }
+
+    return ! writer->failed;
+}
+
+/**
+ * Reading
+ */
+
+/**
+ * Makes sure that at least n bytes can be read. Data in memory is either
+ * long enough or it isn't, but a stream is read from until there are n
+ * bytes. Only the bytes that are needed are taken from the stream, so that
+ * whatever follows the collection can still be read from it.
+ */
+static bool ds_binary_reader_ensure(ds_binary_reader_t *reader, size_t n)
+{
+    size_t available = reader->end - reader->pos;
+
+    if (available >= n) {
+        return true;
+    }
+
+    if ( ! reader->stream) {
+        return false;
+    }
+
+    // Move what's left to the front of the buffer.
+    if (reader->pos != reader->buffer) {
+        memmove(reader->buffer, reader->pos, available);
+        reader->pos = reader->buffer;
+        reader->end = reader->buffer + available;
+    }
+
+    while (available < n) {
+        ssize_t read;
+
+        // Grow the buffer only as bytes arrive, so that a corrupt length
+        // can't allocate much more than the stream actually has.
+        if (available == reader->capacity) {
+            reader->capacity = MIN(n, reader->capacity * 2);
+            reader->buffer   = erealloc(reader->buffer, reader->capacity);
+            reader->pos      = reader->buffer;
+            reader->end      = reader->buffer + available;
+        }
+
+        read = php_stream_read(reader->stream, (char *) reader->buffer + available,
+            MIN(n, reader->capacity) - available);
+
+        if (read <= 0) {
+            return false;
+        }
+
+        available   += read;
+        reader->end += read;
+    }
+
+    return true;
+}
+
+static bool ds_binary_read_varint(ds_binary_reader_t *reader, zend_ulong *n)
+{
+    zend_ulong result = 0;
+    int shift = 0;
+
+    while (shift < (int) (sizeof(zend_ulong) * 8) && ds_binary_reader_ensure(reader, 1)) {
+        unsigned char byte = *reader->pos++;
+
+        result |= ((zend_ulong) (byte & 0x7F)) << shift;
+
+        if ( ! (byte & 0x80)) {
+            *n = result;
+            return true;
+        }
+
+        shift += 7;
+    }
+
+    return false;
+}
+
+static bool ds_binary_read_uint64(ds_binary_reader_t *reader, uint64_t *n)
+{
+    uint64_t result = 0;
+    int i;
+
+    if ( ! ds_binary_reader_ensure(reader, 8)) {
+        return false;
+    }
+
+    for (i = 0; i < 8; i++) {
+        result |= ((uint64_t) reader->pos[i]) << (i * 8);
+    }
+
+    reader->pos += 8;
+    *n = result;
+    return true;
+}
+
+static bool ds_binary_read_uint32(ds_binary_reader_t *reader, uint32_t *n)
+{
+    uint32_t result = 0;
+    int i;
+
+    if ( ! ds_binary_reader_ensure(reader, 4)) {
+        return false;
+    }
+
+    for (i = 0; i < 4; i++) {
+        result |= ((uint32_t) reader->pos[i]) << (i * 8);
+    }
+
+    reader->pos += 4;
+    *n = result;
+    return true;
+}
+
+/**
+ * Reads a value into a zval that the caller becomes the owner of.
+ */
+static bool ds_binary_read_value(ds_binary_reader_t *reader, zval *value)
+{
+    if ( ! ds_binary_reader_ensure(reader, 1)) {
+        return false;
+    }
+
+    switch (*reader->pos++) {
+        case DS_BINARY_NULL:
+            ZVAL_NULL(value);
+            return true;
+
+        case DS_BINARY_FALSE:
+            ZVAL_FALSE(value);
+            return true;
+
+        case DS_BINARY_TRUE:
+            ZVAL_TRUE(value);
+            return true;
+
+        case DS_BINARY_LONG: {
+            uint64_t n;
+
+            if ( ! ds_binary_read_uint64(reader, &n)) {
+                return false;
+            }
+
+            ZVAL_LONG(value, (zend_long) n);
+            return true;
+        }
+
+        case DS_BINARY_DOUBLE: {
+            uint64_t bits;
+            double   dval;
+
+            if ( ! ds_binary_read_uint64(reader, &bits)) {
+                return false;
+            }
+
+            memcpy(&dval, &bits, sizeof(dval));
+            ZVAL_DOUBLE(value, dval);
+            return true;
+        }
+
+        case DS_BINARY_STRING: {
+            zend_ulong length;
+
+            if ( ! ds_binary_read_varint(reader, &length) || ! ds_binary_reader_ensure(reader, length)) {
+                return false;
+            }
+
+            ZVAL_STRINGL(value, (const char *) reader->pos, length);
+            reader->pos += length;
+            return true;
+        }
+
+        case DS_BINARY_SERIALIZED: {
+            zend_ulong length;
+            const unsigned char *end;
+            zval *tmp;
+
+            if ( ! ds_binary_read_varint(reader, &length) || ! ds_binary_reader_ensure(reader, length)) {
+                return false;
+            }
+
+            end = reader->pos + length;
+            tmp = var_tmp_var(&reader->var_hash);
+
+            if ( ! php_var_unserialize(tmp, &reader->pos, end, &reader->var_hash) || reader->pos != end) {
+                return false;
+            }
+
+            ZVAL_COPY(value, tmp);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void ds_binary_reader_init(ds_binary_reader_t *reader, const char *data, size_t length)
+{
+    reader->pos      = (const unsigned char *) data;
+    reader->end      = (const unsigned char *) data + length;
+    reader->stream   = NULL;
+    reader->buffer   = NULL;
+    reader->capacity = 0;
+
+    PHP_VAR_UNSERIALIZE_INIT(reader->var_hash);
+}
+
+static void ds_binary_reader_init_stream(ds_binary_reader_t *reader, php_stream *stream)
+{
+    reader->buffer   = emalloc(DS_BINARY_CHUNK_SIZE);
+    reader->capacity = DS_BINARY_CHUNK_SIZE;
+    reader->pos      = reader->buffer;
+    reader->end      = reader->buffer;
+    reader->stream   = stream;
+
+    PHP_VAR_UNSERIALIZE_INIT(reader->var_hash);
+}
+
+/**
+ * Reads the header and returns the number of values, or -1 if the data is
+ * not valid for the given type of collection.
+ */
+static zend_long ds_binary_read_header(ds_binary_reader_t *reader, ds_binary_type_t type)
+{
+    zend_ulong count;
+
+    if ( ! ds_binary_reader_ensure(reader, 4)
+            || reader->pos[0] != 'D'
+            || reader->pos[1] != 'S'
+            || reader->pos[2] != DS_BINARY_VERSION
+            || reader->pos[3] != (unsigned char) type) {
+        return -1;
+    }
+
+    reader->pos += 4;
+
+    if ( ! ds_binary_read_varint(reader, &count) || count > ZEND_LONG_MAX) {
+        return -1;
+    }
+
+    // Every value takes at least one byte, which prevents a corrupt count
+    // from allocating more than the length of the data.
+    if ( ! reader->stream && count > (zend_ulong) (reader->end - reader->pos)) {
+        return -1;
+    }
+
+    return (zend_long) count;
+}
+
+/**
+ * The capacity to allocate for a number of values. The length of a stream
+ * is not known, so a collection read from one starts with at most a chunk
+ * of values and grows as more are read.
+ */
+static inline zend_long ds_binary_reader_hint(ds_binary_reader_t *reader, zend_long count)
+{
+    return reader->stream ? MIN(count, DS_BINARY_CHUNK_SIZE) : count;
+}
+
+/**
+ * Destroys the reader, throwing if the data was not valid.
+ */
+static void ds_binary_reader_finish(ds_binary_reader_t *reader, bool valid)
+{
+    PHP_VAR_UNSERIALIZE_DESTROY(reader->var_hash);
+
+    if (reader->buffer) {
+        efree(reader->buffer);
+    }
+
+    if ( ! valid && ! EG(exception)) {
+        INVALID_BINARY_DATA();
+    }
+}
+
+/**
+ * Encoding
+ */
+static void ds_binary_write_table(ds_binary_writer_t *writer, ds_htable_t *table, bool values)
+{
+    ds_htable_bucket_t *bucket;
+
+    DS_HTABLE_FOREACH_BUCKET(table, bucket) {
+        ds_binary_write_uint32(writer, DS_HTABLE_BUCKET_HASH(bucket));
+        ds_binary_write_value(writer, &bucket->key);
+
+        if (values) {
+            ds_binary_write_value(writer, &bucket->value);
+        }
+    }
+    DS_HTABLE_FOREACH_END();
+}
+
+static void ds_binary_write_vector_ex(ds_binary_writer_t *writer, ds_vector_t *vector, ds_binary_type_t type)
+{
+    zval *value;
+
+    ds_binary_write_header(writer, type, vector->size);
+
+    DS_VECTOR_FOREACH(vector, value) {
+        ds_binary_write_value(writer, value);
+    }
+    DS_VECTOR_FOREACH_END();
+}
+
+static void ds_binary_write_vector(ds_binary_writer_t *writer, ds_vector_t *vector)
+{
+    ds_binary_write_vector_ex(writer, vector, DS_BINARY_VECTOR);
+}
+
+static void ds_binary_write_stack(ds_binary_writer_t *writer, ds_stack_t *stack)
+{
+    ds_binary_write_vector_ex(writer, stack->vector, DS_BINARY_STACK);
+}
+
+static void ds_binary_write_deque(ds_binary_writer_t *writer, ds_deque_t *deque)
+{
+    zval *value;
+
+    ds_binary_write_header(writer, DS_BINARY_DEQUE, deque->size);
+
+    DS_DEQUE_FOREACH(deque, value) {
+        ds_binary_write_value(writer, value);
+    }
+    DS_DEQUE_FOREACH_END();
+}
+
+static void ds_binary_write_queue(ds_binary_writer_t *writer, ds_queue_t *queue)
+{
+    zval *value;
+
+    ds_binary_write_header(writer, DS_BINARY_QUEUE, queue->size);
+
+    DS_QUEUE_FOREACH(queue, value) {
+        ds_binary_write_value(writer, value);
+    }
+    DS_QUEUE_FOREACH_END();
+}
+
+static void ds_binary_write_set(ds_binary_writer_t *writer, ds_set_t *set)
+{
+    ds_binary_write_header(writer, DS_BINARY_SET, set->table->size);
+    ds_binary_write_table(writer, set->table, false);
+}
+
+static void ds_binary_write_map(ds_binary_writer_t *writer, ds_map_t *map)
+{
+    ds_binary_write_header(writer, DS_BINARY_MAP, map->table->size);
+    ds_binary_write_table(writer, map->table, true);
+}
+
+static void ds_binary_write_priority_queue(ds_binary_writer_t *writer, ds_priority_queue_t *queue)
+{
+    ds_binary_write_header(writer, DS_BINARY_PRIORITY_QUEUE, queue->size);
+
+    // Written in the same order as serialize, so that values of equal
+    // priority keep their order when they are pushed again.
+    if (queue->size > 0) {
+        ds_priority_queue_node_t *nodes = ds_priority_queue_create_sorted_buffer(queue);
+        ds_priority_queue_node_t *pos   = nodes;
+        ds_priority_queue_node_t *end   = nodes + queue->size;
+
+        for (; pos < end; ++pos) {
+            ds_binary_write_value(writer, &pos->value);
+            ds_binary_write_value(writer, &pos->priority);
+        }
+
+        efree(nodes);
+    }
+}
+
+/**
+ * Defines the functions that encode a collection to a string and to a stream.
+ */
+#define DS_BINARY_ENCODER(name, type)                                   \
+zend_string *ds_binary_encode_##name(type *collection)                 \
+{                                                                       \
+    ds_binary_writer_t writer;                                          \
+    ds_binary_writer_init(&writer, NULL);                               \
+    ds_binary_write_##name(&writer, collection);                        \
+    return ds_binary_writer_finish(&writer);                            \
+}                                                                       \
+                                                                        \
+bool ds_binary_encode_##name##_to(type *collection, php_stream *stream) \
+{                                                                       \
+    ds_binary_writer_t writer;                                          \
+    ds_binary_writer_init(&writer, stream);                             \
+    ds_binary_write_##name(&writer, collection);                        \
+    return ds_binary_writer_close(&writer);                             \
+}
+
+DS_BINARY_ENCODER(vector,         ds_vector_t)
+DS_BINARY_ENCODER(stack,          ds_stack_t)
+DS_BINARY_ENCODER(deque,          ds_deque_t)
+DS_BINARY_ENCODER(queue,          ds_queue_t)
+DS_BINARY_ENCODER(set,            ds_set_t)
+DS_BINARY_ENCODER(map,            ds_map_t)
+DS_BINARY_ENCODER(priority_queue, ds_priority_queue_t)
+
+/**
+ * Decoding
+ */
+static ds_vector_t *ds_binary_read_vector_ex(ds_binary_reader_t *reader, ds_binary_type_t type)
+{
+    zval *buffer;
+    zend_long index;
+    zend_long capacity;
+
+    zend_long count = ds_binary_read_header(reader, type);
+
+    if (count < 0) {
+        return NULL;
+    }
+
+    capacity = ds_binary_reader_hint(reader, count);
+    buffer   = ds_allocate_zval_buffer(capacity);
+
+    for (index = 0; index < count; index++) {
+        if (index == capacity) {
+            zend_long grown = MIN(capacity * 2, count);
+
+            buffer   = ds_reallocate_zval_buffer(buffer, grown, capacity, index);
+            capacity = grown;
+        }
+
+        if ( ! ds_binary_read_value(reader, &buffer[index])) {
+            while (index > 0) {
+                zval_ptr_dtor(&buffer[--index]);
+            }
+
+            ds_free_buffer(buffer);
+            return NULL;
+        }
+    }
+
+    return ds_vector_from_buffer(buffer, capacity, count);
+}
+
+static ds_vector_t *ds_binary_read_vector(ds_binary_reader_t *reader)
+{
+    return ds_binary_read_vector_ex(reader, DS_BINARY_VECTOR);
+}
+
+static ds_stack_t *ds_binary_read_stack(ds_binary_reader_t *reader)
+{
+    ds_vector_t *vector = ds_binary_read_vector_ex(reader, DS_BINARY_STACK);
+    return vector ? ds_stack_ex(vector) : NULL;
+}
+
+static ds_deque_t *ds_binary_read_deque(ds_binary_reader_t *reader)
+{
+    ds_deque_t *deque;
+    zval value;
+
+    zend_long count = ds_binary_read_header(reader, DS_BINARY_DEQUE);
+
+    if (count < 0) {
+        return NULL;
+    }
+
+    deque = ds_deque();
+    ds_deque_allocate(deque, ds_binary_reader_hint(reader, count));
+
+    while (count-- > 0) {
+        if ( ! ds_binary_read_value(reader, &value)) {
+            ds_deque_free(deque);
+            return NULL;
+        }
+
+        ds_deque_push(deque, &value);
+        zval_ptr_dtor(&value);
+    }
+
+    return deque;
+}
+
+static ds_queue_t *ds_binary_read_queue(ds_binary_reader_t *reader)
+{
+    ds_queue_t *queue;
+    zval value;
+
+    zend_long count = ds_binary_read_header(reader, DS_BINARY_QUEUE);
+
+    if (count < 0) {
+        return NULL;
+    }
+
+    queue = ds_queue();
+    ds_queue_allocate(queue, ds_binary_reader_hint(reader, count));
+
+    while (count-- > 0) {
+        if ( ! ds_binary_read_value(reader, &value)) {
+            ds_queue_free(queue);
+            return NULL;
+        }
+
+        ds_queue_push_one(queue, &value);
+        zval_ptr_dtor(&value);
+    }
+
+    return queue;
+}
+
+/**
+ * Reads the entries of a set or a map into a table.
+ */
+static bool ds_binary_read_table(ds_binary_reader_t *reader, ds_htable_t *table, zend_long count, bool values)
+{
+    zval key;
+    zval value;
+    uint32_t hash;
+
+    ds_htable_ensure_capacity(table, ds_binary_reader_hint(reader, count));
+
+    while (count-- > 0) {
+        if ( ! ds_binary_read_uint32(reader, &hash) || ! ds_binary_read_value(reader, &key)) {
+            return false;
+        }
+
+        if (values && ! ds_binary_read_value(reader, &value)) {
+            zval_ptr_dtor(&key);
+            return false;
+        }
+
+        // The stored hash is only a checksum: a key is always rehashed, and
+        // data that doesn't match could otherwise corrupt the table.
+        if (Z_TYPE(key) == IS_LONG || Z_TYPE(key) == IS_STRING) {
+            if (ds_htable_hash(&key) != hash) {
+                zval_ptr_dtor(&key);
+
+                if (values) {
+                    zval_ptr_dtor(&value);
+                }
+
+                return false;
+            }
+        } else {
+            // Other keys, eg. objects, could have a different hash than when
+            // they were written.
+            hash = ds_htable_hash(&key);
+        }
+
+        ds_htable_put_hashed(table, &key, hash, values ? &value : NULL);
+        zval_ptr_dtor(&key);
+
+        if (values) {
+            zval_ptr_dtor(&value);
+        }
+    }
+
+    return true;
+}
+
+static ds_set_t *ds_binary_read_set(ds_binary_reader_t *reader)
+{
+    ds_set_t *set;
+
+    zend_long count = ds_binary_read_header(reader, DS_BINARY_SET);
+
+    if (count < 0) {
+        return NULL;
+    }
+
+    set = ds_set();
+
+    if ( ! ds_binary_read_table(reader, set->table, count, false)) {
+        ds_set_free(set);
+        return NULL;
+    }
+
+    return set;
+}
+
+static ds_map_t *ds_binary_read_map(ds_binary_reader_t *reader)
+{
+    ds_map_t *map;
+
+    zend_long count = ds_binary_read_header(reader, DS_BINARY_MAP);
+
+    if (count < 0) {
+        return NULL;
+    }
+
+    map = ds_map();
+
+    if ( ! ds_binary_read_table(reader, map->table, count, true)) {
+        ds_map_free(map);
+        return NULL;
+    }
+
+    return map;
+}
+
+static ds_priority_queue_t *ds_binary_read_priority_queue(ds_binary_reader_t *reader)
+{
+    ds_priority_queue_t *queue;
+    zval value;
+    zval priority;
+
+    zend_long count = ds_binary_read_header(reader, DS_BINARY_PRIORITY_QUEUE);
+
+    if (count < 0 || count > UINT32_MAX) {
+        return NULL;
+    }
+
+    queue = ds_priority_queue();
+    ds_priority_queue_allocate(queue, (uint32_t) ds_binary_reader_hint(reader, count));
+
+    while (count-- > 0) {
+        if ( ! ds_binary_read_value(reader, &value)) {
+            goto error;
+        }
+
+        if ( ! ds_binary_read_value(reader, &priority)) {
+            zval_ptr_dtor(&value);
+            goto error;
+        }
+
+        ds_priority_queue_push(queue, &value, &priority);
+        zval_ptr_dtor(&value);
+        zval_ptr_dtor(&priority);
+
+        if (EG(exception)) {
+            goto error;
+        }
+    }
+
+    return queue;
+
+error:
+    ds_priority_queue_free(queue);
+    return NULL;
+}
+
+/**
+ * Defines the functions that decode a collection from a string and from a
+ * stream.
+ */
+#define DS_BINARY_DECODER(name, type)                                   \
+type *ds_binary_decode_##name(const char *data, size_t length)         \
+{                                                                       \
+    ds_binary_reader_t reader;                                          \
+    type *collection;                                                   \
+    ds_binary_reader_init(&reader, data, length);                       \
+    collection = ds_binary_read_##name(&reader);                        \
+    ds_binary_reader_finish(&reader, collection != NULL);               \
+    return collection;                                                  \
+}                                                                       \
+                                                                        \
+type *ds_binary_decode_##name##_from(php_stream *stream)               \
+{                                                                       \
+    ds_binary_reader_t reader;                                          \
+    type *collection;                                                   \
+    ds_binary_reader_init_stream(&reader, stream);                      \
+    collection = ds_binary_read_##name(&reader);                        \
+    ds_binary_reader_finish(&reader, collection != NULL);               \
+    return collection;                                                  \
+}
+
+DS_BINARY_DECODER(vector,         ds_vector_t)
+DS_BINARY_DECODER(stack,          ds_stack_t)
+DS_BINARY_DECODER(deque,          ds_deque_t)
+DS_BINARY_DECODER(queue,          ds_queue_t)
+DS_BINARY_DECODER(set,            ds_set_t)
+DS_BINARY_DECODER(map,            ds_map_t)
+DS_BINARY_DECODER(priority_queue, ds_priority_queue_t)
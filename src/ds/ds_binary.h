@@ -0,0 +1,102 @@
+#ifndef DS_BINARY_H
+#define DS_BINARY_H
+
+#include "../common.h"
+#include "ds_vector.h"
+#include "ds_deque.h"
+#include "ds_stack.h"
+#include "ds_queue.h"
+#include "ds_set.h"
+#include "ds_map.h"
+#include "ds_priority_queue.h"
+
+/**
+ * A compact binary format for collections, which is much faster to write
+ * and read than the text produced by serialize.
+ *
+ * The data starts with a header: the magic bytes "DS", a version, the type
+ * of the collection and the number of values, so that the collection can be
+ * allocated once before its values are read. Each value is a tag followed by
+ * its payload. Integers and floats are stored as 8 little-endian bytes, and
+ * strings as their length followed by their bytes. Everything else, eg.
+ * arrays and objects, is stored as the length and bytes of serialize. Keys
+ * of sets and maps are preceded by their hash so that loading doesn't
+ * rehash them.
+ *
+ * Lengths and counts are stored as unsigned LEB128 varints.
+ *
+ * Because every value is preceded by its length or has a fixed length, the
+ * format can also be written to and read from a stream in chunks, without
+ * holding all of it in memory.
+ */
+#define DS_BINARY_VERSION 2
+
+/**
+ * Number of bytes that are buffered before they are written to a stream.
+ */
+#define DS_BINARY_CHUNK_SIZE 65536
+
+typedef enum ds_binary_type {
+    DS_BINARY_VECTOR = 1,
+    DS_BINARY_DEQUE,
+    DS_BINARY_STACK,
+    DS_BINARY_QUEUE,
+    DS_BINARY_SET,
+    DS_BINARY_MAP,
+    DS_BINARY_PRIORITY_QUEUE,
+} ds_binary_type_t;
+
+typedef enum ds_binary_tag {
+    DS_BINARY_NULL = 0,
+    DS_BINARY_FALSE,
+    DS_BINARY_TRUE,
+    DS_BINARY_LONG,
+    DS_BINARY_DOUBLE,
+    DS_BINARY_STRING,
+    DS_BINARY_SERIALIZED,
+} ds_binary_tag_t;
+
+zend_string *ds_binary_encode_vector(ds_vector_t *vector);
+zend_string *ds_binary_encode_deque(ds_deque_t *deque);
+zend_string *ds_binary_encode_stack(ds_stack_t *stack);
+zend_string *ds_binary_encode_queue(ds_queue_t *queue);
+zend_string *ds_binary_encode_set(ds_set_t *set);
+zend_string *ds_binary_encode_map(ds_map_t *map);
+zend_string *ds_binary_encode_priority_queue(ds_priority_queue_t *queue);
+
+/**
+ * These return NULL and throw if the data is not valid for the collection.
+ */
+ds_vector_t         *ds_binary_decode_vector(const char *data, size_t length);
+ds_deque_t          *ds_binary_decode_deque(const char *data, size_t length);
+ds_stack_t          *ds_binary_decode_stack(const char *data, size_t length);
+ds_queue_t          *ds_binary_decode_queue(const char *data, size_t length);
+ds_set_t            *ds_binary_decode_set(const char *data, size_t length);
+ds_map_t            *ds_binary_decode_map(const char *data, size_t length);
+ds_priority_queue_t *ds_binary_decode_priority_queue(const char *data, size_t length);
+
+/**
+ * These write to a stream in chunks, and return false and throw if a write
+ * failed.
+ */
+bool ds_binary_encode_vector_to(ds_vector_t *vector, php_stream *stream);
+bool ds_binary_encode_deque_to(ds_deque_t *deque, php_stream *stream);
+bool ds_binary_encode_stack_to(ds_stack_t *stack, php_stream *stream);
+bool ds_binary_encode_queue_to(ds_queue_t *queue, php_stream *stream);
+bool ds_binary_encode_set_to(ds_set_t *set, php_stream *stream);
+bool ds_binary_encode_map_to(ds_map_t *map, php_stream *stream);
+bool ds_binary_encode_priority_queue_to(ds_priority_queue_t *queue, php_stream *stream);
+
+/**
+ * These read no more of the stream than the collection, and return NULL
+ * and throw if the data is not valid for the collection.
+ */
+ds_vector_t         *ds_binary_decode_vector_from(php_stream *stream);
+ds_deque_t          *ds_binary_decode_deque_from(php_stream *stream);
+ds_stack_t          *ds_binary_decode_stack_from(php_stream *stream);
+ds_queue_t          *ds_binary_decode_queue_from(php_stream *stream);
+ds_set_t            *ds_binary_decode_set_from(php_stream *stream);
+ds_map_t            *ds_binary_decode_map_from(php_stream *stream);
+ds_priority_queue_t *ds_binary_decode_priority_queue_from(php_stream *stream);
+
+#endif
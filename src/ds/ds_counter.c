@@ -0,0 +1,331 @@
+#include "../common.h"
+
+#include "../php/objects/php_counter.h"
+#include "../php/classes/php_counter_ce.h"
+
+#include "ds_counter.h"
+#include "ds_htable.h"
+#include "ds_map.h"
+
+static ds_counter_t *ds_counter_ex(ds_htable_t *table, zend_long total)
+{
+    ds_counter_t *counter = ecalloc(1, sizeof(ds_counter_t));
+    counter->table = table;
+    counter->total = total;
+    return counter;
+}
+
+ds_counter_t *ds_counter()
+{
+    return ds_counter_ex(ds_htable(), 0);
+}
+
+ds_counter_t *ds_counter_clone(ds_counter_t *counter)
+{
+    return ds_counter_ex(ds_htable_clone(counter->table), counter->total);
+}
+
+void ds_counter_free(ds_counter_t *counter)
+{
+    ds_htable_free(counter->table);
+    efree(counter);
+}
+
+void ds_counter_clear(ds_counter_t *counter)
+{
+    ds_htable_clear(counter->table);
+    counter->total = 0;
+}
+
+void ds_counter_allocate(ds_counter_t *counter, zend_long capacity)
+{
+    ds_htable_ensure_capacity(counter->table, capacity);
+}
+
+/**
+ * Subtracts from the count of a value, where 'count' is negative.
+ */
+static void ds_counter_reduce(ds_counter_t *counter, zval *value, zend_long count)
+{
+    ds_htable_t *table = counter->table;
+    ds_htable_bucket_t *bucket = ds_htable_lookup_by_key(table, value);
+
+    if ( ! bucket) {
+        return;
+    }
+
+    if (Z_LVAL(bucket->value) + count > 0) {
+        uint32_t index = bucket - table->buckets;
+
+        // A copy of a shared table keeps the same layout.
+        ds_htable_separate(table);
+
+        Z_LVAL(table->buckets[index].value) += count;
+        counter->total += count;
+
+    } else {
+        counter->total -= Z_LVAL(bucket->value);
+        ds_htable_remove(table, value, NULL);
+    }
+}
+
+void ds_counter_add(ds_counter_t *counter, zval *value, zend_long count)
+{
+    ds_htable_bucket_t *bucket;
+
+    if (count < 0) {
+        ds_counter_reduce(counter, value, count);
+        return;
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    // The total is never less than a single count, so checking it is enough.
+    // This is done before a new value is added to the table.
+    if (count > ZEND_LONG_MAX - counter->total) {
+        COUNT_OUT_OF_RANGE();
+        return;
+    }
+
+    if ( ! ds_htable_lookup_or_next(counter->table, value, &bucket)) {
+        ZVAL_LONG(&bucket->value, 0);
+    }
+
+    Z_LVAL(bucket->value) += count;
+    counter->total += count;
+}
+
+static int iterator_add(zend_object_iterator *iterator, void *puser)
+{
+    zval *value = iterator->funcs->get_current_data(iterator);
+
+    ZVAL_DEREF(value);
+    ds_counter_add((ds_counter_t *) puser, value, 1);
+
+    return EG(exception) ? ZEND_HASH_APPLY_STOP : ZEND_HASH_APPLY_KEEP;
+}
+
+static void ds_counter_add_counter(ds_counter_t *counter, ds_counter_t *other, zend_long sign)
+{
+    ds_htable_bucket_t *bucket;
+
+    DS_HTABLE_FOREACH_BUCKET(other->table, bucket) {
+        ds_counter_add(counter, &bucket->key, sign * Z_LVAL(bucket->value));
+
+        if (EG(exception)) {
+            return;
+        }
+    }
+    DS_HTABLE_FOREACH_END();
+}
+
+void ds_counter_add_all(ds_counter_t *counter, zval *values)
+{
+    if (values == NULL) {
+        return;
+    }
+
+    if (ds_is_array(values)) {
+        zval *value;
+
+        ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(values), value) {
+            ZVAL_DEREF(value);
+            ds_counter_add(counter, value, 1);
+
+            if (EG(exception)) {
+                return;
+            }
+        }
+        ZEND_HASH_FOREACH_END();
+        return;
+    }
+
+    if (Z_TYPE_P(values) == IS_OBJECT && Z_OBJCE_P(values) == php_ds_counter_ce) {
+        ds_counter_add_counter(counter, Z_DS_COUNTER_P(values), 1);
+        return;
+    }
+
+    if (ds_is_traversable(values)) {
+        spl_iterator_apply(values, iterator_add, counter);
+        return;
+    }
+
+    ARRAY_OR_TRAVERSABLE_REQUIRED();
+}
+
+zend_long ds_counter_get(ds_counter_t *counter, zval *value)
+{
+    ds_htable_bucket_t *bucket = ds_htable_lookup_by_key(counter->table, value);
+
+    return bucket ? Z_LVAL(bucket->value) : 0;
+}
+
+zend_long ds_counter_remove(ds_counter_t *counter, zval *value)
+{
+    zval removed;
+
+    if (ds_htable_remove(counter->table, value, &removed) == FAILURE) {
+        return 0;
+    }
+
+    counter->total -= Z_LVAL(removed);
+    return Z_LVAL(removed);
+}
+
+ds_counter_t *ds_counter_merge(ds_counter_t *counter, ds_counter_t *other)
+{
+    ds_counter_t *merged = ds_counter_clone(counter);
+    ds_counter_add_counter(merged, other, 1);
+    return merged;
+}
+
+ds_counter_t *ds_counter_subtract(ds_counter_t *counter, ds_counter_t *other)
+{
+    ds_counter_t *difference = ds_counter_clone(counter);
+    ds_counter_add_counter(difference, other, -1);
+    return difference;
+}
+
+/**
+ * Determines if a bucket comes before another in the most common order, ie.
+ * it has a greater count or was counted first. Buckets are never equal.
+ */
+static inline bool ds_counter_bucket_precedes(ds_htable_bucket_t *a, ds_htable_bucket_t *b)
+{
+    zend_long x = Z_LVAL(a->value);
+    zend_long y = Z_LVAL(b->value);
+
+    return x > y || (x == y && a < b);
+}
+
+static int ds_counter_bucket_compare(const void *a, const void *b)
+{
+    return ds_counter_bucket_precedes(
+        *(ds_htable_bucket_t **) a,
+        *(ds_htable_bucket_t **) b
+    ) ? -1 : 1;
+}
+
+/**
+ * The heap keeps the bucket that comes last at the root, so that it can be
+ * replaced by a bucket that comes before it.
+ */
+static void ds_counter_heap_sift_up(ds_htable_bucket_t **heap, zend_long index)
+{
+    while (index > 0) {
+        zend_long parent = (index - 1) / 2;
+        ds_htable_bucket_t *tmp;
+
+        if ( ! ds_counter_bucket_precedes(heap[parent], heap[index])) {
+            return;
+        }
+
+        tmp           = heap[parent];
+        heap[parent]  = heap[index];
+        heap[index]   = tmp;
+        index         = parent;
+    }
+}
+
+static void ds_counter_heap_sift_down(ds_htable_bucket_t **heap, zend_long size, zend_long index)
+{
+    for (;;) {
+        zend_long left  = index * 2 + 1;
+        zend_long right = index * 2 + 2;
+        zend_long last  = index;
+        ds_htable_bucket_t *tmp;
+
+        if (left < size && ds_counter_bucket_precedes(heap[last], heap[left])) {
+            last = left;
+        }
+
+        if (right < size && ds_counter_bucket_precedes(heap[last], heap[right])) {
+            last = right;
+        }
+
+        if (last == index) {
+            return;
+        }
+
+        tmp         = heap[last];
+        heap[last]  = heap[index];
+        heap[index] = tmp;
+        index       = last;
+    }
+}
+
+ds_map_t *ds_counter_most_common(ds_counter_t *counter, zend_long n)
+{
+    ds_htable_t         *table = counter->table;
+    ds_htable_bucket_t **heap;
+    ds_htable_bucket_t  *bucket;
+    ds_map_t            *map = ds_map();
+    zend_long            size = 0;
+    zend_long            i;
+
+    if (n > table->size) {
+        n = table->size;
+    }
+
+    if (n <= 0) {
+        return map;
+    }
+
+    heap = emalloc(n * sizeof(ds_htable_bucket_t *));
+
+    DS_HTABLE_FOREACH_BUCKET(table, bucket) {
+        if (n == table->size) {
+            heap[size++] = bucket;
+
+        } else if (size < n) {
+            heap[size] = bucket;
+            ds_counter_heap_sift_up(heap, size++);
+
+        } else if (ds_counter_bucket_precedes(bucket, heap[0])) {
+            heap[0] = bucket;
+            ds_counter_heap_sift_down(heap, size, 0);
+        }
+    }
+    DS_HTABLE_FOREACH_END();
+
+    qsort(heap, size, sizeof(ds_htable_bucket_t *), ds_counter_bucket_compare);
+
+    ds_map_allocate(map, size);
+
+    for (i = 0; i < size; i++) {
+        bucket = heap[i];
+        ds_htable_put_hashed(map->table, &bucket->key, DS_HTABLE_BUCKET_HASH(bucket), &bucket->value);
+    }
+
+    efree(heap);
+    return map;
+}
+
+bool ds_counter_recount(ds_counter_t *counter)
+{
+    zend_long total = 0;
+    zval *count;
+
+    DS_HTABLE_FOREACH_VALUE(counter->table, count) {
+        if (Z_TYPE_P(count) != IS_LONG || Z_LVAL_P(count) <= 0) {
+            return false;
+        }
+
+        if (Z_LVAL_P(count) > ZEND_LONG_MAX - total) {
+            return false;
+        }
+
+        total += Z_LVAL_P(count);
+    }
+    DS_HTABLE_FOREACH_END();
+
+    counter->total = total;
+    return true;
+}
+
+void ds_counter_to_array(ds_counter_t *counter, zval *return_value)
+{
+    ds_htable_to_array(counter->table, return_value);
+}
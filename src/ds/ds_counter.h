@@ -0,0 +1,68 @@
+#ifndef DS_COUNTER_H
+#define DS_COUNTER_H
+
+#include "../common.h"
+#include "ds_htable.h"
+#include "ds_map.h"
+
+#define DS_COUNTER_SIZE(c)     ((c)->table->size)
+#define DS_COUNTER_CAPACITY(c) ((c)->table->capacity)
+#define DS_COUNTER_IS_EMPTY(c) (DS_COUNTER_SIZE(c) == 0)
+
+/**
+ * Counts are stored in place as the integer values of the table, so they
+ * are never allocated or reference counted. Only positive counts are kept.
+ */
+typedef struct _ds_counter_t {
+    ds_htable_t *table;
+    zend_long    total;     // Sum of all counts
+} ds_counter_t;
+
+ds_counter_t *ds_counter();
+ds_counter_t *ds_counter_clone(ds_counter_t *counter);
+
+void ds_counter_free(ds_counter_t *counter);
+void ds_counter_clear(ds_counter_t *counter);
+void ds_counter_allocate(ds_counter_t *counter, zend_long capacity);
+
+/**
+ * Adds to the count of a value, which is removed when its count is no longer
+ * positive. A new value is added with a single lookup. An OverflowException
+ * is thrown if the total would no longer fit in an integer.
+ */
+void ds_counter_add(ds_counter_t *counter, zval *value, zend_long count);
+
+/**
+ * Adds one for every value of an array or traversable object, or adds all the
+ * counts of another counter.
+ */
+void ds_counter_add_all(ds_counter_t *counter, zval *values);
+
+zend_long ds_counter_get(ds_counter_t *counter, zval *value);
+
+/**
+ * Removes a value, returning the count that it had.
+ */
+zend_long ds_counter_remove(ds_counter_t *counter, zval *value);
+
+ds_counter_t *ds_counter_merge(ds_counter_t *counter, ds_counter_t *other);
+ds_counter_t *ds_counter_subtract(ds_counter_t *counter, ds_counter_t *other);
+
+/**
+ * Creates a map of the most common values to their counts, from the most to
+ * the least common. Values with the same count are in the order that they
+ * were first counted. Only a heap of 'n' buckets is kept while scanning, so
+ * the whole counter is only sorted if 'n' is not less than its size.
+ */
+ds_map_t *ds_counter_most_common(ds_counter_t *counter, zend_long n);
+
+/**
+ * Recalculates the total after counts were loaded directly into the table.
+ * Returns false if a count is not a positive integer, or if the total would
+ * no longer fit in an integer.
+ */
+bool ds_counter_recount(ds_counter_t *counter);
+
+void ds_counter_to_array(ds_counter_t *counter, zval *return_value);
+
+#endif
@@ -81,17 +81,39 @@ static ds_deque_t *ds_deque_from_buffer(zval *buffer, zend_long capacity, zend_l
 
 ds_deque_t *ds_deque_clone(ds_deque_t *deque)
 {
-    zval *source;
-    zval *buffer = ds_allocate_zval_buffer(deque->capacity);
-    zval *target = buffer;
+    ds_deque_t *clone = ecalloc(1, sizeof(ds_deque_t));
+
+    // Unused positions are undefined, so a buffer that wraps around can be
+    // reported to the GC as a whole.
+    zend_long used = MIN(deque->head + deque->size, deque->capacity);
+
+    // Share the buffer until either deque is changed.
+    clone->buffer   = deque->buffer;
+    clone->capacity = deque->capacity;
+    clone->head     = deque->head;
+    clone->tail     = deque->tail;
+    clone->size     = deque->size;
+    clone->refs     = ds_share_buffer(&deque->refs, deque->buffer, used);
+
+    ZVAL_COPY(&clone->snapshot, &deque->snapshot);
+    return clone;
+}
 
-    DS_DEQUE_FOREACH(deque, source) {
-        ZVAL_COPY(target, source);
-        target++;
-    }
-    DS_DEQUE_FOREACH_END();
+void ds_deque_separate(ds_deque_t *deque)
+{
+    if (ds_unshare_buffer(&deque->refs)) {
+        zval *buffer = ds_allocate_zval_buffer(deque->capacity);
+        zend_long mask = deque->capacity - 1;
+        zend_long head = deque->head;
+        zend_long i;
 
-    return ds_deque_from_buffer(buffer, deque->capacity, deque->size);
+        // Keep the same layout so that the head and tail remain valid.
+        for (i = 0; i < deque->size; i++, head++) {
+            ZVAL_COPY(&buffer[head & mask], &deque->buffer[head & mask]);
+        }
+
+        deque->buffer = buffer;
+    }
 }
 
 
@@ -134,7 +156,8 @@ void ds_deque_reset_head(ds_deque_t *deque)
             memcpy(&buffer[0], &deque->buffer[h], r * sizeof(zval));
             memcpy(&buffer[r], &deque->buffer[0], t * sizeof(zval));
 
-            FREE_AND_REPLACE(deque->buffer, buffer);
+            ds_free_buffer(deque->buffer);
+            deque->buffer = buffer;
         }
     }
 
@@ -142,8 +165,49 @@ void ds_deque_reset_head(ds_deque_t *deque)
     deque->tail = deque->size;
 }
 
+/**
+ * Grows the buffer in place where the allocator allows it, then moves only
+ * the smaller of the two partitions of a ring that wraps around, rather than
+ * copying every value to a new buffer with the head at index 0.
+ */
+static void ds_deque_grow(ds_deque_t *deque, zend_long capacity)
+{
+    zend_long current = deque->capacity;
+
+    deque->buffer   = ds_reallocate_zval_buffer(deque->buffer, capacity, current, current);
+    deque->capacity = capacity;
+
+    if (deque->size == 0) {
+        deque->head = 0;
+        deque->tail = 0;
+
+    } else if (deque->head >= deque->tail) {
+        zend_long h = deque->head;
+        zend_long t = deque->tail;
+        zend_long r = current - h; // Number of values on the right.
+
+        if (t <= r) {
+            // Move the wrapped values to just after the right partition.
+            ds_deque_memmove(deque, current, 0, t);
+            memset(deque->buffer, 0, t * sizeof(zval));
+            deque->tail = current + t;
+
+        } else {
+            // Move the right partition to the end of the new buffer.
+            ds_deque_memmove(deque, capacity - r, h, r);
+            memset(&deque->buffer[h], 0, (MIN(current, capacity - r) - h) * sizeof(zval));
+            deque->head = capacity - r;
+        }
+    }
+}
+
 static void ds_deque_reallocate(ds_deque_t *deque, zend_long capacity)
 {
+    if (capacity > deque->capacity) {
+        ds_deque_grow(deque, capacity);
+        return;
+    }
+
     ds_deque_reset_head(deque);
 
     deque->buffer   = ds_reallocate_zval_buffer(deque->buffer, capacity, deque->capacity, deque->size);
@@ -166,14 +230,25 @@ void ds_deque_allocate(ds_deque_t *deque, zend_long size)
     // }
 
     if (capacity > deque->capacity) {
+        ds_deque_separate(deque);
+        ds_deque_reallocate(deque, capacity);
+    }
+}
+
+void ds_deque_shrink_to_fit(ds_deque_t *deque)
+{
+    zend_long capacity = ds_deque_get_capacity_for_size(deque->size);
+
+    if (capacity < deque->capacity) {
+        ds_deque_separate(deque);
         ds_deque_reallocate(deque, capacity);
     }
 }
 
 static inline void ds_deque_auto_truncate(ds_deque_t *deque)
 {
-    // Automatically truncate if the size of the deque drops to a quarter of the capacity.
-    if (deque->size <= deque->capacity / 4) {
+    // Automatically truncate if the size of the deque drops below the shrink threshold.
+    if (DS_SHOULD_SHRINK(deque->size, deque->capacity)) {
         if (deque->capacity / 2 >= DS_DEQUE_MIN_CAPACITY) {
             ds_deque_reallocate(deque, deque->capacity / 2);
         }
@@ -184,12 +259,21 @@ void ds_deque_clear(ds_deque_t *deque)
 {
     zval *val;
 
-    DS_DEQUE_FOREACH(deque, val) {
-        zval_ptr_dtor(val);
+    DS_DEQUE_INVALIDATE(deque);
+
+    // There's no need to copy a shared buffer only to clear it.
+    if (ds_unshare_buffer(&deque->refs)) {
+        deque->buffer = ds_allocate_zval_buffer(DS_DEQUE_MIN_CAPACITY);
+
+    } else {
+        DS_DEQUE_FOREACH(deque, val) {
+            zval_ptr_dtor(val);
+        }
+        DS_DEQUE_FOREACH_END();
+
+        deque->buffer = ds_reallocate_zval_buffer(deque->buffer, DS_DEQUE_MIN_CAPACITY, deque->capacity, 0);
     }
-    DS_DEQUE_FOREACH_END();
 
-    deque->buffer   = ds_reallocate_zval_buffer(deque->buffer, DS_DEQUE_MIN_CAPACITY, deque->capacity, 0);
     deque->head     = 0;
     deque->tail     = 0;
     deque->size     = 0;
@@ -200,12 +284,18 @@ void ds_deque_free(ds_deque_t *deque)
 {
     zval *val;
 
-    DS_DEQUE_FOREACH(deque, val) {
-        zval_ptr_dtor(val);
+    DS_DEQUE_INVALIDATE(deque);
+
+    // Leave a shared buffer to its other owners.
+    if ( ! ds_unshare_buffer(&deque->refs)) {
+        DS_DEQUE_FOREACH(deque, val) {
+            zval_ptr_dtor(val);
+        }
+        DS_DEQUE_FOREACH_END();
+
+        ds_free_buffer(deque->buffer);
     }
-    DS_DEQUE_FOREACH_END();
 
-    efree(deque->buffer);
     efree(deque);
 }
 
@@ -237,7 +327,11 @@ zval *ds_deque_get(ds_deque_t *deque, zend_long index)
 void ds_deque_set(ds_deque_t *deque, zend_long index, zval *value)
 {
     if (ds_deque_valid_position(deque, index)) {
-        zval *ptr = ds_deque_lookup(deque, index);
+        zval *ptr;
+
+        DS_DEQUE_SEPARATE(deque);
+
+        ptr = ds_deque_lookup(deque, index);
         zval_ptr_dtor(ptr);
         ZVAL_COPY(ptr, value);
     }
@@ -245,6 +339,8 @@ void ds_deque_set(ds_deque_t *deque, zend_long index, zval *value)
 
 void ds_deque_reverse(ds_deque_t *deque)
 {
+    DS_DEQUE_SEPARATE(deque);
+
     if (deque->head < deque->tail) {
         ds_reverse_zval_range(
             deque->buffer + deque->head,
@@ -285,6 +381,7 @@ ds_deque_t *ds_deque_reversed(ds_deque_t *deque)
 
 void ds_deque_shift(ds_deque_t *deque, zval *return_value)
 {
+    DS_DEQUE_SEPARATE(deque);
     SET_AS_RETURN_AND_UNDEF(&deque->buffer[deque->head]);
     ds_deque_increment_head(deque);
 
@@ -304,6 +401,7 @@ void ds_deque_shift_throw(ds_deque_t *deque, zval *return_value)
 
 void ds_deque_pop(ds_deque_t *deque, zval *return_value)
 {
+    DS_DEQUE_SEPARATE(deque);
     ds_deque_decrement_tail(deque);
     SET_AS_RETURN_AND_UNDEF(&deque->buffer[deque->tail]);
 
@@ -321,8 +419,114 @@ void ds_deque_pop_throw(ds_deque_t *deque, zval *return_value)
     ds_deque_pop(deque, return_value);
 }
 
+/**
+ * Moves 'length' values from buffer index 'src' to buffer index 'dst', where
+ * either range may wrap around the end of the buffer. This takes at most three
+ * memmoves, done in an order that is safe when the ranges overlap.
+ */
+static void ds_deque_move(ds_deque_t *deque, zend_long dst, zend_long src, zend_long length)
+{
+    const zend_long capacity = deque->capacity;
+    const zend_long mask     = capacity - 1;
+
+    if (length <= 0 || dst == src) {
+        return;
+    }
+
+    if (((dst - src) & mask) < length) {
+        // Moving towards the tail over values that haven't been moved yet,
+        // so move the contiguous parts from back to front.
+        zend_long s = (src + length) & mask;
+        zend_long d = (dst + length) & mask;
+
+        while (length > 0) {
+            zend_long n;
+
+            s = s ? s : capacity;
+            d = d ? d : capacity;
+            n = MIN(length, MIN(s, d));
+
+            ds_deque_memmove(deque, d - n, s - n, n);
+
+            s -= n;
+            d -= n;
+            length -= n;
+        }
+
+    } else {
+        while (length > 0) {
+            zend_long n = MIN(length, MIN(capacity - src, capacity - dst));
+
+            ds_deque_memmove(deque, dst, src, n);
+
+            src = (src + n) & mask;
+            dst = (dst + n) & mask;
+            length -= n;
+        }
+    }
+}
+
+/**
+ * Replaces 'length' values at position 'index' with 'count' values that are
+ * moved from 'src'. The values that are replaced are moved into 'removed',
+ * which must have room for them.
+ *
+ * Either the values before or after the range have to move to make room or
+ * close the gap, so this moves whichever side has fewer values, across the
+ * end of the buffer if it has to.
+ */
+static void ds_deque_replace_range(
+    ds_deque_t *deque,
+    zend_long   index,
+    zend_long   length,
+    zval       *src,
+    zend_long   count,
+    zval       *removed
+) {
+    zend_long size = deque->size - length + count;
+    zend_long i;
+
+    DS_DEQUE_SEPARATE(deque);
+
+    if (size > deque->capacity) {
+        ds_deque_reallocate(deque, ds_deque_get_capacity_for_size(size));
+    }
+
+    for (i = 0; i < length; i++) {
+        ZVAL_COPY_VALUE(&removed[i], ds_deque_lookup(deque, index + i));
+    }
+
+    if (count == length) {
+        // Nothing to move.
+
+    } else if (index < deque->size - index - length) {
+        // Move the values before the range, which moves the head.
+        zend_long head = (deque->head + length - count) & (deque->capacity - 1);
+
+        ds_deque_move(deque, head, deque->head, index);
+        deque->head = head;
+
+    } else {
+        // Move the values after the range, which moves the tail.
+        ds_deque_move(
+            deque,
+            ds_deque_lookup_index(deque, index + count),
+            ds_deque_lookup_index(deque, index + length),
+            deque->size - index - length);
+    }
+
+    for (i = 0; i < count; i++) {
+        ZVAL_COPY_VALUE(ds_deque_lookup(deque, index + i), &src[i]);
+    }
+
+    deque->size = size;
+    deque->tail = ds_deque_lookup_index(deque, size);
+}
+
 void ds_deque_remove(ds_deque_t *deque, zend_long index, zval *return_value)
 {
+    zval removed;
+
     if ( ! ds_deque_valid_position(deque, index)) {
         return;
     }
@@ -339,32 +543,101 @@ void ds_deque_remove(ds_deque_t *deque, zend_long index, zval *return_value)
         return;
     }
 
-    // Translate the positional index to a buffer index.
-    index = ds_deque_lookup_index(deque, index);
+    // Moves the value into the return value, and closes the gap by moving
+    // whichever side of the index has fewer values.
+    ds_deque_replace_range(deque, index, 1, NULL, 0, return_value ? return_value : &removed);
+    ds_deque_auto_truncate(deque);
 
-    // Copy the value into the return value, then clear it.
-    SET_AS_RETURN_AND_UNDEF(&deque->buffer[index]);
+    if ( ! return_value) {
+        zval_ptr_dtor(&removed);
+    }
+}
 
-    if (index < deque->tail) {
-        // Shift all values between the index and the tail.
-        ds_deque_memmove(deque, index, index + 1, deque->tail - index);
-        deque->tail--;
+ds_deque_t *ds_deque_splice(ds_deque_t *deque, zend_long index, zend_long length, zval *values)
+{
+    zval *src = NULL;
+    zval *removed;
+    zend_long count = 0;
+    zend_long capacity;
 
-    } else {
-        // Index comes after tail, and we know at this point that the index
-        // is valid, so it must be after the head which has wrapped around.
+    if (values && ! (src = ds_values_to_zval_buffer(values, &count))) {
+        return NULL;
+    }
+
+    ds_normalize_splice_args(&index, &length, deque->size);
+
+    capacity = ds_deque_get_capacity_for_size(length);
+    removed  = ds_allocate_zval_buffer(capacity);
 
-        // Unshift all values between the head and the index.
-        ds_deque_memmove(deque, deque->head + 1, deque->head, index - deque->head);
-        deque->head++;
+    ds_deque_replace_range(deque, index, length, src, count, removed);
+
+    if (src) {
+        ds_free_buffer(src);
     }
 
-    deque->size--;
+    if (count < length) {
+        ds_deque_auto_truncate(deque);
+    }
+
+    return ds_deque_from_buffer(removed, capacity, length);
+}
+
+void ds_deque_remove_range(ds_deque_t *deque, zend_long index, zend_long length)
+{
+    zval *removed;
+    zend_long i;
+
+    ds_normalize_slice_args(&index, &length, deque->size);
+
+    if (length == 0) {
+        return;
+    }
+
+    removed = ds_allocate_zval_buffer(length);
+    ds_deque_replace_range(deque, index, length, NULL, 0, removed);
     ds_deque_auto_truncate(deque);
+
+    // Release the values only once the deque is in a valid state again,
+    // because a destructor could access the deque.
+    for (i = 0; i < length; i++) {
+        zval_ptr_dtor(&removed[i]);
+    }
+
+    efree(removed);
+}
+
+void ds_deque_insert_all(ds_deque_t *deque, zend_long index, zval *values)
+{
+    zval *src;
+    zend_long count;
+
+    if (index < 0 || index > deque->size) {
+        INDEX_OUT_OF_RANGE(index, deque->size + 1);
+        return;
+    }
+
+    if ( ! (src = ds_values_to_zval_buffer(values, &count))) {
+        return;
+    }
+
+    // The index could be out of range now if the iterator changed the deque.
+    if (index <= deque->size) {
+        ds_deque_replace_range(deque, index, 0, src, count, NULL);
+
+    } else {
+        INDEX_OUT_OF_RANGE(index, deque->size + 1);
+
+        while (count > 0) {
+            zval_ptr_dtor(&src[--count]);
+        }
+    }
+
+    ds_free_buffer(src);
 }
 
 void ds_deque_unshift_va(ds_deque_t *deque, VA_PARAMS)
 {
+    DS_DEQUE_SEPARATE(deque);
     ds_deque_allocate(deque, deque->size + argc);
     deque->size += argc;
 
@@ -376,6 +649,8 @@ void ds_deque_unshift_va(ds_deque_t *deque, VA_PARAMS)
 
 void ds_deque_push(ds_deque_t *deque, zval *value)
 {
+    DS_DEQUE_SEPARATE(deque);
+
     if (deque->size == deque->capacity) {
         ds_deque_double_capacity(deque);
     }
@@ -387,6 +662,7 @@ void ds_deque_push(ds_deque_t *deque, zval *value)
 
 void ds_deque_push_va(ds_deque_t *deque, VA_PARAMS)
 {
+    DS_DEQUE_SEPARATE(deque);
     ds_deque_allocate(deque, deque->size + argc);
 
     while (argc) {
@@ -401,8 +677,7 @@ void ds_deque_push_va(ds_deque_t *deque, VA_PARAMS)
 
 void ds_deque_insert_va(ds_deque_t *deque, zend_long position, VA_PARAMS)
 {
-    zval *dst;
-    zend_long index;
+    zend_long i;
 
     // Basic push if inserting at the back.
     if (position == deque->size) {
@@ -426,49 +701,13 @@ void ds_deque_insert_va(ds_deque_t *deque, zend_long position, VA_PARAMS)
         return;
     }
 
-    // Make sure that we have enough room for the new values.
-    ds_deque_allocate(deque, deque->size + argc);
-
-    // Translate the positional index to a buffer index.
-    index = ds_deque_lookup_index(deque, position);
-
-    if (index <= deque->tail) {
-        // The deque is either contiguous or we're inserting in between the
-        // start of the buffer and the tail, where the head has wrapped around.
-
-        // Check for overflow, which is possible because the head won't
-        // always be at the start of the buffer.
-        if ((deque->tail + argc) > deque->capacity) {
-
-            // There isn't enough free space to the right of the tail,
-            // so move the entire sequence all the way to the left.
-            ds_deque_memmove(deque, 0, deque->head, deque->size);
-
-            index -= deque->head;
-            deque->head = 0;
-            deque->tail = deque->size;
-        }
-
-        // Move the subsequence after the insertion point to the right
-        // to make room for the new values.
-        ds_deque_memmove(deque, (index + argc), index, (deque->tail - index));
-        deque->tail += argc;
-        dst = &deque->buffer[index];
-
-    } else {
-        // We're inserting between a wrapped around head and the end of the
-        // buffer, and it's guaranteed that there's enough free space.
-        ds_deque_memmove(deque, (deque->head - argc), deque->head, (index - deque->head));
-        deque->head -= argc;
-        dst = &deque->buffer[index - argc];
+    // The values are moved into the deque, so each needs another reference.
+    for (i = 0; i < argc; i++) {
+        Z_TRY_ADDREF(argv[i]);
     }
 
-    deque->size += argc;
-
-    // Copy the new values into place.
-    while (argc--) {
-        ZVAL_COPY(dst++, argv++);
-    }
+    // Makes room by moving whichever side of the position has fewer values.
+    ds_deque_replace_range(deque, position, 0, argv, argc, NULL);
 }
 
 static zend_long ds_deque_find_index(ds_deque_t *deque, zval *value)
@@ -489,11 +728,16 @@ static zend_long ds_deque_find_index(ds_deque_t *deque, zval *value)
 
 void ds_deque_join(ds_deque_t *deque, char *str, size_t len, zval *return_value)
 {
-    ds_deque_reset_head(deque);
+    // Only a wrapped around buffer has to be moved, which is a change to the
+    // layout of the buffer, so it can't be done while it's shared.
+    if (deque->head + deque->size > deque->capacity) {
+        ds_deque_separate(deque);
+        ds_deque_reset_head(deque);
+    }
 
     ZVAL_STR(
         return_value,
-        ds_join_zval_buffer(deque->buffer, deque->size, str, len)
+        ds_join_zval_buffer(deque->buffer + deque->head, deque->size, str, len)
     );
 }
 
@@ -525,6 +769,8 @@ void ds_deque_rotate(ds_deque_t *deque, zend_long n)
         return;
     }
 
+    DS_DEQUE_SEPARATE(deque);
+
     if (n < 0) {
         for (n = llabs(n) % deque->size; n > 0; n--) {
 
@@ -556,14 +802,34 @@ void ds_deque_to_array(ds_deque_t *deque, zval *array)
 
     } else {
         zval *value;
+
         array_init_size(array, deque->size);
+        zend_hash_real_init(Z_ARRVAL_P(array), 1);
 
-        DS_DEQUE_FOREACH(deque, value) {
-            add_next_index_zval(array, value);
-            Z_TRY_ADDREF_P(value);
-        }
-        DS_DEQUE_FOREACH_END();
+        ZEND_HASH_FILL_PACKED(Z_ARRVAL_P(array)) {
+            DS_DEQUE_FOREACH(deque, value) {
+                Z_TRY_ADDREF_P(value);
+                ZEND_HASH_FILL_ADD(value);
+            }
+            DS_DEQUE_FOREACH_END();
+        } ZEND_HASH_FILL_END();
+    }
+}
+
+void ds_deque_to_array_cached(ds_deque_t *deque, zval *return_value)
+{
+    if ( ! DSG(array_snapshots)) {
+        ds_deque_to_array(deque, return_value);
+        return;
+    }
+
+    // The snapshot is shared, so any change made to the returned array will
+    // separate it first, leaving the snapshot as it was.
+    if (Z_ISUNDEF(deque->snapshot)) {
+        ds_deque_to_array(deque, &deque->snapshot);
     }
+
+    ZVAL_COPY(return_value, &deque->snapshot);
 }
 
 int ds_deque_index_exists(ds_deque_t *deque, zend_long index)
@@ -580,6 +846,31 @@ bool ds_deque_isset(ds_deque_t *deque, zend_long index, int check_empty)
     return ds_zval_isset(ds_deque_lookup(deque, index), check_empty);
 }
 
+bool ds_deque_equals(ds_deque_t *deque, ds_deque_t *other)
+{
+    zend_long index;
+
+    if (deque->size != other->size) {
+        return false;
+    }
+
+    // Shared buffers are always equal.
+    if (deque->buffer == other->buffer && deque->head == other->head) {
+        return true;
+    }
+
+    for (index = 0; index < deque->size; index++) {
+        zval *x = ds_deque_lookup(deque, index);
+        zval *y = ds_deque_lookup(other, index);
+
+        if ( ! fast_equal_check_function(x, y) || EG(exception)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 zval *ds_deque_get_last(ds_deque_t *deque)
 {
     return &deque->buffer[(deque->tail - 1) & (deque->capacity - 1)];
@@ -623,11 +914,24 @@ static void add_traversable_to_deque(ds_deque_t *deque, zval *obj)
 
 static void add_array_to_deque(ds_deque_t *deque, HashTable *arr)
 {
+    const zend_long n = zend_hash_num_elements(arr);
+
     zval *value;
+
+    if (n == 0) {
+        return;
+    }
+
+    // Allocate once up front so that we can copy without any capacity checks.
+    ds_deque_allocate(deque, deque->size + n);
+
     ZEND_HASH_FOREACH_VAL(arr, value) {
-        ds_deque_push(deque, value);
+        ZVAL_COPY(&deque->buffer[deque->tail], value);
+        ds_deque_increment_tail(deque);
     }
     ZEND_HASH_FOREACH_END();
+
+    deque->size += n;
 }
 
 void ds_deque_push_all(ds_deque_t *deque, zval *values)
@@ -637,6 +941,7 @@ void ds_deque_push_all(ds_deque_t *deque, zval *values)
     }
 
     if (ds_is_array(values)) {
+        DS_DEQUE_SEPARATE(deque);
         add_array_to_deque(deque, Z_ARRVAL_P(values));
         return;
     }
@@ -663,12 +968,17 @@ ds_deque_t *ds_deque_merge(ds_deque_t *deque, zval *values)
 
 void ds_deque_sort_callback(ds_deque_t *deque)
 {
+    DS_DEQUE_SEPARATE(deque);
     ds_deque_reset_head(deque);
     ds_user_sort_zval_buffer(deque->buffer, deque->size);
+
+    // The comparator may have created a snapshot while we were sorting.
+    DS_DEQUE_INVALIDATE(deque);
 }
 
 void ds_deque_sort(ds_deque_t *deque)
 {
+    DS_DEQUE_SEPARATE(deque);
     ds_deque_reset_head(deque);
     ds_sort_zval_buffer(deque->buffer, deque->size);
 }
@@ -677,21 +987,105 @@ void ds_deque_apply(ds_deque_t *deque, FCI_PARAMS)
 {
     zval *value;
     zval retval;
+    zend_long index;
 
-    DS_DEQUE_FOREACH(deque, value) {
+    for (index = 0; index < deque->size; index++) {
         fci.param_count = 1;
-        fci.params      = value;
+        fci.params      = ds_deque_lookup(deque, index);
         fci.retval      = &retval;
 
         if (zend_call_function(&fci, &fci_cache) == FAILURE || Z_ISUNDEF(retval)) {
             return;
         }
 
+        // The callback may have copied the deque or created a snapshot,
+        // so we have to separate and look up the value every time.
+        DS_DEQUE_SEPARATE(deque);
+
+        value = ds_deque_lookup(deque, index);
         zval_ptr_dtor(value);
         ZVAL_COPY_VALUE(value, &retval);
     }
+}
 
-    DS_DEQUE_FOREACH_END();
+/**
+ * Removes values in place, keeping those for which the truth of the callback's
+ * return value matches 'keep'.
+ */
+static void ds_deque_retain_ex(ds_deque_t *deque, bool keep_if, FCI_PARAMS)
+{
+    zval retval;
+    zend_long index;
+    zend_long target;
+    zend_long size = deque->size;
+    zend_ulong changes = deque->changes;
+    uint32_t *keep;
+
+    if (size == 0) {
+        return;
+    }
+
+    keep = DS_BITSET_ALLOCATE(size);
+
+    // Decide which values to keep before changing anything, because the
+    // callback could access or copy the deque while it's being called.
+    for (index = 0; index < size; index++) {
+        fci.param_count = 1;
+        fci.params      = ds_deque_lookup(deque, index);
+        fci.retval      = &retval;
+
+        if (zend_call_function(&fci, &fci_cache) == FAILURE || Z_ISUNDEF(retval)) {
+            efree(keep);
+            return;
+        }
+
+        if (EXPECTED_BOOL_IS_TRUE(&retval) == keep_if) {
+            DS_BITSET_SET(keep, index);
+        }
+
+        zval_ptr_dtor(&retval);
+
+        // The positions of the bits are only valid while values are neither
+        // added, removed nor moved, eg. by a sort or a shift and a push.
+        if (deque->changes != changes) {
+            MODIFIED_BY_CALLBACK();
+            efree(keep);
+            return;
+        }
+    }
+
+    // Compact the buffer in a single pass, with a cursor for the next
+    // position, which wraps around the end of the buffer along with the values.
+    DS_DEQUE_SEPARATE(deque);
+
+    for (index = 0, target = 0; index < size; index++) {
+        zval *value = ds_deque_lookup(deque, index);
+
+        if (DS_BITSET_HAS(keep, index)) {
+            if (target != index) {
+                ZVAL_COPY_VALUE(ds_deque_lookup(deque, target), value);
+            }
+            target++;
+        } else {
+            zval_ptr_dtor(value);
+        }
+    }
+
+    deque->size = target;
+    deque->tail = ds_deque_lookup_index(deque, target);
+    efree(keep);
+
+    ds_deque_auto_truncate(deque);
+}
+
+void ds_deque_retain(ds_deque_t *deque, FCI_PARAMS)
+{
+    ds_deque_retain_ex(deque, true, FCI_ARGS);
+}
+
+void ds_deque_remove_if(ds_deque_t *deque, FCI_PARAMS)
+{
+    ds_deque_retain_ex(deque, false, FCI_ARGS);
 }
 
 ds_deque_t *ds_deque_map(ds_deque_t *deque, FCI_PARAMS)
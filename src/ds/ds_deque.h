@@ -8,6 +8,30 @@
 #define DS_DEQUE_SIZE(d)      ((d)->size)
 #define DS_DEQUE_IS_EMPTY(d)  ((d)->size == 0)
 
+/**
+ * Releases the cached array snapshot, if any, and counts the change. This must
+ * be done before any change is made to the values in the buffer.
+ */
+#define DS_DEQUE_INVALIDATE(d)          \
+do {                                    \
+    ds_deque_t *_id = d;                \
+    DTOR_AND_UNDEF(&_id->snapshot);     \
+    _id->changes++;                     \
+} while (0)
+
+/**
+ * Prepares a deque for a change to its values or its buffer. This releases
+ * the array snapshot and copies the buffer if it's shared with another deque.
+ */
+#define DS_DEQUE_SEPARATE(d)        \
+do {                                \
+    ds_deque_t *_sd = d;            \
+    DS_DEQUE_INVALIDATE(_sd);       \
+    if (_sd->refs) {                \
+        ds_deque_separate(_sd);     \
+    }                               \
+} while (0)
+
 #define DS_DEQUE_FOREACH(d, v)                              \
 do {                                                        \
     const ds_deque_t *_deque = d;                           \
@@ -29,6 +53,9 @@ typedef struct _ds_deque_t {
     zend_long  head;
     zend_long  tail;
     zend_long  size;
+    zval       snapshot; // Cached array of the values, or undef
+    uint32_t  *refs;     // Owners of a shared buffer, or NULL if not shared
+    zend_ulong changes;  // Number of changes, to detect those by callbacks
 } ds_deque_t;
 
 ds_deque_t *ds_deque();
@@ -38,6 +65,12 @@ ds_deque_t *ds_deque_clone(ds_deque_t *src);
 void ds_deque_clear(ds_deque_t *deque);
 void ds_deque_free(ds_deque_t *deque);
 void ds_deque_allocate(ds_deque_t *deque, zend_long capacity);
+
+/**
+ * Reduces the capacity to the smallest power of 2 that fits the size.
+ */
+void ds_deque_shrink_to_fit(ds_deque_t *deque);
+void ds_deque_separate(ds_deque_t *deque);
 void ds_deque_reset_head(ds_deque_t *deque);
 
 void ds_deque_push(ds_deque_t *deque, zval *value);
@@ -77,7 +110,25 @@ void ds_deque_sort_callback(ds_deque_t *deque);
 void ds_deque_sort(ds_deque_t *deque);
 void ds_deque_reverse(ds_deque_t *deque);
 void ds_deque_to_array(ds_deque_t *deque, zval *return_value);
+void ds_deque_to_array_cached(ds_deque_t *deque, zval *return_value);
 void ds_deque_apply(ds_deque_t *deque, FCI_PARAMS);
+void ds_deque_retain(ds_deque_t *deque, FCI_PARAMS);
+void ds_deque_remove_if(ds_deque_t *deque, FCI_PARAMS);
+
+/**
+ * Replaces a range of values with the given values, which can be an array or
+ * a traversable object, and returns a deque of the values that were removed.
+ * Negative offsets and lengths are treated the same way as for a slice.
+ */
+ds_deque_t *ds_deque_splice(ds_deque_t *deque, zend_long index, zend_long length, zval *values);
+void ds_deque_remove_range(ds_deque_t *deque, zend_long index, zend_long length);
+void ds_deque_insert_all(ds_deque_t *deque, zend_long index, zval *values);
 void ds_deque_sum(ds_deque_t *deque, zval *return_value);
 
+/**
+ * Determines if two deques have the same size and equal values in the same
+ * order, stopping at the first value that is not equal.
+ */
+bool ds_deque_equals(ds_deque_t *deque, ds_deque_t *other);
+
 #endif
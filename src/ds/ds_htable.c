@@ -14,7 +14,9 @@ static inline ds_htable_bucket_t *ds_htable_allocate_buckets(uint32_t capacity)
 
 static inline ds_htable_bucket_t *ds_htable_reallocate_buckets(ds_htable_t *table, uint32_t capacity)
 {
-    return erealloc(table->buckets, capacity * sizeof(ds_htable_bucket_t));
+    return ds_reallocate_buffer(table->buckets,
+        capacity * sizeof(ds_htable_bucket_t),
+        table->capacity * sizeof(ds_htable_bucket_t));
 }
 
 static inline uint32_t *ds_htable_allocate_lookup(uint32_t capacity)
@@ -114,7 +116,7 @@ static inline void ds_htable_auto_truncate(ds_htable_t *table)
 {
     const uint32_t capacity = table->capacity;
 
-    if (table->size <= (capacity / 4) && (capacity / 2) >= DS_HTABLE_MIN_CAPACITY) {
+    if (DS_SHOULD_SHRINK(table->size, capacity) && (capacity / 2) >= DS_HTABLE_MIN_CAPACITY) {
         ds_htable_pack(table);
         ds_htable_realloc(table, capacity / 2);
         ds_htable_rehash(table);
@@ -123,7 +125,7 @@ static inline void ds_htable_auto_truncate(ds_htable_t *table)
 
 static ds_htable_t *ds_htable_with_capacity(uint32_t capacity)
 {
-    ds_htable_t *table = ecalloc(1, sizeof(ds_htable_t));
+    ds_htable_t *table = ds_slab_alloc(&DSG(table_slab));
 
     table->buckets     = ds_htable_allocate_buckets(capacity);
     table->lookup      = ds_htable_allocate_lookup(capacity);
@@ -131,6 +133,8 @@ static ds_htable_t *ds_htable_with_capacity(uint32_t capacity)
     table->min_deleted = capacity;
     table->size        = 0;
     table->next        = 0;
+    table->refs        = NULL;
+    table->changes     = 0;
 
     ds_htable_reset_lookup(table);
     return table;
@@ -160,19 +164,36 @@ static void ds_htable_copy(ds_htable_t *_src, ds_htable_t *_dst)
 
 ds_htable_t *ds_htable_clone(ds_htable_t *src)
 {
-    ds_htable_t *dst = ecalloc(1, sizeof(ds_htable_t));
+    ds_htable_t *dst = ds_slab_alloc(&DSG(table_slab));
 
-    dst->buckets     = ds_htable_allocate_buckets(src->capacity);
-    dst->lookup      = ds_htable_allocate_lookup(src->capacity);
+    // Share the buffers until either table is changed.
+    dst->buckets     = src->buckets;
+    dst->lookup      = src->lookup;
     dst->capacity    = src->capacity;
     dst->size        = src->size;
     dst->next        = src->next;
     dst->min_deleted = src->min_deleted;
+    // A bucket is a key and a value, and deleted buckets are undefined.
+    dst->refs        = ds_share_buffer(&src->refs, (zval *) src->buckets, src->next * 2);
+    dst->changes     = 0;
 
-    ds_htable_copy(src, dst);
     return dst;
 }
 
+void ds_htable_separate(ds_htable_t *table)
+{
+    table->changes++;
+
+    if (ds_unshare_buffer(&table->refs)) {
+        ds_htable_t shared = *table;
+
+        table->buckets = ds_htable_allocate_buckets(table->capacity);
+        table->lookup  = ds_htable_allocate_lookup(table->capacity);
+
+        ds_htable_copy(&shared, table);
+    }
+}
+
 static inline bool implements_hashable(zval *key) {
     return Z_TYPE_P(key) == IS_OBJECT && instanceof_function(Z_OBJCE_P(key), hashable_ce);
 }
@@ -318,6 +339,16 @@ static uint32_t get_hash(zval *value)
     }
 }
 
+uint32_t ds_htable_hash(zval *key)
+{
+    return get_hash(key);
+}
+
+bool ds_htable_keys_match(zval *key, zval *other)
+{
+    return key_is_identical(key, other);
+}
+
 static ds_htable_bucket_t *ds_htable_lookup_bucket_by_hash(
     ds_htable_t     *table,
     zval            *key,
@@ -351,6 +382,170 @@ ds_htable_bucket_t *ds_htable_lookup_by_key(ds_htable_t *table, zval *key)
     return ds_htable_lookup_bucket_by_hash(table, key, get_hash(key));
 }
 
+ds_htable_bucket_t *ds_htable_lookup_by_key_ex(ds_htable_t *table, zval *key, uint32_t *hash)
+{
+    *hash = get_hash(key);
+
+    if (EG(exception)) {
+        return NULL;
+    }
+
+    return ds_htable_lookup_bucket_by_hash(table, key, *hash);
+}
+
+uint32_t ds_htable_lookup_all(
+    ds_htable_t         *table,
+    zval                *keys,
+    uint32_t             count,
+    ds_htable_bucket_t  *buckets,
+    bool                 all
+) {
+    uint32_t *hashes;
+    uint32_t  found = 0;
+    uint32_t  i;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    hashes = emalloc(count * sizeof(uint32_t));
+
+    // Hash the whole batch first, which may call Hashable::hash.
+    for (i = 0; i < count; i++) {
+        hashes[i] = get_hash(&keys[i]);
+
+        if (EG(exception)) {
+            efree(hashes);
+            return 0;
+        }
+    }
+
+    // Each lookup reads a lookup slot and then a bucket, which are unlikely
+    // to be cached for large tables. Prefetch the slot of a key further ahead
+    // and the bucket of a key closer ahead, so that both are in the cache by
+    // the time their key is looked up.
+    for (i = 0; i < count; i++) {
+        ds_htable_bucket_t *bucket;
+
+        uint32_t ahead = i + DS_HTABLE_PREFETCH_DISTANCE;
+        uint32_t near  = i + DS_HTABLE_PREFETCH_DISTANCE / 2;
+
+        if (ahead < count) {
+            DS_PREFETCH(&DS_HTABLE_BUCKET_LOOKUP(table, hashes[ahead]));
+        }
+
+        if (near < count) {
+            uint32_t index = DS_HTABLE_BUCKET_LOOKUP(table, hashes[near]);
+
+            if (index != DS_HTABLE_INVALID_INDEX) {
+                DS_PREFETCH(&table->buckets[index]);
+            }
+        }
+
+        bucket = ds_htable_lookup_bucket_by_hash(table, &keys[i], hashes[i]);
+
+        if (EG(exception)) {
+            break;
+        }
+
+        // Hashable::equals could change the table during a later lookup,
+        // so the bucket is copied rather than kept.
+        if (bucket) {
+            DS_HTABLE_BUCKET_COPY(&buckets[i], bucket);
+            found++;
+        } else if (all) {
+            break;
+        }
+    }
+
+    efree(hashes);
+    return found;
+}
+
+ds_htable_bucket_t *ds_htable_lookup_iterable(
+    ds_htable_t  *table,
+    zval         *keys,
+    ds_vector_t  *batch,
+    bool          all,
+    uint32_t     *found
+) {
+    ds_htable_bucket_t *buckets;
+
+    ds_vector_push_all(batch, keys);
+
+    if (EG(exception)) {
+        return NULL;
+    }
+
+    // Keys that are not found are left undefined, ie. deleted.
+    buckets = ecalloc(MAX(1, batch->size), sizeof(ds_htable_bucket_t));
+    *found  = ds_htable_lookup_all(table, batch->buffer, batch->size, buckets, all);
+
+    if (EG(exception)) {
+        ds_htable_free_lookup(buckets, batch->size);
+        return NULL;
+    }
+
+    return buckets;
+}
+
+void ds_htable_free_lookup(ds_htable_bucket_t *buckets, uint32_t count)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        if ( ! DS_HTABLE_BUCKET_DELETED(&buckets[i])) {
+            zval_ptr_dtor(&buckets[i].key);
+            zval_ptr_dtor(&buckets[i].value);
+        }
+    }
+
+    efree(buckets);
+}
+
+bool ds_htable_has_all(ds_htable_t *table, zval *keys)
+{
+    ds_vector_t        *batch = ds_vector();
+    ds_htable_bucket_t *buckets;
+    uint32_t            found;
+    bool                result = false;
+
+    if ((buckets = ds_htable_lookup_iterable(table, keys, batch, true, &found))) {
+        result = found == batch->size;
+        ds_htable_free_lookup(buckets, batch->size);
+    }
+
+    ds_vector_free(batch);
+    return result;
+}
+
+ds_htable_t *ds_htable_intersect_iterable(ds_htable_t *table, zval *keys)
+{
+    ds_vector_t        *batch = ds_vector();
+    ds_htable_bucket_t *buckets;
+    ds_htable_t        *result = NULL;
+    uint32_t            found;
+    zend_long           i;
+
+    if ((buckets = ds_htable_lookup_iterable(table, keys, batch, false, &found))) {
+        result = ds_htable();
+        ds_htable_ensure_capacity(result, found);
+
+        for (i = 0; i < batch->size; i++) {
+            ds_htable_bucket_t *bucket = &buckets[i];
+
+            if ( ! DS_HTABLE_BUCKET_DELETED(bucket)) {
+                ds_htable_put_hashed(result, &bucket->key, DS_HTABLE_BUCKET_HASH(bucket), &bucket->value);
+            }
+        }
+
+        ds_htable_free_lookup(buckets, batch->size);
+    }
+
+    ds_vector_free(batch);
+    return result;
+}
+
 ds_htable_bucket_t *ds_htable_lookup_by_position(ds_htable_t *table, uint32_t position)
 {
     if (table->size == 0 || position >= table->size) {
@@ -474,10 +669,22 @@ static void ds_htable_clear_buffer(ds_htable_t *table)
 
 void ds_htable_clear(ds_htable_t *table)
 {
-    ds_htable_clear_buffer(table);
+    table->changes++;
+
+    // There's no need to copy shared buffers only to clear them.
+    if (ds_unshare_buffer(&table->refs)) {
+        table->buckets  = ds_htable_allocate_buckets(DS_HTABLE_MIN_CAPACITY);
+        table->lookup   = ds_htable_allocate_lookup(DS_HTABLE_MIN_CAPACITY);
+        table->capacity = DS_HTABLE_MIN_CAPACITY;
+        table->size     = 0;
+        table->next     = 0;
 
-    if (table->capacity > DS_HTABLE_MIN_CAPACITY) {
-        ds_htable_realloc(table, DS_HTABLE_MIN_CAPACITY);
+    } else {
+        ds_htable_clear_buffer(table);
+
+        if (table->capacity > DS_HTABLE_MIN_CAPACITY) {
+            ds_htable_realloc(table, DS_HTABLE_MIN_CAPACITY);
+        }
     }
 
     ds_htable_reset_lookup(table);
@@ -487,15 +694,20 @@ void ds_htable_clear(ds_htable_t *table)
 
 void ds_htable_free(ds_htable_t *table)
 {
-    ds_htable_clear_buffer(table);
+    // Leave shared buffers to their other owners.
+    if ( ! ds_unshare_buffer(&table->refs)) {
+        ds_htable_clear_buffer(table);
+
+        ds_free_buffer(table->buckets);
+        efree(table->lookup);
+    }
 
-    efree(table->buckets);
-    efree(table->lookup);
-    efree(table);
+    ds_slab_free(&DSG(table_slab), table);
 }
 
 static inline void ds_htable_sort_ex(ds_htable_t *table, compare_func_t compare_func)
 {
+    ds_htable_separate(table);
     ds_htable_pack(table);
     qsort(table->buckets, table->size, sizeof(ds_htable_bucket_t), compare_func);
     ds_htable_rehash(table);
@@ -612,6 +824,19 @@ void ds_htable_ensure_capacity(ds_htable_t *table, uint32_t capacity)
     capacity = ds_htable_get_capacity_for_size(capacity);
 
     if (capacity > table->capacity) {
+        ds_htable_separate(table);
+        ds_htable_realloc(table, capacity);
+        ds_htable_rehash(table);
+    }
+}
+
+void ds_htable_shrink_to_fit(ds_htable_t *table)
+{
+    uint32_t capacity = ds_htable_get_capacity_for_size(table->size);
+
+    if (capacity < table->capacity) {
+        ds_htable_separate(table);
+        ds_htable_pack(table);
         ds_htable_realloc(table, capacity);
         ds_htable_rehash(table);
     }
@@ -663,6 +888,9 @@ bool ds_htable_lookup_or_next(ds_htable_t *table, zval *key, ds_htable_bucket_t
 {
     const uint32_t hash = get_hash(key);
 
+    // The bucket is returned to be written to, whether it was found or not.
+    ds_htable_separate(table);
+
     // Attempt to find the bucket
     if ((*bucket = ds_htable_lookup_bucket_by_hash(table, key, hash))) {
         return true;
@@ -684,16 +912,81 @@ void ds_htable_put(ds_htable_t *table, zval *key, zval *value)
     // Attempt to find the bucket or initialize it as a new bucket.
     bool found = ds_htable_lookup_or_next(table, key, &bucket);
 
-    // If found, destruct the current value so that we can replace it.
-    if (found) {
-        zval_ptr_dtor(&bucket->value);
-    }
-
+    // Only replace the value if one was provided, so that a found bucket
+    // is never left with a value that has already been destructed.
     if (value) {
+        if (found) {
+            zval_ptr_dtor(&bucket->value);
+        }
+
         ZVAL_COPY(&bucket->value, value);
     }
 }
 
+void ds_htable_put_hashed(ds_htable_t *table, zval *key, uint32_t hash, zval *value)
+{
+    ds_htable_bucket_t *bucket;
+
+    ds_htable_separate(table);
+
+    if ((bucket = ds_htable_lookup_bucket_by_hash(table, key, hash))) {
+        if (value) {
+            zval_ptr_dtor(&bucket->value);
+            ZVAL_COPY(&bucket->value, value);
+        }
+        return;
+    }
+
+    if (table->next == table->capacity) {
+        ds_htable_increase_capacity(table);
+    }
+
+    ds_htable_init_next_bucket(table, key, value, hash);
+}
+
+void ds_htable_put_array(ds_htable_t *table, HashTable *array)
+{
+    zend_string *key;
+    zend_ulong   index;
+    zval        *value;
+    zval         temp;
+
+    ds_htable_separate(table);
+
+    // Size the table once so that we don't have to grow and rehash as we go.
+    ds_htable_ensure_capacity(table, table->size + zend_hash_num_elements(array));
+
+    // The keys of an array are already distinct, so we can skip the lookup
+    // and reuse the hash of string keys if there is nothing to collide with.
+    if (table->size == 0) {
+        if (table->next > 0) {
+            ds_htable_rehash(table);
+        }
+
+        ZEND_HASH_FOREACH_KEY_VAL(array, index, key, value) {
+            if (key) {
+                ZVAL_STR(&temp, key);
+                ds_htable_init_next_bucket(table, &temp, value, get_string_hash(key));
+            } else {
+                ZVAL_LONG(&temp, (zend_long) index);
+                ds_htable_init_next_bucket(table, &temp, value, (uint32_t) index);
+            }
+        }
+        ZEND_HASH_FOREACH_END();
+
+    } else {
+        ZEND_HASH_FOREACH_KEY_VAL(array, index, key, value) {
+            if (key) {
+                ZVAL_STR(&temp, key);
+            } else {
+                ZVAL_LONG(&temp, (zend_long) index);
+            }
+            ds_htable_put(table, &temp, value);
+        }
+        ZEND_HASH_FOREACH_END();
+    }
+}
+
 zval *ds_htable_values(ds_htable_t *table)
 {
     zval *buffer = ds_allocate_zval_buffer(table->size);
@@ -778,12 +1071,19 @@ zend_string *ds_htable_join_keys(ds_htable_t *table, const char* glue, const siz
 
 int ds_htable_remove(ds_htable_t *table, zval *key, zval *return_value)
 {
-    uint32_t hash  = get_hash(key);
-    uint32_t index = DS_HTABLE_BUCKET_LOOKUP(table, hash);
+    uint32_t hash = get_hash(key);
+    uint32_t index;
 
     ds_htable_bucket_t *bucket = NULL;
     ds_htable_bucket_t *prev   = NULL;
 
+    // Only copy shared buffers if there is something to remove.
+    if (table->refs && ds_htable_lookup_bucket_by_hash(table, key, hash)) {
+        ds_htable_separate(table);
+    }
+
+    index = DS_HTABLE_BUCKET_LOOKUP(table, hash);
+
     for (; index != DS_HTABLE_INVALID_INDEX; index = DS_HTABLE_BUCKET_NEXT(bucket)) {
         bucket = &table->buckets[index];
 
@@ -915,9 +1215,16 @@ ds_htable_t *ds_htable_slice(ds_htable_t *table, zend_long index, zend_long leng
 void ds_htable_apply(ds_htable_t *table, FCI_PARAMS)
 {
     zval retval;
+    uint32_t index;
     ds_htable_bucket_t *bucket;
 
-    DS_HTABLE_FOREACH_BUCKET(table, bucket) {
+    for (index = 0; index < table->next; index++) {
+        bucket = &table->buckets[index];
+
+        if (DS_HTABLE_BUCKET_DELETED(bucket)) {
+            continue;
+        }
+
         fci.param_count = 2;
         fci.params      = (zval*) bucket;
         fci.retval      = &retval;
@@ -926,10 +1233,196 @@ void ds_htable_apply(ds_htable_t *table, FCI_PARAMS)
             return;
         }
 
+        // The callback may have copied the table, so we have to separate and
+        // look up the bucket every time. A copy keeps the same layout.
+        ds_htable_separate(table);
+
+        bucket = &table->buckets[index];
         zval_ptr_dtor(&bucket->value);
         ZVAL_COPY_VALUE(&bucket->value, &retval);
     }
+}
+
+/**
+ * Removes the buckets for which the callback returns false, in place. The
+ * callback is given the key, and also the value if 'param_count' is 2.
+ */
+static void ds_htable_retain_ex(ds_htable_t *table, uint32_t param_count, FCI_PARAMS)
+{
+    zval retval;
+    zval key;
+    uint32_t index;
+    uint32_t next = table->next;
+    uint32_t size = table->size;
+    uint32_t *keep;
+    ds_htable_bucket_t *bucket;
+    ds_htable_bucket_t *target;
+
+    if (size == 0) {
+        return;
+    }
+
+    keep = DS_BITSET_ALLOCATE(next);
+
+    // Decide which buckets to keep before changing anything, because the
+    // callback could access or copy the table while it's being called.
+    for (index = 0; index < next; index++) {
+        bucket = &table->buckets[index];
+
+        if (DS_HTABLE_BUCKET_DELETED(bucket)) {
+            continue;
+        }
+
+        ZVAL_COPY(&key, &bucket->key);
+
+        fci.param_count = param_count;
+        fci.params      = (zval*) bucket;
+        fci.retval      = &retval;
+
+        if (zend_call_function(&fci, &fci_cache) == FAILURE || Z_ISUNDEF(retval)) {
+            zval_ptr_dtor(&key);
+            efree(keep);
+            return;
+        }
+
+        if (EXPECTED_BOOL_IS_TRUE(&retval)) {
+            DS_BITSET_SET(keep, index);
+        }
+
+        zval_ptr_dtor(&retval);
+
+        // The positions of the bits are only valid while buckets are neither
+        // added, removed nor moved. A put or remove changes the counts, and
+        // a rehash or sort would have moved another key into this bucket.
+        bucket = &table->buckets[index];
+
+        if (table->next != next || table->size != size
+                || DS_HTABLE_BUCKET_DELETED(bucket)
+                || ! zend_is_identical(&bucket->key, &key)) {
+            MODIFIED_BY_CALLBACK();
+            zval_ptr_dtor(&key);
+            efree(keep);
+            return;
+        }
+
+        zval_ptr_dtor(&key);
+    }
+
+    ds_htable_separate(table);
+
+    // Compact the buckets in a single pass, then rehash only once.
+    target = table->buckets;
+
+    for (index = 0; index < next; index++) {
+        bucket = &table->buckets[index];
+
+        if (DS_HTABLE_BUCKET_DELETED(bucket)) {
+            continue;
+        }
+
+        if (DS_BITSET_HAS(keep, index)) {
+            if (target != bucket) {
+                *target = *bucket;
+            }
+            target++;
+        } else {
+            zval_ptr_dtor(&bucket->key);
+            zval_ptr_dtor(&bucket->value);
+        }
+    }
+
+    efree(keep);
+
+    table->size = target - table->buckets;
+    table->next = table->size;
+
+    // Shrink before the rehash rather than rehashing twice.
+    if (DS_SHOULD_SHRINK(table->size, table->capacity) && table->capacity / 2 >= DS_HTABLE_MIN_CAPACITY) {
+        ds_htable_realloc(table, ds_htable_get_capacity_for_size(table->size * 2));
+    }
+
+    ds_htable_rehash(table);
+}
+
+void ds_htable_retain(ds_htable_t *table, FCI_PARAMS)
+{
+    ds_htable_retain_ex(table, 2, FCI_ARGS);
+}
+
+void ds_htable_retain_keys(ds_htable_t *table, FCI_PARAMS)
+{
+    ds_htable_retain_ex(table, 1, FCI_ARGS);
+}
+
+void ds_htable_apply_keys(ds_htable_t *table, FCI_PARAMS)
+{
+    ds_htable_t  *snapshot;
+    ds_htable_t  *mapped;
+    ds_htable_t   replaced;
+    zval         *keys;
+    zval         *key;
+    uint32_t      size = table->size;
+    uint32_t      count = 0;
+    uint32_t      index;
+
+    if (size == 0) {
+        return;
+    }
+
+    // Iterate over a copy that shares the buffers, so that any change made by
+    // the callback separates the table rather than the buckets being visited.
+    snapshot = ds_htable_clone(table);
+    keys     = ds_allocate_zval_buffer(size);
+
+    DS_HTABLE_FOREACH_KEY(snapshot, key) {
+        fci.param_count = 1;
+        fci.params      = key;
+        fci.retval      = &keys[count];
+
+        if (zend_call_function(&fci, &fci_cache) == FAILURE || Z_ISUNDEF(keys[count])) {
+            break;
+        }
+
+        count++;
+    }
     DS_HTABLE_FOREACH_END();
+
+    ds_htable_free(snapshot);
+
+    if (count < size) {
+        goto cleanup;
+    }
+
+    // Build a new table from the new keys, where keys that are equal are
+    // merged, so that hash() and equals() only ever see a consistent table.
+    mapped = ds_htable_with_capacity(ds_htable_get_capacity_for_size(count));
+
+    for (index = 0; index < count; index++) {
+        ds_htable_put(mapped, &keys[index], NULL);
+
+        if (EG(exception)) {
+            ds_htable_free(mapped);
+            goto cleanup;
+        }
+    }
+
+    // Swap the new buffers in, then free the old ones as if they were a
+    // separate table, because destructors could still access the table.
+    replaced = *table;
+    *table   = *mapped;
+    *mapped  = replaced;
+
+    table->changes = replaced.changes + 1;
+
+    ds_htable_free(mapped);
+    ds_htable_auto_truncate(table);
+
+cleanup:
+    for (index = 0; index < count; index++) {
+        zval_ptr_dtor(&keys[index]);
+    }
+
+    efree(keys);
 }
 
 ds_htable_t *ds_htable_map(ds_htable_t *table, FCI_PARAMS)
@@ -1108,8 +1601,40 @@ ds_htable_t *ds_htable_merge(ds_htable_t *table, ds_htable_t *other)
     return merged;
 }
 
+bool ds_htable_equals(ds_htable_t *table, ds_htable_t *other, bool values)
+{
+    ds_htable_bucket_t *bucket;
+    ds_htable_bucket_t *match;
+
+    if (table->size != other->size) {
+        return false;
+    }
+
+    // Shared buckets are always equal.
+    if (table->buckets == other->buckets) {
+        return true;
+    }
+
+    // Probe using the stored hash, so that no key has to be hashed again.
+    DS_HTABLE_FOREACH_BUCKET(table, bucket) {
+        match = ds_htable_lookup_bucket_by_hash(other, &bucket->key, DS_HTABLE_BUCKET_HASH(bucket));
+
+        if ( ! match || EG(exception)) {
+            return false;
+        }
+
+        if (values && ( ! fast_equal_check_function(&bucket->value, &match->value) || EG(exception))) {
+            return false;
+        }
+    }
+    DS_HTABLE_FOREACH_END();
+
+    return true;
+}
+
 void ds_htable_reverse(ds_htable_t *table)
 {
+    ds_htable_separate(table);
     ds_htable_pack(table);
     {
         ds_htable_bucket_t *a = table->buckets;
@@ -2,9 +2,15 @@
 #define DS_HTABLE_H
 
 #include "../common.h"
+#include "ds_vector.h"
 
 #define DS_HTABLE_MIN_CAPACITY  8  // Must be a power of 2
 
+/**
+ * How many keys ahead of the current one to prefetch in batch lookups.
+ */
+#define DS_HTABLE_PREFETCH_DISTANCE 16
+
 /**
  * Marker to indicate an invalid index in the buffer.
  */
@@ -156,12 +162,33 @@ typedef struct _ds_htable_t {
     uint32_t             size;          // Number of active buckets in the table
     uint32_t             capacity;      // Length of the bucket buffer
     uint32_t             min_deleted;   // First deleted bucket buffer index
+    uint32_t            *refs;          // Owners of shared buffers, or NULL
+    zend_ulong           changes;       // Number of changes, to detect those made while iterating
 } ds_htable_t;
 
 ds_htable_t *ds_htable();
+
+/**
+ * Hashes a key the same way a table would, including Hashable objects.
+ */
+uint32_t ds_htable_hash(zval *key);
+
+/**
+ * Determines if two keys would be considered the same key in a table.
+ */
+bool ds_htable_keys_match(zval *key, zval *other);
+
 zval *ds_htable_values(ds_htable_t *table);
 
 void ds_htable_ensure_capacity(ds_htable_t *table, uint32_t capacity);
+void ds_htable_shrink_to_fit(ds_htable_t *table);
+
+/**
+ * Copies the buckets and lookup buffers if they're shared with another table,
+ * and counts the change. This must be done before any change is made to the
+ * table.
+ */
+void ds_htable_separate(ds_htable_t *table);
 
 void ds_htable_sort(ds_htable_t *table, compare_func_t compare_func);
 void ds_htable_sort_by_key(ds_htable_t *table);
@@ -172,8 +199,56 @@ void ds_htable_sort_callback_by_value(ds_htable_t *table);
 
 ds_htable_bucket_t *ds_htable_lookup_by_value(ds_htable_t *h, zval *key);
 ds_htable_bucket_t *ds_htable_lookup_by_key(ds_htable_t *h, zval *key);
+
+/**
+ * Looks up a key and also returns its hash, so that the key can be put later
+ * without being hashed again.
+ */
+ds_htable_bucket_t *ds_htable_lookup_by_key_ex(ds_htable_t *table, zval *key, uint32_t *hash);
+
 ds_htable_bucket_t *ds_htable_lookup_by_position(ds_htable_t *table, uint32_t position);
 
+/**
+ * Looks up a batch of keys, copying the bucket of each key into 'buckets' at
+ * the same position, which are left deleted for keys that were not found. All
+ * keys are hashed before the first lookup so that the memory of later lookups
+ * can be prefetched. If 'all' is true, stops at the first key that was not
+ * found. Returns the number of keys found.
+ */
+uint32_t ds_htable_lookup_all(
+    ds_htable_t         *table,
+    zval                *keys,
+    uint32_t             count,
+    ds_htable_bucket_t  *buckets,
+    bool                 all
+);
+
+/**
+ * Collects the values of an array or traversable object into 'batch' and
+ * looks up each one as a key, as above. Returns the copied buckets, which
+ * must be freed with ds_htable_free_lookup, or NULL if an exception was thrown.
+ */
+ds_htable_bucket_t *ds_htable_lookup_iterable(
+    ds_htable_t  *table,
+    zval         *keys,
+    ds_vector_t  *batch,
+    bool          all,
+    uint32_t     *found
+);
+
+void ds_htable_free_lookup(ds_htable_bucket_t *buckets, uint32_t count);
+
+/**
+ * Determines if every value of an array or traversable object is a key.
+ */
+bool ds_htable_has_all(ds_htable_t *table, zval *keys);
+
+/**
+ * Creates a table of the buckets whose keys are values of an array or
+ * traversable object, in the order of those values.
+ */
+ds_htable_t *ds_htable_intersect_iterable(ds_htable_t *table, zval *keys);
+
 bool ds_htable_lookup_or_next(ds_htable_t *table, zval *key, ds_htable_bucket_t **return_value);
 bool ds_htable_has_keys(ds_htable_t *h, VA_PARAMS);
 bool ds_htable_has_key(ds_htable_t *table, zval *key);
@@ -181,6 +256,12 @@ bool ds_htable_has_values(ds_htable_t *h, VA_PARAMS);
 bool ds_htable_has_value(ds_htable_t *h, zval *value);
 int  ds_htable_remove(ds_htable_t *h, zval *key, zval *return_value);
 void ds_htable_put(ds_htable_t *h, zval *key, zval *value);
+
+/**
+ * Puts a key whose hash is already known, eg. when loading a table.
+ */
+void ds_htable_put_hashed(ds_htable_t *table, zval *key, uint32_t hash, zval *value);
+void ds_htable_put_array(ds_htable_t *table, HashTable *array);
 void ds_htable_to_array(ds_htable_t *h, zval *arr);
 void ds_htable_free(ds_htable_t *h);
 zval *ds_htable_get(ds_htable_t *h, zval *key);
@@ -203,6 +284,19 @@ ds_htable_t *ds_htable_filter(ds_htable_t *table);
 ds_htable_t *ds_htable_filter_callback(ds_htable_t *table, FCI_PARAMS);
 
 void ds_htable_apply(ds_htable_t *table, FCI_PARAMS);
+
+/**
+ * Removes the buckets for which the callback returns false, in place. The
+ * callback is given the key and value, or only the key for retain_keys.
+ */
+void ds_htable_retain(ds_htable_t *table, FCI_PARAMS);
+void ds_htable_retain_keys(ds_htable_t *table, FCI_PARAMS);
+
+/**
+ * Replaces each key with the result of the callback, in place, for tables
+ * that only have keys. Keys that become equal are merged into the first.
+ */
+void ds_htable_apply_keys(ds_htable_t *table, FCI_PARAMS);
 void ds_htable_reduce(ds_htable_t *table, FCI_PARAMS, zval *initial, zval *return_value);
 
 ds_htable_t *ds_htable_xor(ds_htable_t *table, ds_htable_t *other);
@@ -210,6 +304,12 @@ ds_htable_t *ds_htable_diff(ds_htable_t *table, ds_htable_t *other);
 ds_htable_t *ds_htable_intersect(ds_htable_t *table, ds_htable_t *other);
 ds_htable_t *ds_htable_merge(ds_htable_t *table, ds_htable_t *other);
 
+/**
+ * Determines if two tables have the same keys, regardless of order. Values
+ * are also compared using == if 'values' is true.
+ */
+bool ds_htable_equals(ds_htable_t *table, ds_htable_t *other, bool values);
+
 int ds_htable_serialize(ds_htable_t *table, unsigned char **buffer, size_t *buf_len, zend_serialize_data *data);
 int ds_htable_unserialize(ds_htable_t *table, const unsigned char *buffer, size_t length, zend_unserialize_data *data);
 
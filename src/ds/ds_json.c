@@ -0,0 +1,479 @@
+#include "../common.h"
+
+#include "ext/json/php_json.h"
+
+#if PHP_VERSION_ID >= 70100
+#include "ext/json/php_json_parser.h"
+#include "ext/json/php_json_encoder.h"
+#endif
+
+#include "../php/objects/php_vector.h"
+#include "../php/objects/php_map.h"
+#include "../php/classes/php_vector_ce.h"
+#include "../php/classes/php_map_ce.h"
+
+#include "ds_vector.h"
+#include "ds_map.h"
+#include "ds_json.h"
+
+typedef struct _ds_json_encoder_t {
+    smart_str            buf;
+    int                  options;
+    int                  depth;
+    int                  max_depth;
+    php_json_error_code  error_code;
+#if PHP_VERSION_ID < 70100
+    zend_long            saved_max_depth;
+#endif
+} ds_json_encoder_t;
+
+static const char *ds_json_error_message(php_json_error_code error_code)
+{
+    switch (error_code) {
+        case PHP_JSON_ERROR_DEPTH:
+            return "Maximum stack depth exceeded";
+        case PHP_JSON_ERROR_STATE_MISMATCH:
+            return "State mismatch (invalid or malformed JSON)";
+        case PHP_JSON_ERROR_CTRL_CHAR:
+            return "Control character error, possibly incorrectly encoded";
+        case PHP_JSON_ERROR_SYNTAX:
+            return "Syntax error";
+        case PHP_JSON_ERROR_UTF8:
+            return "Malformed UTF-8 characters, possibly incorrectly encoded";
+        case PHP_JSON_ERROR_RECURSION:
+            return "Recursion detected";
+        case PHP_JSON_ERROR_INF_OR_NAN:
+            return "Inf and NaN cannot be JSON encoded";
+        case PHP_JSON_ERROR_UNSUPPORTED_TYPE:
+            return "Type is not supported";
+        default:
+            return "Unknown error";
+    }
+}
+
+static bool ds_json_check_depth(zend_long depth)
+{
+    if (depth <= 0) {
+        JSON_DEPTH_MUST_BE_POSITIVE();
+        return false;
+    }
+
+    return true;
+}
+
+#if PHP_VERSION_ID >= 70100
+
+/**
+ * Parser methods that create collections where ext/json would create arrays
+ * and objects. Values are owned by the parser, so they are released once the
+ * collection has its own reference.
+ */
+static int ds_json_array_create(php_json_parser *parser, zval *array)
+{
+    ZVAL_DS_VECTOR(array, ds_vector());
+    return SUCCESS;
+}
+
+static int ds_json_array_append(php_json_parser *parser, zval *array, zval *value)
+{
+    ds_vector_push(Z_DS_VECTOR_P(array), value);
+    zval_ptr_dtor(value);
+    return SUCCESS;
+}
+
+static int ds_json_object_create(php_json_parser *parser, zval *object)
+{
+    ZVAL_DS_MAP(object, ds_map());
+    return SUCCESS;
+}
+
+static int ds_json_object_update(php_json_parser *parser, zval *object, zend_string *key, zval *value)
+{
+    zval tmp;
+    ZVAL_STR(&tmp, key);
+
+    ds_htable_put(Z_DS_MAP_P(object)->table, &tmp, value);
+    zval_ptr_dtor(value);
+    zend_string_release(key);
+    return SUCCESS;
+}
+
+static bool ds_json_parse(zval *return_value, const char *json, size_t length, int depth)
+{
+    php_json_parser parser;
+    php_json_parser_methods methods;
+
+    memset(&methods, 0, sizeof(php_json_parser_methods));
+
+    methods.array_create  = ds_json_array_create;
+    methods.array_append  = ds_json_array_append;
+    methods.object_create = ds_json_object_create;
+    methods.object_update = ds_json_object_update;
+
+    php_json_parser_init_ex(&parser, return_value, json, length, 0, depth, &methods);
+
+    if (php_json_parse(&parser) != SUCCESS) {
+        JSON_NOT_DECODED(ds_json_error_message(parser.scanner.errcode));
+        return false;
+    }
+
+    return true;
+}
+
+#else
+
+/**
+ * ext/json can't be extended before 7.1, so decode as usual and convert the
+ * arrays and objects into collections in place.
+ */
+static void ds_json_convert(zval *value)
+{
+    zend_ulong   h;
+    zend_string *key;
+    zval        *val;
+    zval         tmp;
+
+    if (Z_TYPE_P(value) == IS_ARRAY) {
+        ds_vector_t *vector = ds_vector_ex(zend_hash_num_elements(Z_ARRVAL_P(value)));
+
+        ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(value), val) {
+            ds_json_convert(val);
+            ds_vector_push(vector, val);
+        }
+        ZEND_HASH_FOREACH_END();
+
+        zval_ptr_dtor(value);
+        ZVAL_DS_VECTOR(value, vector);
+
+    } else if (Z_TYPE_P(value) == IS_OBJECT) {
+        ds_map_t *map = ds_map();
+
+        ZEND_HASH_FOREACH_KEY_VAL(Z_OBJPROP_P(value), h, key, val) {
+            if (key) {
+                ZVAL_STR_COPY(&tmp, key);
+            } else {
+                ZVAL_STR(&tmp, zend_long_to_str(h));
+            }
+
+            ds_json_convert(val);
+            ds_htable_put(map->table, &tmp, val);
+            zval_ptr_dtor(&tmp);
+        }
+        ZEND_HASH_FOREACH_END();
+
+        zval_ptr_dtor(value);
+        ZVAL_DS_MAP(value, map);
+    }
+}
+
+static bool ds_json_parse(zval *return_value, const char *json, size_t length, int depth)
+{
+    php_json_decode_ex(return_value, (char *) json, length, 0, depth);
+
+    if (JSON_G(error_code) != PHP_JSON_ERROR_NONE) {
+        JSON_NOT_DECODED(ds_json_error_message(JSON_G(error_code)));
+        zval_ptr_dtor(return_value);
+        return false;
+    }
+
+    ds_json_convert(return_value);
+    return true;
+}
+
+#endif
+
+void ds_json_decode(
+    zval             *return_value,
+    const char       *json,
+    size_t            length,
+    zend_long         depth,
+    zend_class_entry *ce
+) {
+    ZVAL_NULL(return_value);
+
+    if ( ! ds_json_check_depth(depth)) {
+        return;
+    }
+
+    if ( ! ds_json_parse(return_value, json, length, (int) MIN(depth, INT_MAX))) {
+        ZVAL_NULL(return_value);
+        return;
+    }
+
+    if (Z_TYPE_P(return_value) != IS_OBJECT || Z_OBJCE_P(return_value) != ce) {
+        JSON_TYPE_NOT_EXPECTED(ce == php_ds_map_ce ? "object" : "array");
+        zval_ptr_dtor(return_value);
+        ZVAL_NULL(return_value);
+    }
+}
+
+static inline void ds_json_encoder_error(ds_json_encoder_t *encoder, php_json_error_code error_code)
+{
+    if (encoder->error_code == PHP_JSON_ERROR_NONE) {
+        encoder->error_code = error_code;
+    }
+}
+
+static inline void ds_json_pretty_print_char(ds_json_encoder_t *encoder, char c)
+{
+    if (encoder->options & PHP_JSON_PRETTY_PRINT) {
+        smart_str_appendc(&encoder->buf, c);
+    }
+}
+
+static inline void ds_json_pretty_print_indent(ds_json_encoder_t *encoder)
+{
+    int i;
+
+    if (encoder->options & PHP_JSON_PRETTY_PRINT) {
+        for (i = 0; i < encoder->depth; ++i) {
+            smart_str_appendl(&encoder->buf, "    ", 4);
+        }
+    }
+}
+
+/**
+ * Enters a nested collection, or writes null if it would be too deep. This
+ * also stops a collection that contains itself.
+ */
+static bool ds_json_encoder_enter(ds_json_encoder_t *encoder)
+{
+    if (encoder->depth >= encoder->max_depth) {
+        ds_json_encoder_error(encoder, PHP_JSON_ERROR_DEPTH);
+        smart_str_appendl(&encoder->buf, "null", 4);
+        return false;
+    }
+
+    encoder->depth++;
+    return true;
+}
+
+static void ds_json_encoder_leave(ds_json_encoder_t *encoder, char c)
+{
+    encoder->depth--;
+
+    ds_json_pretty_print_char(encoder, '\n');
+    ds_json_pretty_print_indent(encoder);
+    smart_str_appendc(&encoder->buf, c);
+}
+
+/**
+ * Passes a value that isn't a Vector or a Map to ext/json, at the current
+ * depth so that nesting and indentation carry on from the collection.
+ */
+static void ds_json_encode_php(ds_json_encoder_t *encoder, zval *value, int options)
+{
+#if PHP_VERSION_ID >= 70100
+    php_json_encoder php_encoder;
+
+    php_json_encode_init(&php_encoder);
+    php_encoder.depth     = encoder->depth;
+    php_encoder.max_depth = encoder->max_depth;
+
+    php_json_encode_zval(&encoder->buf, value, options, &php_encoder);
+    ds_json_encoder_error(encoder, php_encoder.error_code);
+#else
+    JSON_G(error_code)    = PHP_JSON_ERROR_NONE;
+    JSON_G(encoder_depth) = encoder->depth;
+
+    php_json_encode(&encoder->buf, value, options);
+    ds_json_encoder_error(encoder, JSON_G(error_code));
+#endif
+}
+
+static void ds_json_encode_value(ds_json_encoder_t *encoder, zval *value);
+
+static void ds_json_encode_vector_ex(ds_json_encoder_t *encoder, ds_vector_t *vector)
+{
+    zval *value;
+    bool comma = false;
+
+    if (DS_VECTOR_IS_EMPTY(vector)) {
+        smart_str_appendl(&encoder->buf, "[]", 2);
+        return;
+    }
+
+    if ( ! ds_json_encoder_enter(encoder)) {
+        return;
+    }
+
+    smart_str_appendc(&encoder->buf, '[');
+
+    DS_VECTOR_FOREACH(vector, value) {
+        if (comma) {
+            smart_str_appendc(&encoder->buf, ',');
+        }
+
+        comma = true;
+
+        ds_json_pretty_print_char(encoder, '\n');
+        ds_json_pretty_print_indent(encoder);
+        ds_json_encode_value(encoder, value);
+    }
+    DS_VECTOR_FOREACH_END();
+
+    ds_json_encoder_leave(encoder, ']');
+}
+
+/**
+ * Object keys are always strings, so scalar keys are converted the same way
+ * that they would be by an array. Keys are never checked for numbers.
+ */
+static void ds_json_encode_key(ds_json_encoder_t *encoder, zval *key)
+{
+    zval tmp;
+
+    switch (Z_TYPE_P(key)) {
+        case IS_LONG:
+            smart_str_appendc(&encoder->buf, '"');
+            smart_str_append_long(&encoder->buf, Z_LVAL_P(key));
+            smart_str_appendc(&encoder->buf, '"');
+            return;
+
+        case IS_STRING:
+            ds_json_encode_php(encoder, key, encoder->options & ~PHP_JSON_NUMERIC_CHECK);
+            return;
+
+        default:
+            ZVAL_STR(&tmp, zval_get_string(key));
+            ds_json_encode_php(encoder, &tmp, encoder->options & ~PHP_JSON_NUMERIC_CHECK);
+            zval_ptr_dtor(&tmp);
+            return;
+    }
+}
+
+static inline bool ds_json_key_can_be_encoded(zval *key)
+{
+    switch (Z_TYPE_P(key)) {
+        case IS_NULL:
+        case IS_FALSE:
+        case IS_TRUE:
+        case IS_LONG:
+        case IS_DOUBLE:
+        case IS_STRING:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void ds_json_encode_table(ds_json_encoder_t *encoder, ds_htable_t *table)
+{
+    zval *key;
+    zval *value;
+    bool comma = false;
+
+    if (table->size == 0) {
+        smart_str_appendl(&encoder->buf, "{}", 2);
+        return;
+    }
+
+    if ( ! ds_json_encoder_enter(encoder)) {
+        return;
+    }
+
+    smart_str_appendc(&encoder->buf, '{');
+
+    DS_HTABLE_FOREACH_KEY_VALUE(table, key, value) {
+        if ( ! ds_json_key_can_be_encoded(key)) {
+            ds_json_encoder_error(encoder, PHP_JSON_ERROR_UNSUPPORTED_TYPE);
+            continue;
+        }
+
+        if (comma) {
+            smart_str_appendc(&encoder->buf, ',');
+        }
+
+        comma = true;
+
+        ds_json_pretty_print_char(encoder, '\n');
+        ds_json_pretty_print_indent(encoder);
+        ds_json_encode_key(encoder, key);
+        smart_str_appendc(&encoder->buf, ':');
+        ds_json_pretty_print_char(encoder, ' ');
+        ds_json_encode_value(encoder, value);
+    }
+    DS_HTABLE_FOREACH_END();
+
+    ds_json_encoder_leave(encoder, '}');
+}
+
+static void ds_json_encode_value(ds_json_encoder_t *encoder, zval *value)
+{
+    ZVAL_DEREF(value);
+
+    if (Z_TYPE_P(value) == IS_OBJECT) {
+        if (Z_OBJCE_P(value) == php_ds_vector_ce) {
+            ds_json_encode_vector_ex(encoder, Z_DS_VECTOR_P(value));
+            return;
+        }
+
+        if (Z_OBJCE_P(value) == php_ds_map_ce) {
+            ds_json_encode_table(encoder, Z_DS_MAP_P(value)->table);
+            return;
+        }
+    }
+
+    ds_json_encode_php(encoder, value, encoder->options);
+}
+
+static bool ds_json_encoder_init(ds_json_encoder_t *encoder, zend_long options, zend_long depth)
+{
+    if ( ! ds_json_check_depth(depth)) {
+        return false;
+    }
+
+    memset(encoder, 0, sizeof(ds_json_encoder_t));
+
+    encoder->options    = (int) options;
+    encoder->max_depth  = (int) MIN(depth, INT_MAX);
+    encoder->error_code = PHP_JSON_ERROR_NONE;
+
+#if PHP_VERSION_ID < 70100
+    encoder->saved_max_depth  = JSON_G(encode_max_depth);
+    JSON_G(encode_max_depth)  = encoder->max_depth;
+#endif
+
+    return true;
+}
+
+static zend_string *ds_json_encoder_result(ds_json_encoder_t *encoder)
+{
+#if PHP_VERSION_ID < 70100
+    JSON_G(encode_max_depth) = encoder->saved_max_depth;
+#endif
+
+    if (encoder->error_code != PHP_JSON_ERROR_NONE &&
+            ! (encoder->options & PHP_JSON_PARTIAL_OUTPUT_ON_ERROR)) {
+        smart_str_free(&encoder->buf);
+        JSON_NOT_ENCODED(ds_json_error_message(encoder->error_code));
+        return NULL;
+    }
+
+    smart_str_0(&encoder->buf);
+    return encoder->buf.s;
+}
+
+zend_string *ds_json_encode_vector(ds_vector_t *vector, zend_long options, zend_long depth)
+{
+    ds_json_encoder_t encoder;
+
+    if ( ! ds_json_encoder_init(&encoder, options, depth)) {
+        return NULL;
+    }
+
+    ds_json_encode_vector_ex(&encoder, vector);
+    return ds_json_encoder_result(&encoder);
+}
+
+zend_string *ds_json_encode_map(ds_map_t *map, zend_long options, zend_long depth)
+{
+    ds_json_encoder_t encoder;
+
+    if ( ! ds_json_encoder_init(&encoder, options, depth)) {
+        return NULL;
+    }
+
+    ds_json_encode_table(&encoder, map->table);
+    return ds_json_encoder_result(&encoder);
+}
@@ -0,0 +1,41 @@
+#ifndef DS_JSON_H
+#define DS_JSON_H
+
+#include "../common.h"
+#include "ds_vector.h"
+#include "ds_map.h"
+
+/**
+ * Same default maximum depth as json_decode and json_encode.
+ */
+#define DS_JSON_DEFAULT_DEPTH 512
+
+/**
+ * Decodes JSON directly into collections, without building arrays first.
+ * Every JSON array becomes a Vector and every JSON object becomes a Map with
+ * string keys. The decoded value must be an instance of the given class, ie.
+ * a top-level array for a Vector and a top-level object for a Map.
+ *
+ * Sets return_value to null and throws if the JSON is not valid.
+ */
+void ds_json_decode(
+    zval             *return_value,
+    const char       *json,
+    size_t            length,
+    zend_long         depth,
+    zend_class_entry *ce
+);
+
+/**
+ * Encodes a collection directly into a string, without building an array
+ * first. Nested Vectors and Maps are encoded in the same way, and all other
+ * values are passed to ext/json. A Map is always encoded as an object, so
+ * that the result can be decoded back into a Map.
+ *
+ * These return NULL and throw if a value could not be encoded, unless
+ * JSON_PARTIAL_OUTPUT_ON_ERROR is given.
+ */
+zend_string *ds_json_encode_vector(ds_vector_t *vector, zend_long options, zend_long depth);
+zend_string *ds_json_encode_map(ds_map_t *map, zend_long options, zend_long depth);
+
+#endif
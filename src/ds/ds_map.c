@@ -3,6 +3,8 @@
 #include "../php/handlers/php_map_handlers.h"
 #include "../php/classes/php_map_ce.h"
 #include "../php/classes/php_set_ce.h"
+#include "../php/classes/php_vector_ce.h"
+#include "../php/objects/php_vector.h"
 
 #include "ds_htable.h"
 #include "ds_vector.h"
@@ -33,6 +35,11 @@ void ds_map_allocate(ds_map_t *map, zend_long capacity)
     ds_htable_ensure_capacity(map->table, capacity);
 }
 
+void ds_map_shrink_to_fit(ds_map_t *map)
+{
+    ds_htable_shrink_to_fit(map->table);
+}
+
 zend_long ds_map_capacity(ds_map_t *map)
 {
     return map->table->capacity;
@@ -63,6 +70,11 @@ void ds_map_apply(ds_map_t *map, FCI_PARAMS)
     ds_htable_apply(map->table, FCI_ARGS);
 }
 
+void ds_map_retain(ds_map_t *map, FCI_PARAMS)
+{
+    ds_htable_retain(map->table, FCI_ARGS);
+}
+
 ds_map_t *ds_map_map(ds_map_t *map, FCI_PARAMS)
 {
     ds_htable_t *table = ds_htable_map(map->table, FCI_ARGS);
@@ -140,6 +152,229 @@ bool ds_map_has_keys(ds_map_t *map, VA_PARAMS)
     return ds_htable_has_keys(map->table, argc, argv);
 }
 
+bool ds_map_has_all(ds_map_t *map, zval *keys)
+{
+    return ds_htable_has_all(map->table, keys);
+}
+
+ds_map_t *ds_map_get_all(ds_map_t *map, zval *keys, zval *def)
+{
+    ds_vector_t        *batch = ds_vector();
+    ds_htable_bucket_t *buckets;
+    ds_map_t           *result = NULL;
+    uint32_t            found;
+    zend_long           i;
+
+    if ( ! (buckets = ds_htable_lookup_iterable(map->table, keys, batch, ! def, &found))) {
+        ds_vector_free(batch);
+        return NULL;
+    }
+
+    if ( ! def && found < batch->size) {
+        KEY_NOT_FOUND();
+
+    } else {
+        result = ds_map();
+        ds_map_allocate(result, batch->size);
+
+        for (i = 0; i < batch->size; i++) {
+            ds_htable_bucket_t *bucket = &buckets[i];
+
+            if ( ! DS_HTABLE_BUCKET_DELETED(bucket)) {
+                ds_htable_put_hashed(result->table, &bucket->key, DS_HTABLE_BUCKET_HASH(bucket), &bucket->value);
+            } else {
+                ds_htable_put(result->table, &batch->buffer[i], def);
+            }
+        }
+    }
+
+    ds_htable_free_lookup(buckets, batch->size);
+    ds_vector_free(batch);
+    return result;
+}
+
+void ds_map_put_if_absent(ds_map_t *map, zval *key, zval *value, zval *return_value)
+{
+    ds_htable_bucket_t *bucket;
+
+    if ( ! ds_htable_lookup_or_next(map->table, key, &bucket)) {
+        ZVAL_COPY(&bucket->value, value);
+    }
+
+    ZVAL_COPY(return_value, &bucket->value);
+}
+
+/**
+ * Calls the callback with the given parameters, then puts its return value
+ * using a known hash. The callback may have changed the map, so a bucket that
+ * was found before can't be used, but the key doesn't have to be hashed again.
+ */
+static void ds_map_put_result(
+    ds_map_t    *map,
+    zval        *key,
+    uint32_t     hash,
+    FCI_PARAMS,
+    zval        *params,
+    uint32_t     count,
+    zval        *return_value
+) {
+    zval retval;
+
+    fci.param_count = count;
+    fci.params      = params;
+    fci.retval      = &retval;
+
+    if (zend_call_function(&fci, &fci_cache) == FAILURE || Z_ISUNDEF(retval)) {
+        return;
+    }
+
+    ds_htable_put_hashed(map->table, key, hash, &retval);
+    ZVAL_COPY_VALUE(return_value, &retval);
+}
+
+void ds_map_compute(ds_map_t *map, zval *key, FCI_PARAMS, zval *return_value)
+{
+    ds_htable_bucket_t *bucket;
+    uint32_t hash;
+    zval params[2];
+
+    bucket = ds_htable_lookup_by_key_ex(map->table, key, &hash);
+
+    if (EG(exception)) {
+        return;
+    }
+
+    ZVAL_COPY(&params[0], key);
+
+    if (bucket) {
+        ZVAL_COPY(&params[1], &bucket->value);
+    } else {
+        ZVAL_NULL(&params[1]);
+    }
+
+    ds_map_put_result(map, key, hash, FCI_ARGS, params, 2, return_value);
+
+    zval_ptr_dtor(&params[0]);
+    zval_ptr_dtor(&params[1]);
+}
+
+void ds_map_compute_if_absent(ds_map_t *map, zval *key, FCI_PARAMS, zval *return_value)
+{
+    ds_htable_bucket_t *bucket;
+    uint32_t hash;
+    zval param;
+
+    bucket = ds_htable_lookup_by_key_ex(map->table, key, &hash);
+
+    if (EG(exception)) {
+        return;
+    }
+
+    if (bucket) {
+        ZVAL_COPY(return_value, &bucket->value);
+        return;
+    }
+
+    ZVAL_COPY(&param, key);
+    ds_map_put_result(map, key, hash, FCI_ARGS, &param, 1, return_value);
+    zval_ptr_dtor(&param);
+}
+
+void ds_map_increment(ds_map_t *map, zval *key, zval *by, zval *return_value)
+{
+    ds_htable_t *table = map->table;
+    ds_htable_bucket_t *bucket;
+    uint32_t hash;
+    zval sum;
+
+    // The key is only added once the sum is known, so that an addition that
+    // fails leaves the map as it was. A missing key is added to as null.
+    bucket = ds_htable_lookup_by_key_ex(table, key, &hash);
+
+    if (EG(exception)) {
+        return;
+    }
+
+    // Adding numbers can't warn or throw, so a bucket is updated in place.
+    if (( ! bucket ||
+            Z_TYPE(bucket->value) == IS_LONG ||
+            Z_TYPE(bucket->value) == IS_DOUBLE ||
+            Z_TYPE(bucket->value) == IS_NULL) &&
+        (Z_TYPE_P(by) == IS_LONG || Z_TYPE_P(by) == IS_DOUBLE)) {
+
+        if (bucket) {
+            uint32_t index = bucket - table->buckets;
+
+            add_function(&sum, &bucket->value, by);
+
+            // A copy of a shared table keeps the same layout.
+            ds_htable_separate(table);
+            ZVAL_COPY_VALUE(&table->buckets[index].value, &sum);
+
+        } else {
+            zval zero;
+            ZVAL_NULL(&zero);
+            add_function(&sum, &zero, by);
+            ds_htable_put_hashed(table, key, hash, &sum);
+        }
+
+        ZVAL_COPY_VALUE(return_value, &sum);
+
+    // Anything else can call an error handler which may change the map, so
+    // the bucket is looked up again when the sum is put.
+    } else {
+        zval current;
+
+        if (bucket) {
+            ZVAL_COPY(&current, &bucket->value);
+        } else {
+            ZVAL_NULL(&current);
+        }
+
+        ZVAL_UNDEF(&sum);
+
+        if (add_function(&sum, &current, by) == SUCCESS && ! EG(exception)) {
+            ds_htable_put_hashed(map->table, key, hash, &sum);
+            ZVAL_COPY_VALUE(return_value, &sum);
+        } else {
+            zval_ptr_dtor(&sum);
+        }
+
+        zval_ptr_dtor(&current);
+    }
+}
+
+void ds_map_append(ds_map_t *map, zval *key, zval *value)
+{
+    ds_htable_bucket_t *bucket;
+    zval *current;
+
+    if ( ! ds_htable_lookup_or_next(map->table, key, &bucket)) {
+        array_init(&bucket->value);
+    }
+
+    if (EG(exception)) {
+        return;
+    }
+
+    current = &bucket->value;
+    ZVAL_DEREF(current);
+
+    if (Z_TYPE_P(current) == IS_ARRAY) {
+        SEPARATE_ARRAY(current);
+        add_next_index_zval(current, value);
+        Z_TRY_ADDREF_P(value);
+        return;
+    }
+
+    if (Z_TYPE_P(current) == IS_OBJECT && Z_OBJCE_P(current) == php_ds_vector_ce) {
+        ds_vector_push(Z_DS_VECTOR_P(current), value);
+        return;
+    }
+
+    VALUE_CAN_NOT_BE_APPENDED(current);
+}
+
 bool ds_map_has_values(ds_map_t *map, VA_PARAMS)
 {
     return ds_htable_has_values(map->table, argc, argv);
@@ -298,24 +533,6 @@ static inline void add_traversable_to_map(ds_map_t *map, zval *obj)
     spl_iterator_apply(obj, iterator_add, (void*) map);
 }
 
-static inline void add_ht_to_map(ds_map_t *map, HashTable *ht)
-{
-    uint32_t index;
-    zend_string *key;
-    zval *value;
-    zval temp;
-
-    ZEND_HASH_FOREACH_KEY_VAL(ht, index, key, value) {
-        if (key) {
-            ZVAL_STR(&temp, key);
-        } else {
-            ZVAL_LONG(&temp, index);
-        }
-        ds_map_put(map, &temp, value);
-    }
-    ZEND_HASH_FOREACH_END();
-}
-
 void ds_map_put_all(ds_map_t *map, zval *values)
 {
     if ( ! values) {
@@ -323,7 +540,7 @@ void ds_map_put_all(ds_map_t *map, zval *values)
     }
 
     if (ds_is_array(values)) {
-        add_ht_to_map(map, Z_ARRVAL_P(values));
+        ds_htable_put_array(map->table, Z_ARRVAL_P(values));
         return;
     }
 
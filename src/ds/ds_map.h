@@ -31,6 +31,31 @@ bool ds_map_has_value(ds_map_t *map, zval *value);
 bool ds_map_has_keys(ds_map_t *map, VA_PARAMS);
 bool ds_map_has_values(ds_map_t *map, VA_PARAMS);
 
+/**
+ * Batched versions of has and get for many keys at once, which are given as
+ * an array or traversable object. Missing keys map to the default value if
+ * one is given, otherwise throw.
+ */
+bool ds_map_has_all(ds_map_t *map, zval *keys);
+ds_map_t *ds_map_get_all(ds_map_t *map, zval *keys, zval *def);
+
+/**
+ * Updates the value of a key with a single lookup where possible, which
+ * means that the key is only hashed once. Each sets return_value to the value
+ * of the key afterwards. Callbacks may change the map, so their result is put
+ * using the hash that is already known.
+ */
+void ds_map_put_if_absent(ds_map_t *map, zval *key, zval *value, zval *return_value);
+void ds_map_compute(ds_map_t *map, zval *key, FCI_PARAMS, zval *return_value);
+void ds_map_compute_if_absent(ds_map_t *map, zval *key, FCI_PARAMS, zval *return_value);
+void ds_map_increment(ds_map_t *map, zval *key, zval *by, zval *return_value);
+
+/**
+ * Appends a value to the array or Vector of a key, which starts as an empty
+ * array if the key is new.
+ */
+void ds_map_append(ds_map_t *map, zval *key, zval *value);
+
 
 void ds_map_to_array(ds_map_t *map, zval *return_value);
 void ds_map_put_all(ds_map_t *map, zval *values);
@@ -44,6 +69,7 @@ ds_map_t *ds_map_filter(ds_map_t *map);
 ds_map_t *ds_map_filter_callback(ds_map_t *map, FCI_PARAMS);
 
 void ds_map_allocate(ds_map_t *map, zend_long capacity);
+void ds_map_shrink_to_fit(ds_map_t *map);
 zend_long ds_map_capacity(ds_map_t *map);
 
 void ds_map_sort_by_value_callback(ds_map_t *map);
@@ -69,6 +95,7 @@ ds_pair_t *ds_map_skip(ds_map_t *map, zend_long position);
 void ds_map_sum(ds_map_t *map, zval *return_value);
 void ds_map_reduce(ds_map_t *map, FCI_PARAMS, zval *initial, zval *return_value);
 void ds_map_apply(ds_map_t *map, FCI_PARAMS);
+void ds_map_retain(ds_map_t *map, FCI_PARAMS);
 
 
 #endif
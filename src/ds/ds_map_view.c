@@ -0,0 +1,139 @@
+#include "../common.h"
+
+#include "../php/objects/php_pair.h"
+#include "../php/objects/php_set.h"
+#include "../php/objects/php_vector.h"
+#include "../php/classes/php_pair_ce.h"
+
+#include "ds_pair.h"
+#include "ds_set.h"
+#include "ds_vector.h"
+#include "ds_map_view.h"
+
+ds_map_view_t *ds_map_view(ds_map_view_type_t type, zval *map, ds_htable_t *table)
+{
+    ds_map_view_t *view = ecalloc(1, sizeof(ds_map_view_t));
+
+    ZVAL_COPY(&view->map, map);
+
+    view->table = table;
+    view->type  = type;
+
+    return view;
+}
+
+ds_map_view_t *ds_map_view_clone(ds_map_view_t *view)
+{
+    return ds_map_view(view->type, &view->map, view->table);
+}
+
+void ds_map_view_free(ds_map_view_t *view)
+{
+    zval_ptr_dtor(&view->map);
+    efree(view);
+}
+
+/**
+ * A pair is in the view if its key is in the table with an identical value.
+ */
+static bool ds_map_view_contains_pair(ds_map_view_t *view, zval *value)
+{
+    ds_pair_t *pair;
+    zval *found;
+
+    if (Z_TYPE_P(value) != IS_OBJECT || Z_OBJCE_P(value) != php_ds_pair_ce) {
+        return false;
+    }
+
+    pair  = Z_DS_PAIR_P(value);
+    found = ds_htable_get(view->table, &pair->key);
+
+    return found && zend_is_identical(found, &pair->value);
+}
+
+bool ds_map_view_contains_va(ds_map_view_t *view, VA_PARAMS)
+{
+    switch (view->type) {
+        case DS_MAP_VIEW_KEYS:
+            return ds_htable_has_keys(view->table, argc, argv);
+
+        case DS_MAP_VIEW_VALUES:
+            return ds_htable_has_values(view->table, argc, argv);
+
+        case DS_MAP_VIEW_PAIRS:
+            while (argc-- > 0) {
+                if ( ! ds_map_view_contains_pair(view, argv++)) {
+                    return false;
+                }
+            }
+            return true;
+    }
+
+    return false;
+}
+
+void ds_map_view_to_array(ds_map_view_t *view, zval *return_value)
+{
+    zval *key;
+    zval *value;
+
+    array_init_size(return_value, DS_MAP_VIEW_SIZE(view));
+
+    switch (view->type) {
+        case DS_MAP_VIEW_KEYS:
+            DS_HTABLE_FOREACH_KEY(view->table, key) {
+                add_next_index_zval(return_value, key);
+                Z_TRY_ADDREF_P(key);
+            }
+            DS_HTABLE_FOREACH_END();
+            break;
+
+        case DS_MAP_VIEW_VALUES:
+            DS_HTABLE_FOREACH_VALUE(view->table, value) {
+                add_next_index_zval(return_value, value);
+                Z_TRY_ADDREF_P(value);
+            }
+            DS_HTABLE_FOREACH_END();
+            break;
+
+        case DS_MAP_VIEW_PAIRS:
+            DS_HTABLE_FOREACH_KEY_VALUE(view->table, key, value) {
+                zval pair;
+                ZVAL_DS_PAIR(&pair, ds_pair_ex(key, value));
+                add_next_index_zval(return_value, &pair);
+            }
+            DS_HTABLE_FOREACH_END();
+            break;
+    }
+}
+
+void ds_map_view_copy(ds_map_view_t *view, zval *return_value)
+{
+    zend_long size = DS_MAP_VIEW_SIZE(view);
+
+    switch (view->type) {
+        case DS_MAP_VIEW_KEYS:
+            ZVAL_DS_SET(return_value, ds_set_ex(ds_htable_clone(view->table)));
+            break;
+
+        case DS_MAP_VIEW_VALUES:
+            ZVAL_DS_VECTOR(return_value,
+                ds_vector_from_buffer(ds_htable_values(view->table), size, size));
+            break;
+
+        case DS_MAP_VIEW_PAIRS: {
+            zval *buffer = ds_allocate_zval_buffer(size);
+            zval *target = buffer;
+            zval *key;
+            zval *value;
+
+            DS_HTABLE_FOREACH_KEY_VALUE(view->table, key, value) {
+                ZVAL_DS_PAIR(target++, ds_pair_ex(key, value));
+            }
+            DS_HTABLE_FOREACH_END();
+
+            ZVAL_DS_VECTOR(return_value, ds_vector_from_buffer(buffer, size, size));
+            break;
+        }
+    }
+}
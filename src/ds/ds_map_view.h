@@ -0,0 +1,45 @@
+#ifndef DS_MAP_VIEW_H
+#define DS_MAP_VIEW_H
+
+#include "../common.h"
+#include "ds_htable.h"
+
+/**
+ * A read-only view of the keys, values or pairs of a map. The view refers to
+ * the map's own table rather than a copy, so creating a view is cheap and it
+ * always sees the current entries of the map. The table's change counter is
+ * used to stop iterating over a view when the map is changed during the loop.
+ */
+typedef enum ds_map_view_type {
+    DS_MAP_VIEW_KEYS,
+    DS_MAP_VIEW_VALUES,
+    DS_MAP_VIEW_PAIRS,
+} ds_map_view_type_t;
+
+#define DS_MAP_VIEW_SIZE(v)     ((v)->table->size)
+#define DS_MAP_VIEW_IS_EMPTY(v) (DS_MAP_VIEW_SIZE(v) == 0)
+
+typedef struct _ds_map_view_t {
+    zval                map;    // Object that owns the table, kept alive by the view
+    ds_htable_t        *table;  // Table of the map, which the view doesn't own
+    ds_map_view_type_t  type;
+} ds_map_view_t;
+
+/**
+ * Creates a view over the table of a map object, adding a reference to it.
+ */
+ds_map_view_t *ds_map_view(ds_map_view_type_t type, zval *map, ds_htable_t *table);
+ds_map_view_t *ds_map_view_clone(ds_map_view_t *view);
+
+void ds_map_view_free(ds_map_view_t *view);
+
+bool ds_map_view_contains_va(ds_map_view_t *view, VA_PARAMS);
+void ds_map_view_to_array(ds_map_view_t *view, zval *return_value);
+
+/**
+ * Copies the view into a collection of its own: a Set of the keys, or a
+ * Vector of the values or the pairs.
+ */
+void ds_map_view_copy(ds_map_view_t *view, zval *return_value);
+
+#endif
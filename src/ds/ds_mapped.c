@@ -0,0 +1,616 @@
+#include "../common.h"
+
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
+
+#include "ds_binary.h"
+#include "ds_mapped.h"
+
+#define DS_MAPPED_HEADER_SIZE sizeof(ds_mapped_header_t)
+
+/**
+ * Writing
+ */
+static bool ds_mapped_write_slot(ds_mapped_slot_t *slot, zval *value, smart_str *data)
+{
+    memset(slot, 0, sizeof(ds_mapped_slot_t));
+
+    ZVAL_DEREF(value);
+
+    switch (Z_TYPE_P(value)) {
+        case IS_NULL:
+            slot->tag = DS_BINARY_NULL;
+            return true;
+
+        case IS_FALSE:
+            slot->tag = DS_BINARY_FALSE;
+            return true;
+
+        case IS_TRUE:
+            slot->tag = DS_BINARY_TRUE;
+            return true;
+
+        case IS_LONG:
+            slot->tag     = DS_BINARY_LONG;
+            slot->payload = (uint64_t) Z_LVAL_P(value);
+            return true;
+
+        case IS_DOUBLE: {
+            double dval = Z_DVAL_P(value);
+
+            slot->tag = DS_BINARY_DOUBLE;
+            memcpy(&slot->payload, &dval, sizeof(slot->payload));
+            return true;
+        }
+
+        case IS_STRING:
+            if (Z_STRLEN_P(value) > UINT32_MAX) {
+                break;
+            }
+
+            slot->tag     = DS_BINARY_STRING;
+            slot->length  = (uint32_t) Z_STRLEN_P(value);
+            slot->payload = data->s ? ZSTR_LEN(data->s) : 0;
+
+            smart_str_appendl(data, Z_STRVAL_P(value), Z_STRLEN_P(value));
+            return true;
+    }
+
+    VALUE_CAN_NOT_BE_MAPPED(value);
+    return false;
+}
+
+static void ds_mapped_write_header(
+    smart_str           *buf,
+    ds_mapped_type_t     type,
+    zend_long            size,
+    uint32_t             capacity,
+    size_t               data,
+    size_t               data_size
+) {
+    ds_mapped_header_t header;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DS_MAPPED_MAGIC, sizeof(header.magic));
+
+    header.version    = DS_MAPPED_VERSION;
+    header.type       = type;
+    header.byte_order = DS_MAPPED_BYTE_ORDER;
+    header.capacity   = capacity;
+    header.size       = size;
+    header.data       = data;
+    header.data_size  = data_size;
+
+    smart_str_appendl(buf, (const char *) &header, sizeof(header));
+}
+
+/**
+ * Renames or removes a file through the wrapper that handles its path.
+ */
+static bool ds_mapped_rename(const char *from, const char *to)
+{
+    php_stream_wrapper *wrapper = php_stream_locate_url_wrapper(from, NULL, 0);
+
+    if ( ! wrapper || ! wrapper->wops || ! wrapper->wops->rename) {
+        return false;
+    }
+
+    return wrapper->wops->rename(wrapper, from, to, 0, php_stream_context_from_zval(NULL, 0));
+}
+
+static void ds_mapped_unlink(const char *path)
+{
+    php_stream_wrapper *wrapper = php_stream_locate_url_wrapper(path, NULL, 0);
+
+    if (wrapper && wrapper->wops && wrapper->wops->unlink) {
+        wrapper->wops->unlink(wrapper, path, 0, php_stream_context_from_zval(NULL, 0));
+    }
+}
+
+/**
+ * Writes the layout and the string bytes to a file, replacing its contents.
+ *
+ * The file could be mapped by other processes, so it's never truncated in
+ * place: the contents are written to a temporary file in the same directory
+ * which is then renamed over the target. Existing mappings keep the old file.
+ */
+static bool ds_mapped_write_file(const char *path, smart_str *layout, smart_str *data)
+{
+    static uint32_t sequence = 0;
+
+    php_stream *stream;
+    char *temp;
+    bool written;
+
+    spprintf(&temp, 0, "%s.%ld.%u.tmp", path, (long) getpid(), sequence++);
+
+    stream = php_stream_open_wrapper(temp, "xb", 0, NULL);
+
+    if ( ! stream) {
+        efree(temp);
+        FILE_NOT_OPENED(path);
+        return false;
+    }
+
+    written = php_stream_write(stream, ZSTR_VAL(layout->s), ZSTR_LEN(layout->s)) == ZSTR_LEN(layout->s);
+
+    if (written && data->s) {
+        written = php_stream_write(stream, ZSTR_VAL(data->s), ZSTR_LEN(data->s)) == ZSTR_LEN(data->s);
+    }
+
+    php_stream_close(stream);
+
+    if (written) {
+        written = ds_mapped_rename(temp, path);
+    }
+
+    if ( ! written) {
+        ds_mapped_unlink(temp);
+        FILE_NOT_WRITTEN(path);
+    }
+
+    efree(temp);
+    return written;
+}
+
+bool ds_mapped_write_vector(ds_vector_t *vector, const char *path)
+{
+    smart_str layout = {0};
+    smart_str data   = {0};
+    size_t offset    = DS_MAPPED_HEADER_SIZE + vector->size * sizeof(ds_mapped_slot_t);
+    bool written     = false;
+    ds_mapped_slot_t slot;
+    zval *value;
+
+    smart_str_alloc(&layout, offset, 0);
+    ds_mapped_write_header(&layout, DS_MAPPED_VECTOR, vector->size, 0, 0, 0);
+
+    DS_VECTOR_FOREACH(vector, value) {
+        if ( ! ds_mapped_write_slot(&slot, value, &data)) {
+            goto done;
+        }
+
+        smart_str_appendl(&layout, (const char *) &slot, sizeof(slot));
+    }
+    DS_VECTOR_FOREACH_END();
+
+    // Now that the size of the strings is known, complete the header.
+    ((ds_mapped_header_t *) ZSTR_VAL(layout.s))->data      = offset;
+    ((ds_mapped_header_t *) ZSTR_VAL(layout.s))->data_size = data.s ? ZSTR_LEN(data.s) : 0;
+
+    written = ds_mapped_write_file(path, &layout, &data);
+
+done:
+    smart_str_free(&layout);
+    smart_str_free(&data);
+    return written;
+}
+
+bool ds_mapped_write_map(ds_htable_t *table, const char *path)
+{
+    smart_str layout  = {0};
+    smart_str data    = {0};
+    uint32_t capacity = ds_next_power_of_2(table->size, DS_HTABLE_MIN_CAPACITY);
+    uint32_t *lookup  = emalloc(capacity * sizeof(uint32_t));
+    bool written      = false;
+    size_t buckets    = DS_MAPPED_HEADER_SIZE;
+    size_t offset     = buckets + table->size * sizeof(ds_mapped_bucket_t) + capacity * sizeof(uint32_t);
+    uint32_t index    = 0;
+
+    ds_htable_bucket_t *bucket;
+
+    memset(lookup, 0xFF, capacity * sizeof(uint32_t));
+
+    smart_str_alloc(&layout, offset, 0);
+    ds_mapped_write_header(&layout, DS_MAPPED_MAP, table->size, capacity, offset, 0);
+
+    DS_HTABLE_FOREACH_BUCKET(table, bucket) {
+        ds_mapped_bucket_t mapped;
+        uint32_t *head;
+
+        if (Z_TYPE(bucket->key) != IS_LONG && Z_TYPE(bucket->key) != IS_STRING) {
+            KEY_CAN_NOT_BE_MAPPED(&bucket->key);
+            goto done;
+        }
+
+        if ( ! ds_mapped_write_slot(&mapped.key, &bucket->key, &data) ||
+             ! ds_mapped_write_slot(&mapped.value, &bucket->value, &data)) {
+            goto done;
+        }
+
+        // Chain the bucket the same way that a table is rehashed.
+        head = &lookup[DS_HTABLE_BUCKET_HASH(bucket) & (capacity - 1)];
+
+        mapped.hash = DS_HTABLE_BUCKET_HASH(bucket);
+        mapped.next = *head;
+        *head = index++;
+
+        smart_str_appendl(&layout, (const char *) &mapped, sizeof(mapped));
+    }
+    DS_HTABLE_FOREACH_END();
+
+    smart_str_appendl(&layout, (const char *) lookup, capacity * sizeof(uint32_t));
+
+    ((ds_mapped_header_t *) ZSTR_VAL(layout.s))->data_size = data.s ? ZSTR_LEN(data.s) : 0;
+
+    written = ds_mapped_write_file(path, &layout, &data);
+
+done:
+    efree(lookup);
+    smart_str_free(&layout);
+    smart_str_free(&data);
+    return written;
+}
+
+/**
+ * Opening
+ */
+static bool ds_mapped_init(ds_mapped_t *mapped, const char *contents, size_t length, ds_mapped_type_t type)
+{
+    const ds_mapped_header_t *header = (const ds_mapped_header_t *) contents;
+    size_t available;
+    size_t layout;
+
+    if (length < DS_MAPPED_HEADER_SIZE
+            || memcmp(header->magic, DS_MAPPED_MAGIC, sizeof(header->magic)) != 0
+            || header->version    != DS_MAPPED_VERSION
+            || header->type       != type
+            || header->byte_order != DS_MAPPED_BYTE_ORDER) {
+        return false;
+    }
+
+    available = length - DS_MAPPED_HEADER_SIZE;
+
+    // Everything is checked against the length so that a truncated or
+    // corrupted file can't cause a read beyond the end of the mapping.
+    if (type == DS_MAPPED_VECTOR) {
+        if (header->size > available / sizeof(ds_mapped_slot_t)) {
+            return false;
+        }
+
+        layout = header->size * sizeof(ds_mapped_slot_t);
+
+    } else {
+        if (header->size >= DS_MAPPED_INVALID_INDEX
+                || header->capacity == 0
+                || (header->capacity & (header->capacity - 1)) != 0
+                || header->size > available / sizeof(ds_mapped_bucket_t)) {
+            return false;
+        }
+
+        layout = header->size * sizeof(ds_mapped_bucket_t);
+
+        if (header->capacity > (available - layout) / sizeof(uint32_t)) {
+            return false;
+        }
+
+        layout += header->capacity * sizeof(uint32_t);
+    }
+
+    if (header->data < DS_MAPPED_HEADER_SIZE + layout
+            || header->data > length
+            || header->data_size > length - header->data) {
+        return false;
+    }
+
+    mapped->type      = type;
+    mapped->size      = header->size;
+    mapped->capacity  = header->capacity;
+    mapped->data      = contents + header->data;
+    mapped->data_size = header->data_size;
+
+    if (type == DS_MAPPED_VECTOR) {
+        mapped->slots = (const ds_mapped_slot_t *) (contents + DS_MAPPED_HEADER_SIZE);
+    } else {
+        mapped->buckets = (const ds_mapped_bucket_t *) (contents + DS_MAPPED_HEADER_SIZE);
+        mapped->lookup  = (const uint32_t *) (mapped->buckets + mapped->size);
+    }
+
+    return true;
+}
+
+#ifdef HAVE_MMAP
+/**
+ * Maps a plain file, so that its pages are only read when they're accessed
+ * and are shared with every other process that maps the same file.
+ */
+static bool ds_mapped_map_stream(ds_mapped_t *mapped, php_stream *stream, size_t length)
+{
+    int fd;
+    void *addr;
+
+    if (php_stream_cast(stream, PHP_STREAM_AS_FD, (void **) &fd, 0) != SUCCESS) {
+        return false;
+    }
+
+    addr = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    mapped->addr   = addr;
+    mapped->length = length;
+
+    return true;
+}
+#endif
+
+ds_mapped_t *ds_mapped_open(const char *path, ds_mapped_type_t type)
+{
+    ds_mapped_t *mapped = ecalloc(1, sizeof(ds_mapped_t));
+    php_stream_statbuf ssb;
+    php_stream *stream;
+    const char *contents;
+    size_t length;
+
+    stream = php_stream_open_wrapper((char *) path, "rb", 0, NULL);
+
+    if ( ! stream) {
+        efree(mapped);
+        FILE_NOT_OPENED(path);
+        return NULL;
+    }
+
+    if (php_stream_stat(stream, &ssb) == SUCCESS && ssb.sb.st_size >= (zend_off_t) DS_MAPPED_HEADER_SIZE) {
+        length = (size_t) ssb.sb.st_size;
+    } else {
+        length = 0;
+    }
+
+#ifdef HAVE_MMAP
+    if (length > 0 && ds_mapped_map_stream(mapped, stream, length)) {
+        contents = mapped->addr;
+    } else
+#endif
+    {
+        // The file can't be mapped, eg. it's not a plain file or mmap is
+        // not available, so read it into memory instead.
+        mapped->contents = php_stream_copy_to_mem(stream, PHP_STREAM_COPY_ALL, 0);
+
+        if (mapped->contents) {
+            contents = ZSTR_VAL(mapped->contents);
+            length   = ZSTR_LEN(mapped->contents);
+        } else {
+            contents = NULL;
+            length   = 0;
+        }
+    }
+
+    // A mapping remains valid after the file is closed.
+    php_stream_close(stream);
+
+    if ( ! ds_mapped_init(mapped, contents, length, type)) {
+        ds_mapped_free(mapped);
+        INVALID_MAPPED_FILE();
+        return NULL;
+    }
+
+    return mapped;
+}
+
+ds_mapped_t *ds_mapped_empty(ds_mapped_type_t type)
+{
+    static const uint32_t lookup = DS_MAPPED_INVALID_INDEX;
+
+    ds_mapped_t *mapped = ecalloc(1, sizeof(ds_mapped_t));
+
+    mapped->type     = type;
+    mapped->capacity = 1;
+    mapped->lookup   = &lookup;
+    mapped->data     = "";
+
+    return mapped;
+}
+
+void ds_mapped_free(ds_mapped_t *mapped)
+{
+#ifdef HAVE_MMAP
+    if (mapped->addr) {
+        munmap(mapped->addr, mapped->length);
+    }
+#endif
+
+    if (mapped->contents) {
+        zend_string_release(mapped->contents);
+    }
+
+    efree(mapped);
+}
+
+/**
+ * Reading
+ */
+static void ds_mapped_box(ds_mapped_t *mapped, const ds_mapped_slot_t *slot, zval *return_value)
+{
+    switch (slot->tag) {
+        case DS_BINARY_NULL:
+            ZVAL_NULL(return_value);
+            return;
+
+        case DS_BINARY_FALSE:
+            ZVAL_FALSE(return_value);
+            return;
+
+        case DS_BINARY_TRUE:
+            ZVAL_TRUE(return_value);
+            return;
+
+        case DS_BINARY_LONG:
+            ZVAL_LONG(return_value, (zend_long) slot->payload);
+            return;
+
+        case DS_BINARY_DOUBLE: {
+            double dval;
+            memcpy(&dval, &slot->payload, sizeof(dval));
+            ZVAL_DOUBLE(return_value, dval);
+            return;
+        }
+
+        case DS_BINARY_STRING:
+            if (slot->payload <= mapped->data_size && slot->length <= mapped->data_size - slot->payload) {
+                ZVAL_STRINGL(return_value, mapped->data + slot->payload, slot->length);
+                return;
+            }
+            break;
+    }
+
+    INVALID_MAPPED_FILE();
+    ZVAL_NULL(return_value);
+}
+
+void ds_mapped_get_value(ds_mapped_t *mapped, zend_long position, zval *return_value)
+{
+    if (mapped->type == DS_MAPPED_VECTOR) {
+        ds_mapped_box(mapped, &mapped->slots[position], return_value);
+    } else {
+        ds_mapped_box(mapped, &mapped->buckets[position].value, return_value);
+    }
+}
+
+void ds_mapped_get_key(ds_mapped_t *mapped, zend_long position, zval *return_value)
+{
+    if (mapped->type == DS_MAPPED_VECTOR) {
+        ZVAL_LONG(return_value, position);
+    } else {
+        ds_mapped_box(mapped, &mapped->buckets[position].key, return_value);
+    }
+}
+
+/**
+ * Compares a key to the key of a bucket without boxing it.
+ */
+static bool ds_mapped_key_match(ds_mapped_t *mapped, const ds_mapped_slot_t *slot, zval *key)
+{
+    switch (Z_TYPE_P(key)) {
+        case IS_LONG:
+            return slot->tag == DS_BINARY_LONG && (zend_long) slot->payload == Z_LVAL_P(key);
+
+        case IS_STRING:
+            return slot->tag == DS_BINARY_STRING
+                && slot->length == Z_STRLEN_P(key)
+                && slot->payload <= mapped->data_size
+                && slot->length <= mapped->data_size - slot->payload
+                && memcmp(mapped->data + slot->payload, Z_STRVAL_P(key), slot->length) == 0;
+
+        default:
+            return false;
+    }
+}
+
+bool ds_mapped_lookup(ds_mapped_t *mapped, zval *key, zval *return_value)
+{
+    uint32_t hash;
+    uint32_t index;
+    zend_long steps = 0;
+
+    ZVAL_DEREF(key);
+
+    // Only int and string keys can be mapped.
+    if (Z_TYPE_P(key) != IS_LONG && Z_TYPE_P(key) != IS_STRING) {
+        return false;
+    }
+
+    hash  = ds_htable_hash(key);
+    index = mapped->lookup[hash & (mapped->capacity - 1)];
+
+    // The length of a chain is bounded in case the file is corrupted.
+    while (index < (uint32_t) mapped->size && steps++ < mapped->size) {
+        const ds_mapped_bucket_t *bucket = &mapped->buckets[index];
+
+        if (bucket->hash == hash && ds_mapped_key_match(mapped, &bucket->key, key)) {
+            ds_mapped_box(mapped, &bucket->value, return_value);
+            return true;
+        }
+
+        index = bucket->next;
+    }
+
+    return false;
+}
+
+void ds_mapped_to_array(ds_mapped_t *mapped, zval *return_value)
+{
+    zend_long position;
+
+    array_init_size(return_value, mapped->size);
+
+    for (position = 0; position < mapped->size; position++) {
+        zval key;
+        zval value;
+
+        ds_mapped_get_value(mapped, position, &value);
+
+        if (mapped->type == DS_MAPPED_VECTOR) {
+            add_next_index_zval(return_value, &value);
+            continue;
+        }
+
+        ds_mapped_get_key(mapped, position, &key);
+
+        if (Z_TYPE(key) == IS_LONG) {
+            add_index_zval(return_value, Z_LVAL(key), &value);
+        } else {
+            zend_symtable_update(Z_ARRVAL_P(return_value), Z_STR(key), &value);
+            zval_ptr_dtor(&key);
+        }
+    }
+}
+
+ds_vector_t *ds_mapped_to_vector(ds_mapped_t *mapped)
+{
+    ds_vector_t *vector = ds_vector_ex(mapped->size);
+    zend_long position;
+
+    for (position = 0; position < mapped->size; position++) {
+        ds_mapped_get_value(mapped, position, &vector->buffer[position]);
+    }
+
+    vector->size = mapped->size;
+    return vector;
+}
+
+ds_map_t *ds_mapped_to_map(ds_mapped_t *mapped)
+{
+    ds_map_t *map = ds_map();
+    zend_long position;
+
+    ds_map_allocate(map, mapped->size);
+
+    for (position = 0; position < mapped->size; position++) {
+        const ds_mapped_bucket_t *bucket = &mapped->buckets[position];
+        zval key;
+        zval value;
+
+        ds_mapped_box(mapped, &bucket->key, &key);
+
+        // A corrupted hash would put the key in the wrong chain of the table,
+        // so the stored hash has to match the key before it can be trusted.
+        if ((Z_TYPE(key) != IS_LONG && Z_TYPE(key) != IS_STRING) || ds_htable_hash(&key) != bucket->hash) {
+            zval_ptr_dtor(&key);
+
+            if ( ! EG(exception)) {
+                INVALID_MAPPED_FILE();
+            }
+
+            ds_map_free(map);
+            return NULL;
+        }
+
+        ds_mapped_box(mapped, &bucket->value, &value);
+
+        if (EG(exception)) {
+            zval_ptr_dtor(&key);
+            ds_map_free(map);
+            return NULL;
+        }
+
+        ds_htable_put_hashed(map->table, &key, bucket->hash, &value);
+
+        zval_ptr_dtor(&key);
+        zval_ptr_dtor(&value);
+    }
+
+    return map;
+}
@@ -0,0 +1,103 @@
+#ifndef DS_MAPPED_H
+#define DS_MAPPED_H
+
+#include "../common.h"
+#include "ds_vector.h"
+#include "ds_map.h"
+
+/**
+ * A read-only file layout for a vector or a map of scalars and strings, which
+ * is memory-mapped rather than read, so that the pages are shared by every
+ * process that maps the same file. Values are only boxed into zvals when they
+ * are accessed.
+ *
+ * A file starts with a header, followed by the slots of a vector or the
+ * buckets of a map, then the lookup of a map, then the bytes of all strings.
+ * Buckets and the lookup work like those of ds_htable_t. The file is written
+ * in the byte order of the machine that writes it, and can only be mapped by
+ * a machine with the same byte order.
+ */
+#define DS_MAPPED_MAGIC         "DSMAPPED"
+#define DS_MAPPED_VERSION       1
+#define DS_MAPPED_INVALID_INDEX ((uint32_t) -1)
+#define DS_MAPPED_BYTE_ORDER    0x01020304
+
+typedef enum ds_mapped_type {
+    DS_MAPPED_VECTOR = 1,
+    DS_MAPPED_MAP,
+} ds_mapped_type_t;
+
+typedef struct _ds_mapped_header_t {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    type;
+    uint32_t    byte_order;
+    uint32_t    capacity;       // Length of the lookup of a map
+    uint64_t    size;           // Number of values or buckets
+    uint64_t    data;           // Offset of the string bytes
+    uint64_t    data_size;      // Number of string bytes
+} ds_mapped_header_t;
+
+typedef struct _ds_mapped_slot_t {
+    uint8_t     tag;            // Uses the tags of the binary format
+    uint8_t     reserved[3];
+    uint32_t    length;         // Length of a string
+    uint64_t    payload;        // Integer, bits of a float, or offset of a string
+} ds_mapped_slot_t;
+
+typedef struct _ds_mapped_bucket_t {
+    ds_mapped_slot_t    key;
+    ds_mapped_slot_t    value;
+    uint32_t            hash;
+    uint32_t            next;   // Index of the next bucket in the chain
+} ds_mapped_bucket_t;
+
+typedef struct _ds_mapped_t {
+    ds_mapped_type_t            type;
+    zend_long                   size;
+    uint32_t                    capacity;
+    const ds_mapped_slot_t     *slots;      // Values of a vector
+    const ds_mapped_bucket_t   *buckets;    // Buckets of a map
+    const uint32_t             *lookup;     // Lookup of a map
+    const char                 *data;       // String bytes
+    uint64_t                    data_size;
+    void                       *addr;       // Mapped address, or NULL
+    size_t                      length;     // Mapped length
+    zend_string                *contents;   // Contents when the file could not be mapped
+} ds_mapped_t;
+
+#define DS_MAPPED_SIZE(m)     ((m)->size)
+#define DS_MAPPED_IS_EMPTY(m) ((m)->size == 0)
+
+/**
+ * Write a vector or the table of a map to a file. Only null, bool, int,
+ * float and string values can be written, and map keys must be int or
+ * string. These throw and return false on failure.
+ */
+bool ds_mapped_write_vector(ds_vector_t *vector, const char *path);
+bool ds_mapped_write_map(ds_htable_t *table, const char *path);
+
+/**
+ * Maps a file of the given type, or throws and returns NULL.
+ */
+ds_mapped_t *ds_mapped_open(const char *path, ds_mapped_type_t type);
+ds_mapped_t *ds_mapped_empty(ds_mapped_type_t type);
+void ds_mapped_free(ds_mapped_t *mapped);
+
+/**
+ * Boxes the value or key at a position, ie. an index of a vector or the
+ * position of a bucket of a map.
+ */
+void ds_mapped_get_value(ds_mapped_t *mapped, zend_long position, zval *return_value);
+void ds_mapped_get_key(ds_mapped_t *mapped, zend_long position, zval *return_value);
+
+/**
+ * Boxes the value of a key in a map, returning false if it was not found.
+ */
+bool ds_mapped_lookup(ds_mapped_t *mapped, zval *key, zval *return_value);
+
+void ds_mapped_to_array(ds_mapped_t *mapped, zval *return_value);
+ds_vector_t *ds_mapped_to_vector(ds_mapped_t *mapped);
+ds_map_t *ds_mapped_to_map(ds_mapped_t *mapped);
+
+#endif
@@ -7,7 +7,7 @@
 
 ds_pair_t *ds_pair()
 {
-    ds_pair_t *pair = ecalloc(1, sizeof(ds_pair_t));
+    ds_pair_t *pair = ds_slab_alloc(&DSG(pair_slab));
 
     ZVAL_UNDEF(&pair->key);
     ZVAL_UNDEF(&pair->value);
@@ -46,9 +46,17 @@ void ds_pair_to_array(ds_pair_t *pair, zval *array)
     Z_TRY_ADDREF_P(&pair->value);
 }
 
+bool ds_pair_equals(ds_pair_t *pair, ds_pair_t *other)
+{
+    return fast_equal_check_function(&pair->key, &other->key)
+        && ! EG(exception)
+        && fast_equal_check_function(&pair->value, &other->value)
+        && ! EG(exception);
+}
+
 void ds_pair_free(ds_pair_t *pair)
 {
     DTOR_AND_UNDEF(&pair->key);
     DTOR_AND_UNDEF(&pair->value);
-    efree(pair);
+    ds_slab_free(&DSG(pair_slab), pair);
 }
@@ -13,6 +13,7 @@ ds_pair_t *ds_pair_ex(zval *key, zval *value);
 ds_pair_t *ds_pair_clone(ds_pair_t *pair);
 
 void ds_pair_to_array(ds_pair_t *pair, zval *return_value);
+bool ds_pair_equals(ds_pair_t *pair, ds_pair_t *other);
 void ds_pair_free(ds_pair_t *pair);
 
 #endif
@@ -0,0 +1,599 @@
+#include "../common.h"
+#include "ds_htable.h"
+#include "ds_persistent_map.h"
+
+#define BITS DS_PERSISTENT_MAP_BITS
+#define MASK DS_PERSISTENT_MAP_MASK
+
+/**
+ * The bit of a node's maps that the given hash uses at the given shift.
+ */
+#define HASH_BIT(hash, shift) (((uint32_t) 1) << (((hash) >> (shift)) & MASK))
+
+/**
+ * Position in a node's entries or children of the given bit of a map.
+ */
+#define BIT_INDEX(map, bit) (popcount((map) & ((bit) - 1)))
+
+static inline uint32_t popcount(uint32_t x)
+{
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F;
+    return (x * 0x01010101) >> 24;
+}
+
+static ds_persistent_map_node_t *node_allocate()
+{
+    ds_persistent_map_node_t *node = ecalloc(1, sizeof(ds_persistent_map_node_t));
+    node->refs = 1;
+    return node;
+}
+
+/**
+ * Removes an owner from a node, freeing it and releasing its entries and
+ * children if it was the last one.
+ */
+static void node_release(ds_persistent_map_node_t *node)
+{
+    uint32_t index;
+
+    if ( ! node || --node->refs > 0) {
+        return;
+    }
+
+    for (index = 0; index < node->size; index++) {
+        zval_ptr_dtor(&node->entries[index].key);
+        zval_ptr_dtor(&node->entries[index].value);
+    }
+
+    for (index = 0; index < popcount(node->nodemap); index++) {
+        node_release(node->children[index]);
+    }
+
+    if (node->entries) {
+        efree(node->entries);
+    }
+
+    if (node->children) {
+        efree(node->children);
+    }
+
+    efree(node);
+}
+
+static ds_persistent_map_node_t *node_copy(ds_persistent_map_node_t *node)
+{
+    ds_persistent_map_node_t *copy = node_allocate();
+    uint32_t count = popcount(node->nodemap);
+    uint32_t index;
+
+    copy->datamap = node->datamap;
+    copy->nodemap = node->nodemap;
+    copy->size    = node->size;
+
+    if (node->size > 0) {
+        copy->entries = emalloc(node->size * sizeof(ds_htable_bucket_t));
+
+        for (index = 0; index < node->size; index++) {
+            DS_HTABLE_BUCKET_COPY(&copy->entries[index], &node->entries[index]);
+        }
+    }
+
+    if (count > 0) {
+        copy->children = emalloc(count * sizeof(ds_persistent_map_node_t *));
+
+        for (index = 0; index < count; index++) {
+            copy->children[index] = node->children[index];
+            copy->children[index]->refs++;
+        }
+    }
+
+    return copy;
+}
+
+/**
+ * Returns the node in the given slot, after replacing it with a copy if it's
+ * shared with another version. The copy shares the children of the original.
+ */
+static ds_persistent_map_node_t *node_editable(ds_persistent_map_node_t **slot)
+{
+    ds_persistent_map_node_t *node = *slot;
+
+    if (node->refs > 1) {
+        node->refs--;
+        node  = node_copy(node);
+        *slot = node;
+    }
+
+    return node;
+}
+
+/**
+ * Moves an entry into a node's entries at the given position.
+ */
+static void node_insert_entry(ds_persistent_map_node_t *node, uint32_t index, ds_htable_bucket_t *entry)
+{
+    node->entries = erealloc(node->entries, (node->size + 1) * sizeof(ds_htable_bucket_t));
+
+    memmove(
+        &node->entries[index + 1],
+        &node->entries[index],
+        (node->size - index) * sizeof(ds_htable_bucket_t));
+
+    node->entries[index] = *entry;
+    node->size++;
+}
+
+/**
+ * Removes an entry from a node's entries without destructing it.
+ */
+static void node_remove_entry(ds_persistent_map_node_t *node, uint32_t index)
+{
+    node->size--;
+
+    memmove(
+        &node->entries[index],
+        &node->entries[index + 1],
+        (node->size - index) * sizeof(ds_htable_bucket_t));
+
+    if (node->size == 0) {
+        efree(node->entries);
+        node->entries = NULL;
+    }
+}
+
+static void node_insert_child(ds_persistent_map_node_t *node, uint32_t bit, ds_persistent_map_node_t *child)
+{
+    uint32_t count = popcount(node->nodemap);
+    uint32_t index = BIT_INDEX(node->nodemap, bit);
+
+    node->children = erealloc(node->children, (count + 1) * sizeof(ds_persistent_map_node_t *));
+
+    memmove(
+        &node->children[index + 1],
+        &node->children[index],
+        (count - index) * sizeof(ds_persistent_map_node_t *));
+
+    node->children[index] = child;
+    node->nodemap |= bit;
+}
+
+static void node_remove_child(ds_persistent_map_node_t *node, uint32_t bit)
+{
+    uint32_t count = popcount(node->nodemap) - 1;
+    uint32_t index = BIT_INDEX(node->nodemap, bit);
+
+    memmove(
+        &node->children[index],
+        &node->children[index + 1],
+        (count - index) * sizeof(ds_persistent_map_node_t *));
+
+    node->nodemap &= ~bit;
+
+    if (count == 0) {
+        efree(node->children);
+        node->children = NULL;
+    }
+}
+
+static inline void init_entry(ds_htable_bucket_t *entry, zval *key, zval *value, uint32_t hash)
+{
+    ZVAL_COPY(&entry->key, key);
+    ZVAL_COPY(&entry->value, value);
+    DS_HTABLE_BUCKET_HASH(entry) = hash;
+}
+
+/**
+ * Creates a node at the given shift for an existing entry, which is moved,
+ * and a new entry. Hashes that are equal up to this shift create a chain of
+ * nodes until they differ, or end in a collision node.
+ */
+static ds_persistent_map_node_t *node_merge(
+    ds_htable_bucket_t  *entry,
+    zval                *key,
+    zval                *value,
+    uint32_t             hash,
+    uint32_t             shift
+) {
+    ds_persistent_map_node_t *node = node_allocate();
+    ds_htable_bucket_t added;
+
+    if (shift >= DS_PERSISTENT_MAP_COLLISION_SHIFT) {
+        init_entry(&added, key, value, hash);
+        node_insert_entry(node, 0, entry);
+        node_insert_entry(node, 1, &added);
+
+    } else {
+        uint32_t a = HASH_BIT(DS_HTABLE_BUCKET_HASH(entry), shift);
+        uint32_t b = HASH_BIT(hash, shift);
+
+        if (a == b) {
+            node_insert_child(node, a, node_merge(entry, key, value, hash, shift + BITS));
+
+        } else {
+            init_entry(&added, key, value, hash);
+            node_insert_entry(node, 0, a < b ? entry : &added);
+            node_insert_entry(node, 1, a < b ? &added : entry);
+            node->datamap = a | b;
+        }
+    }
+
+    return node;
+}
+
+static void node_put(
+    ds_persistent_map_node_t  **slot,
+    uint32_t                    shift,
+    zval                       *key,
+    zval                       *value,
+    uint32_t                    hash,
+    bool                       *added
+) {
+    ds_persistent_map_node_t *node = node_editable(slot);
+    ds_htable_bucket_t *entry;
+    ds_htable_bucket_t  temp;
+    uint32_t bit;
+
+    if (shift >= DS_PERSISTENT_MAP_COLLISION_SHIFT) {
+        uint32_t index;
+
+        for (index = 0; index < node->size; index++) {
+            entry = &node->entries[index];
+
+            if (ds_htable_keys_match(&entry->key, key)) {
+                zval_ptr_dtor(&entry->value);
+                ZVAL_COPY(&entry->value, value);
+                return;
+            }
+        }
+
+        init_entry(&temp, key, value, hash);
+        node_insert_entry(node, node->size, &temp);
+        *added = true;
+        return;
+    }
+
+    bit = HASH_BIT(hash, shift);
+
+    if (node->datamap & bit) {
+        uint32_t index = BIT_INDEX(node->datamap, bit);
+
+        entry = &node->entries[index];
+
+        if (DS_HTABLE_BUCKET_HASH(entry) == hash && ds_htable_keys_match(&entry->key, key)) {
+            zval_ptr_dtor(&entry->value);
+            ZVAL_COPY(&entry->value, value);
+            return;
+        }
+
+        // Both entries move down into a new child node.
+        temp = *entry;
+        node_remove_entry(node, index);
+        node->datamap &= ~bit;
+        node_insert_child(node, bit, node_merge(&temp, key, value, hash, shift + BITS));
+        *added = true;
+
+    } else if (node->nodemap & bit) {
+        node_put(&node->children[BIT_INDEX(node->nodemap, bit)], shift + BITS, key, value, hash, added);
+
+    } else {
+        init_entry(&temp, key, value, hash);
+        node_insert_entry(node, BIT_INDEX(node->datamap, bit), &temp);
+        node->datamap |= bit;
+        *added = true;
+    }
+}
+
+/**
+ * Removes a key that is known to exist below the given slot.
+ */
+static void node_remove(
+    ds_persistent_map_node_t  **slot,
+    uint32_t                    shift,
+    zval                       *key,
+    uint32_t                    hash,
+    zval                       *return_value
+) {
+    ds_persistent_map_node_t *node = node_editable(slot);
+    ds_persistent_map_node_t *child;
+    ds_htable_bucket_t *entry;
+    uint32_t index;
+    uint32_t bit;
+
+    if (shift >= DS_PERSISTENT_MAP_COLLISION_SHIFT) {
+        for (index = 0; index < node->size; index++) {
+            entry = &node->entries[index];
+
+            if (ds_htable_keys_match(&entry->key, key)) {
+                SET_AS_RETURN_AND_UNDEF(&entry->value);
+                zval_ptr_dtor(&entry->key);
+                node_remove_entry(node, index);
+                return;
+            }
+        }
+        return;
+    }
+
+    bit = HASH_BIT(hash, shift);
+
+    if (node->datamap & bit) {
+        index = BIT_INDEX(node->datamap, bit);
+        entry = &node->entries[index];
+
+        SET_AS_RETURN_AND_UNDEF(&entry->value);
+        zval_ptr_dtor(&entry->key);
+        node_remove_entry(node, index);
+        node->datamap &= ~bit;
+        return;
+    }
+
+    index = BIT_INDEX(node->nodemap, bit);
+    node_remove(&node->children[index], shift + BITS, key, hash, return_value);
+    child = node->children[index];
+
+    // A child with only one entry left is moved back up into this node, so
+    // that the trie stays as shallow as possible. The child was made
+    // editable by the removal, so nothing else refers to its entry.
+    if (child->nodemap == 0 && child->size <= 1) {
+        if (child->size == 1) {
+            ds_htable_bucket_t moved = child->entries[0];
+
+            node_remove_entry(child, 0);
+            node_insert_entry(node, BIT_INDEX(node->datamap, bit), &moved);
+            node->datamap |= bit;
+        }
+
+        node_remove_child(node, bit);
+        node_release(child);
+    }
+}
+
+ds_persistent_map_t *ds_persistent_map()
+{
+    return ecalloc(1, sizeof(ds_persistent_map_t));
+}
+
+ds_persistent_map_t *ds_persistent_map_clone(ds_persistent_map_t *map)
+{
+    ds_persistent_map_t *clone = ecalloc(1, sizeof(ds_persistent_map_t));
+
+    *clone = *map;
+
+    if (clone->root) {
+        clone->root->refs++;
+    }
+
+    return clone;
+}
+
+void ds_persistent_map_free(ds_persistent_map_t *map)
+{
+    node_release(map->root);
+    efree(map);
+}
+
+static void node_gather(ds_persistent_map_node_t *node, zval **buffer, int *size, int *count)
+{
+    uint32_t index;
+
+    if ( ! node || node->refs > 1) {
+        return;
+    }
+
+    if (*size - *count < (int) node->size * 2) {
+        *size   = MAX(*size * 2, *count + (int) node->size * 2);
+        *buffer = safe_erealloc(*buffer, *size, sizeof(zval), 0);
+    }
+
+    // An entry is a bucket, which is a key and a value.
+    for (index = 0; index < node->size; index++) {
+        ZVAL_COPY_VALUE(*buffer + (*count)++, &node->entries[index].key);
+        ZVAL_COPY_VALUE(*buffer + (*count)++, &node->entries[index].value);
+    }
+
+    for (index = 0; index < popcount(node->nodemap); index++) {
+        node_gather(node->children[index], buffer, size, count);
+    }
+}
+
+void ds_persistent_map_gather(ds_persistent_map_t *map, zval **buffer, int *size, int *count)
+{
+    node_gather(map->root, buffer, size, count);
+}
+
+ds_htable_bucket_t *ds_persistent_map_lookup(ds_persistent_map_t *map, zval *key)
+{
+    ds_persistent_map_node_t *node = map->root;
+    uint32_t hash;
+    uint32_t shift = 0;
+
+    if ( ! node) {
+        return NULL;
+    }
+
+    hash = ds_htable_hash(key);
+
+    while (shift < DS_PERSISTENT_MAP_COLLISION_SHIFT) {
+        uint32_t bit = HASH_BIT(hash, shift);
+
+        if (node->datamap & bit) {
+            ds_htable_bucket_t *entry = &node->entries[BIT_INDEX(node->datamap, bit)];
+
+            if (DS_HTABLE_BUCKET_HASH(entry) == hash && ds_htable_keys_match(&entry->key, key)) {
+                return entry;
+            }
+
+            return NULL;
+        }
+
+        if ( ! (node->nodemap & bit)) {
+            return NULL;
+        }
+
+        node   = node->children[BIT_INDEX(node->nodemap, bit)];
+        shift += BITS;
+    }
+
+    {
+        uint32_t index;
+
+        for (index = 0; index < node->size; index++) {
+            if (ds_htable_keys_match(&node->entries[index].key, key)) {
+                return &node->entries[index];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+zval *ds_persistent_map_get(ds_persistent_map_t *map, zval *key, zval *def)
+{
+    ds_htable_bucket_t *entry = ds_persistent_map_lookup(map, key);
+
+    if (entry) {
+        return &entry->value;
+    }
+
+    if (def) {
+        return def;
+    }
+
+    KEY_NOT_FOUND();
+    return NULL;
+}
+
+bool ds_persistent_map_has_key(ds_persistent_map_t *map, zval *key)
+{
+    return ds_persistent_map_lookup(map, key) != NULL;
+}
+
+void ds_persistent_map_put(ds_persistent_map_t *map, zval *key, zval *value)
+{
+    uint32_t hash = ds_htable_hash(key);
+    bool added = false;
+
+    // Hashing an object can fail, eg. a Hashable that returns an array.
+    if (EG(exception)) {
+        return;
+    }
+
+    if ( ! map->root) {
+        map->root = node_allocate();
+    }
+
+    node_put(&map->root, 0, key, value, hash, &added);
+
+    if (added) {
+        map->size++;
+    }
+}
+
+static int iterator_add(zend_object_iterator *iterator, void *puser)
+{
+    zval key;
+    zval *value = iterator->funcs->get_current_data(iterator);
+                  iterator->funcs->get_current_key(iterator, &key);
+
+    ds_persistent_map_put((ds_persistent_map_t *) puser, &key, value);
+    zval_ptr_dtor(&key);
+
+    return ZEND_HASH_APPLY_KEEP;
+}
+
+void ds_persistent_map_put_all(ds_persistent_map_t *map, zval *values)
+{
+    if ( ! values) {
+        return;
+    }
+
+    if (ds_is_array(values)) {
+        zend_string *key;
+        zend_ulong   index;
+        zval        *value;
+        zval         temp;
+
+        ZEND_HASH_FOREACH_KEY_VAL(Z_ARRVAL_P(values), index, key, value) {
+            if (key) {
+                ZVAL_STR(&temp, key);
+            } else {
+                ZVAL_LONG(&temp, (zend_long) index);
+            }
+            ds_persistent_map_put(map, &temp, value);
+        }
+        ZEND_HASH_FOREACH_END();
+        return;
+    }
+
+    if (ds_is_traversable(values)) {
+        spl_iterator_apply(values, iterator_add, (void *) map);
+        return;
+    }
+
+    ARRAY_OR_TRAVERSABLE_REQUIRED();
+}
+
+int ds_persistent_map_remove(ds_persistent_map_t *map, zval *key, zval *return_value)
+{
+    // Look the key up first, so that nodes aren't copied for nothing.
+    if ( ! ds_persistent_map_lookup(map, key)) {
+        return FAILURE;
+    }
+
+    node_remove(&map->root, 0, key, ds_htable_hash(key), return_value);
+
+    if (--map->size == 0) {
+        node_release(map->root);
+        map->root = NULL;
+    }
+
+    return SUCCESS;
+}
+
+void ds_persistent_map_cursor_rewind(ds_persistent_map_cursor_t *cursor, ds_persistent_map_t *map)
+{
+    cursor->depth        = map->root ? 0 : -1;
+    cursor->nodes[0]     = map->root;
+    cursor->positions[0] = 0;
+}
+
+ds_htable_bucket_t *ds_persistent_map_cursor_next(ds_persistent_map_cursor_t *cursor)
+{
+    // Each node's entries come before the entries of its children.
+    while (cursor->depth >= 0) {
+        ds_persistent_map_node_t *node = cursor->nodes[cursor->depth];
+        uint32_t position = cursor->positions[cursor->depth]++;
+
+        if (position < node->size) {
+            return &node->entries[position];
+        }
+
+        position -= node->size;
+
+        if (position < popcount(node->nodemap)) {
+            cursor->depth++;
+            cursor->nodes[cursor->depth]     = node->children[position];
+            cursor->positions[cursor->depth] = 0;
+        } else {
+            cursor->depth--;
+        }
+    }
+
+    return NULL;
+}
+
+void ds_persistent_map_to_array(ds_persistent_map_t *map, zval *return_value)
+{
+    HashTable *array;
+    zval *key;
+    zval *value;
+
+    array_init_size(return_value, map->size);
+    array = Z_ARR_P(return_value);
+
+    DS_PERSISTENT_MAP_FOREACH_KEY_VALUE(map, key, value) {
+        array_set_zval_key(array, key, value);
+    }
+    DS_PERSISTENT_MAP_FOREACH_END();
+}
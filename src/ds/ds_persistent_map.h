@@ -0,0 +1,113 @@
+#ifndef DS_PERSISTENT_MAP_H
+#define DS_PERSISTENT_MAP_H
+
+#include "../common.h"
+#include "ds_htable.h"
+
+/**
+ * A persistent map is a hash array mapped trie, which uses 5 bits of a key's
+ * hash at each level to find either an entry or the next node. Nodes are
+ * reference counted and shared between versions, so that a change only
+ * copies the nodes along the path to the key that changed.
+ *
+ * Keys are hashed and compared the same way as a Map, and each entry is a
+ * table bucket so that the hash is stored alongside the key.
+ */
+#define DS_PERSISTENT_MAP_BITS  5
+#define DS_PERSISTENT_MAP_MASK  ((1 << DS_PERSISTENT_MAP_BITS) - 1)
+
+/**
+ * All 32 bits of the hash have been used once a node is this deep, so its
+ * entries all have the same hash and are searched linearly.
+ */
+#define DS_PERSISTENT_MAP_COLLISION_SHIFT 35
+
+/**
+ * Number of levels, including the level of collision nodes.
+ */
+#define DS_PERSISTENT_MAP_MAX_DEPTH (DS_PERSISTENT_MAP_COLLISION_SHIFT / DS_PERSISTENT_MAP_BITS + 1)
+
+#define DS_PERSISTENT_MAP_SIZE(m)     ((m)->size)
+#define DS_PERSISTENT_MAP_IS_EMPTY(m) (DS_PERSISTENT_MAP_SIZE(m) == 0)
+
+#define DS_PERSISTENT_MAP_FOREACH_BUCKET(m, b)                      \
+do {                                                                \
+    ds_persistent_map_cursor_t _c;                                  \
+    ds_persistent_map_cursor_rewind(&_c, m);                        \
+    while ((b = ds_persistent_map_cursor_next(&_c)) != NULL) {
+
+#define DS_PERSISTENT_MAP_FOREACH_KEY_VALUE(m, k, v)                \
+do {                                                                \
+    ds_persistent_map_cursor_t _c;                                  \
+    ds_htable_bucket_t *_b;                                         \
+    ds_persistent_map_cursor_rewind(&_c, m);                        \
+    while ((_b = ds_persistent_map_cursor_next(&_c)) != NULL) {     \
+        k = &_b->key;                                               \
+        v = &_b->value;
+
+#define DS_PERSISTENT_MAP_FOREACH_END() \
+    } \
+} while (0)
+
+typedef struct ds_persistent_map_node ds_persistent_map_node_t;
+
+struct ds_persistent_map_node {
+    uint32_t                    refs;       // Number of parents and maps that share this node
+    uint32_t                    datamap;    // Hash bits that have an entry in this node
+    uint32_t                    nodemap;    // Hash bits that have a child node
+    uint32_t                    size;       // Number of entries in this node
+    ds_htable_bucket_t         *entries;    // Entries in order of their bit
+    ds_persistent_map_node_t  **children;   // Child nodes in order of their bit
+};
+
+typedef struct ds_persistent_map {
+    ds_persistent_map_node_t   *root;       // NULL when empty
+    uint32_t                    size;       // Number of entries in the trie
+} ds_persistent_map_t;
+
+/**
+ * Depth-first position in a map, which is stable as long as the map is not
+ * changed in place.
+ */
+typedef struct ds_persistent_map_cursor {
+    ds_persistent_map_node_t   *nodes[DS_PERSISTENT_MAP_MAX_DEPTH];
+    uint32_t                    positions[DS_PERSISTENT_MAP_MAX_DEPTH];
+    int                         depth;
+} ds_persistent_map_cursor_t;
+
+ds_persistent_map_t *ds_persistent_map();
+
+/**
+ * Creates a new version that shares all of its nodes with the given map.
+ */
+ds_persistent_map_t *ds_persistent_map_clone(ds_persistent_map_t *map);
+
+void ds_persistent_map_free(ds_persistent_map_t *map);
+
+/**
+ * Appends the keys and values that only this version holds to a buffer for
+ * the GC, growing the buffer as needed. Those are the entries of the nodes
+ * that are reached without passing a node that is shared with another
+ * version, which would otherwise be counted once for every version.
+ */
+void ds_persistent_map_gather(ds_persistent_map_t *map, zval **buffer, int *size, int *count);
+
+ds_htable_bucket_t *ds_persistent_map_lookup(ds_persistent_map_t *map, zval *key);
+
+zval *ds_persistent_map_get(ds_persistent_map_t *map, zval *key, zval *def);
+bool  ds_persistent_map_has_key(ds_persistent_map_t *map, zval *key);
+
+/**
+ * These change the map in place, copying only the nodes that are shared
+ * with another version. Use a clone to create a new version.
+ */
+void ds_persistent_map_put(ds_persistent_map_t *map, zval *key, zval *value);
+void ds_persistent_map_put_all(ds_persistent_map_t *map, zval *values);
+int  ds_persistent_map_remove(ds_persistent_map_t *map, zval *key, zval *return_value);
+
+void ds_persistent_map_cursor_rewind(ds_persistent_map_cursor_t *cursor, ds_persistent_map_t *map);
+ds_htable_bucket_t *ds_persistent_map_cursor_next(ds_persistent_map_cursor_t *cursor);
+
+void ds_persistent_map_to_array(ds_persistent_map_t *map, zval *return_value);
+
+#endif
@@ -0,0 +1,421 @@
+#include "../common.h"
+#include "ds_persistent_vector.h"
+
+#define BITS  DS_PERSISTENT_VECTOR_BITS
+#define WIDTH DS_PERSISTENT_VECTOR_WIDTH
+#define MASK  DS_PERSISTENT_VECTOR_MASK
+
+static inline bool index_out_of_range(zend_long index, zend_long max)
+{
+    if (index < 0 || index >= max) {
+        INDEX_OUT_OF_RANGE(index, max);
+        return true;
+    }
+    return false;
+}
+
+static ds_persistent_vector_node_t *node_allocate()
+{
+    // Zeroed memory is NULL for children and undef for values.
+    ds_persistent_vector_node_t *node = ecalloc(1, sizeof(ds_persistent_vector_node_t));
+    node->refs = 1;
+    return node;
+}
+
+/**
+ * Removes an owner from a node, freeing it and releasing its children or
+ * values if it was the last one. A level of 0 indicates a leaf.
+ */
+static void node_release(ds_persistent_vector_node_t *node, uint32_t level)
+{
+    uint32_t index;
+
+    if ( ! node || --node->refs > 0) {
+        return;
+    }
+
+    if (level == 0) {
+        for (index = 0; index < WIDTH; index++) {
+            zval_ptr_dtor(&node->u.values[index]);
+        }
+    } else {
+        for (index = 0; index < WIDTH; index++) {
+            node_release(node->u.children[index], level - BITS);
+        }
+    }
+
+    efree(node);
+}
+
+static ds_persistent_vector_node_t *node_copy(ds_persistent_vector_node_t *node, uint32_t level)
+{
+    ds_persistent_vector_node_t *copy = node_allocate();
+    uint32_t index;
+
+    if (level == 0) {
+        COPY_ZVAL_BUFFER(copy->u.values, node->u.values, WIDTH);
+    } else {
+        for (index = 0; index < WIDTH; index++) {
+            ds_persistent_vector_node_t *child = node->u.children[index];
+
+            if (child) {
+                child->refs++;
+            }
+
+            copy->u.children[index] = child;
+        }
+    }
+
+    return copy;
+}
+
+/**
+ * Returns the node in the given slot, after replacing it with a copy if it's
+ * shared with another version. The copy shares the children of the original.
+ */
+static ds_persistent_vector_node_t *node_editable(ds_persistent_vector_node_t **slot, uint32_t level)
+{
+    ds_persistent_vector_node_t *node = *slot;
+
+    if (node->refs > 1) {
+        node->refs--;
+        node  = node_copy(node, level);
+        *slot = node;
+    }
+
+    return node;
+}
+
+/**
+ * Creates a chain of single-child nodes from the given level down to a leaf.
+ */
+static ds_persistent_vector_node_t *node_path(uint32_t level, ds_persistent_vector_node_t *leaf)
+{
+    ds_persistent_vector_node_t *path;
+
+    if (level == 0) {
+        return leaf;
+    }
+
+    path = node_allocate();
+    path->u.children[0] = node_path(level - BITS, leaf);
+    return path;
+}
+
+static ds_persistent_vector_node_t *trie_leaf(ds_persistent_vector_t *vector, zend_long index)
+{
+    ds_persistent_vector_node_t *node = vector->root;
+    uint32_t level;
+
+    for (level = vector->shift; level > 0; level -= BITS) {
+        node = node->u.children[(index >> level) & MASK];
+    }
+
+    return node;
+}
+
+/**
+ * Moves a full tail into the trie, where 'size' includes the tail's values.
+ */
+static void trie_push_leaf(
+    ds_persistent_vector_node_t **slot,
+    uint32_t                      level,
+    zend_long                     size,
+    ds_persistent_vector_node_t  *leaf
+) {
+    ds_persistent_vector_node_t  *parent = node_editable(slot, level);
+    ds_persistent_vector_node_t **child  = &parent->u.children[((size - 1) >> level) & MASK];
+
+    if (level == BITS) {
+        *child = leaf;
+
+    } else if (*child) {
+        trie_push_leaf(child, level - BITS, size, leaf);
+
+    } else {
+        *child = node_path(level - BITS, leaf);
+    }
+}
+
+/**
+ * Removes the last leaf from the trie, where 'size' includes that leaf's
+ * values. Returns true if the node in the slot became empty and was released.
+ */
+static bool trie_pop_leaf(ds_persistent_vector_node_t **slot, uint32_t level, zend_long size)
+{
+    uint32_t index = ((size - 1) >> level) & MASK;
+
+    ds_persistent_vector_node_t  *parent = node_editable(slot, level);
+    ds_persistent_vector_node_t **child  = &parent->u.children[index];
+
+    if (level > BITS) {
+        if ( ! trie_pop_leaf(child, level - BITS, size)) {
+            return false;
+        }
+    } else {
+        node_release(*child, 0);
+        *child = NULL;
+    }
+
+    // The leaf was the only thing left in this node.
+    if (index == 0) {
+        node_release(parent, level);
+        *slot = NULL;
+        return true;
+    }
+
+    return false;
+}
+
+ds_persistent_vector_t *ds_persistent_vector()
+{
+    ds_persistent_vector_t *vector = ecalloc(1, sizeof(ds_persistent_vector_t));
+    vector->shift = BITS;
+    return vector;
+}
+
+ds_persistent_vector_t *ds_persistent_vector_clone(ds_persistent_vector_t *vector)
+{
+    ds_persistent_vector_t *clone = ecalloc(1, sizeof(ds_persistent_vector_t));
+
+    *clone = *vector;
+
+    if (clone->root) {
+        clone->root->refs++;
+    }
+
+    if (clone->tail) {
+        clone->tail->refs++;
+    }
+
+    return clone;
+}
+
+void ds_persistent_vector_free(ds_persistent_vector_t *vector)
+{
+    node_release(vector->root, vector->shift);
+    node_release(vector->tail, 0);
+    efree(vector);
+}
+
+static void node_gather(ds_persistent_vector_node_t *node, uint32_t level, zval **buffer, int *size, int *count)
+{
+    uint32_t index;
+
+    if ( ! node || node->refs > 1) {
+        return;
+    }
+
+    if (level > 0) {
+        for (index = 0; index < WIDTH; index++) {
+            node_gather(node->u.children[index], level - BITS, buffer, size, count);
+        }
+        return;
+    }
+
+    if (*size - *count < WIDTH) {
+        *size   = MAX(*size * 2, *count + WIDTH);
+        *buffer = safe_erealloc(*buffer, *size, sizeof(zval), 0);
+    }
+
+    // Unused values of the tail are undefined.
+    memcpy(*buffer + *count, node->u.values, WIDTH * sizeof(zval));
+    *count += WIDTH;
+}
+
+void ds_persistent_vector_gather(ds_persistent_vector_t *vector, zval **buffer, int *size, int *count)
+{
+    node_gather(vector->root, vector->shift, buffer, size, count);
+    node_gather(vector->tail, 0, buffer, size, count);
+}
+
+ds_persistent_vector_node_t *ds_persistent_vector_leaf(ds_persistent_vector_t *vector, zend_long index)
+{
+    if (index >= DS_PERSISTENT_VECTOR_TAIL_OFFSET(vector)) {
+        return vector->tail;
+    }
+
+    return trie_leaf(vector, index);
+}
+
+zval *ds_persistent_vector_get(ds_persistent_vector_t *vector, zend_long index)
+{
+    if (index_out_of_range(index, vector->size)) {
+        return NULL;
+    }
+
+    return &ds_persistent_vector_leaf(vector, index)->u.values[index & MASK];
+}
+
+bool ds_persistent_vector_isset(ds_persistent_vector_t *vector, zend_long index, int check_empty)
+{
+    if (index < 0 || index >= vector->size) {
+        return 0;
+    }
+
+    return ds_zval_isset(&ds_persistent_vector_leaf(vector, index)->u.values[index & MASK], check_empty);
+}
+
+void ds_persistent_vector_push(ds_persistent_vector_t *vector, zval *value)
+{
+    zend_long offset = vector->size - DS_PERSISTENT_VECTOR_TAIL_OFFSET(vector);
+
+    if (vector->tail == NULL) {
+        vector->tail = node_allocate();
+
+    } else if (offset == WIDTH) {
+
+        // The tail is full, so it becomes the last leaf of the trie.
+        if (vector->root == NULL) {
+            vector->root = node_allocate();
+            vector->root->u.children[0] = vector->tail;
+
+        // The root is full, so add a level above it.
+        } else if ((vector->size >> BITS) > ((zend_long) 1 << vector->shift)) {
+            ds_persistent_vector_node_t *root = node_allocate();
+
+            root->u.children[0] = vector->root;
+            root->u.children[1] = node_path(vector->shift, vector->tail);
+
+            vector->root   = root;
+            vector->shift += BITS;
+
+        } else {
+            trie_push_leaf(&vector->root, vector->shift, vector->size, vector->tail);
+        }
+
+        vector->tail = node_allocate();
+        offset = 0;
+
+    } else {
+        node_editable(&vector->tail, 0);
+    }
+
+    ZVAL_COPY(&vector->tail->u.values[offset], value);
+    vector->size++;
+}
+
+static int iterator_add(zend_object_iterator *iterator, void *puser)
+{
+    ds_persistent_vector_push((ds_persistent_vector_t *) puser, iterator->funcs->get_current_data(iterator));
+    return ZEND_HASH_APPLY_KEEP;
+}
+
+void ds_persistent_vector_push_all(ds_persistent_vector_t *vector, zval *values)
+{
+    if ( ! values) {
+        return;
+    }
+
+    if (ds_is_array(values)) {
+        zval *value;
+
+        ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(values), value) {
+            ds_persistent_vector_push(vector, value);
+        }
+        ZEND_HASH_FOREACH_END();
+        return;
+    }
+
+    if (ds_is_traversable(values)) {
+        spl_iterator_apply(values, iterator_add, (void *) vector);
+        return;
+    }
+
+    ARRAY_OR_TRAVERSABLE_REQUIRED();
+}
+
+void ds_persistent_vector_set(ds_persistent_vector_t *vector, zend_long index, zval *value)
+{
+    ds_persistent_vector_node_t **slot;
+    zval *current;
+
+    if (index_out_of_range(index, vector->size)) {
+        return;
+    }
+
+    if (index >= DS_PERSISTENT_VECTOR_TAIL_OFFSET(vector)) {
+        slot = &vector->tail;
+
+    } else {
+        uint32_t level;
+
+        // Copy each shared node along the path to the leaf.
+        slot = &vector->root;
+
+        for (level = vector->shift; level > 0; level -= BITS) {
+            slot = &node_editable(slot, level)->u.children[(index >> level) & MASK];
+        }
+    }
+
+    current = &node_editable(slot, 0)->u.values[index & MASK];
+
+    zval_ptr_dtor(current);
+    ZVAL_COPY(current, value);
+}
+
+void ds_persistent_vector_pop(ds_persistent_vector_t *vector, zval *return_value)
+{
+    zend_long offset = vector->size - DS_PERSISTENT_VECTOR_TAIL_OFFSET(vector);
+
+    if (vector->size == 0) {
+        NOT_ALLOWED_WHEN_EMPTY();
+        return;
+    }
+
+    SET_AS_RETURN_AND_UNDEF(&node_editable(&vector->tail, 0)->u.values[offset - 1]);
+    vector->size--;
+
+    if (offset > 1) {
+        return;
+    }
+
+    // The tail is now empty, so the last leaf of the trie takes its place.
+    node_release(vector->tail, 0);
+    vector->tail = NULL;
+
+    if (vector->size == 0) {
+        return;
+    }
+
+    vector->tail = trie_leaf(vector, vector->size - 1);
+    vector->tail->refs++;
+
+    trie_pop_leaf(&vector->root, vector->shift, vector->size);
+
+    // Remove a level if the root only has one child left.
+    if (vector->root && vector->shift > BITS && vector->root->u.children[1] == NULL) {
+        ds_persistent_vector_node_t *root = vector->root->u.children[0];
+
+        root->refs++;
+        node_release(vector->root, vector->shift);
+
+        vector->root   = root;
+        vector->shift -= BITS;
+    }
+
+    if (vector->root == NULL) {
+        vector->shift = BITS;
+    }
+}
+
+void ds_persistent_vector_to_array(ds_persistent_vector_t *vector, zval *return_value)
+{
+    if (vector->size == 0) {
+        array_init(return_value);
+
+    } else {
+        zval *value;
+
+        array_init_size(return_value, vector->size);
+        zend_hash_real_init(Z_ARRVAL_P(return_value), 1);
+
+        ZEND_HASH_FILL_PACKED(Z_ARRVAL_P(return_value)) {
+            DS_PERSISTENT_VECTOR_FOREACH(vector, value) {
+                Z_TRY_ADDREF_P(value);
+                ZEND_HASH_FILL_ADD(value);
+            }
+            DS_PERSISTENT_VECTOR_FOREACH_END();
+        } ZEND_HASH_FILL_END();
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef DS_PERSISTENT_VECTOR_H
+#define DS_PERSISTENT_VECTOR_H
+
+#include "../common.h"
+
+/**
+ * A persistent vector is a 32-ary trie of values with a separate tail leaf
+ * for the last (up to) 32 values. Nodes are reference counted and shared
+ * between versions, so that a change only copies the nodes along the path
+ * to the value that changed, ie. log32(n) nodes.
+ */
+#define DS_PERSISTENT_VECTOR_BITS   5
+#define DS_PERSISTENT_VECTOR_WIDTH  (1 << DS_PERSISTENT_VECTOR_BITS)
+#define DS_PERSISTENT_VECTOR_MASK   (DS_PERSISTENT_VECTOR_WIDTH - 1)
+
+#define DS_PERSISTENT_VECTOR_SIZE(v)     ((v)->size)
+#define DS_PERSISTENT_VECTOR_IS_EMPTY(v) (DS_PERSISTENT_VECTOR_SIZE(v) == 0)
+
+/**
+ * Index of the first value in the tail.
+ */
+#define DS_PERSISTENT_VECTOR_TAIL_OFFSET(v) \
+    ((v)->size < DS_PERSISTENT_VECTOR_WIDTH \
+        ? 0 \
+        : (((v)->size - 1) >> DS_PERSISTENT_VECTOR_BITS) << DS_PERSISTENT_VECTOR_BITS)
+
+/**
+ * Foreach value, looking up each leaf only once.
+ */
+#define DS_PERSISTENT_VECTOR_FOREACH(v, z)                          \
+do {                                                                \
+    ds_persistent_vector_t      *_v = v;                            \
+    ds_persistent_vector_node_t *_leaf = NULL;                      \
+    zend_long _i;                                                   \
+    for (_i = 0; _i < _v->size; ++_i) {                             \
+        if ((_i & DS_PERSISTENT_VECTOR_MASK) == 0) {                \
+            _leaf = ds_persistent_vector_leaf(_v, _i);              \
+        }                                                           \
+        z = &_leaf->u.values[_i & DS_PERSISTENT_VECTOR_MASK];
+
+#define DS_PERSISTENT_VECTOR_FOREACH_END() \
+    } \
+} while (0)
+
+typedef struct ds_persistent_vector_node ds_persistent_vector_node_t;
+
+struct ds_persistent_vector_node {
+    uint32_t refs;  // Number of parents and vectors that share this node
+    union {
+        ds_persistent_vector_node_t *children[DS_PERSISTENT_VECTOR_WIDTH];
+        zval                         values[DS_PERSISTENT_VECTOR_WIDTH];
+    } u;
+};
+
+typedef struct ds_persistent_vector {
+    ds_persistent_vector_node_t *root;   // Trie of full leaves, or NULL
+    ds_persistent_vector_node_t *tail;   // Leaf of the last values, or NULL
+    zend_long                    size;   // Number of values
+    uint32_t                     shift;  // Bits to shift for the root level
+} ds_persistent_vector_t;
+
+ds_persistent_vector_t *ds_persistent_vector();
+
+/**
+ * Creates a new version that shares all of its nodes with the given vector.
+ */
+ds_persistent_vector_t *ds_persistent_vector_clone(ds_persistent_vector_t *vector);
+
+void ds_persistent_vector_free(ds_persistent_vector_t *vector);
+
+/**
+ * Appends the values that only this version holds to a buffer for the GC,
+ * growing the buffer as needed. Those are the values of the leaves that are
+ * reached without passing a node that is shared with another version, which
+ * would otherwise be counted once for every version.
+ */
+void ds_persistent_vector_gather(ds_persistent_vector_t *vector, zval **buffer, int *size, int *count);
+
+/**
+ * Returns the leaf that holds the value at the given index, which must be
+ * within range.
+ */
+ds_persistent_vector_node_t *ds_persistent_vector_leaf(ds_persistent_vector_t *vector, zend_long index);
+
+zval *ds_persistent_vector_get(ds_persistent_vector_t *vector, zend_long index);
+bool  ds_persistent_vector_isset(ds_persistent_vector_t *vector, zend_long index, int check_empty);
+
+/**
+ * These change the vector in place, copying only the nodes that are shared
+ * with another version. Use a clone to create a new version.
+ */
+void ds_persistent_vector_push(ds_persistent_vector_t *vector, zval *value);
+void ds_persistent_vector_push_all(ds_persistent_vector_t *vector, zval *values);
+void ds_persistent_vector_set(ds_persistent_vector_t *vector, zend_long index, zval *value);
+void ds_persistent_vector_pop(ds_persistent_vector_t *vector, zval *return_value);
+
+void ds_persistent_vector_to_array(ds_persistent_vector_t *vector, zval *return_value);
+
+#endif
@@ -67,6 +67,7 @@ void ds_priority_queue_allocate(ds_priority_queue_t *queue, uint32_t capacity)
     capacity = ds_priority_queue_get_capacity_for_size(capacity);
 
     if (capacity > queue->capacity) {
+        ds_priority_queue_separate(queue);
         reallocate_to_capacity(queue, capacity);
     }
 }
@@ -83,6 +84,16 @@ ds_priority_queue_t *ds_priority_queue()
     return queue;
 }
 
+void ds_priority_queue_shrink_to_fit(ds_priority_queue_t *queue)
+{
+    uint32_t capacity = ds_priority_queue_get_capacity_for_size(queue->size);
+
+    if (capacity < queue->capacity) {
+        ds_priority_queue_separate(queue);
+        reallocate_to_capacity(queue, capacity);
+    }
+}
+
 uint32_t ds_priority_queue_capacity(ds_priority_queue_t *queue)
 {
     return queue->capacity;
@@ -98,6 +109,8 @@ void ds_priority_queue_push(ds_priority_queue_t *queue, zval *value, zval *prior
     ds_priority_queue_node_t *nodes;
     ds_priority_queue_node_t *node;
 
+    ds_priority_queue_separate(queue);
+
     if (queue->size == queue->capacity) {
         increase_capacity(queue);
     }
@@ -136,7 +149,7 @@ void ds_priority_queue_push(ds_priority_queue_t *queue, zval *value, zval *prior
 
 static inline void ds_priority_queue_compact(ds_priority_queue_t *queue)
 {
-    if (queue->size <= (queue->capacity / 4) && (queue->capacity / 2) >= DS_PRIORITY_QUEUE_MIN_CAPACITY) {
+    if (DS_SHOULD_SHRINK(queue->size, queue->capacity) && (queue->capacity / 2) >= DS_PRIORITY_QUEUE_MIN_CAPACITY) {
         reallocate_to_capacity(queue, queue->capacity / 2);
     }
 }
@@ -147,7 +160,7 @@ void ds_priority_queue_pop(ds_priority_queue_t *queue, zval *return_value)
     uint32_t swap;
 
     ds_priority_queue_node_t bottom;
-    ds_priority_queue_node_t *nodes = queue->nodes;
+    ds_priority_queue_node_t *nodes;
 
     const uint32_t size = queue->size;
     const uint32_t half = (size - 1) / 2;
@@ -159,6 +172,9 @@ void ds_priority_queue_pop(ds_priority_queue_t *queue, zval *return_value)
         return;
     }
 
+    ds_priority_queue_separate(queue);
+    nodes = queue->nodes;
+
     // Return the root if a return value was requested.
     if (return_value) {
         ZVAL_COPY(return_value, &(nodes[0].value));
@@ -215,14 +231,24 @@ ds_priority_queue_t *ds_priority_queue_clone(ds_priority_queue_t * queue)
 {
     ds_priority_queue_t *clone = ecalloc(1, sizeof(ds_priority_queue_t));
 
-    clone->nodes    = copy_nodes(queue);
+    // Share the nodes until either queue is changed.
+    clone->nodes    = queue->nodes;
     clone->capacity = queue->capacity;
     clone->size     = queue->size;
     clone->next     = queue->next;
+    // A node is a value and a priority.
+    clone->refs     = ds_share_buffer(&queue->refs, (zval *) queue->nodes, queue->size * 2);
 
     return clone;
 }
 
+void ds_priority_queue_separate(ds_priority_queue_t *queue)
+{
+    if (ds_unshare_buffer(&queue->refs)) {
+        queue->nodes = copy_nodes(queue);
+    }
+}
+
 zval *ds_priority_queue_peek(ds_priority_queue_t *queue)
 {
     if (queue->size == 0) {
@@ -274,11 +300,53 @@ void ds_priority_queue_to_array(ds_priority_queue_t *queue, zval *array)
     }
 }
 
+bool ds_priority_queue_equals(ds_priority_queue_t *queue, ds_priority_queue_t *other)
+{
+    ds_priority_queue_node_t *a, *b, *x, *y, *end;
+
+    bool equal = true;
+
+    if (queue->size != other->size) {
+        return false;
+    }
+
+    // Shared nodes are always equal.
+    if (queue->nodes == other->nodes || queue->size == 0) {
+        return true;
+    }
+
+    // Values with the same priority are compared in insertion order.
+    a = ds_priority_queue_create_sorted_buffer(queue);
+    b = ds_priority_queue_create_sorted_buffer(other);
+
+    for (x = a, y = b, end = a + queue->size; x < end; ++x, ++y) {
+        if ( ! fast_equal_check_function(&x->priority, &y->priority) ||
+             ! fast_equal_check_function(&x->value, &y->value) ||
+             EG(exception)) {
+            equal = false;
+            break;
+        }
+    }
+
+    efree(a);
+    efree(b);
+
+    return equal;
+}
+
 void ds_priority_queue_clear(ds_priority_queue_t *queue)
 {
     ds_priority_queue_node_t *pos = queue->nodes;
     ds_priority_queue_node_t *end = queue->nodes + queue->size;
 
+    // There's no need to copy shared nodes only to clear them.
+    if (ds_unshare_buffer(&queue->refs)) {
+        queue->nodes    = allocate_nodes(DS_PRIORITY_QUEUE_MIN_CAPACITY);
+        queue->capacity = DS_PRIORITY_QUEUE_MIN_CAPACITY;
+        queue->size     = 0;
+        return;
+    }
+
     for (; pos < end; ++pos) {
         DTOR_AND_UNDEF(&pos->value);
         DTOR_AND_UNDEF(&pos->priority);
@@ -291,7 +359,11 @@ void ds_priority_queue_clear(ds_priority_queue_t *queue)
 
 void ds_priority_queue_free(ds_priority_queue_t *queue)
 {
-    ds_priority_queue_clear(queue);
-    efree(queue->nodes);
+    // Leave shared nodes to their other owners.
+    if ( ! ds_unshare_buffer(&queue->refs)) {
+        ds_priority_queue_clear(queue);
+        efree(queue->nodes);
+    }
+
     efree(queue);
 }
@@ -13,6 +13,7 @@ typedef struct _ds_priority_queue_t {
     uint32_t                    capacity;
     uint32_t                    size;
     uint32_t                    next;
+    uint32_t                   *refs;   // Owners of shared nodes, or NULL
 } ds_priority_queue_t;
 
 #define DS_PRIORITY_QUEUE_MIN_CAPACITY 8
@@ -57,6 +58,9 @@ DS_PRIORITY_QUEUE_FOREACH_NODE(queue, __node)                           \
 ds_priority_queue_t *ds_priority_queue();
 
 void ds_priority_queue_allocate(ds_priority_queue_t *queue, uint32_t capacity);
+void ds_priority_queue_shrink_to_fit(ds_priority_queue_t *queue);
+
+void ds_priority_queue_separate(ds_priority_queue_t *queue);
 
 uint32_t ds_priority_queue_capacity(ds_priority_queue_t *queue);
 
@@ -68,6 +72,8 @@ void ds_priority_queue_push(ds_priority_queue_t *queue, zval *value, zval *prior
 
 void ds_priority_queue_to_array(ds_priority_queue_t *queue, zval *array);
 
+bool ds_priority_queue_equals(ds_priority_queue_t *queue, ds_priority_queue_t *other);
+
 void ds_priority_queue_free(ds_priority_queue_t *queue);
 
 void ds_priority_queue_clear(ds_priority_queue_t *queue);
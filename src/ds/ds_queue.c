@@ -4,60 +4,312 @@
 #include "../php/handlers/php_queue_handlers.h"
 #include "../php/classes/php_queue_ce.h"
 
-#include "ds_deque.h"
 #include "ds_queue.h"
 
-ds_queue_t *ds_queue_ex(ds_deque_t *deque)
+#define BITS DS_QUEUE_BLOCK_BITS
+#define MASK DS_QUEUE_BLOCK_MASK
+
+static inline zval *ds_queue_lookup(ds_queue_t *queue, zend_long position)
 {
-    ds_queue_t *queue = ecalloc(1, sizeof(ds_queue_t));
-    queue->deque = deque;
-    return queue;
+    return &queue->map[queue->first + (position >> BITS)][position & MASK];
+}
+
+/**
+ * Takes an empty block from the pool, or allocates a new one.
+ */
+static zval *ds_queue_take_block(ds_queue_t *queue)
+{
+    if (queue->spare > 0) {
+        return queue->pool[--queue->spare];
+    }
+
+    return emalloc(DS_QUEUE_BLOCK_SIZE * sizeof(zval));
+}
+
+/**
+ * Keeps an empty block in the pool, or frees it if the pool is full.
+ */
+static void ds_queue_release_block(ds_queue_t *queue, zval *block)
+{
+    if (queue->spare < DS_QUEUE_POOL_SIZE) {
+        queue->pool[queue->spare++] = block;
+    } else {
+        efree(block);
+    }
+}
+
+/**
+ * Starts the queue again with an empty map that has one block.
+ */
+static void ds_queue_reset(ds_queue_t *queue)
+{
+    queue->map      = emalloc(DS_QUEUE_MIN_MAP * sizeof(zval *));
+    queue->map_size = DS_QUEUE_MIN_MAP;
+    queue->map[0]   = ds_queue_take_block(queue);
+    queue->first    = 0;
+    queue->blocks   = 1;
+    queue->head     = 0;
+    queue->size     = 0;
+    queue->capacity = DS_QUEUE_MIN_CAPACITY;
+}
+
+/**
+ * Destructs all values and frees the blocks in use and the map.
+ */
+static void ds_queue_free_blocks(ds_queue_t *queue)
+{
+    zend_long index;
+    zval *value;
+
+    DS_QUEUE_FOREACH(queue, value) {
+        zval_ptr_dtor(value);
+    }
+    DS_QUEUE_FOREACH_END();
+
+    for (index = 0; index < queue->blocks; index++) {
+        efree(queue->map[queue->first + index]);
+    }
+
+    efree(queue->map);
+}
+
+/**
+ * Adds a block to the back, making room in the map if it's full. The map
+ * is only doubled if most of it is in use, otherwise the pointers of the
+ * blocks in use are moved back to the start of the map.
+ */
+static void ds_queue_add_block(ds_queue_t *queue)
+{
+    if (queue->first + queue->blocks == queue->map_size) {
+        if (queue->first >= queue->map_size / 2) {
+            memmove(queue->map, queue->map + queue->first, queue->blocks * sizeof(zval *));
+            queue->first = 0;
+
+        } else {
+            queue->map_size *= 2;
+            queue->map = erealloc(queue->map, queue->map_size * sizeof(zval *));
+        }
+    }
+
+    queue->map[queue->first + queue->blocks++] = ds_queue_take_block(queue);
+}
+
+/**
+ * Removes the first block once all of its values have been removed.
+ */
+static void ds_queue_remove_first_block(ds_queue_t *queue)
+{
+    ds_queue_release_block(queue, queue->map[queue->first]);
+
+    queue->first++;
+    queue->blocks--;
+    queue->head = 0;
+
+    // Halve the map following the same policy as the other buffers.
+    if (DS_SHOULD_SHRINK(queue->blocks, queue->map_size) && queue->map_size / 2 >= DS_QUEUE_MIN_MAP) {
+        memmove(queue->map, queue->map + queue->first, queue->blocks * sizeof(zval *));
+
+        queue->first     = 0;
+        queue->map_size /= 2;
+        queue->map       = erealloc(queue->map, queue->map_size * sizeof(zval *));
+    }
+}
+
+static inline zend_long ds_queue_get_capacity_for_size(zend_long size)
+{
+    return (zend_long) ds_next_power_of_2((uint32_t) size, DS_QUEUE_MIN_CAPACITY);
+}
+
+static inline void ds_queue_push_value(ds_queue_t *queue, zval *value)
+{
+    zend_long position = queue->head + queue->size;
+
+    if (position == queue->blocks << BITS) {
+        ds_queue_add_block(queue);
+    }
+
+    if (queue->size == queue->capacity) {
+        queue->capacity <<= 1;
+    }
+
+    ZVAL_COPY(ds_queue_lookup(queue, position), value);
+    queue->size++;
 }
 
 ds_queue_t *ds_queue()
 {
-    return ds_queue_ex(ds_deque());
+    ds_queue_t *queue = ecalloc(1, sizeof(ds_queue_t));
+    ds_queue_reset(queue);
+    return queue;
 }
 
 ds_queue_t *ds_queue_clone(ds_queue_t *queue)
 {
-    return ds_queue_ex(ds_deque_clone(queue->deque));
+    ds_queue_t *clone = ecalloc(1, sizeof(ds_queue_t));
+
+    // Share the map and its blocks until either queue is changed. The pool
+    // is not shared, so the clone starts without one.
+    clone->map      = queue->map;
+    clone->map_size = queue->map_size;
+    clone->first    = queue->first;
+    clone->blocks   = queue->blocks;
+    clone->head     = queue->head;
+    clone->size     = queue->size;
+    clone->capacity = queue->capacity;
+    clone->refs     = ds_share_blocks(&queue->refs, queue->map + queue->first, BITS, queue->head, queue->size);
+
+    return clone;
+}
+
+void ds_queue_separate(ds_queue_t *queue)
+{
+    if (ds_unshare_buffer(&queue->refs)) {
+        zval **map = queue->map;
+        zend_long position;
+        zend_long end = queue->head + queue->size;
+        zend_long index;
+
+        // Keep the same layout so that the head and blocks remain valid.
+        queue->map = emalloc(queue->map_size * sizeof(zval *));
+
+        for (index = 0; index < queue->blocks; index++) {
+            queue->map[queue->first + index] = ds_queue_take_block(queue);
+        }
+
+        for (position = queue->head; position < end; position++) {
+            zval *src = &map[queue->first + (position >> BITS)][position & MASK];
+            ZVAL_COPY(ds_queue_lookup(queue, position), src);
+        }
+    }
 }
 
 void ds_queue_free(ds_queue_t *queue)
 {
-    ds_deque_free(queue->deque);
+    // Leave shared blocks to their other owners.
+    if ( ! ds_unshare_buffer(&queue->refs)) {
+        ds_queue_free_blocks(queue);
+    }
+
+    while (queue->spare > 0) {
+        efree(queue->pool[--queue->spare]);
+    }
+
     efree(queue);
 }
 
 void ds_queue_allocate(ds_queue_t *queue, zend_long capacity)
 {
-    ds_deque_allocate(queue->deque, capacity);
+    zend_long blocks;
+
+    capacity = ds_queue_get_capacity_for_size(capacity);
+
+    if (capacity <= queue->capacity) {
+        return;
+    }
+
+    queue->capacity = capacity;
+
+    // Reserve the blocks up front, which is what the capacity was asked for.
+    blocks = (queue->head + capacity + MASK) >> BITS;
+
+    if (blocks > queue->blocks) {
+        DS_QUEUE_SEPARATE(queue);
+
+        while (queue->blocks < blocks) {
+            ds_queue_add_block(queue);
+        }
+    }
+}
+
+void ds_queue_shrink_to_fit(ds_queue_t *queue)
+{
+    zend_long blocks   = MAX(1, (queue->head + queue->size + MASK) >> BITS);
+    zend_long map_size = MAX(blocks, DS_QUEUE_MIN_MAP);
+
+    queue->capacity = ds_queue_get_capacity_for_size(queue->size);
+
+    if (queue->blocks > blocks || queue->map_size > map_size) {
+        DS_QUEUE_SEPARATE(queue);
+
+        // Free the empty blocks after the last value.
+        while (queue->blocks > blocks) {
+            efree(queue->map[queue->first + --queue->blocks]);
+        }
+
+        if (queue->map_size > map_size) {
+            memmove(queue->map, queue->map + queue->first, queue->blocks * sizeof(zval *));
+
+            queue->first    = 0;
+            queue->map_size = map_size;
+            queue->map      = erealloc(queue->map, map_size * sizeof(zval *));
+        }
+    }
+
+    while (queue->spare > 0) {
+        efree(queue->pool[--queue->spare]);
+    }
 }
 
 zend_long ds_queue_capacity(ds_queue_t *queue)
 {
-    return queue->deque->capacity;
+    return queue->capacity;
 }
 
 void ds_queue_push(ds_queue_t *queue, VA_PARAMS)
 {
-    ds_deque_push_va(queue->deque, argc, argv);
+    DS_QUEUE_SEPARATE(queue);
+
+    while (argc--) {
+        ds_queue_push_value(queue, argv++);
+    }
 }
 
 void ds_queue_push_one(ds_queue_t *queue, zval *value)
 {
-    ds_deque_push(queue->deque, value);
+    DS_QUEUE_SEPARATE(queue);
+    ds_queue_push_value(queue, value);
 }
 
 void ds_queue_clear(ds_queue_t *queue)
 {
-    ds_deque_clear(queue->deque);
+    // There's no need to copy shared blocks only to clear them.
+    if ( ! ds_unshare_buffer(&queue->refs)) {
+        ds_queue_free_blocks(queue);
+    }
+
+    ds_queue_reset(queue);
 }
 
-void ds_queue_push_all(ds_queue_t *queue, zval *value)
+static int iterator_add(zend_object_iterator *iterator, void *puser)
 {
-    ds_deque_push_all(queue->deque, value);
+    ds_queue_push_one((ds_queue_t *) puser, iterator->funcs->get_current_data(iterator));
+    return ZEND_HASH_APPLY_KEEP;
+}
+
+void ds_queue_push_all(ds_queue_t *queue, zval *values)
+{
+    if ( ! values) {
+        return;
+    }
+
+    if (ds_is_array(values)) {
+        zval *value;
+
+        DS_QUEUE_SEPARATE(queue);
+
+        ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(values), value) {
+            ds_queue_push_value(queue, value);
+        }
+        ZEND_HASH_FOREACH_END();
+        return;
+    }
+
+    if (ds_is_traversable(values)) {
+        spl_iterator_apply(values, iterator_add, queue);
+        return;
+    }
+
+    ARRAY_OR_TRAVERSABLE_REQUIRED();
 }
 
 void ds_queue_to_array(ds_queue_t *queue, zval *return_value)
@@ -71,30 +323,81 @@ void ds_queue_to_array(ds_queue_t *queue, zval *return_value)
         zval *value;
         array_init_size(return_value, size);
 
-        DS_DEQUE_FOREACH(queue->deque, value) {
+        DS_QUEUE_FOREACH(queue, value) {
             add_next_index_zval(return_value, value);
             Z_TRY_ADDREF_P(value);
         }
-        DS_DEQUE_FOREACH_END();
+        DS_QUEUE_FOREACH_END();
     }
 }
 
-void ds_queue_pop_throw(ds_queue_t *queue, zval *return_value)
+bool ds_queue_equals(ds_queue_t *queue, ds_queue_t *other)
 {
-    ds_deque_shift_throw(queue->deque, return_value);
+    zend_long position;
+    zval *value;
+
+    if (queue->size != other->size) {
+        return false;
+    }
+
+    position = other->head;
+
+    DS_QUEUE_FOREACH(queue, value) {
+        if ( ! fast_equal_check_function(value, ds_queue_lookup(other, position++)) || EG(exception)) {
+            return false;
+        }
+    }
+    DS_QUEUE_FOREACH_END();
+
+    return true;
 }
 
 void ds_queue_pop(ds_queue_t *queue, zval *return_value)
 {
-    ds_deque_shift(queue->deque, return_value);
+    DS_QUEUE_SEPARATE(queue);
+    SET_AS_RETURN_AND_UNDEF(ds_queue_lookup(queue, queue->head));
+
+    queue->size--;
+    queue->head++;
+
+    if (DS_SHOULD_SHRINK(queue->size, queue->capacity) && queue->capacity / 2 >= DS_QUEUE_MIN_CAPACITY) {
+        queue->capacity >>= 1;
+    }
+
+    if (queue->head == DS_QUEUE_BLOCK_SIZE && queue->blocks > 1) {
+        ds_queue_remove_first_block(queue);
+
+    // Start again at the front of the only block.
+    } else if (queue->size == 0) {
+        queue->head = 0;
+    }
 }
 
-zval *ds_queue_peek_throw(ds_queue_t *queue)
+void ds_queue_pop_throw(ds_queue_t *queue, zval *return_value)
 {
-    return ds_deque_get_first_throw(queue->deque);
+    if (QUEUE_IS_EMPTY(queue)) {
+        NOT_ALLOWED_WHEN_EMPTY();
+        return;
+    }
+
+    ds_queue_pop(queue, return_value);
 }
 
 zval *ds_queue_peek(ds_queue_t *queue)
 {
-    return ds_deque_get_first(queue->deque);
+    if (QUEUE_IS_EMPTY(queue)) {
+        return NULL;
+    }
+
+    return ds_queue_lookup(queue, queue->head);
+}
+
+zval *ds_queue_peek_throw(ds_queue_t *queue)
+{
+    if (QUEUE_IS_EMPTY(queue)) {
+        NOT_ALLOWED_WHEN_EMPTY();
+        return NULL;
+    }
+
+    return ds_queue_lookup(queue, queue->head);
 }
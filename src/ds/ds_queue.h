@@ -2,16 +2,62 @@
 #define DS_QUEUE_H
 
 #include "../common.h"
-#include "ds_deque.h"
 
-#define QUEUE_SIZE(q)     ((q)->deque->size)
-#define QUEUE_IS_EMPTY(q) ((q)->deque->size == 0)
+/**
+ * A queue stores its values in fixed-size blocks, with a map of pointers to
+ * the blocks that are in use. Growing the queue allocates one more block and
+ * never moves a value, so only the map is copied when it runs out of room.
+ * Blocks that are emptied at the front are kept in a small pool to be used
+ * again at the back.
+ */
+#define DS_QUEUE_BLOCK_BITS  6
+#define DS_QUEUE_BLOCK_SIZE  (1 << DS_QUEUE_BLOCK_BITS)
+#define DS_QUEUE_BLOCK_MASK  (DS_QUEUE_BLOCK_SIZE - 1)
 
+#define DS_QUEUE_MIN_CAPACITY 8 // Must be a power of 2
+#define DS_QUEUE_MIN_MAP      8 // Does not have to be a power of 2
+#define DS_QUEUE_POOL_SIZE    4
+
+#define QUEUE_SIZE(q)     ((q)->size)
+#define QUEUE_IS_EMPTY(q) ((q)->size == 0)
+
+/**
+ * Prepares a queue for a change to its values or its blocks, which copies
+ * the blocks if they're shared with another queue.
+ */
+#define DS_QUEUE_SEPARATE(q)        \
+do {                                \
+    ds_queue_t *_sq = q;            \
+    if (_sq->refs) {                \
+        ds_queue_separate(_sq);     \
+    }                               \
+} while (0)
+
+/**
+ * Foreach value from front to back, without removing them.
+ */
+#define DS_QUEUE_FOREACH(q, v)                                              \
+do {                                                                        \
+    const ds_queue_t *_q     = q;                                           \
+    zval           **_blocks = _q->map + _q->first;                         \
+    zend_long        _pos    = _q->head;                                    \
+    zend_long        _end    = _q->head + _q->size;                         \
+                                                                            \
+    for (; _pos < _end; _pos++) {                                           \
+        v = &_blocks[_pos >> DS_QUEUE_BLOCK_BITS][_pos & DS_QUEUE_BLOCK_MASK];
+
+#define DS_QUEUE_FOREACH_END() \
+    } \
+} while (0)
+
+/**
+ * Foreach value, removing each one from the queue.
+ */
 #define QUEUE_FOREACH(queue, value)                 \
 do {                                                \
     zval _tmp;                                      \
-    while ( ! DS_DEQUE_IS_EMPTY(queue->deque)) {    \
-        ds_deque_shift(queue->deque, &_tmp);        \
+    while ( ! QUEUE_IS_EMPTY(queue)) {              \
+        ds_queue_pop(queue, &_tmp);                 \
         value = &_tmp;
 
 #define QUEUE_FOREACH_END()     \
@@ -20,14 +66,30 @@ do {                                                \
 } while (0)                     \
 
 typedef struct _ds_queue_t {
-    ds_deque_t    *deque;
+    zval        **map;                      // Blocks in use, starting at 'first'
+    zend_long     map_size;                 // Length of the map
+    zend_long     first;                    // Map index of the first block
+    zend_long     blocks;                   // Number of blocks in use
+    zend_long     head;                     // Offset of the first value in the first block
+    zend_long     size;                     // Number of values
+    zend_long     capacity;                 // Capacity as reported by capacity()
+    zval         *pool[DS_QUEUE_POOL_SIZE]; // Empty blocks to use again
+    int           spare;                    // Number of blocks in the pool
+    uint32_t     *refs;                     // Owners of shared blocks, or NULL if not shared
 } ds_queue_t;
 
-ds_queue_t *ds_queue_ex(ds_deque_t *deque);
 ds_queue_t *ds_queue();
 ds_queue_t *ds_queue_clone(ds_queue_t *queue);
 
+void ds_queue_separate(ds_queue_t *queue);
 void ds_queue_allocate(ds_queue_t *queue, zend_long capacity);
+void ds_queue_shrink_to_fit(ds_queue_t *queue);
+/**
+ * The capacity of a queue is kept as it was when the values were in a single
+ * ring buffer: a power of 2 that is doubled when a value is pushed to a full
+ * queue and halved as values are removed, following the shrink threshold.
+ * It's independent of the blocks, which are only allocated when needed.
+ */
 zend_long ds_queue_capacity(ds_queue_t *queue);
 
 void  ds_queue_push(ds_queue_t *queue, VA_PARAMS);
@@ -39,6 +101,7 @@ zval *ds_queue_peek(ds_queue_t *queue);
 zval *ds_queue_peek_throw(ds_queue_t *queue);
 void  ds_queue_push_all(ds_queue_t *queue, zval *value);
 void  ds_queue_to_array(ds_queue_t *queue, zval *return_value);
+bool  ds_queue_equals(ds_queue_t *queue, ds_queue_t *other);
 void  ds_queue_free(ds_queue_t *queue);
 
 int ds_queue_serialize(zval *object, unsigned char **buffer, size_t *length, zend_serialize_data *data);
@@ -29,6 +29,11 @@ void ds_set_allocate(ds_set_t *set, zend_long capacity)
     ds_htable_ensure_capacity(set->table, capacity);
 }
 
+void ds_set_shrink_to_fit(ds_set_t *set)
+{
+    ds_htable_shrink_to_fit(set->table);
+}
+
 void ds_set_sort_callback(ds_set_t *set)
 {
     ds_htable_sort_callback_by_key(set->table);
@@ -114,6 +119,18 @@ bool ds_set_contains_va(ds_set_t *set, VA_PARAMS)
     return ds_htable_has_keys(set->table, argc, argv);
 }
 
+bool ds_set_contains_all(ds_set_t *set, zval *values)
+{
+    return ds_htable_has_all(set->table, values);
+}
+
+ds_set_t *ds_set_filter_contained(ds_set_t *set, zval *values)
+{
+    ds_htable_t *table = ds_htable_intersect_iterable(set->table, values);
+
+    return table ? ds_set_ex(table) : NULL;
+}
+
 static inline void ds_set_remove(ds_set_t *set, zval *value)
 {
     ds_htable_remove(set->table, value, NULL);
@@ -195,6 +212,10 @@ ds_set_t *ds_set_intersect(ds_set_t *set, ds_set_t *other)
 void ds_set_assign_intersect(ds_set_t *set, ds_set_t *other)
 {
     zval *value;
+
+    // Separate up front, because we're removing values as we iterate.
+    ds_htable_separate(set->table);
+
     DS_SET_FOREACH(set, value) {
         if ( ! ds_set_contains(other, value)) {
             ds_set_remove(set, value);
@@ -214,6 +235,9 @@ void ds_set_assign_xor(ds_set_t *set, ds_set_t *other)
 {
     zval *value;
 
+    // Separate up front, because we're removing values as we iterate.
+    ds_htable_separate(set->table);
+
     DS_SET_FOREACH(set, value) {
         if (ds_set_contains(other, value)) {
             ds_set_remove(set, value);
@@ -326,6 +350,16 @@ ds_set_t * ds_set_map(ds_set_t *set, FCI_PARAMS)
     }
 }
 
+void ds_set_apply(ds_set_t *set, FCI_PARAMS)
+{
+    ds_htable_apply_keys(set->table, FCI_ARGS);
+}
+
+void ds_set_retain(ds_set_t *set, FCI_PARAMS)
+{
+    ds_htable_retain_keys(set->table, FCI_ARGS);
+}
+
 ds_set_t *ds_set_filter_callback(ds_set_t *set, FCI_PARAMS)
 {
     ds_set_t *result = ds_set();
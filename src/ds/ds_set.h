@@ -22,11 +22,19 @@ ds_set_t *ds_set_clone(ds_set_t *set);
 void ds_set_free(ds_set_t *set);
 void ds_set_clear(ds_set_t *set);
 void ds_set_allocate(ds_set_t *set, zend_long capacity);
+void ds_set_shrink_to_fit(ds_set_t *set);
 
 void ds_set_add(ds_set_t *set, zval *value);
 void ds_set_add_va(ds_set_t *set, VA_PARAMS);
 bool ds_set_contains_va(ds_set_t *set, VA_PARAMS);
 bool ds_set_contains(ds_set_t *set, zval *value);
+
+/**
+ * Batched versions of contains for many values at once, which are given as
+ * an array or traversable object.
+ */
+bool ds_set_contains_all(ds_set_t *set, zval *values);
+ds_set_t *ds_set_filter_contained(ds_set_t *set, zval *values);
 void ds_set_remove_va(ds_set_t *set, VA_PARAMS);
 
 void ds_set_to_array(ds_set_t *set, zval *arr);
@@ -51,6 +59,9 @@ ds_set_t *ds_set_map(ds_set_t *set, FCI_PARAMS);
 ds_set_t *ds_set_filter_callback(ds_set_t *set, FCI_PARAMS);
 ds_set_t *ds_set_filter(ds_set_t *set);
 
+void ds_set_apply(ds_set_t *set, FCI_PARAMS);
+void ds_set_retain(ds_set_t *set, FCI_PARAMS);
+
 void ds_set_reverse (ds_set_t *set);
 ds_set_t *ds_set_reversed(ds_set_t *set);
 
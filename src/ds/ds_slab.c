@@ -0,0 +1,66 @@
+#include "ds_slab.h"
+
+/**
+ * Each block starts with a header that links it to the previous block,
+ * followed by its structs. Freed structs store the next free struct in
+ * their first bytes, so a struct has to be at least as large as a pointer.
+ */
+#define DS_SLAB_HEADER_SIZE ZEND_MM_ALIGNED_SIZE(sizeof(ds_slab_block_t))
+
+void ds_slab_init(ds_slab_t *slab, size_t size)
+{
+    slab->size   = ZEND_MM_ALIGNED_SIZE(MAX(size, sizeof(void *)));
+    slab->free   = NULL;
+    slab->next   = NULL;
+    slab->end    = NULL;
+    slab->blocks = NULL;
+}
+
+static void ds_slab_add_block(ds_slab_t *slab)
+{
+    ds_slab_block_t *block = emalloc(DS_SLAB_HEADER_SIZE + slab->size * DS_SLAB_BLOCK_LENGTH);
+
+    block->next  = slab->blocks;
+    slab->blocks = block;
+    slab->next   = ((char *) block) + DS_SLAB_HEADER_SIZE;
+    slab->end    = slab->next + slab->size * DS_SLAB_BLOCK_LENGTH;
+}
+
+void *ds_slab_alloc(ds_slab_t *slab)
+{
+    void *ptr;
+
+    // Use a freed struct first.
+    if (slab->free) {
+        ptr        = slab->free;
+        slab->free = *((void **) ptr);
+        return ptr;
+    }
+
+    if (slab->next == slab->end) {
+        ds_slab_add_block(slab);
+    }
+
+    ptr         = slab->next;
+    slab->next += slab->size;
+    return ptr;
+}
+
+void ds_slab_free(ds_slab_t *slab, void *ptr)
+{
+    *((void **) ptr) = slab->free;
+    slab->free       = ptr;
+}
+
+void ds_slab_destroy(ds_slab_t *slab)
+{
+    ds_slab_block_t *block = slab->blocks;
+
+    while (block) {
+        ds_slab_block_t *next = block->next;
+        efree(block);
+        block = next;
+    }
+
+    ds_slab_init(slab, slab->size);
+}
@@ -0,0 +1,32 @@
+#ifndef DS_SLAB_H
+#define DS_SLAB_H
+
+#include "php.h"
+
+/**
+ * A slab allocates small structs of a fixed size in blocks, and recycles
+ * them through a free list when they're freed. This avoids an allocation
+ * for every struct when many of them are created at once, eg. one pair for
+ * every entry of a map. Blocks are only released when the slab is destroyed
+ * at the end of the request.
+ */
+#define DS_SLAB_BLOCK_LENGTH 256 // Number of structs in each block
+
+typedef struct _ds_slab_block_t {
+    struct _ds_slab_block_t *next;
+} ds_slab_block_t;
+
+typedef struct _ds_slab_t {
+    size_t           size;      // Size of each struct
+    void            *free;      // Head of the list of freed structs
+    char            *next;      // Next unused struct of the current block
+    char            *end;       // End of the current block
+    ds_slab_block_t *blocks;    // Blocks in use, the current block first
+} ds_slab_t;
+
+void  ds_slab_init(ds_slab_t *slab, size_t size);
+void *ds_slab_alloc(ds_slab_t *slab);
+void  ds_slab_free(ds_slab_t *slab, void *ptr);
+void  ds_slab_destroy(ds_slab_t *slab);
+
+#endif
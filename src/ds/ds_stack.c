@@ -34,6 +34,11 @@ void ds_stack_allocate(ds_stack_t *stack, zend_long capacity)
     ds_vector_allocate(stack->vector, capacity);
 }
 
+void ds_stack_shrink_to_fit(ds_stack_t *stack)
+{
+    ds_vector_shrink_to_fit(stack->vector);
+}
+
 void ds_stack_push_va(ds_stack_t *stack, VA_PARAMS)
 {
     ds_vector_push_va(stack->vector, argc, argv);
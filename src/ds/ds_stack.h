@@ -13,6 +13,7 @@ do {                                                \
     zval _tmp;                                      \
                                                     \
     ds_vector_t *_v = stack->vector;                     \
+    DS_VECTOR_SEPARATE(_v);                         \
     zval *_end = _v->buffer;                        \
     zval *_pos = _end + _v->size - 1;               \
                                                     \
@@ -37,6 +38,7 @@ ds_stack_t *ds_stack_clone(ds_stack_t *stack);
 void  ds_stack_push(ds_stack_t *stack, zval *value);
 void  ds_stack_push_va(ds_stack_t *stack, VA_PARAMS);
 void  ds_stack_allocate(ds_stack_t *stack, zend_long capacity);
+void  ds_stack_shrink_to_fit(ds_stack_t *stack);
 void  ds_stack_clear(ds_stack_t *stack);
 void  ds_stack_pop(ds_stack_t *stack, zval *return_value);
 void  ds_stack_pop_throw(ds_stack_t *stack, zval *return_value);
@@ -0,0 +1,632 @@
+#include "../common.h"
+
+#include "../php/objects/php_pair.h"
+#include "ds_pair.h"
+#include "ds_stream.h"
+
+typedef struct ds_stream_run ds_stream_run_t;
+
+/**
+ * Receives each value that makes it through all of the stages. Returns false
+ * to stop the run, eg. when a terminal operation already has what it needs.
+ */
+typedef bool (*ds_stream_sink_t)(ds_stream_run_t *run, zval *value);
+
+struct ds_stream_run {
+    ds_stream_stage_t **stages;     // Stages in the order that values pass through them
+    uint32_t            size;       // Number of stages
+    ds_stream_sink_t    sink;
+    void               *target;     // State of the terminal operation
+    zend_long          *counts;     // Values seen so far by each stage
+};
+
+typedef struct ds_stream_flat_map {
+    ds_stream_run_t    *run;
+    uint32_t            index;      // Stage to push each value into
+    bool                more;
+} ds_stream_flat_map_t;
+
+typedef struct ds_stream_reduce {
+    zend_fcall_info         fci;
+    zend_fcall_info_cache   fci_cache;
+    zval                    carry;
+} ds_stream_reduce_t;
+
+static bool ds_stream_push(ds_stream_run_t *run, uint32_t index, zval *value);
+
+static void ds_stream_source_release(ds_stream_source_t *source)
+{
+    if (--source->refs > 0) {
+        return;
+    }
+
+    switch (source->type) {
+        case DS_STREAM_SOURCE_VECTOR:
+        case DS_STREAM_SOURCE_VECTOR_REVERSED:
+            ds_vector_free(source->collection.vector);
+            break;
+
+        case DS_STREAM_SOURCE_DEQUE:
+            ds_deque_free(source->collection.deque);
+            break;
+
+        case DS_STREAM_SOURCE_QUEUE:
+            ds_queue_free(source->collection.queue);
+            break;
+
+        case DS_STREAM_SOURCE_PAIRS:
+        case DS_STREAM_SOURCE_KEYS:
+            ds_htable_free(source->collection.table);
+            break;
+
+        case DS_STREAM_SOURCE_PERSISTENT_VECTOR:
+            ds_persistent_vector_free(source->collection.persistent_vector);
+            break;
+
+        case DS_STREAM_SOURCE_PERSISTENT_MAP:
+            ds_persistent_map_free(source->collection.persistent_map);
+            break;
+    }
+
+    efree(source);
+}
+
+/**
+ * Releases a stage, and the stages before it that are no longer shared.
+ */
+static void ds_stream_stage_release(ds_stream_stage_t *stage)
+{
+    while (stage && --stage->refs == 0) {
+        ds_stream_stage_t *prev = stage->prev;
+
+        zval_ptr_dtor(&stage->fci.function_name);
+        efree(stage);
+
+        stage = prev;
+    }
+}
+
+static zend_long ds_stream_source_size(ds_stream_source_t *source)
+{
+    switch (source->type) {
+        case DS_STREAM_SOURCE_VECTOR:
+        case DS_STREAM_SOURCE_VECTOR_REVERSED:
+            return source->collection.vector->size;
+
+        case DS_STREAM_SOURCE_DEQUE:
+            return source->collection.deque->size;
+
+        case DS_STREAM_SOURCE_QUEUE:
+            return QUEUE_SIZE(source->collection.queue);
+
+        case DS_STREAM_SOURCE_PAIRS:
+        case DS_STREAM_SOURCE_KEYS:
+            return source->collection.table->size;
+
+        case DS_STREAM_SOURCE_PERSISTENT_VECTOR:
+            return source->collection.persistent_vector->size;
+
+        case DS_STREAM_SOURCE_PERSISTENT_MAP:
+            return source->collection.persistent_map->size;
+    }
+
+    return 0;
+}
+
+/**
+ * Returns the number of values that come out of a stage, or -1 if that can't
+ * be known without running filter and flatMap callbacks. The stages before it
+ * are applied first, starting with the size of the source.
+ */
+static zend_long ds_stream_stage_size(ds_stream_stage_t *stage, zend_long size)
+{
+    if (stage->prev) {
+        size = ds_stream_stage_size(stage->prev, size);
+    }
+
+    if (size < 0) {
+        return -1;
+    }
+
+    switch (stage->op) {
+        case DS_STREAM_FILTER:
+        case DS_STREAM_FLAT_MAP:
+            return -1;
+
+        case DS_STREAM_MAP:
+            return size;
+
+        case DS_STREAM_SKIP:
+            return MAX(0, size - stage->n);
+
+        case DS_STREAM_TAKE:
+            return MIN(size, stage->n);
+    }
+
+    return size;
+}
+
+/**
+ * Returns the number of values that a stream will produce, or -1 if that
+ * can't be known without running its filter and flatMap callbacks.
+ */
+static zend_long ds_stream_known_size(ds_stream_t *stream)
+{
+    zend_long size = ds_stream_source_size(stream->source);
+
+    return stream->last ? ds_stream_stage_size(stream->last, size) : size;
+}
+
+static bool ds_stream_call(ds_stream_stage_t *stage, zval *value, zval *retval)
+{
+    zend_fcall_info fci = stage->fci;
+
+    fci.param_count = 1;
+    fci.params      = value;
+    fci.retval      = retval;
+
+    if (zend_call_function(&fci, &stage->fci_cache) == FAILURE || Z_ISUNDEF_P(retval)) {
+        return false;
+    }
+
+    return true;
+}
+
+static int ds_stream_flat_map_apply(zend_object_iterator *iterator, void *puser)
+{
+    ds_stream_flat_map_t *context = (ds_stream_flat_map_t *) puser;
+
+    context->more = ds_stream_push(
+        context->run,
+        context->index,
+        iterator->funcs->get_current_data(iterator));
+
+    return context->more ? ZEND_HASH_APPLY_KEEP : ZEND_HASH_APPLY_STOP;
+}
+
+/**
+ * Pushes each value of an array or traversable object into a stage.
+ */
+static bool ds_stream_push_all(ds_stream_run_t *run, uint32_t index, zval *values)
+{
+    if (ds_is_array(values)) {
+        zval *value;
+
+        ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(values), value) {
+            if ( ! ds_stream_push(run, index, value)) {
+                return false;
+            }
+        }
+        ZEND_HASH_FOREACH_END();
+        return true;
+    }
+
+    if (ds_is_traversable(values)) {
+        ds_stream_flat_map_t context = {run, index, true};
+
+        spl_iterator_apply(values, ds_stream_flat_map_apply, (void *) &context);
+        return context.more && ! EG(exception);
+    }
+
+    ARRAY_OR_TRAVERSABLE_REQUIRED();
+    return false;
+}
+
+/**
+ * Pushes a value through the stages, starting at the given index, and then
+ * into the sink. Returns false if the run should stop.
+ */
+static bool ds_stream_push(ds_stream_run_t *run, uint32_t index, zval *value)
+{
+    for (; index < run->size; index++) {
+        ds_stream_stage_t *stage = run->stages[index];
+        zval retval;
+        bool more;
+
+        switch (stage->op) {
+            case DS_STREAM_FILTER:
+                if ( ! ds_stream_call(stage, value, &retval)) {
+                    return false;
+                }
+
+                more = EXPECTED_BOOL_IS_TRUE(&retval);
+                zval_ptr_dtor(&retval);
+
+                if ( ! more) {
+                    return true;
+                }
+                break;
+
+            case DS_STREAM_MAP:
+                if ( ! ds_stream_call(stage, value, &retval)) {
+                    return false;
+                }
+
+                more = ds_stream_push(run, index + 1, &retval);
+                zval_ptr_dtor(&retval);
+                return more;
+
+            case DS_STREAM_FLAT_MAP:
+                if ( ! ds_stream_call(stage, value, &retval)) {
+                    return false;
+                }
+
+                more = ds_stream_push_all(run, index + 1, &retval);
+                zval_ptr_dtor(&retval);
+                return more;
+
+            case DS_STREAM_SKIP:
+                if (run->counts[index] < stage->n) {
+                    run->counts[index]++;
+                    return true;
+                }
+                break;
+
+            case DS_STREAM_TAKE:
+                run->counts[index]++;
+
+                // Stop as soon as enough values have been taken, rather than
+                // when the next value arrives.
+                more = ds_stream_push(run, index + 1, value);
+                return more && run->counts[index] < stage->n;
+        }
+    }
+
+    return run->sink(run, value);
+}
+
+/**
+ * Pushes each value of the source through the stream into a sink.
+ */
+static void ds_stream_run(ds_stream_t *stream, ds_stream_sink_t sink, void *target)
+{
+    ds_stream_source_t *source = stream->source;
+    ds_stream_stage_t  *stage;
+    ds_stream_run_t run;
+    zval *value;
+    zval *key;
+    zval pair;
+    uint32_t index = stream->size;
+
+    run.size   = stream->size;
+    run.stages = run.size ? emalloc(run.size * sizeof(ds_stream_stage_t *)) : NULL;
+    run.sink   = sink;
+    run.target = target;
+
+    // The stages are linked from the last to the first.
+    for (stage = stream->last; stage; stage = stage->prev) {
+        run.stages[--index] = stage;
+    }
+
+    // Nothing would get past a stage that takes nothing.
+    for (index = 0; index < run.size; index++) {
+        if (run.stages[index]->op == DS_STREAM_TAKE && run.stages[index]->n <= 0) {
+            efree(run.stages);
+            return;
+        }
+    }
+
+    run.counts = run.size ? ecalloc(run.size, sizeof(zend_long)) : NULL;
+
+    switch (source->type) {
+        case DS_STREAM_SOURCE_VECTOR:
+            DS_VECTOR_FOREACH(source->collection.vector, value) {
+                if ( ! ds_stream_push(&run, 0, value)) {
+                    break;
+                }
+            }
+            DS_VECTOR_FOREACH_END();
+            break;
+
+        case DS_STREAM_SOURCE_VECTOR_REVERSED:
+            DS_VECTOR_FOREACH_REVERSED(source->collection.vector, value) {
+                if ( ! ds_stream_push(&run, 0, value)) {
+                    break;
+                }
+            }
+            DS_VECTOR_FOREACH_END();
+            break;
+
+        case DS_STREAM_SOURCE_DEQUE:
+            DS_DEQUE_FOREACH(source->collection.deque, value) {
+                if ( ! ds_stream_push(&run, 0, value)) {
+                    break;
+                }
+            }
+            DS_DEQUE_FOREACH_END();
+            break;
+
+        case DS_STREAM_SOURCE_QUEUE:
+            DS_QUEUE_FOREACH(source->collection.queue, value) {
+                if ( ! ds_stream_push(&run, 0, value)) {
+                    break;
+                }
+            }
+            DS_QUEUE_FOREACH_END();
+            break;
+
+        case DS_STREAM_SOURCE_PAIRS:
+            DS_HTABLE_FOREACH_KEY_VALUE(source->collection.table, key, value) {
+                bool more;
+
+                ZVAL_DS_PAIR(&pair, ds_pair_ex(key, value));
+                more = ds_stream_push(&run, 0, &pair);
+                zval_ptr_dtor(&pair);
+
+                if ( ! more) {
+                    break;
+                }
+            }
+            DS_HTABLE_FOREACH_END();
+            break;
+
+        case DS_STREAM_SOURCE_KEYS:
+            DS_HTABLE_FOREACH_KEY(source->collection.table, key) {
+                if ( ! ds_stream_push(&run, 0, key)) {
+                    break;
+                }
+            }
+            DS_HTABLE_FOREACH_END();
+            break;
+
+        case DS_STREAM_SOURCE_PERSISTENT_VECTOR:
+            DS_PERSISTENT_VECTOR_FOREACH(source->collection.persistent_vector, value) {
+                if ( ! ds_stream_push(&run, 0, value)) {
+                    break;
+                }
+            }
+            DS_PERSISTENT_VECTOR_FOREACH_END();
+            break;
+
+        case DS_STREAM_SOURCE_PERSISTENT_MAP:
+            DS_PERSISTENT_MAP_FOREACH_KEY_VALUE(source->collection.persistent_map, key, value) {
+                bool more;
+
+                ZVAL_DS_PAIR(&pair, ds_pair_ex(key, value));
+                more = ds_stream_push(&run, 0, &pair);
+                zval_ptr_dtor(&pair);
+
+                if ( ! more) {
+                    break;
+                }
+            }
+            DS_PERSISTENT_MAP_FOREACH_END();
+            break;
+    }
+
+    if (run.counts) {
+        efree(run.counts);
+        efree(run.stages);
+    }
+}
+
+ds_stream_t *ds_stream(ds_stream_source_type_t type, void *collection)
+{
+    ds_stream_t *stream = ecalloc(1, sizeof(ds_stream_t));
+
+    stream->source                 = emalloc(sizeof(ds_stream_source_t));
+    stream->source->type           = type;
+    stream->source->collection.ptr = collection;
+    stream->source->refs           = 1;
+
+    return stream;
+}
+
+ds_stream_t *ds_stream_clone(ds_stream_t *stream)
+{
+    ds_stream_t *clone = ecalloc(1, sizeof(ds_stream_t));
+
+    clone->source = stream->source;
+    clone->last   = stream->last;
+    clone->size   = stream->size;
+
+    clone->source->refs++;
+
+    if (clone->last) {
+        clone->last->refs++;
+    }
+
+    return clone;
+}
+
+void ds_stream_free(ds_stream_t *stream)
+{
+    ds_stream_stage_release(stream->last);
+    ds_stream_source_release(stream->source);
+    efree(stream);
+}
+
+/**
+ * Creates a stream that shares the source and stages of a stream, followed by
+ * a new stage that is returned to be initialized.
+ */
+static ds_stream_t *ds_stream_with_stage(ds_stream_t *stream, ds_stream_stage_t **stage)
+{
+    ds_stream_t *copy = ds_stream_clone(stream);
+
+    *stage = ecalloc(1, sizeof(ds_stream_stage_t));
+
+    // The new stage takes over the reference to the last stage.
+    (*stage)->prev = copy->last;
+    (*stage)->refs = 1;
+
+    copy->last = *stage;
+    copy->size++;
+
+    return copy;
+}
+
+ds_stream_t *ds_stream_with_callback(ds_stream_t *stream, ds_stream_op_t op, FCI_PARAMS)
+{
+    ds_stream_stage_t *stage;
+    ds_stream_t *copy = ds_stream_with_stage(stream, &stage);
+
+    stage->op        = op;
+    stage->n         = 0;
+    stage->fci       = fci;
+    stage->fci_cache = fci_cache;
+
+    // The callback has to outlive the call that provided it.
+    Z_TRY_ADDREF(stage->fci.function_name);
+    return copy;
+}
+
+ds_stream_t *ds_stream_with_limit(ds_stream_t *stream, ds_stream_op_t op, zend_long n)
+{
+    ds_stream_stage_t *stage;
+    ds_stream_t *copy = ds_stream_with_stage(stream, &stage);
+
+    stage->op        = op;
+    stage->n         = MAX(n, 0);
+    stage->fci       = empty_fcall_info;
+    stage->fci_cache = empty_fcall_info_cache;
+
+    return copy;
+}
+
+static bool ds_stream_sink_vector(ds_stream_run_t *run, zval *value)
+{
+    ds_vector_push((ds_vector_t *) run->target, value);
+    return true;
+}
+
+ds_vector_t *ds_stream_to_vector(ds_stream_t *stream)
+{
+    zend_long size = ds_stream_known_size(stream);
+
+    // Allocate once up front if we know how many values there will be.
+    ds_vector_t *vector = size > 0 ? ds_vector_ex(size) : ds_vector();
+
+    ds_stream_run(stream, ds_stream_sink_vector, vector);
+
+    if (EG(exception)) {
+        ds_vector_free(vector);
+        return NULL;
+    }
+
+    return vector;
+}
+
+static bool ds_stream_sink_array(ds_stream_run_t *run, zval *value)
+{
+    Z_TRY_ADDREF_P(value);
+    zend_hash_next_index_insert((HashTable *) run->target, value);
+    return true;
+}
+
+void ds_stream_to_array(ds_stream_t *stream, zval *return_value)
+{
+    zend_long size = ds_stream_known_size(stream);
+
+    array_init_size(return_value, size > 0 ? size : 0);
+    ds_stream_run(stream, ds_stream_sink_array, Z_ARRVAL_P(return_value));
+
+    if (EG(exception)) {
+        zval_ptr_dtor(return_value);
+        ZVAL_NULL(return_value);
+    }
+}
+
+static bool ds_stream_sink_count(ds_stream_run_t *run, zval *value)
+{
+    (*(zend_long *) run->target)++;
+    return true;
+}
+
+zend_long ds_stream_count(ds_stream_t *stream)
+{
+    zend_long count = ds_stream_known_size(stream);
+
+    // Map callbacks are skipped when the count is known without them.
+    if (count < 0) {
+        count = 0;
+        ds_stream_run(stream, ds_stream_sink_count, &count);
+    }
+
+    return count;
+}
+
+static bool ds_stream_sink_reduce(ds_stream_run_t *run, zval *value)
+{
+    ds_stream_reduce_t *reduce = (ds_stream_reduce_t *) run->target;
+
+    zval params[2];
+    zval retval;
+
+    ZVAL_COPY_VALUE(&params[0], &reduce->carry);
+    ZVAL_COPY_VALUE(&params[1], value);
+
+    reduce->fci.param_count = 2;
+    reduce->fci.params      = params;
+    reduce->fci.retval      = &retval;
+
+    if (zend_call_function(&reduce->fci, &reduce->fci_cache) == FAILURE || Z_ISUNDEF(retval)) {
+        return false;
+    }
+
+    zval_ptr_dtor(&reduce->carry);
+    ZVAL_COPY_VALUE(&reduce->carry, &retval);
+    return true;
+}
+
+void ds_stream_reduce(ds_stream_t *stream, zval *initial, zval *return_value, FCI_PARAMS)
+{
+    ds_stream_reduce_t reduce;
+
+    reduce.fci       = fci;
+    reduce.fci_cache = fci_cache;
+
+    if (initial == NULL) {
+        ZVAL_NULL(&reduce.carry);
+    } else {
+        ZVAL_COPY(&reduce.carry, initial);
+    }
+
+    ds_stream_run(stream, ds_stream_sink_reduce, &reduce);
+
+    if (EG(exception)) {
+        zval_ptr_dtor(&reduce.carry);
+        ZVAL_NULL(return_value);
+        return;
+    }
+
+    ZVAL_COPY_VALUE(return_value, &reduce.carry);
+}
+
+static bool ds_stream_sink_sum(ds_stream_run_t *run, zval *value)
+{
+    DS_ADD_TO_SUM(value, (zval *) run->target);
+    return true;
+}
+
+void ds_stream_sum(ds_stream_t *stream, zval *return_value)
+{
+    ZVAL_LONG(return_value, 0);
+    ds_stream_run(stream, ds_stream_sink_sum, return_value);
+}
+
+static bool ds_stream_sink_first(ds_stream_run_t *run, zval *value)
+{
+    ZVAL_COPY((zval *) run->target, value);
+    return false;
+}
+
+void ds_stream_first(ds_stream_t *stream, zval *return_value)
+{
+    zval first;
+
+    ZVAL_UNDEF(&first);
+    ds_stream_run(stream, ds_stream_sink_first, &first);
+
+    if (EG(exception)) {
+        zval_ptr_dtor(&first);
+        return;
+    }
+
+    if (Z_ISUNDEF(first)) {
+        NOT_ALLOWED_WHEN_EMPTY();
+        return;
+    }
+
+    ZVAL_COPY_VALUE(return_value, &first);
+}
@@ -0,0 +1,95 @@
+#ifndef DS_STREAM_H
+#define DS_STREAM_H
+
+#include "../common.h"
+#include "ds_vector.h"
+#include "ds_deque.h"
+#include "ds_queue.h"
+#include "ds_htable.h"
+#include "ds_persistent_vector.h"
+#include "ds_persistent_map.h"
+
+/**
+ * A stream is a lazy pipeline of stages over a source collection. Nothing is
+ * evaluated until a terminal operation runs, which pushes each value of the
+ * source through all of the stages in a single pass.
+ */
+typedef enum ds_stream_op {
+    DS_STREAM_FILTER,
+    DS_STREAM_MAP,
+    DS_STREAM_FLAT_MAP,
+    DS_STREAM_SKIP,
+    DS_STREAM_TAKE,
+} ds_stream_op_t;
+
+typedef enum ds_stream_source_type {
+    DS_STREAM_SOURCE_VECTOR,
+    DS_STREAM_SOURCE_VECTOR_REVERSED,   // Eg. a stack, from top to bottom
+    DS_STREAM_SOURCE_DEQUE,
+    DS_STREAM_SOURCE_QUEUE,
+    DS_STREAM_SOURCE_PAIRS,             // Pairs of a map's table
+    DS_STREAM_SOURCE_KEYS,              // Keys of a set's table
+    DS_STREAM_SOURCE_PERSISTENT_VECTOR,
+    DS_STREAM_SOURCE_PERSISTENT_MAP,    // Pairs of a persistent map
+} ds_stream_source_type_t;
+
+/**
+ * A stream that is derived from another shares its source and all of its
+ * stages, so adding a stage only allocates that stage. Each stage links back
+ * to the stage before it, and both are reference counted.
+ */
+typedef struct ds_stream_source {
+    ds_stream_source_type_t     type;
+    union {
+        void                   *ptr;
+        ds_vector_t            *vector;
+        ds_deque_t             *deque;
+        ds_queue_t             *queue;
+        ds_htable_t            *table;
+        ds_persistent_vector_t *persistent_vector;
+        ds_persistent_map_t    *persistent_map;
+    } collection;                           // Owned by the source
+    uint32_t                    refs;       // Number of streams that share the source
+} ds_stream_source_t;
+
+typedef struct ds_stream_stage {
+    ds_stream_op_t              op;
+    zend_long                   n;          // Number of values to skip or take
+    zend_fcall_info             fci;        // Callback of filter and map stages
+    zend_fcall_info_cache       fci_cache;
+    struct ds_stream_stage     *prev;       // Stage before this one, or NULL
+    uint32_t                    refs;       // Number of streams and stages that share the stage
+} ds_stream_stage_t;
+
+typedef struct ds_stream {
+    ds_stream_source_t         *source;
+    ds_stream_stage_t          *last;       // Last stage, or NULL if there are none
+    uint32_t                    size;       // Number of stages
+} ds_stream_t;
+
+/**
+ * Creates a stream over a source that the stream takes ownership of, which is
+ * usually a clone that shares its buffer with the collection.
+ */
+ds_stream_t *ds_stream(ds_stream_source_type_t type, void *source);
+ds_stream_t *ds_stream_clone(ds_stream_t *stream);
+void ds_stream_free(ds_stream_t *stream);
+
+/**
+ * These return a new stream with another stage, leaving the stream as it was.
+ * The new stream shares the source and the stages of the stream.
+ */
+ds_stream_t *ds_stream_with_callback(ds_stream_t *stream, ds_stream_op_t op, FCI_PARAMS);
+ds_stream_t *ds_stream_with_limit(ds_stream_t *stream, ds_stream_op_t op, zend_long n);
+
+/**
+ * Terminal operations.
+ */
+ds_vector_t *ds_stream_to_vector(ds_stream_t *stream);
+zend_long ds_stream_count(ds_stream_t *stream);
+void ds_stream_to_array(ds_stream_t *stream, zval *return_value);
+void ds_stream_reduce(ds_stream_t *stream, zval *initial, zval *return_value, FCI_PARAMS);
+void ds_stream_sum(ds_stream_t *stream, zval *return_value);
+void ds_stream_first(ds_stream_t *stream, zval *return_value);
+
+#endif
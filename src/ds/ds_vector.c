@@ -12,8 +12,27 @@ static inline bool index_out_of_range(zend_long index, zend_long max)
     return false;
 }
 
+/**
+ * Moves the values back to the start of the allocation, so that the free
+ * slots before the first value are added to the capacity.
+ */
+static void ds_vector_reclaim_offset(ds_vector_t *vector)
+{
+    zval *allocation = DS_VECTOR_ALLOCATION(vector);
+
+    memmove(allocation, vector->buffer, vector->size * sizeof(zval));
+
+    vector->buffer    = allocation;
+    vector->capacity += vector->offset;
+    vector->offset    = 0;
+}
+
 static inline void ds_vector_reallocate(ds_vector_t *vector, zend_long capacity)
 {
+    if (vector->offset > 0) {
+        ds_vector_reclaim_offset(vector);
+    }
+
     vector->buffer   = ds_reallocate_zval_buffer(vector->buffer, capacity, vector->capacity, vector->size);
     vector->capacity = capacity;
 }
@@ -45,15 +64,28 @@ ds_vector_t *ds_vector_clone(ds_vector_t *vector)
     } else {
         ds_vector_t *clone = ecalloc(1, sizeof(ds_vector_t));
 
-        clone->buffer   = ds_allocate_zval_buffer(vector->capacity);
+        // Share the buffer until either vector is changed.
+        clone->buffer   = vector->buffer;
         clone->capacity = vector->capacity;
         clone->size     = vector->size;
+        clone->offset   = vector->offset;
+        clone->refs     = ds_share_buffer(&vector->refs, vector->buffer, vector->size);
 
-        COPY_ZVAL_BUFFER(clone->buffer, vector->buffer, vector->size);
+        ZVAL_COPY(&clone->snapshot, &vector->snapshot);
         return clone;
     }
 }
 
+void ds_vector_separate(ds_vector_t *vector)
+{
+    if (ds_unshare_buffer(&vector->refs)) {
+        zval *buffer = ds_allocate_zval_buffer(vector->capacity);
+        COPY_ZVAL_BUFFER(buffer, vector->buffer, vector->size);
+        vector->buffer = buffer;
+        vector->offset = 0;
+    }
+}
+
 ds_vector_t *ds_vector_from_buffer(zval *buffer, zend_long capacity, zend_long size)
 {
     ds_vector_t *vector = ecalloc(1, sizeof(ds_vector_t));
@@ -74,29 +106,52 @@ ds_vector_t *ds_vector_from_buffer(zval *buffer, zend_long capacity, zend_long s
 void ds_vector_allocate(ds_vector_t *vector, zend_long capacity)
 {
     if (capacity > vector->capacity) {
+        ds_vector_separate(vector);
         ds_vector_reallocate(vector, capacity);
     }
 }
 
-static inline void ds_vector_increase_capacity(ds_vector_t *vector)
+void ds_vector_shrink_to_fit(ds_vector_t *vector)
 {
-    ds_vector_reallocate(vector, vector->capacity + (vector->capacity >> 1));
+    zend_long capacity = MAX(vector->size, DS_VECTOR_MIN_CAPACITY);
+
+    if (capacity < vector->capacity || vector->offset > 0) {
+        ds_vector_separate(vector);
+        ds_vector_reallocate(vector, capacity);
+    }
 }
 
 static inline void ds_vector_ensure_capacity(ds_vector_t *vector, zend_long capacity)
 {
     if (capacity > vector->capacity) {
-        zend_long boundary = vector->capacity + (vector->capacity >> 1);
+        zend_long boundary;
+        double    growth;
+
+        // Use the free slots at the front instead of growing, but only if
+        // there are enough of them to pay for moving the values.
+        if (vector->offset >= vector->size / 2 && capacity <= vector->capacity + vector->offset) {
+            ds_vector_reclaim_offset(vector);
+            return;
+        }
+
+        // The grow factor is always finite and greater than 1, but a large
+        // factor could still grow beyond what a capacity can be. A factor
+        // close to 1 is rounded up, and grows by at least the minimum
+        // capacity so that a small buffer doesn't grow one slot at a time.
+        growth   = ceil(vector->capacity * DSG(grow_factor));
+        growth   = MAX(growth, (double) vector->capacity + DS_VECTOR_MIN_CAPACITY);
+        boundary = growth < DS_VECTOR_MAX_CAPACITY ? (zend_long) growth : DS_VECTOR_MAX_CAPACITY;
+
         ds_vector_reallocate(vector, MAX(capacity, boundary));
     }
 }
 
 static inline void ds_vector_auto_truncate(ds_vector_t *vector)
 {
-    const zend_long c = vector->capacity;
+    const zend_long c = vector->capacity + vector->offset;
     const zend_long n = vector->size;
 
-    if (n <= c / 4 && c / 2 >= DS_VECTOR_MIN_CAPACITY) {
+    if (DS_SHOULD_SHRINK(n, c) && c / 2 >= DS_VECTOR_MIN_CAPACITY) {
         ds_vector_reallocate(vector, c / 2);
     }
 }
@@ -107,9 +162,14 @@ void ds_vector_remove(ds_vector_t *vector, zend_long index, zval *return_value)
         return;
     }
 
+    DS_VECTOR_SEPARATE(vector);
+
     if (index == vector->size - 1) {
         ds_vector_pop(vector, return_value);
 
+    } else if (index == 0) {
+        ds_vector_shift(vector, return_value);
+
     } else {
         zval *pos = vector->buffer + index;
 
@@ -140,7 +200,7 @@ zval *ds_vector_get(ds_vector_t *vector, zend_long index)
 static inline void increase_capacity_if_full(ds_vector_t *vector)
 {
     if (vector->size == vector->capacity) {
-        ds_vector_increase_capacity(vector);
+        ds_vector_ensure_capacity(vector, vector->size + 1);
     }
 }
 
@@ -158,6 +218,17 @@ static inline void ds_vector_clear_buffer(ds_vector_t *vector)
 
 void ds_vector_clear(ds_vector_t *vector)
 {
+    DS_VECTOR_INVALIDATE(vector);
+
+    // There's no need to copy a shared buffer only to clear it.
+    if (ds_unshare_buffer(&vector->refs)) {
+        vector->buffer   = ds_allocate_zval_buffer(DS_VECTOR_MIN_CAPACITY);
+        vector->capacity = DS_VECTOR_MIN_CAPACITY;
+        vector->size     = 0;
+        vector->offset   = 0;
+        return;
+    }
+
     if (vector->size > 0) {
         ds_vector_clear_buffer(vector);
 
@@ -170,7 +241,11 @@ void ds_vector_clear(ds_vector_t *vector)
 void ds_vector_set(ds_vector_t *vector, zend_long index, zval *value)
 {
     if ( ! index_out_of_range(index, vector->size)) {
-        zval *ptr = vector->buffer + index;
+        zval *ptr;
+
+        DS_VECTOR_SEPARATE(vector);
+
+        ptr = vector->buffer + index;
         zval_ptr_dtor(ptr);
         ZVAL_COPY(ptr, value);
     }
@@ -188,11 +263,34 @@ void ds_vector_to_array(ds_vector_t *vector, zval *return_value)
         zval *end = pos + size;
 
         array_init_size(return_value, size);
+        zend_hash_real_init(Z_ARRVAL_P(return_value), 1);
 
-        for (; pos != end; ++pos) {
-            add_next_index_zval(return_value, pos);
-            Z_TRY_ADDREF_P(pos);
-        }
+        ZEND_HASH_FILL_PACKED(Z_ARRVAL_P(return_value)) {
+            for (; pos != end; ++pos) {
+                Z_TRY_ADDREF_P(pos);
+                ZEND_HASH_FILL_ADD(pos);
+            }
+        } ZEND_HASH_FILL_END();
+    }
+}
+
+void ds_vector_to_array_snapshot(ds_vector_t *vector, zval *return_value)
+{
+    // The snapshot is shared, so any change made to the returned array will
+    // separate it first, leaving the snapshot as it was.
+    if (Z_ISUNDEF(vector->snapshot)) {
+        ds_vector_to_array(vector, &vector->snapshot);
+    }
+
+    ZVAL_COPY(return_value, &vector->snapshot);
+}
+
+void ds_vector_to_array_cached(ds_vector_t *vector, zval *return_value)
+{
+    if (DSG(array_snapshots)) {
+        ds_vector_to_array_snapshot(vector, return_value);
+    } else {
+        ds_vector_to_array(vector, return_value);
     }
 }
 
@@ -247,12 +345,19 @@ void ds_vector_join(ds_vector_t *vector, char *str, size_t len, zval *return_val
 
 void ds_vector_insert_va(ds_vector_t *vector, zend_long index, VA_PARAMS)
 {
+    // Use the free space at the front if inserting before the first value.
+    if (index == 0 && vector->size > 0) {
+        ds_vector_unshift_va(vector, VA_ARGS);
+        return;
+    }
+
     if ( ! index_out_of_range(index, vector->size + 1) && argc > 0) {
         zend_long len;
         zval *src;
         zval *dst;
         zval *end;
 
+        DS_VECTOR_SEPARATE(vector);
         ds_vector_ensure_capacity(vector, vector->size + argc);
 
         src = argv;
@@ -277,8 +382,122 @@ void ds_vector_insert(ds_vector_t *vector, zend_long index, zval *value)
     ds_vector_insert_va(vector, index, 1, value);
 }
 
+/**
+ * Replaces 'length' values at 'index' with 'count' values that are moved from
+ * 'src', so that the values after the range are moved only once. The values
+ * that are replaced are moved into 'removed', which must have room for them.
+ */
+static void ds_vector_replace_range(
+    ds_vector_t *vector,
+    zend_long    index,
+    zend_long    length,
+    zval        *src,
+    zend_long    count,
+    zval        *removed
+) {
+    zval *pos;
+    zend_long after;
+
+    DS_VECTOR_SEPARATE(vector);
+    ds_vector_ensure_capacity(vector, vector->size - length + count);
+
+    pos   = vector->buffer + index;
+    after = vector->size - index - length;
+
+    if (length > 0) {
+        memcpy(removed, pos, length * sizeof(zval));
+    }
+
+    if (count != length && after > 0) {
+        memmove(pos + count, pos + length, after * sizeof(zval));
+    }
+
+    if (count > 0) {
+        memcpy(pos, src, count * sizeof(zval));
+    }
+
+    vector->size += count - length;
+}
+
+ds_vector_t *ds_vector_splice(ds_vector_t *vector, zend_long index, zend_long length, zval *values)
+{
+    zval *src = NULL;
+    zval *removed;
+    zend_long count = 0;
+
+    if (values && ! (src = ds_values_to_zval_buffer(values, &count))) {
+        return NULL;
+    }
+
+    ds_normalize_splice_args(&index, &length, vector->size);
+
+    removed = ds_allocate_zval_buffer(MAX(length, DS_VECTOR_MIN_CAPACITY));
+    ds_vector_replace_range(vector, index, length, src, count, removed);
+
+    if (src) {
+        ds_free_buffer(src);
+    }
+
+    if (count < length) {
+        ds_vector_auto_truncate(vector);
+    }
+
+    return ds_vector_from_buffer(removed, MAX(length, DS_VECTOR_MIN_CAPACITY), length);
+}
+
+void ds_vector_remove_range(ds_vector_t *vector, zend_long index, zend_long length)
+{
+    zval *removed;
+    zend_long i;
+
+    ds_normalize_slice_args(&index, &length, vector->size);
+
+    if (length == 0) {
+        return;
+    }
+
+    removed = ds_allocate_zval_buffer(length);
+    ds_vector_replace_range(vector, index, length, NULL, 0, removed);
+    ds_vector_auto_truncate(vector);
+
+    // Release the values only once the vector is in a valid state again,
+    // because a destructor could access the vector.
+    for (i = 0; i < length; i++) {
+        zval_ptr_dtor(&removed[i]);
+    }
+
+    efree(removed);
+}
+
+void ds_vector_insert_all(ds_vector_t *vector, zend_long index, zval *values)
+{
+    zval *src;
+    zend_long count;
+
+    if (index_out_of_range(index, vector->size + 1)) {
+        return;
+    }
+
+    if ( ! (src = ds_values_to_zval_buffer(values, &count))) {
+        return;
+    }
+
+    // The index could be out of range now if the iterator changed the vector.
+    if ( ! index_out_of_range(index, vector->size + 1)) {
+        ds_vector_replace_range(vector, index, 0, src, count, NULL);
+
+    } else {
+        while (count > 0) {
+            zval_ptr_dtor(&src[--count]);
+        }
+    }
+
+    ds_free_buffer(src);
+}
+
 void ds_vector_push(ds_vector_t *vector, zval *value)
 {
+    DS_VECTOR_SEPARATE(vector);
     increase_capacity_if_full(vector);
     ZVAL_COPY(&vector->buffer[vector->size++], value);
 }
@@ -293,6 +512,7 @@ void ds_vector_push_va(ds_vector_t *vector, VA_PARAMS)
     if (argc > 0) {
         zval *src, *dst, *end;
 
+        DS_VECTOR_SEPARATE(vector);
         ds_vector_ensure_capacity(vector, vector->size + argc);
 
         src = argv;
@@ -307,44 +527,64 @@ void ds_vector_push_va(ds_vector_t *vector, VA_PARAMS)
     }
 }
 
+/**
+ * Makes room for at least 'n' values before the first value. Extra room is
+ * added in proportion to the size, so that a series of unshifts only has to
+ * move the values every so often.
+ */
+static void ds_vector_reserve_front(ds_vector_t *vector, zend_long n)
+{
+    zend_long offset = MAX(n, vector->size / 2);
+    zval *allocation = ds_allocate_zval_buffer(offset + vector->capacity);
+
+    memcpy(allocation + offset, vector->buffer, vector->size * sizeof(zval));
+    ds_free_buffer(DS_VECTOR_ALLOCATION(vector));
+
+    vector->buffer = allocation + offset;
+    vector->offset = offset;
+}
+
 void ds_vector_unshift(ds_vector_t *vector, zval *value)
 {
-    ds_vector_insert(vector, 0, value);
+    ds_vector_unshift_va(vector, 1, value);
 }
 
 void ds_vector_unshift_va(ds_vector_t *vector, VA_PARAMS)
 {
-    if (argc == 1) {
-        ds_vector_unshift(vector, argv);
-        return;
-    }
-
     if (argc > 0) {
-        zval *dst, *src, *end;
+        zval *dst;
 
-        ds_vector_ensure_capacity(vector, vector->size + argc);
+        DS_VECTOR_SEPARATE(vector);
 
-        src = argv;
-        dst = vector->buffer;
-        end = dst + argc;
+        if (vector->offset < argc) {
+            ds_vector_reserve_front(vector, argc);
+        }
 
-        memmove(end, dst, vector->size * sizeof(zval));
+        vector->buffer   -= argc;
+        vector->offset   -= argc;
+        vector->capacity += argc;
+        vector->size     += argc;
 
-        while (dst != end) {
-            ZVAL_COPY(dst++, src++);
-        }
+        dst = vector->buffer;
 
-        vector->size += argc;
+        while (argc--) {
+            ZVAL_COPY(dst++, argv++);
+        }
     }
 }
 
 void ds_vector_sort_callback(ds_vector_t *vector)
 {
+    DS_VECTOR_SEPARATE(vector);
     ds_user_sort_zval_buffer(vector->buffer, vector->size);
+
+    // The comparator may have created a snapshot while we were sorting.
+    DS_VECTOR_INVALIDATE(vector);
 }
 
 void ds_vector_sort(ds_vector_t *vector)
 {
+    DS_VECTOR_SEPARATE(vector);
     ds_sort_zval_buffer(vector->buffer, vector->size);
 }
 
@@ -362,6 +602,32 @@ bool ds_vector_index_exists(ds_vector_t *vector, zend_long index)
     return index >= 0 && index < vector->size;
 }
 
+bool ds_vector_equals(ds_vector_t *vector, ds_vector_t *other)
+{
+    zval *x, *y, *end;
+
+    if (vector->size != other->size) {
+        return false;
+    }
+
+    // Shared buffers are always equal.
+    if (vector->buffer == other->buffer) {
+        return true;
+    }
+
+    x   = vector->buffer;
+    y   = other->buffer;
+    end = x + vector->size;
+
+    for (; x < end; ++x, ++y) {
+        if ( ! fast_equal_check_function(x, y) || EG(exception)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static int iterator_add(zend_object_iterator *iterator, void *puser)
 {
     ds_vector_push((ds_vector_t *) puser, iterator->funcs->get_current_data(iterator));
@@ -375,13 +641,39 @@ static inline void add_traversable_to_vector(ds_vector_t *vector, zval *obj)
 
 static inline void add_array_to_vector(ds_vector_t *vector, HashTable *array)
 {
-    zval *value;
-    ds_vector_ensure_capacity(vector, vector->size + array->nNumOfElements);
+    const zend_long n = zend_hash_num_elements(array);
+
+    zval *dst;
+
+    if (n == 0) {
+        return;
+    }
+
+    // Allocate once up front so that we can copy without any capacity checks.
+    ds_vector_ensure_capacity(vector, vector->size + n);
+
+    dst = vector->buffer + vector->size;
 
-    ZEND_HASH_FOREACH_VAL(array, value) {
-        ds_vector_push(vector, value);
+    // Packed arrays without holes can be copied straight from the buckets.
+    if (ds_php_array_is_packed(array)) {
+        Bucket *pos = array->arData;
+        Bucket *end = pos + n;
+
+        for (; pos != end; ++pos, ++dst) {
+            ZVAL_COPY(dst, &pos->val);
+        }
+
+    } else {
+        zval *value;
+
+        ZEND_HASH_FOREACH_VAL(array, value) {
+            ZVAL_COPY(dst, value);
+            dst++;
+        }
+        ZEND_HASH_FOREACH_END();
     }
-    ZEND_HASH_FOREACH_END();
+
+    vector->size += n;
 }
 
 void ds_vector_rotate(ds_vector_t *vector, zend_long r)
@@ -400,6 +692,8 @@ void ds_vector_rotate(ds_vector_t *vector, zend_long r)
     // There's no need to rotate if the sequence won't be affected.
     if (r == 0 || r == n) return;
 
+    DS_VECTOR_SEPARATE(vector);
+
     a = vector->buffer; // Start of buffer
     b = a + r;          // Pivot
     c = a + n;          // End of buffer
@@ -417,6 +711,7 @@ void ds_vector_push_all(ds_vector_t *vector, zval *values)
     }
 
     if (ds_is_array(values)) {
+        DS_VECTOR_SEPARATE(vector);
         add_array_to_vector(vector, Z_ARRVAL_P(values));
         return;
     }
@@ -443,6 +738,7 @@ ds_vector_t *ds_vector_merge(ds_vector_t *vector, zval *values)
 
 void ds_vector_pop(ds_vector_t *vector, zval *return_value)
 {
+    DS_VECTOR_SEPARATE(vector);
     SET_AS_RETURN_AND_UNDEF(&vector->buffer[--vector->size]);
     ds_vector_auto_truncate(vector);
 }
@@ -459,12 +755,19 @@ void ds_vector_pop_throw(ds_vector_t *vector, zval *return_value)
 
 void ds_vector_shift(ds_vector_t *vector, zval *return_value)
 {
-    zval *first = vector->buffer;
+    zval *first;
 
+    DS_VECTOR_SEPARATE(vector);
+
+    first = vector->buffer;
     SET_AS_RETURN_AND_UNDEF(first);
 
+    // The slot of the first value becomes free space at the front.
+    vector->buffer++;
+    vector->offset++;
+    vector->capacity--;
     vector->size--;
-    memmove(first, first + 1, vector->size * sizeof(zval));
+
     ds_vector_auto_truncate(vector);
 }
 
@@ -510,6 +813,7 @@ zval *ds_vector_get_first_throw(ds_vector_t *vector)
 
 void ds_vector_reverse(ds_vector_t *vector)
 {
+    DS_VECTOR_SEPARATE(vector);
     ds_reverse_zval_range(vector->buffer, vector->buffer + vector->size);
 }
 
@@ -531,20 +835,106 @@ void ds_vector_apply(ds_vector_t *vector, FCI_PARAMS)
 {
     zval retval;
     zval *value;
+    zend_long index;
 
-    DS_VECTOR_FOREACH(vector, value) {
+    for (index = 0; index < vector->size; index++) {
         fci.param_count = 1;
-        fci.params      = value;
+        fci.params      = &vector->buffer[index];
         fci.retval      = &retval;
 
         if (zend_call_function(&fci, &fci_cache) == FAILURE || Z_ISUNDEF(retval)) {
             return;
         }
 
+        // The callback may have copied the vector or created a snapshot,
+        // so we have to separate and look up the value every time.
+        DS_VECTOR_SEPARATE(vector);
+
+        value = &vector->buffer[index];
         zval_ptr_dtor(value);
         ZVAL_COPY_VALUE(value, &retval);
     }
-    DS_VECTOR_FOREACH_END();
+}
+
+/**
+ * Removes values in place, keeping those for which the truth of the callback's
+ * return value matches 'keep'.
+ */
+static void ds_vector_retain_ex(ds_vector_t *vector, bool keep_if, FCI_PARAMS)
+{
+    zval retval;
+    zval *value;
+    zval *target;
+    zend_long index;
+    zend_long size = vector->size;
+    zend_ulong changes = vector->changes;
+    uint32_t *keep;
+
+    if (size == 0) {
+        return;
+    }
+
+    keep = DS_BITSET_ALLOCATE(size);
+
+    // Decide which values to keep before changing anything, because the
+    // callback could access or copy the vector while it's being called.
+    for (index = 0; index < size; index++) {
+        fci.param_count = 1;
+        fci.params      = &vector->buffer[index];
+        fci.retval      = &retval;
+
+        if (zend_call_function(&fci, &fci_cache) == FAILURE || Z_ISUNDEF(retval)) {
+            efree(keep);
+            return;
+        }
+
+        if (EXPECTED_BOOL_IS_TRUE(&retval) == keep_if) {
+            DS_BITSET_SET(keep, index);
+        }
+
+        zval_ptr_dtor(&retval);
+
+        // The positions of the bits are only valid while values are neither
+        // added, removed nor moved, eg. by a sort or a shift and a push.
+        if (vector->changes != changes) {
+            MODIFIED_BY_CALLBACK();
+            efree(keep);
+            return;
+        }
+    }
+
+    // Compact the buffer in a single pass, with a cursor for the next value.
+    DS_VECTOR_SEPARATE(vector);
+
+    target = vector->buffer;
+
+    for (index = 0; index < size; index++) {
+        value = &vector->buffer[index];
+
+        if (DS_BITSET_HAS(keep, index)) {
+            if (target != value) {
+                ZVAL_COPY_VALUE(target, value);
+            }
+            target++;
+        } else {
+            zval_ptr_dtor(value);
+        }
+    }
+
+    vector->size = target - vector->buffer;
+    efree(keep);
+
+    ds_vector_auto_truncate(vector);
+}
+
+void ds_vector_retain(ds_vector_t *vector, FCI_PARAMS)
+{
+    ds_vector_retain_ex(vector, true, FCI_ARGS);
+}
+
+void ds_vector_remove_if(ds_vector_t *vector, FCI_PARAMS)
+{
+    ds_vector_retain_ex(vector, false, FCI_ARGS);
 }
 
 ds_vector_t *ds_vector_map(ds_vector_t *vector, FCI_PARAMS)
@@ -711,7 +1101,13 @@ void ds_vector_sum(ds_vector_t *vector, zval *return_value)
 
 void ds_vector_free(ds_vector_t *vector)
 {
-    ds_vector_clear_buffer(vector);
-    efree(vector->buffer);
+    DS_VECTOR_INVALIDATE(vector);
+
+    // Leave a shared buffer to its other owners.
+    if ( ! ds_unshare_buffer(&vector->refs)) {
+        ds_vector_clear_buffer(vector);
+        ds_free_buffer(DS_VECTOR_ALLOCATION(vector));
+    }
+
     efree(vector);
 }
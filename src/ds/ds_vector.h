@@ -4,16 +4,51 @@
 #include "../common.h"
 
 typedef struct ds_vector {
-    zval       *buffer;
-    zend_long   capacity;  // Buffer length
+    zval       *buffer;    // First value, which is 'offset' into the allocation
+    zend_long   capacity;  // Buffer length from the first value
     zend_long   size;      // Number of values in the buffer
+    zend_long   offset;    // Free slots before the first value
+    zval        snapshot;  // Cached array of the values, or undef
+    uint32_t   *refs;      // Owners of a shared buffer, or NULL if not shared
+    zend_ulong  changes;   // Number of changes, to detect those by callbacks
 } ds_vector_t;
 
 #define DS_VECTOR_MIN_CAPACITY  8  // Does not have to be a power of 2
+#define DS_VECTOR_MAX_CAPACITY  ((zend_long) (ZEND_LONG_MAX / sizeof(zval)))
+
+/**
+ * Start of the allocation, which is before the first value when values have
+ * been shifted off or room has been made to unshift.
+ */
+#define DS_VECTOR_ALLOCATION(v) ((v)->buffer - (v)->offset)
 
 #define DS_VECTOR_SIZE(v)     ((v)->size)
 #define DS_VECTOR_IS_EMPTY(v) (DS_VECTOR_SIZE(v) == 0)
 
+/**
+ * Releases the cached array snapshot, if any, and counts the change. This must
+ * be done before any change is made to the values in the buffer.
+ */
+#define DS_VECTOR_INVALIDATE(v)         \
+do {                                    \
+    ds_vector_t *_iv = v;               \
+    DTOR_AND_UNDEF(&_iv->snapshot);     \
+    _iv->changes++;                     \
+} while (0)
+
+/**
+ * Prepares a vector for a change to its values or its buffer. This releases
+ * the array snapshot and copies the buffer if it's shared with another vector.
+ */
+#define DS_VECTOR_SEPARATE(v)       \
+do {                                \
+    ds_vector_t *_sv = v;           \
+    DS_VECTOR_INVALIDATE(_sv);      \
+    if (_sv->refs) {                \
+        ds_vector_separate(_sv);    \
+    }                               \
+} while (0)
+
 /**
  * Foreach value
  */
@@ -48,6 +83,12 @@ ds_vector_t *ds_vector_from_buffer(zval *buffer, zend_long capacity, zend_long s
 
 void ds_vector_allocate(ds_vector_t *vector, zend_long capacity);
 
+/**
+ * Reduces the capacity to the size, or the minimum capacity.
+ */
+void ds_vector_shrink_to_fit(ds_vector_t *vector);
+void ds_vector_separate(ds_vector_t *vector);
+
 void ds_vector_clear(ds_vector_t *vector);
 void ds_vector_free(ds_vector_t *vector);
 
@@ -90,6 +131,17 @@ void ds_vector_reverse(ds_vector_t *vector);
 void ds_vector_rotate(ds_vector_t *vector, zend_long rotations);
 void ds_vector_join(ds_vector_t *vector, char *str, size_t len, zval *return_value);
 void ds_vector_apply(ds_vector_t *vector, FCI_PARAMS);
+void ds_vector_retain(ds_vector_t *vector, FCI_PARAMS);
+void ds_vector_remove_if(ds_vector_t *vector, FCI_PARAMS);
+
+/**
+ * Replaces a range of values with the given values, which can be an array or
+ * a traversable object, and returns a vector of the values that were removed.
+ * Negative offsets and lengths are treated the same way as for a slice.
+ */
+ds_vector_t *ds_vector_splice(ds_vector_t *vector, zend_long index, zend_long length, zval *values);
+void ds_vector_remove_range(ds_vector_t *vector, zend_long index, zend_long length);
+void ds_vector_insert_all(ds_vector_t *vector, zend_long index, zval *values);
 
 void ds_vector_sum(ds_vector_t *vector, zval *return_value);
 
@@ -97,8 +149,16 @@ void ds_vector_sort(ds_vector_t *vector);
 void ds_vector_sort_callback(ds_vector_t *vector);
 
 void ds_vector_to_array(ds_vector_t *vector, zval *return_value);
+void ds_vector_to_array_cached(ds_vector_t *vector, zval *return_value);
+void ds_vector_to_array_snapshot(ds_vector_t *vector, zval *return_value);
 
 bool ds_vector_index_exists(ds_vector_t *vector, zend_long index);
 bool ds_vector_isset(ds_vector_t *vector, zend_long index, int check_empty);
 
+/**
+ * Determines if two vectors have the same size and equal values in the same
+ * order, stopping at the first value that is not equal.
+ */
+bool ds_vector_equals(ds_vector_t *vector, ds_vector_t *other);
+
 #endif
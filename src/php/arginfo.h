@@ -27,6 +27,11 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 0) \
 ZEND_ARG_TYPE_INFO(0, s, IS_STRING, 0) \
 ZEND_END_ARG_INFO()
 
+#define ARGINFO_STRING(name, s) \
+ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 1) \
+ZEND_ARG_TYPE_INFO(0, s, IS_STRING, 0) \
+ZEND_END_ARG_INFO()
+
 #define ARGINFO_OPTIONAL_CALLABLE(name, c) \
 ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 0) \
 ZEND_ARG_TYPE_INFO(0, c, IS_CALLABLE, 1) \
@@ -37,6 +42,12 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 1) \
 ZEND_ARG_TYPE_INFO(0, c, IS_CALLABLE, 0) \
 ZEND_END_ARG_INFO()
 
+#define ARGINFO_ZVAL_CALLABLE(name, z, c) \
+ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 2) \
+ZEND_ARG_INFO(0, z) \
+ZEND_ARG_TYPE_INFO(0, c, IS_CALLABLE, 0) \
+ZEND_END_ARG_INFO()
+
 #define ARGINFO_VARIADIC_ZVAL(name, v) \
 ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 0) \
 ZEND_ARG_VARIADIC_INFO(0, v) \
@@ -47,6 +58,12 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 1) \
 ZEND_ARG_TYPE_INFO(0, i, IS_LONG, 0) \
 ZEND_END_ARG_INFO()
 
+#define ARGINFO_LONG_LONG(name, i1, i2) \
+ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 2) \
+ZEND_ARG_TYPE_INFO(0, i1, IS_LONG, 0) \
+ZEND_ARG_TYPE_INFO(0, i2, IS_LONG, 0) \
+ZEND_END_ARG_INFO()
+
 #define ARGINFO_LONG_ZVAL(name, i, z) \
 ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 2) \
 ZEND_ARG_TYPE_INFO(0, i, IS_LONG, 0) \
@@ -59,6 +76,17 @@ ZEND_ARG_INFO(0, z) \
 ZEND_ARG_TYPE_INFO(0, i, IS_LONG, 0) \
 ZEND_END_ARG_INFO()
 
+#define ARGINFO_ZVAL_OPTIONAL_LONG(name, z, i) \
+ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 1) \
+ZEND_ARG_INFO(0, z) \
+ZEND_ARG_TYPE_INFO(0, i, IS_LONG, 0) \
+ZEND_END_ARG_INFO()
+
+#define ARGINFO_ARRAY(name, a) \
+ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 1) \
+ZEND_ARG_ARRAY_INFO(0, a, 0) \
+ZEND_END_ARG_INFO()
+
 #define ARGINFO_ZVAL(name, z) \
 ZEND_BEGIN_ARG_INFO_EX(arginfo_##name, 0, 0, 1) \
 ZEND_ARG_INFO(0, z) \
@@ -122,11 +150,28 @@ ZEND_END_ARG_INFO()
     ZEND_ARG_TYPE_INFO(0, s, IS_STRING, 0) \
     ZEND_END_ARG_INFO()
 
+#define ARGINFO_STRING_RETURN_DS(name, s, col) \
+    DS_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(name, 0, 1, col, 0) \
+    ZEND_ARG_TYPE_INFO(0, s, IS_STRING, 0) \
+    ZEND_END_ARG_INFO()
+
+#define ARGINFO_STRING_OPTIONAL_LONG_RETURN_DS(name, s, i, col) \
+    DS_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(name, 0, 1, col, 0) \
+    ZEND_ARG_TYPE_INFO(0, s, IS_STRING, 0) \
+    ZEND_ARG_TYPE_INFO(0, i, IS_LONG, 0) \
+    ZEND_END_ARG_INFO()
+
 #define ARGINFO_ZVAL_RETURN_DS(name, z, col) \
     DS_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(name, 0, 1, col, 0) \
     ZEND_ARG_TYPE_INFO(0, z, 0, 0) \
     ZEND_END_ARG_INFO()
 
+#define ARGINFO_ZVAL_OPTIONAL_ZVAL_RETURN_DS(name, z1, z2, col) \
+    DS_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(name, 0, 1, col, 0) \
+    ZEND_ARG_INFO(0, z1) \
+    ZEND_ARG_INFO(0, z2) \
+    ZEND_END_ARG_INFO()
+
 #define ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(name, c, col) \
     DS_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(name, 0, 0, col, 0) \
     ZEND_ARG_TYPE_INFO(0, c, IS_CALLABLE, 1) \
@@ -138,11 +183,28 @@ ZEND_END_ARG_INFO()
     ZEND_ARG_TYPE_INFO(0, i2, IS_LONG, 1) \
     ZEND_END_ARG_INFO()
 
+#define ARGINFO_LONG_OPTIONAL_LONG_OPTIONAL_ZVAL_RETURN_DS(name, i1, i2, z, col) \
+    DS_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(name, 0, 1, col, 0) \
+    ZEND_ARG_TYPE_INFO(0, i1, IS_LONG, 0) \
+    ZEND_ARG_TYPE_INFO(0, i2, IS_LONG, 1) \
+    ZEND_ARG_TYPE_INFO(0, z, 0, 1) \
+    ZEND_END_ARG_INFO()
+
 #define ARGINFO_LONG_RETURN_DS(name, i, col) \
     DS_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(name, 0, 1, col, 0) \
     ZEND_ARG_TYPE_INFO(0, i, IS_LONG, 0) \
     ZEND_END_ARG_INFO()
 
+#define ARGINFO_OPTIONAL_NULLABLE_LONG_RETURN_DS(name, i, col) \
+    DS_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(name, 0, 0, col, 0) \
+    ZEND_ARG_TYPE_INFO(0, i, IS_LONG, 1) \
+    ZEND_END_ARG_INFO()
+
+#define ARGINFO_ZVAL_RETURN_LONG(name, z) \
+    DS_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(name, 0, 1, IS_LONG, 0) \
+    ZEND_ARG_INFO(0, z) \
+    ZEND_END_ARG_INFO()
+
 #define ARGINFO_NONE_RETURN_LONG(name) \
     DS_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(name, 0, 0, IS_LONG, 0) \
     ZEND_END_ARG_INFO()
@@ -151,6 +213,12 @@ ZEND_END_ARG_INFO()
     DS_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(name, 0, 0, IS_STRING, 0) \
     ZEND_END_ARG_INFO()
 
+#define ARGINFO_OPTIONAL_LONG_OPTIONAL_LONG_RETURN_STRING(name, i1, i2) \
+    DS_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(name, 0, 0, IS_STRING, 0) \
+    ZEND_ARG_TYPE_INFO(0, i1, IS_LONG, 0) \
+    ZEND_ARG_TYPE_INFO(0, i2, IS_LONG, 0) \
+    ZEND_END_ARG_INFO()
+
 #define ARGINFO_NONE_RETURN_DS(name, class_name) \
     DS_BEGIN_ARG_WITH_RETURN_OBJ_INFO_EX(name, 0, 0, class_name, 0) \
     ZEND_END_ARG_INFO()
@@ -0,0 +1,188 @@
+#include "../../common.h"
+
+#include "../parameters.h"
+#include "../arginfo.h"
+
+#include "../objects/php_counter.h"
+#include "../objects/php_map.h"
+
+#include "../iterators/php_counter_iterator.h"
+#include "../handlers/php_common_handlers.h"
+#include "../handlers/php_counter_handlers.h"
+
+#include "php_collection_ce.h"
+#include "php_counter_ce.h"
+
+#define METHOD(name) PHP_METHOD(Counter, name)
+
+zend_class_entry *php_ds_counter_ce;
+
+METHOD(__construct)
+{
+    PARSE_OPTIONAL_ZVAL(values);
+
+    if (values) {
+        ds_counter_add_all(THIS_DS_COUNTER(), values);
+    }
+}
+
+METHOD(allocate)
+{
+    PARSE_LONG(capacity);
+    ds_counter_allocate(THIS_DS_COUNTER(), capacity);
+}
+
+METHOD(capacity)
+{
+    PARSE_NONE;
+    RETURN_LONG(DS_COUNTER_CAPACITY(THIS_DS_COUNTER()));
+}
+
+METHOD(add)
+{
+    PARSE_ZVAL_OPTIONAL_LONG(value, count, 1);
+    ds_counter_add(THIS_DS_COUNTER(), value, count);
+}
+
+METHOD(addAll)
+{
+    PARSE_ZVAL(values);
+    ds_counter_add_all(THIS_DS_COUNTER(), values);
+}
+
+METHOD(get)
+{
+    PARSE_ZVAL(value);
+    RETURN_LONG(ds_counter_get(THIS_DS_COUNTER(), value));
+}
+
+METHOD(remove)
+{
+    PARSE_ZVAL(value);
+    RETURN_LONG(ds_counter_remove(THIS_DS_COUNTER(), value));
+}
+
+METHOD(total)
+{
+    PARSE_NONE;
+    RETURN_LONG(THIS_DS_COUNTER()->total);
+}
+
+METHOD(mostCommon)
+{
+    PARSE_OPTIONAL_NULLABLE_LONG(n, n_is_null);
+    RETURN_DS_MAP(ds_counter_most_common(THIS_DS_COUNTER(), n_is_null ? ZEND_LONG_MAX : n));
+}
+
+METHOD(merge)
+{
+    PARSE_OBJ(obj, php_ds_counter_ce);
+    RETURN_DS_COUNTER(ds_counter_merge(THIS_DS_COUNTER(), Z_DS_COUNTER_P(obj)));
+}
+
+METHOD(subtract)
+{
+    PARSE_OBJ(obj, php_ds_counter_ce);
+    RETURN_DS_COUNTER(ds_counter_subtract(THIS_DS_COUNTER(), Z_DS_COUNTER_P(obj)));
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+METHOD(clear)
+{
+    PARSE_NONE;
+    ds_counter_clear(THIS_DS_COUNTER());
+}
+
+METHOD(copy)
+{
+    PARSE_NONE;
+    RETURN_OBJ(php_ds_counter_create_clone(THIS_DS_COUNTER()));
+}
+
+METHOD(count)
+{
+    PARSE_NONE;
+    RETURN_LONG(DS_COUNTER_SIZE(THIS_DS_COUNTER()));
+}
+
+METHOD(isEmpty)
+{
+    PARSE_NONE;
+    RETURN_BOOL(DS_COUNTER_IS_EMPTY(THIS_DS_COUNTER()));
+}
+
+METHOD(toArray)
+{
+    PARSE_NONE;
+    ds_counter_to_array(THIS_DS_COUNTER(), return_value);
+}
+
+METHOD(jsonSerialize)
+{
+    PARSE_NONE;
+    ds_counter_to_array(THIS_DS_COUNTER(), return_value);
+}
+
+#if PHP_VERSION_ID >= 70400
+METHOD(__serialize)
+{
+    PARSE_NONE;
+    php_ds_counter_magic_serialize(getThis(), return_value);
+}
+
+METHOD(__unserialize)
+{
+    PARSE_HASH(data);
+    php_ds_counter_magic_unserialize(getThis(), data);
+}
+#endif
+
+void php_ds_register_counter()
+{
+    zend_class_entry ce;
+
+    zend_function_entry methods[] = {
+        PHP_DS_ME(Counter, __construct)
+#if PHP_VERSION_ID >= 70400
+        PHP_DS_ME(Counter, __serialize)
+        PHP_DS_ME(Counter, __unserialize)
+#endif
+        PHP_DS_ME(Counter, add)
+        PHP_DS_ME(Counter, addAll)
+        PHP_DS_ME(Counter, allocate)
+        PHP_DS_ME(Counter, capacity)
+        PHP_DS_ME(Counter, equals)
+        PHP_DS_ME(Counter, get)
+        PHP_DS_ME(Counter, merge)
+        PHP_DS_ME(Counter, mostCommon)
+        PHP_DS_ME(Counter, remove)
+        PHP_DS_ME(Counter, subtract)
+        PHP_DS_ME(Counter, total)
+
+        PHP_DS_COLLECTION_ME_LIST(Counter)
+        PHP_FE_END
+    };
+
+    INIT_CLASS_ENTRY(ce, PHP_DS_NS(Counter), methods);
+
+    php_ds_counter_ce = zend_register_internal_class(&ce);
+    php_ds_counter_ce->ce_flags      |= ZEND_ACC_FINAL;
+    php_ds_counter_ce->create_object  = php_ds_counter_create_object;
+    php_ds_counter_ce->get_iterator   = php_ds_counter_get_iterator;
+    php_ds_counter_ce->serialize      = php_ds_counter_serialize;
+    php_ds_counter_ce->unserialize    = php_ds_counter_unserialize;
+
+    zend_declare_class_constant_long(
+        php_ds_counter_ce,
+        STR_AND_LEN("MIN_CAPACITY"),
+        DS_HTABLE_MIN_CAPACITY
+    );
+
+    zend_class_implements(php_ds_counter_ce, 1, collection_ce);
+    php_ds_register_counter_handlers();
+}
@@ -0,0 +1,30 @@
+#ifndef DS_COUNTER_CE_H
+#define DS_COUNTER_CE_H
+
+#include "php.h"
+#include "../../common.h"
+#include "../arginfo.h"
+
+extern zend_class_entry *php_ds_counter_ce;
+
+ARGINFO_OPTIONAL_ZVAL(                      Counter___construct, values);
+ARGINFO_LONG(                               Counter_allocate, capacity);
+ARGINFO_NONE_RETURN_LONG(                   Counter_capacity);
+ARGINFO_ZVAL_OPTIONAL_LONG(                 Counter_add, value, count);
+ARGINFO_ZVAL(                               Counter_addAll, values);
+ARGINFO_ZVAL_RETURN_LONG(                   Counter_get, value);
+ARGINFO_ZVAL_RETURN_LONG(                   Counter_remove, value);
+ARGINFO_NONE_RETURN_LONG(                   Counter_total);
+ARGINFO_OPTIONAL_NULLABLE_LONG_RETURN_DS(   Counter_mostCommon, n, Map);
+ARGINFO_DS_RETURN_DS(                       Counter_merge, counter, Counter, Counter);
+ARGINFO_DS_RETURN_DS(                       Counter_subtract, counter, Counter, Counter);
+ARGINFO_ZVAL_RETURN_BOOL(                   Counter_equals, other);
+
+#if PHP_VERSION_ID >= 70400
+ARGINFO_NONE_RETURN_ARRAY(                  Counter___serialize);
+ARGINFO_ARRAY(                              Counter___unserialize, data);
+#endif
+
+void php_ds_register_counter();
+
+#endif
@@ -4,7 +4,10 @@
 #include "../arginfo.h"
 
 #include "../objects/php_deque.h"
+#include "../objects/php_stream.h"
+#include "../../ds/ds_binary.h"
 #include "../iterators/php_deque_iterator.h"
+#include "../handlers/php_common_handlers.h"
 #include "../handlers/php_deque_handlers.h"
 
 #include "php_collection_ce.h"
@@ -40,6 +43,12 @@ METHOD(allocate)
     ds_deque_allocate(THIS_DS_DEQUE(), capacity);
 }
 
+METHOD(shrinkToFit)
+{
+    PARSE_NONE;
+    ds_deque_shrink_to_fit(THIS_DS_DEQUE());
+}
+
 METHOD(apply)
 {
     PARSE_CALLABLE();
@@ -87,6 +96,12 @@ METHOD(filter)
     }
 }
 
+METHOD(retain)
+{
+    PARSE_CALLABLE();
+    ds_deque_retain(THIS_DS_DEQUE(), FCI_ARGS);
+}
+
 METHOD(slice)
 {
     ds_deque_t *deque = THIS_DS_DEQUE();
@@ -100,6 +115,20 @@ METHOD(slice)
     }
 }
 
+METHOD(splice)
+{
+    ds_deque_t *deque = THIS_DS_DEQUE();
+
+    PARSE_LONG_OPTIONAL_LONG_OPTIONAL_ZVAL(index, length, length_is_null, values);
+
+    // Splice to the end if a length isn't given.
+    if (length_is_null) {
+        length = deque->size;
+    }
+
+    RETURN_DS_DEQUE(ds_deque_splice(deque, index, length, values));
+}
+
 METHOD(sort)
 {
     ds_deque_t *sorted = THIS_DS_DEQUE();
@@ -194,7 +223,7 @@ METHOD(sum)
 METHOD(toArray)
 {
     PARSE_NONE;
-    ds_deque_to_array(THIS_DS_DEQUE(), return_value);
+    ds_deque_to_array_cached(THIS_DS_DEQUE(), return_value);
 }
 
 METHOD(get)
@@ -221,12 +250,30 @@ METHOD(remove)
     ds_deque_remove(THIS_DS_DEQUE(), index, return_value);
 }
 
+METHOD(removeIf)
+{
+    PARSE_CALLABLE();
+    ds_deque_remove_if(THIS_DS_DEQUE(), FCI_ARGS);
+}
+
+METHOD(removeRange)
+{
+    PARSE_LONG_AND_LONG(index, length);
+    ds_deque_remove_range(THIS_DS_DEQUE(), index, length);
+}
+
 METHOD(insert)
 {
     PARSE_LONG_AND_VARIADIC_ZVAL(index);
     ds_deque_insert_va(THIS_DS_DEQUE(), index, argc, argv);
 }
 
+METHOD(insertAll)
+{
+    PARSE_LONG_AND_ZVAL(index, values);
+    ds_deque_insert_all(THIS_DS_DEQUE(), index, values);
+}
+
 METHOD(reverse)
 {
     PARSE_NONE;
@@ -260,8 +307,58 @@ METHOD(copy)
 METHOD(jsonSerialize)
 {
     PARSE_NONE;
-    ds_deque_to_array(THIS_DS_DEQUE(), return_value);
+    ds_deque_to_array_cached(THIS_DS_DEQUE(), return_value);
+}
+
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_DEQUE, ds_deque_clone(THIS_DS_DEQUE())));
+}
+
+METHOD(toBinary)
+{
+    PARSE_NONE;
+    RETURN_STR(ds_binary_encode_deque(THIS_DS_DEQUE()));
+}
+
+METHOD(fromBinary)
+{
+    PARSE_STRING();
+    RETURN_DS_DEQUE(ds_binary_decode_deque(str, len));
+}
+
+METHOD(writeTo)
+{
+    PARSE_STREAM();
+    ds_binary_encode_deque_to(THIS_DS_DEQUE(), stream);
+}
+
+METHOD(readFrom)
+{
+    PARSE_STREAM();
+    RETURN_DS_DEQUE(ds_binary_decode_deque_from(stream));
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+#if PHP_VERSION_ID >= 70400
+METHOD(__serialize)
+{
+    PARSE_NONE;
+    php_ds_deque_magic_serialize(getThis(), return_value);
+}
+
+METHOD(__unserialize)
+{
+    PARSE_HASH(data);
+    php_ds_deque_magic_unserialize(getThis(), data);
 }
+#endif
 
 void php_ds_register_deque()
 {
@@ -269,6 +366,22 @@ void php_ds_register_deque()
 
     zend_function_entry methods[] = {
         PHP_DS_ME(Deque, __construct)
+#if PHP_VERSION_ID >= 70400
+        PHP_DS_ME(Deque, __serialize)
+        PHP_DS_ME(Deque, __unserialize)
+#endif
+        PHP_DS_ME_STATIC(Deque, fromBinary)
+        PHP_DS_ME_STATIC(Deque, readFrom)
+        PHP_DS_ME(Deque, equals)
+        PHP_DS_ME(Deque, insertAll)
+        PHP_DS_ME(Deque, removeIf)
+        PHP_DS_ME(Deque, removeRange)
+        PHP_DS_ME(Deque, retain)
+        PHP_DS_ME(Deque, shrinkToFit)
+        PHP_DS_ME(Deque, splice)
+        PHP_DS_ME(Deque, stream)
+        PHP_DS_ME(Deque, toBinary)
+        PHP_DS_ME(Deque, writeTo)
 
         PHP_DS_COLLECTION_ME_LIST(Deque)
         PHP_DS_SEQUENCE_ME_LIST(Deque)
@@ -8,6 +8,23 @@
 extern zend_class_entry *php_ds_deque_ce;
 
 ARGINFO_OPTIONAL_ZVAL(Deque___construct, values);
+ARGINFO_CALLABLE(Deque_retain, callback);
+ARGINFO_LONG_ZVAL(Deque_insertAll, index, values);
+ARGINFO_CALLABLE(Deque_removeIf, callback);
+ARGINFO_LONG_LONG(Deque_removeRange, index, length);
+ARGINFO_NONE(Deque_shrinkToFit);
+ARGINFO_LONG_OPTIONAL_LONG_OPTIONAL_ZVAL_RETURN_DS(Deque_splice, index, length, values, Deque);
+ARGINFO_NONE_RETURN_DS(Deque_stream, Stream);
+ARGINFO_NONE_RETURN_STRING(Deque_toBinary);
+ARGINFO_STRING_RETURN_DS(Deque_fromBinary, data, Deque);
+ARGINFO_ZVAL(Deque_writeTo, stream);
+ARGINFO_ZVAL_RETURN_DS(Deque_readFrom, stream, Deque);
+ARGINFO_ZVAL_RETURN_BOOL(Deque_equals, other);
+
+#if PHP_VERSION_ID >= 70400
+ARGINFO_NONE_RETURN_ARRAY(Deque___serialize);
+ARGINFO_ARRAY(Deque___unserialize, data);
+#endif
 
 void php_ds_register_deque();
 
@@ -0,0 +1,296 @@
+#include "../../common.h"
+
+#include "../parameters.h"
+#include "../arginfo.h"
+
+#include "../objects/php_vector.h"
+#include "../objects/php_map.h"
+#include "../objects/php_immutable_map.h"
+#include "../objects/php_pair.h"
+#include "../objects/php_set.h"
+#include "../objects/php_stream.h"
+#include "../objects/php_map_view.h"
+
+#include "../iterators/php_map_iterator.h"
+#include "../handlers/php_common_handlers.h"
+#include "../handlers/php_immutable_map_handlers.h"
+
+#include "php_collection_ce.h"
+#include "php_immutable_map_ce.h"
+
+#define METHOD(name) PHP_METHOD(ImmutableMap, name)
+
+#define THIS_DS_IMMUTABLE_MAP_OBJ() Z_DS_IMMUTABLE_MAP_OBJ_P(getThis())
+
+zend_class_entry *php_ds_immutable_map_ce;
+
+METHOD(__construct)
+{
+    php_ds_immutable_map_t *obj = THIS_DS_IMMUTABLE_MAP_OBJ();
+
+    PARSE_OPTIONAL_ZVAL(values);
+
+    if (obj->constructed) {
+        RECONSTRUCTION_NOT_ALLOWED();
+        return;
+    }
+
+    if (values) {
+        ds_map_put_all(obj->map, values);
+    }
+
+    obj->constructed = true;
+}
+
+METHOD(clear)
+{
+    PARSE_NONE;
+    MUTABILITY_NOT_ALLOWED();
+}
+
+METHOD(copy)
+{
+    PARSE_NONE;
+
+    // There's no need to copy something that can't be changed.
+    ZVAL_COPY(return_value, getThis());
+}
+
+METHOD(count)
+{
+    PARSE_NONE;
+    RETURN_LONG(DS_MAP_SIZE(THIS_DS_MAP()));
+}
+
+METHOD(filter)
+{
+    if (ZEND_NUM_ARGS()) {
+        PARSE_CALLABLE();
+        RETURN_DS_IMMUTABLE_MAP(ds_map_filter_callback(THIS_DS_MAP(), FCI_ARGS));
+    } else {
+        RETURN_DS_IMMUTABLE_MAP(ds_map_filter(THIS_DS_MAP()));
+    }
+}
+
+METHOD(first)
+{
+    PARSE_NONE;
+    RETURN_DS_PAIR(ds_map_first(THIS_DS_MAP()));
+}
+
+METHOD(get)
+{
+    PARSE_ZVAL_OPTIONAL_ZVAL(key, def);
+    RETURN_ZVAL_COPY(ds_map_get(THIS_DS_MAP(), key, def));
+}
+
+METHOD(hasKey)
+{
+    PARSE_ZVAL(key);
+    RETURN_BOOL(ds_map_has_key(THIS_DS_MAP(), key));
+}
+
+METHOD(hasValue)
+{
+    PARSE_ZVAL(value);
+    RETURN_BOOL(ds_map_has_value(THIS_DS_MAP(), value));
+}
+
+METHOD(isEmpty)
+{
+    PARSE_NONE;
+    RETURN_BOOL(DS_MAP_IS_EMPTY(THIS_DS_MAP()));
+}
+
+METHOD(jsonSerialize)
+{
+    PARSE_NONE;
+    php_ds_immutable_map_to_array(THIS_DS_IMMUTABLE_MAP_OBJ(), return_value);
+}
+
+METHOD(keys)
+{
+    PARSE_NONE;
+    RETURN_DS_SET(ds_set_ex(ds_htable_clone(THIS_DS_MAP()->table)));
+}
+
+METHOD(ksorted)
+{
+    if (ZEND_NUM_ARGS()) {
+        PARSE_COMPARE_CALLABLE();
+        RETURN_DS_IMMUTABLE_MAP(ds_map_sorted_by_key_callback(THIS_DS_MAP()));
+    } else {
+        RETURN_DS_IMMUTABLE_MAP(ds_map_sorted_by_key(THIS_DS_MAP()));
+    }
+}
+
+METHOD(last)
+{
+    PARSE_NONE;
+    RETURN_DS_PAIR(ds_map_last(THIS_DS_MAP()));
+}
+
+METHOD(map)
+{
+    PARSE_CALLABLE();
+    RETURN_DS_IMMUTABLE_MAP(ds_map_map(THIS_DS_MAP(), FCI_ARGS));
+}
+
+METHOD(merge)
+{
+    PARSE_ZVAL(values);
+    RETURN_DS_IMMUTABLE_MAP(ds_map_merge(THIS_DS_MAP(), values));
+}
+
+METHOD(pairs)
+{
+    ds_map_t *map = THIS_DS_MAP();
+    PARSE_NONE;
+    RETURN_DS_VECTOR(
+        ds_vector_from_buffer(ds_map_pairs(map), DS_MAP_SIZE(map), DS_MAP_SIZE(map)));
+}
+
+METHOD(reduce)
+{
+    PARSE_CALLABLE_AND_OPTIONAL_ZVAL(initial);
+    ds_map_reduce(THIS_DS_MAP(), FCI_ARGS, initial, return_value);
+}
+
+METHOD(reversed)
+{
+    PARSE_NONE;
+    RETURN_DS_IMMUTABLE_MAP(ds_map_reversed(THIS_DS_MAP()));
+}
+
+METHOD(skip)
+{
+    PARSE_LONG(position);
+    RETURN_DS_PAIR(ds_map_skip(THIS_DS_MAP(), position));
+}
+
+METHOD(slice)
+{
+    ds_map_t *map = THIS_DS_MAP();
+
+    if (ZEND_NUM_ARGS() > 1) {
+        PARSE_LONG_AND_LONG(index, length);
+        RETURN_DS_IMMUTABLE_MAP(ds_map_slice(map, index, length));
+    } else {
+        PARSE_LONG(index);
+        RETURN_DS_IMMUTABLE_MAP(ds_map_slice(map, index, DS_MAP_SIZE(map)));
+    }
+}
+
+METHOD(sorted)
+{
+    if (ZEND_NUM_ARGS()) {
+        PARSE_COMPARE_CALLABLE();
+        RETURN_DS_IMMUTABLE_MAP(ds_map_sorted_by_value_callback(THIS_DS_MAP()));
+    } else {
+        RETURN_DS_IMMUTABLE_MAP(ds_map_sorted_by_value(THIS_DS_MAP()));
+    }
+}
+
+METHOD(sum)
+{
+    PARSE_NONE;
+    ds_map_sum(THIS_DS_MAP(), return_value);
+}
+
+METHOD(toArray)
+{
+    PARSE_NONE;
+    php_ds_immutable_map_to_array(THIS_DS_IMMUTABLE_MAP_OBJ(), return_value);
+}
+
+METHOD(toMap)
+{
+    PARSE_NONE;
+    RETURN_OBJ(php_ds_map_create_clone(THIS_DS_MAP()));
+}
+
+METHOD(values)
+{
+    ds_map_t *map = THIS_DS_MAP();
+    PARSE_NONE;
+    RETURN_DS_VECTOR(
+        ds_vector_from_buffer(ds_map_values(map), DS_MAP_SIZE(map), DS_MAP_SIZE(map)));
+}
+
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_PAIRS, ds_htable_clone(THIS_DS_MAP()->table)));
+}
+
+METHOD(keysView)
+{
+    PARSE_NONE;
+    RETURN_DS_MAP_VIEW(ds_map_view(DS_MAP_VIEW_KEYS, getThis(), THIS_DS_MAP()->table));
+}
+
+METHOD(valuesView)
+{
+    PARSE_NONE;
+    RETURN_DS_MAP_VIEW(ds_map_view(DS_MAP_VIEW_VALUES, getThis(), THIS_DS_MAP()->table));
+}
+
+METHOD(pairsView)
+{
+    PARSE_NONE;
+    RETURN_DS_MAP_VIEW(ds_map_view(DS_MAP_VIEW_PAIRS, getThis(), THIS_DS_MAP()->table));
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+void php_ds_register_immutable_map()
+{
+    zend_class_entry ce;
+
+    zend_function_entry methods[] = {
+        PHP_DS_ME(ImmutableMap, __construct)
+        PHP_DS_ME(ImmutableMap, equals)
+        PHP_DS_ME(ImmutableMap, filter)
+        PHP_DS_ME(ImmutableMap, first)
+        PHP_DS_ME(ImmutableMap, get)
+        PHP_DS_ME(ImmutableMap, hasKey)
+        PHP_DS_ME(ImmutableMap, hasValue)
+        PHP_DS_ME(ImmutableMap, keys)
+        PHP_DS_ME(ImmutableMap, keysView)
+        PHP_DS_ME(ImmutableMap, ksorted)
+        PHP_DS_ME(ImmutableMap, last)
+        PHP_DS_ME(ImmutableMap, map)
+        PHP_DS_ME(ImmutableMap, merge)
+        PHP_DS_ME(ImmutableMap, pairs)
+        PHP_DS_ME(ImmutableMap, pairsView)
+        PHP_DS_ME(ImmutableMap, reduce)
+        PHP_DS_ME(ImmutableMap, reversed)
+        PHP_DS_ME(ImmutableMap, skip)
+        PHP_DS_ME(ImmutableMap, slice)
+        PHP_DS_ME(ImmutableMap, sorted)
+        PHP_DS_ME(ImmutableMap, stream)
+        PHP_DS_ME(ImmutableMap, sum)
+        PHP_DS_ME(ImmutableMap, toMap)
+        PHP_DS_ME(ImmutableMap, values)
+        PHP_DS_ME(ImmutableMap, valuesView)
+
+        PHP_DS_COLLECTION_ME_LIST(ImmutableMap)
+        PHP_FE_END
+    };
+
+    INIT_CLASS_ENTRY(ce, PHP_DS_NS(ImmutableMap), methods);
+
+    php_ds_immutable_map_ce = zend_register_internal_class(&ce);
+    php_ds_immutable_map_ce->ce_flags      |= ZEND_ACC_FINAL;
+    php_ds_immutable_map_ce->create_object  = php_ds_immutable_map_create_object;
+    php_ds_immutable_map_ce->get_iterator   = php_ds_map_get_iterator;
+    php_ds_immutable_map_ce->serialize      = php_ds_immutable_map_serialize;
+    php_ds_immutable_map_ce->unserialize    = php_ds_immutable_map_unserialize;
+
+    zend_class_implements(php_ds_immutable_map_ce, 1, collection_ce);
+    php_ds_register_immutable_map_handlers();
+}
@@ -0,0 +1,38 @@
+#ifndef DS_IMMUTABLE_MAP_CE_H
+#define DS_IMMUTABLE_MAP_CE_H
+
+#include "php.h"
+#include "../../common.h"
+#include "../arginfo.h"
+
+extern zend_class_entry *php_ds_immutable_map_ce;
+
+ARGINFO_OPTIONAL_ZVAL(                      ImmutableMap___construct, values);
+ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(        ImmutableMap_filter, callback, ImmutableMap);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_first, Pair);
+ARGINFO_ZVAL_OPTIONAL_ZVAL(                 ImmutableMap_get, key, default);
+ARGINFO_ZVAL_RETURN_BOOL(                   ImmutableMap_hasKey, key);
+ARGINFO_ZVAL_RETURN_BOOL(                   ImmutableMap_hasValue, value);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_keys, Set);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_keysView, MapView);
+ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(        ImmutableMap_ksorted, comparator, ImmutableMap);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_last, Pair);
+ARGINFO_CALLABLE_RETURN_DS(                 ImmutableMap_map, callback, ImmutableMap);
+ARGINFO_ZVAL_RETURN_DS(                     ImmutableMap_merge, values, ImmutableMap);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_pairs, Sequence);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_pairsView, MapView);
+ARGINFO_CALLABLE_OPTIONAL_ZVAL(             ImmutableMap_reduce, callback, initial);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_reversed, ImmutableMap);
+ARGINFO_LONG_RETURN_DS(                     ImmutableMap_skip, position, Pair);
+ARGINFO_LONG_OPTIONAL_LONG_RETURN_DS(       ImmutableMap_slice, index, length, ImmutableMap);
+ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(        ImmutableMap_sorted, comparator, ImmutableMap);
+ARGINFO_NONE(                               ImmutableMap_sum);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_toMap, Map);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_values, Sequence);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_valuesView, MapView);
+ARGINFO_NONE_RETURN_DS(                     ImmutableMap_stream, Stream);
+ARGINFO_ZVAL_RETURN_BOOL(                   ImmutableMap_equals, other);
+
+void php_ds_register_immutable_map();
+
+#endif
@@ -0,0 +1,240 @@
+#include "../../common.h"
+
+#include "../parameters.h"
+#include "../arginfo.h"
+
+#include "../objects/php_vector.h"
+#include "../objects/php_immutable_vector.h"
+#include "../objects/php_stream.h"
+#include "../iterators/php_vector_iterator.h"
+#include "../handlers/php_common_handlers.h"
+#include "../handlers/php_immutable_vector_handlers.h"
+
+#include "php_collection_ce.h"
+#include "php_immutable_vector_ce.h"
+
+#define METHOD(name) PHP_METHOD(ImmutableVector, name)
+
+zend_class_entry *php_ds_immutable_vector_ce;
+
+METHOD(__construct)
+{
+    php_ds_immutable_vector_t *obj = (php_ds_immutable_vector_t *) Z_OBJ_P(getThis());
+
+    PARSE_OPTIONAL_ZVAL(values);
+
+    if (obj->constructed) {
+        RECONSTRUCTION_NOT_ALLOWED();
+        return;
+    }
+
+    if (values) {
+        ds_vector_push_all(obj->vector, values);
+    }
+
+    obj->constructed = true;
+}
+
+METHOD(clear)
+{
+    PARSE_NONE;
+    MUTABILITY_NOT_ALLOWED();
+}
+
+METHOD(contains)
+{
+    PARSE_VARIADIC_ZVAL();
+    RETURN_BOOL(ds_vector_contains_va(THIS_DS_VECTOR(), argc, argv));
+}
+
+METHOD(copy)
+{
+    PARSE_NONE;
+
+    // There's no need to copy something that can't be changed.
+    ZVAL_COPY(return_value, getThis());
+}
+
+METHOD(count)
+{
+    PARSE_NONE;
+    RETURN_LONG(DS_VECTOR_SIZE(THIS_DS_VECTOR()));
+}
+
+METHOD(filter)
+{
+    if (ZEND_NUM_ARGS()) {
+        PARSE_CALLABLE();
+        RETURN_DS_IMMUTABLE_VECTOR(ds_vector_filter_callback(THIS_DS_VECTOR(), FCI_ARGS));
+    } else {
+        RETURN_DS_IMMUTABLE_VECTOR(ds_vector_filter(THIS_DS_VECTOR()));
+    }
+}
+
+METHOD(find)
+{
+    PARSE_ZVAL(value);
+    ds_vector_find(THIS_DS_VECTOR(), value, return_value);
+}
+
+METHOD(first)
+{
+    PARSE_NONE;
+    RETURN_ZVAL_COPY(ds_vector_get_first_throw(THIS_DS_VECTOR()));
+}
+
+METHOD(get)
+{
+    PARSE_LONG(index);
+    RETURN_ZVAL_COPY(ds_vector_get(THIS_DS_VECTOR(), index));
+}
+
+METHOD(isEmpty)
+{
+    PARSE_NONE;
+    RETURN_BOOL(DS_VECTOR_IS_EMPTY(THIS_DS_VECTOR()));
+}
+
+METHOD(join)
+{
+    if (ZEND_NUM_ARGS()) {
+        PARSE_STRING();
+        ds_vector_join(THIS_DS_VECTOR(), str, len, return_value);
+    } else {
+        ds_vector_join(THIS_DS_VECTOR(), NULL, 0, return_value);
+    }
+}
+
+METHOD(jsonSerialize)
+{
+    PARSE_NONE;
+    ds_vector_to_array_snapshot(THIS_DS_VECTOR(), return_value);
+}
+
+METHOD(last)
+{
+    PARSE_NONE;
+    RETURN_ZVAL_COPY(ds_vector_get_last_throw(THIS_DS_VECTOR()));
+}
+
+METHOD(map)
+{
+    PARSE_CALLABLE();
+    RETURN_DS_IMMUTABLE_VECTOR(ds_vector_map(THIS_DS_VECTOR(), FCI_ARGS));
+}
+
+METHOD(merge)
+{
+    PARSE_ZVAL(values);
+    RETURN_DS_IMMUTABLE_VECTOR(ds_vector_merge(THIS_DS_VECTOR(), values));
+}
+
+METHOD(reduce)
+{
+    PARSE_CALLABLE_AND_OPTIONAL_ZVAL(initial);
+    ds_vector_reduce(THIS_DS_VECTOR(), initial, return_value, FCI_ARGS);
+}
+
+METHOD(reversed)
+{
+    PARSE_NONE;
+    RETURN_DS_IMMUTABLE_VECTOR(ds_vector_reversed(THIS_DS_VECTOR()));
+}
+
+METHOD(slice)
+{
+    ds_vector_t *vector = THIS_DS_VECTOR();
+
+    if (ZEND_NUM_ARGS() > 1) {
+        PARSE_LONG_AND_LONG(index, length);
+        RETURN_DS_IMMUTABLE_VECTOR(ds_vector_slice(vector, index, length));
+    } else {
+        PARSE_LONG(index);
+        RETURN_DS_IMMUTABLE_VECTOR(ds_vector_slice(vector, index, vector->size));
+    }
+}
+
+METHOD(sorted)
+{
+    ds_vector_t *vector = ds_vector_clone(THIS_DS_VECTOR());
+
+    if (ZEND_NUM_ARGS()) {
+        PARSE_COMPARE_CALLABLE();
+        ds_vector_sort_callback(vector);
+    } else {
+        ds_vector_sort(vector);
+    }
+
+    RETURN_DS_IMMUTABLE_VECTOR(vector);
+}
+
+METHOD(sum)
+{
+    PARSE_NONE;
+    ds_vector_sum(THIS_DS_VECTOR(), return_value);
+}
+
+METHOD(toArray)
+{
+    PARSE_NONE;
+    ds_vector_to_array_snapshot(THIS_DS_VECTOR(), return_value);
+}
+
+METHOD(toVector)
+{
+    PARSE_NONE;
+    RETURN_OBJ(php_ds_vector_create_clone(THIS_DS_VECTOR()));
+}
+
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_VECTOR, ds_vector_clone(THIS_DS_VECTOR())));
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+void php_ds_register_immutable_vector()
+{
+    zend_class_entry ce;
+
+    zend_function_entry methods[] = {
+        PHP_DS_ME(ImmutableVector, __construct)
+        PHP_DS_ME(ImmutableVector, contains)
+        PHP_DS_ME(ImmutableVector, equals)
+        PHP_DS_ME(ImmutableVector, filter)
+        PHP_DS_ME(ImmutableVector, find)
+        PHP_DS_ME(ImmutableVector, first)
+        PHP_DS_ME(ImmutableVector, get)
+        PHP_DS_ME(ImmutableVector, join)
+        PHP_DS_ME(ImmutableVector, last)
+        PHP_DS_ME(ImmutableVector, map)
+        PHP_DS_ME(ImmutableVector, merge)
+        PHP_DS_ME(ImmutableVector, reduce)
+        PHP_DS_ME(ImmutableVector, reversed)
+        PHP_DS_ME(ImmutableVector, slice)
+        PHP_DS_ME(ImmutableVector, sorted)
+        PHP_DS_ME(ImmutableVector, stream)
+        PHP_DS_ME(ImmutableVector, sum)
+        PHP_DS_ME(ImmutableVector, toVector)
+
+        PHP_DS_COLLECTION_ME_LIST(ImmutableVector)
+        PHP_FE_END
+    };
+
+    INIT_CLASS_ENTRY(ce, PHP_DS_NS(ImmutableVector), methods);
+
+    php_ds_immutable_vector_ce = zend_register_internal_class(&ce);
+    php_ds_immutable_vector_ce->ce_flags      |= ZEND_ACC_FINAL;
+    php_ds_immutable_vector_ce->create_object  = php_ds_immutable_vector_create_object;
+    php_ds_immutable_vector_ce->get_iterator   = php_ds_vector_get_iterator;
+    php_ds_immutable_vector_ce->serialize      = php_ds_immutable_vector_serialize;
+    php_ds_immutable_vector_ce->unserialize    = php_ds_immutable_vector_unserialize;
+
+    zend_class_implements(php_ds_immutable_vector_ce, 1, collection_ce);
+    php_register_immutable_vector_handlers();
+}
@@ -0,0 +1,31 @@
+#ifndef DS_IMMUTABLE_VECTOR_CE_H
+#define DS_IMMUTABLE_VECTOR_CE_H
+
+#include "php.h"
+#include "../../common.h"
+#include "../arginfo.h"
+
+extern zend_class_entry *php_ds_immutable_vector_ce;
+
+ARGINFO_OPTIONAL_ZVAL(                  ImmutableVector___construct, values);
+ARGINFO_VARIADIC_ZVAL_RETURN_BOOL(      ImmutableVector_contains, values);
+ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(    ImmutableVector_filter, callback, ImmutableVector);
+ARGINFO_ZVAL(                           ImmutableVector_find, value);
+ARGINFO_NONE(                           ImmutableVector_first);
+ARGINFO_LONG(                           ImmutableVector_get, index);
+ARGINFO_OPTIONAL_STRING_RETURN_STRING(  ImmutableVector_join, glue);
+ARGINFO_NONE(                           ImmutableVector_last);
+ARGINFO_CALLABLE_RETURN_DS(             ImmutableVector_map, callback, ImmutableVector);
+ARGINFO_ZVAL_RETURN_DS(                 ImmutableVector_merge, values, ImmutableVector);
+ARGINFO_CALLABLE_OPTIONAL_ZVAL(         ImmutableVector_reduce, callback, initial);
+ARGINFO_NONE_RETURN_DS(                 ImmutableVector_reversed, ImmutableVector);
+ARGINFO_LONG_OPTIONAL_LONG_RETURN_DS(   ImmutableVector_slice, index, length, ImmutableVector);
+ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(    ImmutableVector_sorted, comparator, ImmutableVector);
+ARGINFO_NONE(                           ImmutableVector_sum);
+ARGINFO_NONE_RETURN_DS(                 ImmutableVector_toVector, Vector);
+ARGINFO_NONE_RETURN_DS(                 ImmutableVector_stream, Stream);
+ARGINFO_ZVAL_RETURN_BOOL(               ImmutableVector_equals, other);
+
+void php_ds_register_immutable_vector();
+
+#endif
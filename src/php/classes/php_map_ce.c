@@ -5,10 +5,17 @@
 
 #include "../objects/php_vector.h"
 #include "../objects/php_map.h"
+#include "../objects/php_mapped.h"
+#include "../objects/php_immutable_map.h"
 #include "../objects/php_pair.h"
 #include "../objects/php_set.h"
+#include "../objects/php_stream.h"
+#include "../objects/php_map_view.h"
+#include "../../ds/ds_binary.h"
+#include "../../ds/ds_json.h"
 
 #include "../iterators/php_map_iterator.h"
+#include "../handlers/php_common_handlers.h"
 #include "../handlers/php_map_handlers.h"
 
 #include "php_collection_ce.h"
@@ -33,6 +40,12 @@ METHOD(allocate)
     ds_map_allocate(THIS_DS_MAP(), capacity);
 }
 
+METHOD(shrinkToFit)
+{
+    PARSE_NONE;
+    ds_map_shrink_to_fit(THIS_DS_MAP());
+}
+
 METHOD(apply)
 {
     PARSE_CALLABLE();
@@ -51,6 +64,43 @@ METHOD(put)
     ds_map_put(THIS_DS_MAP(), key, value);
 }
 
+METHOD(putIfAbsent)
+{
+    PARSE_ZVAL_ZVAL(key, value);
+    ds_map_put_if_absent(THIS_DS_MAP(), key, value, return_value);
+}
+
+METHOD(compute)
+{
+    PARSE_ZVAL_AND_CALLABLE(key);
+    ds_map_compute(THIS_DS_MAP(), key, FCI_ARGS, return_value);
+}
+
+METHOD(computeIfAbsent)
+{
+    PARSE_ZVAL_AND_CALLABLE(key);
+    ds_map_compute_if_absent(THIS_DS_MAP(), key, FCI_ARGS, return_value);
+}
+
+METHOD(increment)
+{
+    zval one;
+    PARSE_ZVAL_OPTIONAL_ZVAL(key, by);
+
+    if ( ! by) {
+        ZVAL_LONG(&one, 1);
+        by = &one;
+    }
+
+    ds_map_increment(THIS_DS_MAP(), key, by, return_value);
+}
+
+METHOD(append)
+{
+    PARSE_ZVAL_ZVAL(key, value);
+    ds_map_append(THIS_DS_MAP(), key, value);
+}
+
 METHOD(putAll)
 {
     PARSE_ZVAL(values);
@@ -63,6 +113,12 @@ METHOD(get)
     RETURN_ZVAL_COPY(ds_map_get(THIS_DS_MAP(), key, def));
 }
 
+METHOD(getAll)
+{
+    PARSE_ZVAL_OPTIONAL_ZVAL(keys, def);
+    RETURN_DS_MAP(ds_map_get_all(THIS_DS_MAP(), keys, def));
+}
+
 METHOD(intersect)
 {
     PARSE_OBJ(obj, php_ds_map_ce);
@@ -81,6 +137,12 @@ METHOD(hasKey)
     RETURN_BOOL(ds_map_has_key(THIS_DS_MAP(), key));
 }
 
+METHOD(hasAll)
+{
+    PARSE_ZVAL(keys);
+    RETURN_BOOL(ds_map_has_all(THIS_DS_MAP(), keys));
+}
+
 METHOD(hasValue)
 {
     PARSE_ZVAL(value);
@@ -205,6 +267,12 @@ METHOD(filter)
     }
 }
 
+METHOD(freeze)
+{
+    PARSE_NONE;
+    RETURN_OBJ(php_ds_immutable_map_create_clone(THIS_DS_MAP()));
+}
+
 METHOD(first)
 {
     PARSE_NONE;
@@ -217,6 +285,12 @@ METHOD(reduce)
     ds_map_reduce(THIS_DS_MAP(), FCI_ARGS, initial, return_value);
 }
 
+METHOD(retain)
+{
+    PARSE_CALLABLE();
+    ds_map_retain(THIS_DS_MAP(), FCI_ARGS);
+}
+
 METHOD(reverse)
 {
     PARSE_NONE;
@@ -280,42 +354,165 @@ METHOD(xor)
     RETURN_DS_MAP(ds_map_xor(THIS_DS_MAP(), Z_DS_MAP_P(obj)));
 }
 
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_PAIRS, ds_htable_clone(THIS_DS_MAP()->table)));
+}
+
+METHOD(keysView)
+{
+    PARSE_NONE;
+    RETURN_DS_MAP_VIEW(ds_map_view(DS_MAP_VIEW_KEYS, getThis(), THIS_DS_MAP()->table));
+}
+
+METHOD(valuesView)
+{
+    PARSE_NONE;
+    RETURN_DS_MAP_VIEW(ds_map_view(DS_MAP_VIEW_VALUES, getThis(), THIS_DS_MAP()->table));
+}
+
+METHOD(pairsView)
+{
+    PARSE_NONE;
+    RETURN_DS_MAP_VIEW(ds_map_view(DS_MAP_VIEW_PAIRS, getThis(), THIS_DS_MAP()->table));
+}
+
+METHOD(toBinary)
+{
+    PARSE_NONE;
+    RETURN_STR(ds_binary_encode_map(THIS_DS_MAP()));
+}
+
+METHOD(fromBinary)
+{
+    PARSE_STRING();
+    RETURN_DS_MAP(ds_binary_decode_map(str, len));
+}
+
+METHOD(writeTo)
+{
+    PARSE_STREAM();
+    ds_binary_encode_map_to(THIS_DS_MAP(), stream);
+}
+
+METHOD(readFrom)
+{
+    PARSE_STREAM();
+    RETURN_DS_MAP(ds_binary_decode_map_from(stream));
+}
+
+METHOD(toMappedFile)
+{
+    PARSE_PATH();
+    ds_mapped_write_map(THIS_DS_MAP()->table, path);
+}
+
+METHOD(mapFile)
+{
+    PARSE_PATH();
+    RETURN_DS_MAPPED(ds_mapped_open(path, DS_MAPPED_MAP));
+}
+
+METHOD(toJson)
+{
+    zend_string *json;
+    PARSE_OPTIONAL_LONG_OPTIONAL_LONG(options, 0, depth, DS_JSON_DEFAULT_DEPTH);
+
+    if ((json = ds_json_encode_map(THIS_DS_MAP(), options, depth))) {
+        RETURN_STR(json);
+    }
+}
+
+METHOD(fromJson)
+{
+    PARSE_STRING_OPTIONAL_LONG(depth, DS_JSON_DEFAULT_DEPTH);
+    ds_json_decode(return_value, str, len, depth, php_ds_map_ce);
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+#if PHP_VERSION_ID >= 70400
+METHOD(__serialize)
+{
+    PARSE_NONE;
+    php_ds_map_magic_serialize(getThis(), return_value);
+}
+
+METHOD(__unserialize)
+{
+    PARSE_HASH(data);
+    php_ds_map_magic_unserialize(getThis(), data);
+}
+#endif
+
 void php_ds_register_map()
 {
     zend_class_entry ce;
 
     zend_function_entry methods[] = {
         PHP_DS_ME(Map, __construct)
+#if PHP_VERSION_ID >= 70400
+        PHP_DS_ME(Map, __serialize)
+        PHP_DS_ME(Map, __unserialize)
+#endif
         PHP_DS_ME(Map, allocate)
+        PHP_DS_ME_STATIC(Map, fromBinary)
+        PHP_DS_ME_STATIC(Map, readFrom)
+        PHP_DS_ME(Map, toMappedFile)
+        PHP_DS_ME_STATIC(Map, mapFile)
+        PHP_DS_ME(Map, toJson)
+        PHP_DS_ME_STATIC(Map, fromJson)
+        PHP_DS_ME(Map, equals)
+        PHP_DS_ME(Map, shrinkToFit)
+        PHP_DS_ME(Map, append)
         PHP_DS_ME(Map, apply)
         PHP_DS_ME(Map, capacity)
+        PHP_DS_ME(Map, compute)
+        PHP_DS_ME(Map, computeIfAbsent)
         PHP_DS_ME(Map, diff)
         PHP_DS_ME(Map, filter)
         PHP_DS_ME(Map, first)
+        PHP_DS_ME(Map, freeze)
         PHP_DS_ME(Map, get)
+        PHP_DS_ME(Map, getAll)
         PHP_DS_ME(Map, hasKey)
+        PHP_DS_ME(Map, hasAll)
         PHP_DS_ME(Map, hasValue)
+        PHP_DS_ME(Map, increment)
         PHP_DS_ME(Map, intersect)
         PHP_DS_ME(Map, keys)
+        PHP_DS_ME(Map, keysView)
         PHP_DS_ME(Map, ksort)
         PHP_DS_ME(Map, ksorted)
         PHP_DS_ME(Map, last)
         PHP_DS_ME(Map, map)
         PHP_DS_ME(Map, merge)
         PHP_DS_ME(Map, pairs)
+        PHP_DS_ME(Map, pairsView)
         PHP_DS_ME(Map, put)
         PHP_DS_ME(Map, putAll)
+        PHP_DS_ME(Map, putIfAbsent)
         PHP_DS_ME(Map, reduce)
         PHP_DS_ME(Map, remove)
+        PHP_DS_ME(Map, retain)
         PHP_DS_ME(Map, reverse)
         PHP_DS_ME(Map, reversed)
         PHP_DS_ME(Map, skip)
         PHP_DS_ME(Map, slice)
         PHP_DS_ME(Map, sort)
         PHP_DS_ME(Map, sorted)
+        PHP_DS_ME(Map, stream)
         PHP_DS_ME(Map, sum)
+        PHP_DS_ME(Map, toBinary)
+        PHP_DS_ME(Map, writeTo)
         PHP_DS_ME(Map, union)
         PHP_DS_ME(Map, values)
+        PHP_DS_ME(Map, valuesView)
         PHP_DS_ME(Map, xor)
 
         PHP_DS_COLLECTION_ME_LIST(Map)
@@ -9,14 +9,23 @@ extern zend_class_entry *php_ds_map_ce;
 
 ARGINFO_OPTIONAL_ZVAL(                      Map___construct, values);
 ARGINFO_LONG(                               Map_allocate, capacity);
+ARGINFO_NONE(                               Map_shrinkToFit);
 ARGINFO_CALLABLE(                           Map_apply, callback);
 ARGINFO_NONE_RETURN_LONG(                   Map_capacity);
 ARGINFO_ZVAL_ZVAL(                          Map_put, key, value);
+ARGINFO_ZVAL_ZVAL(                          Map_putIfAbsent, key, value);
+ARGINFO_ZVAL_CALLABLE(                      Map_compute, key, callback);
+ARGINFO_ZVAL_CALLABLE(                      Map_computeIfAbsent, key, callback);
+ARGINFO_ZVAL_OPTIONAL_ZVAL(                 Map_increment, key, by);
+ARGINFO_ZVAL_ZVAL(                          Map_append, key, value);
 ARGINFO_ZVAL(                               Map_putAll, values);
 ARGINFO_ZVAL_OPTIONAL_ZVAL(                 Map_get, key, default);
+ARGINFO_ZVAL_OPTIONAL_ZVAL_RETURN_DS(       Map_getAll, keys, default, Map);
 ARGINFO_DS_RETURN_DS(                       Map_intersect, map, Map, Map);
 ARGINFO_ZVAL_OPTIONAL_ZVAL(                 Map_remove, key, default);
+ARGINFO_CALLABLE(                           Map_retain, callback);
 ARGINFO_ZVAL_RETURN_BOOL(                   Map_hasKey, key);
+ARGINFO_ZVAL_RETURN_BOOL(                   Map_hasAll, keys);
 ARGINFO_ZVAL_RETURN_BOOL(                   Map_hasValue, value);
 ARGINFO_DS_RETURN_DS(                       Map_diff, map, Map, Map);
 ARGINFO_OPTIONAL_CALLABLE(                  Map_sort, comparator);
@@ -24,11 +33,14 @@ ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(        Map_sorted, comparator, Map);
 ARGINFO_OPTIONAL_CALLABLE(                  Map_ksort, comparator);
 ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(        Map_ksorted, comparator, Map);
 ARGINFO_NONE_RETURN_DS(                     Map_keys, Set);
+ARGINFO_NONE_RETURN_DS(                     Map_keysView, MapView);
 ARGINFO_NONE_RETURN_DS(                     Map_last, Pair);
 ARGINFO_ZVAL_RETURN_DS(                     Map_merge, values, Map);
 ARGINFO_NONE_RETURN_DS(                     Map_pairs, Sequence);
+ARGINFO_NONE_RETURN_DS(                     Map_pairsView, MapView);
 ARGINFO_NONE(                               Map_jsonSerialize);
 ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(        Map_filter, callback, Map);
+ARGINFO_NONE_RETURN_DS(                     Map_freeze, ImmutableMap);
 ARGINFO_NONE_RETURN_DS(                     Map_first, Pair);
 ARGINFO_CALLABLE_OPTIONAL_ZVAL(             Map_reduce, callback, initial);
 ARGINFO_NONE(                               Map_reverse);
@@ -39,7 +51,23 @@ ARGINFO_LONG_OPTIONAL_LONG_RETURN_DS(       Map_slice, index, length, Map);
 ARGINFO_NONE(                               Map_sum);
 ARGINFO_ZVAL_RETURN_DS(                     Map_union, map, Map);
 ARGINFO_NONE_RETURN_DS(                     Map_values, Sequence);
+ARGINFO_NONE_RETURN_DS(                     Map_valuesView, MapView);
 ARGINFO_DS_RETURN_DS(                       Map_xor, map, Map, Map);
+ARGINFO_NONE_RETURN_DS(                     Map_stream, Stream);
+ARGINFO_NONE_RETURN_STRING(                 Map_toBinary);
+ARGINFO_STRING_RETURN_DS(                   Map_fromBinary, data, Map);
+ARGINFO_ZVAL(                               Map_writeTo, stream);
+ARGINFO_ZVAL_RETURN_DS(                     Map_readFrom, stream, Map);
+ARGINFO_STRING(                             Map_toMappedFile, path);
+ARGINFO_STRING_RETURN_DS(                   Map_mapFile, path, MappedMap);
+ARGINFO_OPTIONAL_LONG_OPTIONAL_LONG_RETURN_STRING(Map_toJson, options, depth);
+ARGINFO_STRING_OPTIONAL_LONG_RETURN_DS(     Map_fromJson, json, depth, Map);
+ARGINFO_ZVAL_RETURN_BOOL(                   Map_equals, other);
+
+#if PHP_VERSION_ID >= 70400
+ARGINFO_NONE_RETURN_ARRAY(                  Map___serialize);
+ARGINFO_ARRAY(                              Map___unserialize, data);
+#endif
 
 void php_ds_register_map();
 
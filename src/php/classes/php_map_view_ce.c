@@ -0,0 +1,83 @@
+#include "../../common.h"
+
+#include "../parameters.h"
+#include "../arginfo.h"
+
+#include "../objects/php_map_view.h"
+#include "../iterators/php_map_view_iterator.h"
+#include "../handlers/php_map_view_handlers.h"
+
+#include "php_collection_ce.h"
+#include "php_map_view_ce.h"
+
+#define METHOD(name) PHP_METHOD(MapView, name)
+
+zend_class_entry *php_ds_map_view_ce;
+
+METHOD(clear)
+{
+    PARSE_NONE;
+
+    // A view is read-only, the map has to be cleared instead.
+    MUTABILITY_NOT_ALLOWED();
+}
+
+METHOD(contains)
+{
+    PARSE_VARIADIC_ZVAL();
+    RETURN_BOOL(ds_map_view_contains_va(THIS_DS_MAP_VIEW(), argc, argv));
+}
+
+METHOD(copy)
+{
+    PARSE_NONE;
+    ds_map_view_copy(THIS_DS_MAP_VIEW(), return_value);
+}
+
+METHOD(count)
+{
+    PARSE_NONE;
+    RETURN_LONG(DS_MAP_VIEW_SIZE(THIS_DS_MAP_VIEW()));
+}
+
+METHOD(isEmpty)
+{
+    PARSE_NONE;
+    RETURN_BOOL(DS_MAP_VIEW_IS_EMPTY(THIS_DS_MAP_VIEW()));
+}
+
+METHOD(jsonSerialize)
+{
+    PARSE_NONE;
+    ds_map_view_to_array(THIS_DS_MAP_VIEW(), return_value);
+}
+
+METHOD(toArray)
+{
+    PARSE_NONE;
+    ds_map_view_to_array(THIS_DS_MAP_VIEW(), return_value);
+}
+
+void php_ds_register_map_view()
+{
+    zend_class_entry ce;
+
+    zend_function_entry methods[] = {
+        PHP_DS_ME(MapView, contains)
+
+        PHP_DS_COLLECTION_ME_LIST(MapView)
+        PHP_FE_END
+    };
+
+    INIT_CLASS_ENTRY(ce, PHP_DS_NS(MapView), methods);
+
+    php_ds_map_view_ce = zend_register_internal_class(&ce);
+    php_ds_map_view_ce->ce_flags      |= ZEND_ACC_FINAL;
+    php_ds_map_view_ce->create_object  = php_ds_map_view_create_object;
+    php_ds_map_view_ce->get_iterator   = php_ds_map_view_get_iterator;
+    php_ds_map_view_ce->serialize      = zend_class_serialize_deny;
+    php_ds_map_view_ce->unserialize    = zend_class_unserialize_deny;
+
+    zend_class_implements(php_ds_map_view_ce, 1, collection_ce);
+    php_register_map_view_handlers();
+}
@@ -0,0 +1,14 @@
+#ifndef DS_MAP_VIEW_CE_H
+#define DS_MAP_VIEW_CE_H
+
+#include "php.h"
+#include "../../common.h"
+#include "../arginfo.h"
+
+extern zend_class_entry *php_ds_map_view_ce;
+
+ARGINFO_VARIADIC_ZVAL_RETURN_BOOL(  MapView_contains, values);
+
+void php_ds_register_map_view();
+
+#endif
@@ -0,0 +1,119 @@
+#include "../../common.h"
+
+#include "../parameters.h"
+#include "../arginfo.h"
+
+#include "../objects/php_mapped.h"
+#include "../objects/php_map.h"
+#include "../iterators/php_mapped_iterator.h"
+#include "../handlers/php_mapped_handlers.h"
+
+#include "php_collection_ce.h"
+#include "php_mapped_map_ce.h"
+
+#define METHOD(name) PHP_METHOD(MappedMap, name)
+
+zend_class_entry *php_ds_mapped_map_ce;
+
+METHOD(clear)
+{
+    PARSE_NONE;
+    MUTABILITY_NOT_ALLOWED();
+}
+
+METHOD(copy)
+{
+    PARSE_NONE;
+
+    // There's no need to copy something that can't be changed.
+    ZVAL_COPY(return_value, getThis());
+}
+
+METHOD(count)
+{
+    PARSE_NONE;
+    RETURN_LONG(DS_MAPPED_SIZE(THIS_DS_MAPPED()));
+}
+
+METHOD(get)
+{
+    PARSE_ZVAL_OPTIONAL_ZVAL(key, def);
+
+    if (ds_mapped_lookup(THIS_DS_MAPPED(), key, return_value)) {
+        return;
+    }
+
+    if (def) {
+        RETURN_ZVAL_COPY(def);
+    }
+
+    KEY_NOT_FOUND();
+}
+
+METHOD(hasKey)
+{
+    zval value;
+    bool found;
+
+    PARSE_ZVAL(key);
+
+    found = ds_mapped_lookup(THIS_DS_MAPPED(), key, &value);
+
+    if (found) {
+        zval_ptr_dtor(&value);
+    }
+
+    RETURN_BOOL(found);
+}
+
+METHOD(isEmpty)
+{
+    PARSE_NONE;
+    RETURN_BOOL(DS_MAPPED_IS_EMPTY(THIS_DS_MAPPED()));
+}
+
+METHOD(jsonSerialize)
+{
+    PARSE_NONE;
+    ds_mapped_to_array(THIS_DS_MAPPED(), return_value);
+}
+
+METHOD(toArray)
+{
+    PARSE_NONE;
+    ds_mapped_to_array(THIS_DS_MAPPED(), return_value);
+}
+
+METHOD(toMap)
+{
+    PARSE_NONE;
+    RETURN_DS_MAP(ds_mapped_to_map(THIS_DS_MAPPED()));
+}
+
+void php_ds_register_mapped_map()
+{
+    zend_class_entry ce;
+
+    zend_function_entry methods[] = {
+        PHP_DS_ME(MappedMap, get)
+        PHP_DS_ME(MappedMap, hasKey)
+        PHP_DS_ME(MappedMap, toMap)
+
+        PHP_DS_COLLECTION_ME_LIST(MappedMap)
+        PHP_FE_END
+    };
+
+    INIT_CLASS_ENTRY(ce, PHP_DS_NS(MappedMap), methods);
+
+    php_ds_mapped_map_ce = zend_register_internal_class(&ce);
+    php_ds_mapped_map_ce->ce_flags      |= ZEND_ACC_FINAL;
+    php_ds_mapped_map_ce->create_object  = php_ds_mapped_map_create_object;
+    php_ds_mapped_map_ce->get_iterator   = php_ds_mapped_get_iterator;
+    php_ds_mapped_map_ce->serialize      = zend_class_serialize_deny;
+    php_ds_mapped_map_ce->unserialize    = zend_class_unserialize_deny;
+
+    zend_class_implements(php_ds_mapped_map_ce, 1, collection_ce);
+
+    // Both classes share the same handlers, so they're registered once here.
+    php_register_mapped_handlers();
+}
@@ -0,0 +1,16 @@
+#ifndef DS_MAPPED_MAP_CE_H
+#define DS_MAPPED_MAP_CE_H
+
+#include "php.h"
+#include "../../common.h"
+#include "../arginfo.h"
+
+extern zend_class_entry *php_ds_mapped_map_ce;
+
+ARGINFO_ZVAL_OPTIONAL_ZVAL(     MappedMap_get, key, default);
+ARGINFO_ZVAL_RETURN_BOOL(       MappedMap_hasKey, key);
+ARGINFO_NONE_RETURN_DS(         MappedMap_toMap, Map);
+
+void php_ds_register_mapped_map();
+
+#endif
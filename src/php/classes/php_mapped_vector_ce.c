@@ -0,0 +1,98 @@
+#include "../../common.h"
+
+#include "../parameters.h"
+#include "../arginfo.h"
+
+#include "../objects/php_mapped.h"
+#include "../objects/php_vector.h"
+#include "../iterators/php_mapped_iterator.h"
+#include "../handlers/php_mapped_handlers.h"
+
+#include "php_collection_ce.h"
+#include "php_mapped_vector_ce.h"
+
+#define METHOD(name) PHP_METHOD(MappedVector, name)
+
+zend_class_entry *php_ds_mapped_vector_ce;
+
+METHOD(clear)
+{
+    PARSE_NONE;
+    MUTABILITY_NOT_ALLOWED();
+}
+
+METHOD(copy)
+{
+    PARSE_NONE;
+
+    // There's no need to copy something that can't be changed.
+    ZVAL_COPY(return_value, getThis());
+}
+
+METHOD(count)
+{
+    PARSE_NONE;
+    RETURN_LONG(DS_MAPPED_SIZE(THIS_DS_MAPPED()));
+}
+
+METHOD(get)
+{
+    ds_mapped_t *mapped = THIS_DS_MAPPED();
+
+    PARSE_LONG(index);
+
+    if (index < 0 || index >= mapped->size) {
+        INDEX_OUT_OF_RANGE(index, mapped->size);
+        return;
+    }
+
+    ds_mapped_get_value(mapped, index, return_value);
+}
+
+METHOD(isEmpty)
+{
+    PARSE_NONE;
+    RETURN_BOOL(DS_MAPPED_IS_EMPTY(THIS_DS_MAPPED()));
+}
+
+METHOD(jsonSerialize)
+{
+    PARSE_NONE;
+    ds_mapped_to_array(THIS_DS_MAPPED(), return_value);
+}
+
+METHOD(toArray)
+{
+    PARSE_NONE;
+    ds_mapped_to_array(THIS_DS_MAPPED(), return_value);
+}
+
+METHOD(toVector)
+{
+    PARSE_NONE;
+    RETURN_DS_VECTOR(ds_mapped_to_vector(THIS_DS_MAPPED()));
+}
+
+void php_ds_register_mapped_vector()
+{
+    zend_class_entry ce;
+
+    zend_function_entry methods[] = {
+        PHP_DS_ME(MappedVector, get)
+        PHP_DS_ME(MappedVector, toVector)
+
+        PHP_DS_COLLECTION_ME_LIST(MappedVector)
+        PHP_FE_END
+    };
+
+    INIT_CLASS_ENTRY(ce, PHP_DS_NS(MappedVector), methods);
+
+    php_ds_mapped_vector_ce = zend_register_internal_class(&ce);
+    php_ds_mapped_vector_ce->ce_flags      |= ZEND_ACC_FINAL;
+    php_ds_mapped_vector_ce->create_object  = php_ds_mapped_vector_create_object;
+    php_ds_mapped_vector_ce->get_iterator   = php_ds_mapped_get_iterator;
+    php_ds_mapped_vector_ce->serialize      = zend_class_serialize_deny;
+    php_ds_mapped_vector_ce->unserialize    = zend_class_unserialize_deny;
+
+    zend_class_implements(php_ds_mapped_vector_ce, 1, collection_ce);
+}
@@ -0,0 +1,15 @@
+#ifndef DS_MAPPED_VECTOR_CE_H
+#define DS_MAPPED_VECTOR_CE_H
+
+#include "php.h"
+#include "../../common.h"
+#include "../arginfo.h"
+
+extern zend_class_entry *php_ds_mapped_vector_ce;
+
+ARGINFO_LONG(                   MappedVector_get, index);
+ARGINFO_NONE_RETURN_DS(         MappedVector_toVector, Vector);
+
+void php_ds_register_mapped_vector();
+
+#endif
@@ -4,6 +4,7 @@
 #include "../arginfo.h"
 
 #include "../objects/php_pair.h"
+#include "../handlers/php_common_handlers.h"
 #include "../handlers/php_pair_handlers.h"
 
 #include "php_pair_ce.h"
@@ -50,13 +51,38 @@ METHOD(jsonSerialize)
     ds_pair_to_array(THIS_DS_PAIR(), return_value);
 }
 
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+#if PHP_VERSION_ID >= 70400
+METHOD(__serialize)
+{
+    PARSE_NONE;
+    php_ds_pair_magic_serialize(getThis(), return_value);
+}
+
+METHOD(__unserialize)
+{
+    PARSE_HASH(data);
+    php_ds_pair_magic_unserialize(getThis(), data);
+}
+#endif
+
 void php_ds_register_pair()
 {
     zend_class_entry ce;
 
     zend_function_entry methods[] = {
         PHP_DS_ME(Pair, __construct)
+#if PHP_VERSION_ID >= 70400
+        PHP_DS_ME(Pair, __serialize)
+        PHP_DS_ME(Pair, __unserialize)
+#endif
         PHP_DS_ME(Pair, copy)
+        PHP_DS_ME(Pair, equals)
         PHP_DS_ME(Pair, jsonSerialize)
         PHP_DS_ME(Pair, toArray)
         PHP_FE_END
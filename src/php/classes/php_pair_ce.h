@@ -11,6 +11,12 @@ ARGINFO_OPTIONAL_ZVAL_OPTIONAL_ZVAL(    Pair___construct, key, value);
 ARGINFO_NONE_RETURN_DS(                 Pair_copy, Pair);
 ARGINFO_NONE_RETURN_ARRAY(              Pair_toArray);
 ARGINFO_NONE(                           Pair_jsonSerialize);
+ARGINFO_ZVAL_RETURN_BOOL(               Pair_equals, other);
+
+#if PHP_VERSION_ID >= 70400
+ARGINFO_NONE_RETURN_ARRAY(              Pair___serialize);
+ARGINFO_ARRAY(                          Pair___unserialize, data);
+#endif
 
 void php_ds_register_pair();
 
@@ -0,0 +1,192 @@
+#include "../../common.h"
+
+#include "../parameters.h"
+#include "../arginfo.h"
+
+#include "../objects/php_map.h"
+#include "../objects/php_persistent_map.h"
+#include "../objects/php_stream.h"
+#include "../iterators/php_persistent_map_iterator.h"
+#include "../handlers/php_persistent_map_handlers.h"
+
+#include "php_collection_ce.h"
+#include "php_persistent_map_ce.h"
+
+#define METHOD(name) PHP_METHOD(PersistentMap, name)
+
+zend_class_entry *php_ds_persistent_map_ce;
+
+METHOD(__construct)
+{
+    php_ds_persistent_map_t *obj = (php_ds_persistent_map_t *) Z_OBJ_P(getThis());
+
+    PARSE_OPTIONAL_ZVAL(values);
+
+    if (obj->constructed) {
+        RECONSTRUCTION_NOT_ALLOWED();
+        return;
+    }
+
+    if (values) {
+        ds_persistent_map_put_all(obj->map, values);
+    }
+
+    obj->constructed = true;
+}
+
+METHOD(clear)
+{
+    PARSE_NONE;
+    MUTABILITY_NOT_ALLOWED();
+}
+
+METHOD(copy)
+{
+    PARSE_NONE;
+
+    // There's no need to copy something that can't be changed.
+    ZVAL_COPY(return_value, getThis());
+}
+
+METHOD(count)
+{
+    PARSE_NONE;
+    RETURN_LONG(DS_PERSISTENT_MAP_SIZE(THIS_DS_PERSISTENT_MAP()));
+}
+
+METHOD(get)
+{
+    PARSE_ZVAL_OPTIONAL_ZVAL(key, def);
+    RETURN_ZVAL_COPY(ds_persistent_map_get(THIS_DS_PERSISTENT_MAP(), key, def));
+}
+
+METHOD(hasKey)
+{
+    PARSE_ZVAL(key);
+    RETURN_BOOL(ds_persistent_map_has_key(THIS_DS_PERSISTENT_MAP(), key));
+}
+
+METHOD(isEmpty)
+{
+    PARSE_NONE;
+    RETURN_BOOL(DS_PERSISTENT_MAP_IS_EMPTY(THIS_DS_PERSISTENT_MAP()));
+}
+
+METHOD(jsonSerialize)
+{
+    PARSE_NONE;
+    ds_persistent_map_to_array(THIS_DS_PERSISTENT_MAP(), return_value);
+}
+
+METHOD(put)
+{
+    ds_persistent_map_t *map;
+
+    PARSE_ZVAL_ZVAL(key, value);
+
+    map = ds_persistent_map_clone(THIS_DS_PERSISTENT_MAP());
+    ds_persistent_map_put(map, key, value);
+
+    if (EG(exception)) {
+        ds_persistent_map_free(map);
+        return;
+    }
+
+    RETURN_DS_PERSISTENT_MAP(map);
+}
+
+METHOD(putAll)
+{
+    ds_persistent_map_t *map;
+
+    PARSE_ZVAL(values);
+
+    // Only the first put copies shared nodes, the rest change the copies.
+    map = ds_persistent_map_clone(THIS_DS_PERSISTENT_MAP());
+    ds_persistent_map_put_all(map, values);
+
+    if (EG(exception)) {
+        ds_persistent_map_free(map);
+        return;
+    }
+
+    RETURN_DS_PERSISTENT_MAP(map);
+}
+
+METHOD(remove)
+{
+    ds_persistent_map_t *map;
+
+    PARSE_ZVAL(key);
+
+    // Removing a key that doesn't exist returns the same version.
+    if ( ! ds_persistent_map_has_key(THIS_DS_PERSISTENT_MAP(), key)) {
+        ZVAL_COPY(return_value, getThis());
+        return;
+    }
+
+    map = ds_persistent_map_clone(THIS_DS_PERSISTENT_MAP());
+    ds_persistent_map_remove(map, key, NULL);
+    RETURN_DS_PERSISTENT_MAP(map);
+}
+
+METHOD(toArray)
+{
+    PARSE_NONE;
+    ds_persistent_map_to_array(THIS_DS_PERSISTENT_MAP(), return_value);
+}
+
+METHOD(toMap)
+{
+    ds_map_t *map = ds_map();
+    zval *key;
+    zval *value;
+
+    PARSE_NONE;
+
+    ds_htable_ensure_capacity(map->table, DS_PERSISTENT_MAP_SIZE(THIS_DS_PERSISTENT_MAP()));
+
+    DS_PERSISTENT_MAP_FOREACH_KEY_VALUE(THIS_DS_PERSISTENT_MAP(), key, value) {
+        ds_htable_put(map->table, key, value);
+    }
+    DS_PERSISTENT_MAP_FOREACH_END();
+
+    RETURN_DS_MAP(map);
+}
+
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_PERSISTENT_MAP, ds_persistent_map_clone(THIS_DS_PERSISTENT_MAP())));
+}
+
+void php_ds_register_persistent_map()
+{
+    zend_class_entry ce;
+
+    zend_function_entry methods[] = {
+        PHP_DS_ME(PersistentMap, __construct)
+        PHP_DS_ME(PersistentMap, get)
+        PHP_DS_ME(PersistentMap, hasKey)
+        PHP_DS_ME(PersistentMap, put)
+        PHP_DS_ME(PersistentMap, putAll)
+        PHP_DS_ME(PersistentMap, remove)
+        PHP_DS_ME(PersistentMap, stream)
+        PHP_DS_ME(PersistentMap, toMap)
+
+        PHP_DS_COLLECTION_ME_LIST(PersistentMap)
+        PHP_FE_END
+    };
+
+    INIT_CLASS_ENTRY(ce, PHP_DS_NS(PersistentMap), methods);
+
+    php_ds_persistent_map_ce = zend_register_internal_class(&ce);
+    php_ds_persistent_map_ce->ce_flags      |= ZEND_ACC_FINAL;
+    php_ds_persistent_map_ce->create_object  = php_ds_persistent_map_create_object;
+    php_ds_persistent_map_ce->get_iterator   = php_ds_persistent_map_get_iterator;
+    php_ds_persistent_map_ce->serialize      = php_ds_persistent_map_serialize;
+    php_ds_persistent_map_ce->unserialize    = php_ds_persistent_map_unserialize;
+
+    zend_class_implements(php_ds_persistent_map_ce, 1, collection_ce);
+    php_register_persistent_map_handlers();
+}
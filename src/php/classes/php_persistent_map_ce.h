@@ -0,0 +1,21 @@
+#ifndef DS_PERSISTENT_MAP_CE_H
+#define DS_PERSISTENT_MAP_CE_H
+
+#include "php.h"
+#include "../../common.h"
+#include "../arginfo.h"
+
+extern zend_class_entry *php_ds_persistent_map_ce;
+
+ARGINFO_OPTIONAL_ZVAL(          PersistentMap___construct, values);
+ARGINFO_ZVAL_OPTIONAL_ZVAL(     PersistentMap_get, key, default);
+ARGINFO_ZVAL_RETURN_BOOL(       PersistentMap_hasKey, key);
+ARGINFO_ZVAL_ZVAL(              PersistentMap_put, key, value);
+ARGINFO_ZVAL_RETURN_DS(         PersistentMap_putAll, values, PersistentMap);
+ARGINFO_ZVAL_RETURN_DS(         PersistentMap_remove, key, PersistentMap);
+ARGINFO_NONE_RETURN_DS(         PersistentMap_toMap, Map);
+ARGINFO_NONE_RETURN_DS(         PersistentMap_stream, Stream);
+
+void php_ds_register_persistent_map();
+
+#endif
@@ -0,0 +1,213 @@
+#include "../../common.h"
+
+#include "../parameters.h"
+#include "../arginfo.h"
+
+#include "../objects/php_vector.h"
+#include "../objects/php_persistent_vector.h"
+#include "../objects/php_stream.h"
+#include "../iterators/php_persistent_vector_iterator.h"
+#include "../handlers/php_persistent_vector_handlers.h"
+
+#include "php_collection_ce.h"
+#include "php_persistent_vector_ce.h"
+
+#define METHOD(name) PHP_METHOD(PersistentVector, name)
+
+zend_class_entry *php_ds_persistent_vector_ce;
+
+METHOD(__construct)
+{
+    php_ds_persistent_vector_t *obj = (php_ds_persistent_vector_t *) Z_OBJ_P(getThis());
+
+    PARSE_OPTIONAL_ZVAL(values);
+
+    if (obj->constructed) {
+        RECONSTRUCTION_NOT_ALLOWED();
+        return;
+    }
+
+    if (values) {
+        ds_persistent_vector_push_all(obj->vector, values);
+    }
+
+    obj->constructed = true;
+}
+
+METHOD(clear)
+{
+    PARSE_NONE;
+    MUTABILITY_NOT_ALLOWED();
+}
+
+METHOD(copy)
+{
+    PARSE_NONE;
+
+    // There's no need to copy something that can't be changed.
+    ZVAL_COPY(return_value, getThis());
+}
+
+METHOD(count)
+{
+    PARSE_NONE;
+    RETURN_LONG(DS_PERSISTENT_VECTOR_SIZE(THIS_DS_PERSISTENT_VECTOR()));
+}
+
+METHOD(first)
+{
+    ds_persistent_vector_t *vector = THIS_DS_PERSISTENT_VECTOR();
+
+    PARSE_NONE;
+
+    if (DS_PERSISTENT_VECTOR_IS_EMPTY(vector)) {
+        NOT_ALLOWED_WHEN_EMPTY();
+        return;
+    }
+
+    RETURN_ZVAL_COPY(ds_persistent_vector_get(vector, 0));
+}
+
+METHOD(get)
+{
+    PARSE_LONG(index);
+    RETURN_ZVAL_COPY(ds_persistent_vector_get(THIS_DS_PERSISTENT_VECTOR(), index));
+}
+
+METHOD(isEmpty)
+{
+    PARSE_NONE;
+    RETURN_BOOL(DS_PERSISTENT_VECTOR_IS_EMPTY(THIS_DS_PERSISTENT_VECTOR()));
+}
+
+METHOD(jsonSerialize)
+{
+    PARSE_NONE;
+    ds_persistent_vector_to_array(THIS_DS_PERSISTENT_VECTOR(), return_value);
+}
+
+METHOD(last)
+{
+    ds_persistent_vector_t *vector = THIS_DS_PERSISTENT_VECTOR();
+
+    PARSE_NONE;
+
+    if (DS_PERSISTENT_VECTOR_IS_EMPTY(vector)) {
+        NOT_ALLOWED_WHEN_EMPTY();
+        return;
+    }
+
+    RETURN_ZVAL_COPY(ds_persistent_vector_get(vector, vector->size - 1));
+}
+
+METHOD(pop)
+{
+    ds_persistent_vector_t *vector = THIS_DS_PERSISTENT_VECTOR();
+
+    PARSE_NONE;
+
+    if (DS_PERSISTENT_VECTOR_IS_EMPTY(vector)) {
+        NOT_ALLOWED_WHEN_EMPTY();
+        return;
+    }
+
+    vector = ds_persistent_vector_clone(vector);
+    ds_persistent_vector_pop(vector, NULL);
+    RETURN_DS_PERSISTENT_VECTOR(vector);
+}
+
+METHOD(push)
+{
+    ds_persistent_vector_t *vector;
+    int index;
+
+    PARSE_VARIADIC_ZVAL();
+
+    // Only the first push copies shared nodes, the rest change the copies.
+    vector = ds_persistent_vector_clone(THIS_DS_PERSISTENT_VECTOR());
+
+    for (index = 0; index < argc; index++) {
+        ds_persistent_vector_push(vector, &argv[index]);
+    }
+
+    RETURN_DS_PERSISTENT_VECTOR(vector);
+}
+
+METHOD(set)
+{
+    ds_persistent_vector_t *vector;
+
+    PARSE_LONG_AND_ZVAL(index, value);
+
+    vector = ds_persistent_vector_clone(THIS_DS_PERSISTENT_VECTOR());
+    ds_persistent_vector_set(vector, index, value);
+
+    if (EG(exception)) {
+        ds_persistent_vector_free(vector);
+        return;
+    }
+
+    RETURN_DS_PERSISTENT_VECTOR(vector);
+}
+
+METHOD(toArray)
+{
+    PARSE_NONE;
+    ds_persistent_vector_to_array(THIS_DS_PERSISTENT_VECTOR(), return_value);
+}
+
+METHOD(toVector)
+{
+    ds_persistent_vector_t *vector = THIS_DS_PERSISTENT_VECTOR();
+    ds_vector_t *result;
+    zval *value;
+
+    PARSE_NONE;
+
+    result = ds_vector_ex(vector->size);
+
+    DS_PERSISTENT_VECTOR_FOREACH(vector, value) {
+        ds_vector_push(result, value);
+    }
+    DS_PERSISTENT_VECTOR_FOREACH_END();
+
+    RETURN_DS_VECTOR(result);
+}
+
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_PERSISTENT_VECTOR, ds_persistent_vector_clone(THIS_DS_PERSISTENT_VECTOR())));
+}
+
+void php_ds_register_persistent_vector()
+{
+    zend_class_entry ce;
+
+    zend_function_entry methods[] = {
+        PHP_DS_ME(PersistentVector, __construct)
+        PHP_DS_ME(PersistentVector, first)
+        PHP_DS_ME(PersistentVector, get)
+        PHP_DS_ME(PersistentVector, last)
+        PHP_DS_ME(PersistentVector, pop)
+        PHP_DS_ME(PersistentVector, push)
+        PHP_DS_ME(PersistentVector, set)
+        PHP_DS_ME(PersistentVector, stream)
+        PHP_DS_ME(PersistentVector, toVector)
+
+        PHP_DS_COLLECTION_ME_LIST(PersistentVector)
+        PHP_FE_END
+    };
+
+    INIT_CLASS_ENTRY(ce, PHP_DS_NS(PersistentVector), methods);
+
+    php_ds_persistent_vector_ce = zend_register_internal_class(&ce);
+    php_ds_persistent_vector_ce->ce_flags      |= ZEND_ACC_FINAL;
+    php_ds_persistent_vector_ce->create_object  = php_ds_persistent_vector_create_object;
+    php_ds_persistent_vector_ce->get_iterator   = php_ds_persistent_vector_get_iterator;
+    php_ds_persistent_vector_ce->serialize      = php_ds_persistent_vector_serialize;
+    php_ds_persistent_vector_ce->unserialize    = php_ds_persistent_vector_unserialize;
+
+    zend_class_implements(php_ds_persistent_vector_ce, 1, collection_ce);
+    php_register_persistent_vector_handlers();
+}
@@ -0,0 +1,22 @@
+#ifndef DS_PERSISTENT_VECTOR_CE_H
+#define DS_PERSISTENT_VECTOR_CE_H
+
+#include "php.h"
+#include "../../common.h"
+#include "../arginfo.h"
+
+extern zend_class_entry *php_ds_persistent_vector_ce;
+
+ARGINFO_OPTIONAL_ZVAL(          PersistentVector___construct, values);
+ARGINFO_NONE(                   PersistentVector_first);
+ARGINFO_LONG(                   PersistentVector_get, index);
+ARGINFO_NONE(                   PersistentVector_last);
+ARGINFO_NONE_RETURN_DS(         PersistentVector_pop, PersistentVector);
+ARGINFO_VARIADIC_ZVAL(          PersistentVector_push, values);
+ARGINFO_LONG_ZVAL(              PersistentVector_set, index, value);
+ARGINFO_NONE_RETURN_DS(         PersistentVector_toVector, Vector);
+ARGINFO_NONE_RETURN_DS(         PersistentVector_stream, Stream);
+
+void php_ds_register_persistent_vector();
+
+#endif
@@ -4,8 +4,11 @@
 #include "../arginfo.h"
 
 #include "../iterators/php_priority_queue_iterator.h"
+#include "../handlers/php_common_handlers.h"
 #include "../handlers/php_priority_queue_handlers.h"
 #include "../objects/php_priority_queue.h"
+#include "../objects/php_stream.h"
+#include "../../ds/ds_binary.h"
 
 #include "php_collection_ce.h"
 #include "php_priority_queue_ce.h"
@@ -25,6 +28,12 @@ METHOD(allocate)
     ds_priority_queue_allocate(THIS_DS_PRIORITY_QUEUE(), capacity);
 }
 
+METHOD(shrinkToFit)
+{
+    PARSE_NONE;
+    ds_priority_queue_shrink_to_fit(THIS_DS_PRIORITY_QUEUE());
+}
+
 METHOD(capacity)
 {
     PARSE_NONE;
@@ -85,17 +94,89 @@ METHOD(jsonSerialize)
     ds_priority_queue_to_array(THIS_DS_PRIORITY_QUEUE(), return_value);
 }
 
+METHOD(stream)
+{
+    ds_vector_t *vector;
+    zval values;
+
+    PARSE_NONE;
+
+    // The heap can't be traversed in order without popping, so the stream
+    // is over a vector of the values in the order that they would be popped.
+    ds_priority_queue_to_array(THIS_DS_PRIORITY_QUEUE(), &values);
+    vector = ds_vector_ex(zend_hash_num_elements(Z_ARRVAL(values)));
+    ds_vector_push_all(vector, &values);
+    zval_ptr_dtor(&values);
+
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_VECTOR, vector));
+}
+
+METHOD(toBinary)
+{
+    PARSE_NONE;
+    RETURN_STR(ds_binary_encode_priority_queue(THIS_DS_PRIORITY_QUEUE()));
+}
+
+METHOD(fromBinary)
+{
+    PARSE_STRING();
+    RETURN_DS_PRIORITY_QUEUE(ds_binary_decode_priority_queue(str, len));
+}
+
+METHOD(writeTo)
+{
+    PARSE_STREAM();
+    ds_binary_encode_priority_queue_to(THIS_DS_PRIORITY_QUEUE(), stream);
+}
+
+METHOD(readFrom)
+{
+    PARSE_STREAM();
+    RETURN_DS_PRIORITY_QUEUE(ds_binary_decode_priority_queue_from(stream));
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+#if PHP_VERSION_ID >= 70400
+METHOD(__serialize)
+{
+    PARSE_NONE;
+    php_ds_priority_queue_magic_serialize(getThis(), return_value);
+}
+
+METHOD(__unserialize)
+{
+    PARSE_HASH(data);
+    php_ds_priority_queue_magic_unserialize(getThis(), data);
+}
+#endif
+
 void php_ds_register_priority_queue()
 {
     zend_class_entry ce;
 
     zend_function_entry methods[] = {
         PHP_DS_ME(PriorityQueue, __construct)
+#if PHP_VERSION_ID >= 70400
+        PHP_DS_ME(PriorityQueue, __serialize)
+        PHP_DS_ME(PriorityQueue, __unserialize)
+#endif
         PHP_DS_ME(PriorityQueue, allocate)
+        PHP_DS_ME_STATIC(PriorityQueue, fromBinary)
+        PHP_DS_ME_STATIC(PriorityQueue, readFrom)
+        PHP_DS_ME(PriorityQueue, equals)
+        PHP_DS_ME(PriorityQueue, shrinkToFit)
         PHP_DS_ME(PriorityQueue, capacity)
         PHP_DS_ME(PriorityQueue, peek)
         PHP_DS_ME(PriorityQueue, pop)
         PHP_DS_ME(PriorityQueue, push)
+        PHP_DS_ME(PriorityQueue, stream)
+        PHP_DS_ME(PriorityQueue, toBinary)
+        PHP_DS_ME(PriorityQueue, writeTo)
 
         PHP_DS_COLLECTION_ME_LIST(PriorityQueue)
         PHP_FE_END
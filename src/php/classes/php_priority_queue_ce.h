@@ -9,11 +9,23 @@ extern zend_class_entry *php_ds_priority_queue_ce;
 
 ARGINFO_NONE(                   PriorityQueue___construct);
 ARGINFO_LONG(                   PriorityQueue_allocate, capacity);
+ARGINFO_NONE(                   PriorityQueue_shrinkToFit);
 ARGINFO_NONE_RETURN_LONG(       PriorityQueue_capacity);
 ARGINFO_NONE_RETURN_DS(         PriorityQueue_copy, PriorityQueue);
 ARGINFO_ZVAL_ZVAL(              PriorityQueue_push, value, priority);
 ARGINFO_NONE(                   PriorityQueue_pop);
 ARGINFO_NONE(                   PriorityQueue_peek);
+ARGINFO_NONE_RETURN_DS(         PriorityQueue_stream, Stream);
+ARGINFO_NONE_RETURN_STRING(     PriorityQueue_toBinary);
+ARGINFO_STRING_RETURN_DS(       PriorityQueue_fromBinary, data, PriorityQueue);
+ARGINFO_ZVAL(                   PriorityQueue_writeTo, stream);
+ARGINFO_ZVAL_RETURN_DS(         PriorityQueue_readFrom, stream, PriorityQueue);
+ARGINFO_ZVAL_RETURN_BOOL(       PriorityQueue_equals, other);
+
+#if PHP_VERSION_ID >= 70400
+ARGINFO_NONE_RETURN_ARRAY(      PriorityQueue___serialize);
+ARGINFO_ARRAY(                  PriorityQueue___unserialize, data);
+#endif
 
 void php_ds_register_priority_queue();
 
@@ -4,8 +4,11 @@
 #include "../arginfo.h"
 
 #include "../iterators/php_queue_iterator.h"
+#include "../handlers/php_common_handlers.h"
 #include "../handlers/php_queue_handlers.h"
 #include "../objects/php_queue.h"
+#include "../objects/php_stream.h"
+#include "../../ds/ds_binary.h"
 
 #include "php_collection_ce.h"
 #include "php_queue_ce.h"
@@ -29,6 +32,12 @@ METHOD(allocate)
     ds_queue_allocate(THIS_DS_QUEUE(), capacity);
 }
 
+METHOD(shrinkToFit)
+{
+    PARSE_NONE;
+    ds_queue_shrink_to_fit(THIS_DS_QUEUE());
+}
+
 METHOD(capacity)
 {
     PARSE_NONE;
@@ -89,17 +98,78 @@ METHOD(jsonSerialize)
     ds_queue_to_array(THIS_DS_QUEUE(), return_value);
 }
 
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_QUEUE, ds_queue_clone(THIS_DS_QUEUE())));
+}
+
+METHOD(toBinary)
+{
+    PARSE_NONE;
+    RETURN_STR(ds_binary_encode_queue(THIS_DS_QUEUE()));
+}
+
+METHOD(fromBinary)
+{
+    PARSE_STRING();
+    RETURN_DS_QUEUE(ds_binary_decode_queue(str, len));
+}
+
+METHOD(writeTo)
+{
+    PARSE_STREAM();
+    ds_binary_encode_queue_to(THIS_DS_QUEUE(), stream);
+}
+
+METHOD(readFrom)
+{
+    PARSE_STREAM();
+    RETURN_DS_QUEUE(ds_binary_decode_queue_from(stream));
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+#if PHP_VERSION_ID >= 70400
+METHOD(__serialize)
+{
+    PARSE_NONE;
+    php_ds_queue_magic_serialize(getThis(), return_value);
+}
+
+METHOD(__unserialize)
+{
+    PARSE_HASH(data);
+    php_ds_queue_magic_unserialize(getThis(), data);
+}
+#endif
+
 void php_ds_register_queue()
 {
     zend_class_entry ce;
 
     zend_function_entry methods[] = {
         PHP_DS_ME(Queue, __construct)
+#if PHP_VERSION_ID >= 70400
+        PHP_DS_ME(Queue, __serialize)
+        PHP_DS_ME(Queue, __unserialize)
+#endif
         PHP_DS_ME(Queue, allocate)
+        PHP_DS_ME_STATIC(Queue, fromBinary)
+        PHP_DS_ME_STATIC(Queue, readFrom)
+        PHP_DS_ME(Queue, equals)
+        PHP_DS_ME(Queue, shrinkToFit)
         PHP_DS_ME(Queue, capacity)
         PHP_DS_ME(Queue, peek)
         PHP_DS_ME(Queue, pop)
         PHP_DS_ME(Queue, push)
+        PHP_DS_ME(Queue, stream)
+        PHP_DS_ME(Queue, toBinary)
+        PHP_DS_ME(Queue, writeTo)
 
         PHP_DS_COLLECTION_ME_LIST(Queue)
         PHP_FE_END
@@ -114,7 +184,7 @@ void php_ds_register_queue()
     php_ds_queue_ce->serialize      = php_ds_queue_serialize;
     php_ds_queue_ce->unserialize    = php_ds_queue_unserialize;
 
-    zend_declare_class_constant_long(php_ds_queue_ce, STR_AND_LEN("MIN_CAPACITY"), DS_DEQUE_MIN_CAPACITY);
+    zend_declare_class_constant_long(php_ds_queue_ce, STR_AND_LEN("MIN_CAPACITY"), DS_QUEUE_MIN_CAPACITY);
     zend_class_implements(php_ds_queue_ce, 1, collection_ce);
 
     php_ds_register_queue_handlers();
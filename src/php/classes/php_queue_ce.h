@@ -9,10 +9,22 @@ extern zend_class_entry *php_ds_queue_ce;
 
 ARGINFO_OPTIONAL_ZVAL(          Queue___construct, values);
 ARGINFO_LONG(                   Queue_allocate, capacity);
+ARGINFO_NONE(                   Queue_shrinkToFit);
 ARGINFO_NONE_RETURN_LONG(       Queue_capacity);
 ARGINFO_VARIADIC_ZVAL(          Queue_push, values);
 ARGINFO_NONE(                   Queue_pop);
 ARGINFO_NONE(                   Queue_peek);
+ARGINFO_NONE_RETURN_DS(         Queue_stream, Stream);
+ARGINFO_NONE_RETURN_STRING(     Queue_toBinary);
+ARGINFO_STRING_RETURN_DS(       Queue_fromBinary, data, Queue);
+ARGINFO_ZVAL(                   Queue_writeTo, stream);
+ARGINFO_ZVAL_RETURN_DS(         Queue_readFrom, stream, Queue);
+ARGINFO_ZVAL_RETURN_BOOL(       Queue_equals, other);
+
+#if PHP_VERSION_ID >= 70400
+ARGINFO_NONE_RETURN_ARRAY(      Queue___serialize);
+ARGINFO_ARRAY(                  Queue___unserialize, data);
+#endif
 
 void php_ds_register_queue();
 
@@ -4,8 +4,11 @@
 #include "../arginfo.h"
 
 #include "../objects/php_set.h"
+#include "../objects/php_stream.h"
+#include "../../ds/ds_binary.h"
 
 #include "../iterators/php_set_iterator.h"
+#include "../handlers/php_common_handlers.h"
 #include "../handlers/php_set_handlers.h"
 
 #include "php_collection_ce.h"
@@ -40,6 +43,12 @@ METHOD(allocate)
     ds_set_allocate(THIS_DS_SET(), capacity);
 }
 
+METHOD(shrinkToFit)
+{
+    PARSE_NONE;
+    ds_set_shrink_to_fit(THIS_DS_SET());
+}
+
 METHOD(capacity)
 {
     PARSE_NONE;
@@ -70,6 +79,12 @@ METHOD(contains)
     RETURN_BOOL(ds_set_contains_va(THIS_DS_SET(), argc, argv));
 }
 
+METHOD(containsAll)
+{
+    PARSE_ZVAL(values);
+    RETURN_BOOL(ds_set_contains_all(THIS_DS_SET(), values));
+}
+
 METHOD(diff)
 {
     PARSE_OBJ(obj, php_ds_set_ce);
@@ -187,6 +202,12 @@ METHOD(slice)
     }
 }
 
+METHOD(apply)
+{
+    PARSE_CALLABLE();
+    ds_set_apply(THIS_DS_SET(), FCI_ARGS);
+}
+
 METHOD(filter)
 {
     if (ZEND_NUM_ARGS()) {
@@ -197,6 +218,18 @@ METHOD(filter)
     }
 }
 
+METHOD(filterContained)
+{
+    PARSE_ZVAL(values);
+    RETURN_DS_SET(ds_set_filter_contained(THIS_DS_SET(), values));
+}
+
+METHOD(retain)
+{
+    PARSE_CALLABLE();
+    ds_set_retain(THIS_DS_SET(), FCI_ARGS);
+}
+
 METHOD(reverse)
 {
     PARSE_NONE;
@@ -221,18 +254,79 @@ METHOD(jsonSerialize)
     ds_set_to_array(THIS_DS_SET(), return_value);
 }
 
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_KEYS, ds_htable_clone(THIS_DS_SET()->table)));
+}
+
+METHOD(toBinary)
+{
+    PARSE_NONE;
+    RETURN_STR(ds_binary_encode_set(THIS_DS_SET()));
+}
+
+METHOD(fromBinary)
+{
+    PARSE_STRING();
+    RETURN_DS_SET(ds_binary_decode_set(str, len));
+}
+
+METHOD(writeTo)
+{
+    PARSE_STREAM();
+    ds_binary_encode_set_to(THIS_DS_SET(), stream);
+}
+
+METHOD(readFrom)
+{
+    PARSE_STREAM();
+    RETURN_DS_SET(ds_binary_decode_set_from(stream));
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+#if PHP_VERSION_ID >= 70400
+METHOD(__serialize)
+{
+    PARSE_NONE;
+    php_ds_set_magic_serialize(getThis(), return_value);
+}
+
+METHOD(__unserialize)
+{
+    PARSE_HASH(data);
+    php_ds_set_magic_unserialize(getThis(), data);
+}
+#endif
+
 void php_ds_register_set()
 {
     zend_class_entry ce;
 
     zend_function_entry methods[] = {
         PHP_DS_ME(Set, __construct)
+#if PHP_VERSION_ID >= 70400
+        PHP_DS_ME(Set, __serialize)
+        PHP_DS_ME(Set, __unserialize)
+#endif
         PHP_DS_ME(Set, add)
         PHP_DS_ME(Set, allocate)
+        PHP_DS_ME_STATIC(Set, fromBinary)
+        PHP_DS_ME_STATIC(Set, readFrom)
+        PHP_DS_ME(Set, equals)
+        PHP_DS_ME(Set, shrinkToFit)
+        PHP_DS_ME(Set, apply)
         PHP_DS_ME(Set, capacity)
         PHP_DS_ME(Set, contains)
+        PHP_DS_ME(Set, containsAll)
         PHP_DS_ME(Set, diff)
         PHP_DS_ME(Set, filter)
+        PHP_DS_ME(Set, filterContained)
         PHP_DS_ME(Set, first)
         PHP_DS_ME(Set, get)
         PHP_DS_ME(Set, intersect)
@@ -242,12 +336,16 @@ void php_ds_register_set()
         PHP_DS_ME(Set, merge)
         PHP_DS_ME(Set, reduce)
         PHP_DS_ME(Set, remove)
+        PHP_DS_ME(Set, retain)
         PHP_DS_ME(Set, reverse)
         PHP_DS_ME(Set, reversed)
         PHP_DS_ME(Set, slice)
         PHP_DS_ME(Set, sort)
         PHP_DS_ME(Set, sorted)
+        PHP_DS_ME(Set, stream)
         PHP_DS_ME(Set, sum)
+        PHP_DS_ME(Set, toBinary)
+        PHP_DS_ME(Set, writeTo)
         PHP_DS_ME(Set, union)
         PHP_DS_ME(Set, xor)
 
@@ -10,11 +10,14 @@ extern zend_class_entry *php_ds_set_ce;
 ARGINFO_OPTIONAL_ZVAL(                      Set___construct, values);
 ARGINFO_OPTIONAL_STRING(                    Set_join, glue);
 ARGINFO_LONG(                               Set_allocate, capacity);
+ARGINFO_NONE(                               Set_shrinkToFit);
+ARGINFO_CALLABLE(                           Set_apply, callback);
 ARGINFO_NONE_RETURN_LONG(                   Set_capacity);
 ARGINFO_VARIADIC_ZVAL(                      Set_add, values);
 ARGINFO_VARIADIC_ZVAL(                      Set_remove, values);
 ARGINFO_LONG(                               Set_get, index);
 ARGINFO_VARIADIC_ZVAL_RETURN_BOOL(          Set_contains, values);
+ARGINFO_ZVAL_RETURN_BOOL(                   Set_containsAll, values);
 ARGINFO_DS_RETURN_DS(                       Set_diff, set, Set, Set);
 ARGINFO_DS_RETURN_DS(                       Set_intersect, set, Set, Set);
 ARGINFO_DS_RETURN_DS(                       Set_xor, set, Set, Set);
@@ -27,10 +30,23 @@ ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(        Set_sorted, comparator, Set);
 ARGINFO_CALLABLE_OPTIONAL_ZVAL(             Set_reduce, callback, initial);
 ARGINFO_LONG_OPTIONAL_LONG_RETURN_DS(       Set_slice, index, length, Set);
 ARGINFO_OPTIONAL_CALLABLE_RETURN_DS(        Set_filter, predicate, Set);
+ARGINFO_ZVAL_RETURN_DS(                     Set_filterContained, values, Set);
 ARGINFO_CALLABLE_RETURN_DS(                 Set_map, callback, Set);
+ARGINFO_CALLABLE(                           Set_retain, predicate);
 ARGINFO_NONE(                               Set_reverse);
 ARGINFO_NONE_RETURN_DS(                     Set_reversed, Set);
 ARGINFO_NONE(                               Set_sum);
+ARGINFO_NONE_RETURN_DS(                     Set_stream, Stream);
+ARGINFO_NONE_RETURN_STRING(                 Set_toBinary);
+ARGINFO_STRING_RETURN_DS(                   Set_fromBinary, data, Set);
+ARGINFO_ZVAL(                               Set_writeTo, stream);
+ARGINFO_ZVAL_RETURN_DS(                     Set_readFrom, stream, Set);
+ARGINFO_ZVAL_RETURN_BOOL(                   Set_equals, other);
+
+#if PHP_VERSION_ID >= 70400
+ARGINFO_NONE_RETURN_ARRAY(                  Set___serialize);
+ARGINFO_ARRAY(                              Set___unserialize, data);
+#endif
 
 void php_ds_register_set();
 
@@ -4,8 +4,11 @@
 #include "../arginfo.h"
 
 #include "../objects/php_stack.h"
+#include "../objects/php_stream.h"
+#include "../../ds/ds_binary.h"
 
 #include "../iterators/php_stack_iterator.h"
+#include "../handlers/php_common_handlers.h"
 #include "../handlers/php_stack_handlers.h"
 
 #include "php_collection_ce.h"
@@ -30,6 +33,12 @@ METHOD(allocate)
     ds_stack_allocate(THIS_DS_STACK(), capacity);
 }
 
+METHOD(shrinkToFit)
+{
+    PARSE_NONE;
+    ds_stack_shrink_to_fit(THIS_DS_STACK());
+}
+
 METHOD(capacity)
 {
     PARSE_NONE;
@@ -90,17 +99,78 @@ METHOD(jsonSerialize)
     ds_stack_to_array(THIS_DS_STACK(), return_value);
 }
 
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_VECTOR_REVERSED, ds_vector_clone(THIS_DS_STACK()->vector)));
+}
+
+METHOD(toBinary)
+{
+    PARSE_NONE;
+    RETURN_STR(ds_binary_encode_stack(THIS_DS_STACK()));
+}
+
+METHOD(fromBinary)
+{
+    PARSE_STRING();
+    RETURN_DS_STACK(ds_binary_decode_stack(str, len));
+}
+
+METHOD(writeTo)
+{
+    PARSE_STREAM();
+    ds_binary_encode_stack_to(THIS_DS_STACK(), stream);
+}
+
+METHOD(readFrom)
+{
+    PARSE_STREAM();
+    RETURN_DS_STACK(ds_binary_decode_stack_from(stream));
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+#if PHP_VERSION_ID >= 70400
+METHOD(__serialize)
+{
+    PARSE_NONE;
+    php_ds_stack_magic_serialize(getThis(), return_value);
+}
+
+METHOD(__unserialize)
+{
+    PARSE_HASH(data);
+    php_ds_stack_magic_unserialize(getThis(), data);
+}
+#endif
+
 void php_ds_register_stack()
 {
     zend_class_entry ce;
 
     zend_function_entry methods[] = {
         PHP_DS_ME(Stack, __construct)
+#if PHP_VERSION_ID >= 70400
+        PHP_DS_ME(Stack, __serialize)
+        PHP_DS_ME(Stack, __unserialize)
+#endif
         PHP_DS_ME(Stack, allocate)
+        PHP_DS_ME_STATIC(Stack, fromBinary)
+        PHP_DS_ME_STATIC(Stack, readFrom)
+        PHP_DS_ME(Stack, equals)
+        PHP_DS_ME(Stack, shrinkToFit)
         PHP_DS_ME(Stack, capacity)
         PHP_DS_ME(Stack, peek)
         PHP_DS_ME(Stack, pop)
         PHP_DS_ME(Stack, push)
+        PHP_DS_ME(Stack, stream)
+        PHP_DS_ME(Stack, toBinary)
+        PHP_DS_ME(Stack, writeTo)
 
         PHP_DS_COLLECTION_ME_LIST(Stack)
         PHP_FE_END
@@ -9,10 +9,22 @@ extern zend_class_entry *php_ds_stack_ce;
 
 ARGINFO_OPTIONAL_ZVAL(          Stack___construct, values);
 ARGINFO_LONG(                   Stack_allocate, capacity);
+ARGINFO_NONE(                   Stack_shrinkToFit);
 ARGINFO_NONE_RETURN_LONG(       Stack_capacity);
 ARGINFO_VARIADIC_ZVAL(          Stack_push, values);
 ARGINFO_NONE(                   Stack_pop);
 ARGINFO_NONE(                   Stack_peek);
+ARGINFO_NONE_RETURN_DS(         Stack_stream, Stream);
+ARGINFO_NONE_RETURN_STRING(     Stack_toBinary);
+ARGINFO_STRING_RETURN_DS(       Stack_fromBinary, data, Stack);
+ARGINFO_ZVAL(                   Stack_writeTo, stream);
+ARGINFO_ZVAL_RETURN_DS(         Stack_readFrom, stream, Stack);
+ARGINFO_ZVAL_RETURN_BOOL(       Stack_equals, other);
+
+#if PHP_VERSION_ID >= 70400
+ARGINFO_NONE_RETURN_ARRAY(      Stack___serialize);
+ARGINFO_ARRAY(                  Stack___unserialize, data);
+#endif
 
 void php_ds_register_stack();
 
@@ -0,0 +1,110 @@
+#include "../../common.h"
+
+#include "../parameters.h"
+#include "../arginfo.h"
+
+#include "../objects/php_vector.h"
+#include "../objects/php_stream.h"
+#include "../handlers/php_stream_handlers.h"
+
+#include "php_stream_ce.h"
+
+#define METHOD(name) PHP_METHOD(Stream, name)
+
+zend_class_entry *php_ds_stream_ce;
+
+METHOD(count)
+{
+    PARSE_NONE;
+    RETURN_LONG(ds_stream_count(THIS_DS_STREAM()));
+}
+
+METHOD(filter)
+{
+    PARSE_CALLABLE();
+    RETURN_DS_STREAM(ds_stream_with_callback(THIS_DS_STREAM(), DS_STREAM_FILTER, FCI_ARGS));
+}
+
+METHOD(first)
+{
+    PARSE_NONE;
+    ds_stream_first(THIS_DS_STREAM(), return_value);
+}
+
+METHOD(flatMap)
+{
+    PARSE_CALLABLE();
+    RETURN_DS_STREAM(ds_stream_with_callback(THIS_DS_STREAM(), DS_STREAM_FLAT_MAP, FCI_ARGS));
+}
+
+METHOD(map)
+{
+    PARSE_CALLABLE();
+    RETURN_DS_STREAM(ds_stream_with_callback(THIS_DS_STREAM(), DS_STREAM_MAP, FCI_ARGS));
+}
+
+METHOD(reduce)
+{
+    PARSE_CALLABLE_AND_OPTIONAL_ZVAL(initial);
+    ds_stream_reduce(THIS_DS_STREAM(), initial, return_value, FCI_ARGS);
+}
+
+METHOD(skip)
+{
+    PARSE_LONG(n);
+    RETURN_DS_STREAM(ds_stream_with_limit(THIS_DS_STREAM(), DS_STREAM_SKIP, n));
+}
+
+METHOD(sum)
+{
+    PARSE_NONE;
+    ds_stream_sum(THIS_DS_STREAM(), return_value);
+}
+
+METHOD(take)
+{
+    PARSE_LONG(n);
+    RETURN_DS_STREAM(ds_stream_with_limit(THIS_DS_STREAM(), DS_STREAM_TAKE, n));
+}
+
+METHOD(toArray)
+{
+    PARSE_NONE;
+    ds_stream_to_array(THIS_DS_STREAM(), return_value);
+}
+
+METHOD(toVector)
+{
+    PARSE_NONE;
+    RETURN_DS_VECTOR(ds_stream_to_vector(THIS_DS_STREAM()));
+}
+
+void php_ds_register_stream()
+{
+    zend_class_entry ce;
+
+    zend_function_entry methods[] = {
+        PHP_DS_ME(Stream, count)
+        PHP_DS_ME(Stream, filter)
+        PHP_DS_ME(Stream, first)
+        PHP_DS_ME(Stream, flatMap)
+        PHP_DS_ME(Stream, map)
+        PHP_DS_ME(Stream, reduce)
+        PHP_DS_ME(Stream, skip)
+        PHP_DS_ME(Stream, sum)
+        PHP_DS_ME(Stream, take)
+        PHP_DS_ME(Stream, toArray)
+        PHP_DS_ME(Stream, toVector)
+        PHP_FE_END
+    };
+
+    INIT_CLASS_ENTRY(ce, PHP_DS_NS(Stream), methods);
+
+    php_ds_stream_ce = zend_register_internal_class(&ce);
+    php_ds_stream_ce->ce_flags      |= ZEND_ACC_FINAL;
+    php_ds_stream_ce->create_object  = php_ds_stream_create_object;
+    php_ds_stream_ce->serialize      = zend_class_serialize_deny;
+    php_ds_stream_ce->unserialize    = zend_class_unserialize_deny;
+
+    php_register_stream_handlers();
+}
@@ -0,0 +1,24 @@
+#ifndef DS_STREAM_CE_H
+#define DS_STREAM_CE_H
+
+#include "php.h"
+#include "../../common.h"
+#include "../arginfo.h"
+
+extern zend_class_entry *php_ds_stream_ce;
+
+ARGINFO_NONE_RETURN_LONG(           Stream_count);
+ARGINFO_CALLABLE_RETURN_DS(         Stream_filter, callback, Stream);
+ARGINFO_NONE(                       Stream_first);
+ARGINFO_CALLABLE_RETURN_DS(         Stream_flatMap, callback, Stream);
+ARGINFO_CALLABLE_RETURN_DS(         Stream_map, callback, Stream);
+ARGINFO_CALLABLE_OPTIONAL_ZVAL(     Stream_reduce, callback, initial);
+ARGINFO_LONG_RETURN_DS(             Stream_skip, n, Stream);
+ARGINFO_NONE(                       Stream_sum);
+ARGINFO_LONG_RETURN_DS(             Stream_take, n, Stream);
+ARGINFO_NONE_RETURN_ARRAY(          Stream_toArray);
+ARGINFO_NONE_RETURN_DS(             Stream_toVector, Vector);
+
+void php_ds_register_stream();
+
+#endif
@@ -4,7 +4,13 @@
 #include "../arginfo.h"
 
 #include "../objects/php_vector.h"
+#include "../objects/php_mapped.h"
+#include "../objects/php_immutable_vector.h"
+#include "../objects/php_stream.h"
+#include "../../ds/ds_binary.h"
+#include "../../ds/ds_json.h"
 #include "../iterators/php_vector_iterator.h"
+#include "../handlers/php_common_handlers.h"
 #include "../handlers/php_vector_handlers.h"
 
 #include "php_collection_ce.h"
@@ -30,6 +36,12 @@ METHOD(allocate)
     ds_vector_allocate(THIS_DS_VECTOR(), capacity);
 }
 
+METHOD(shrinkToFit)
+{
+    PARSE_NONE;
+    ds_vector_shrink_to_fit(THIS_DS_VECTOR());
+}
+
 METHOD(apply)
 {
     PARSE_CALLABLE();
@@ -88,6 +100,12 @@ METHOD(first)
     RETURN_ZVAL_COPY(ds_vector_get_first_throw(THIS_DS_VECTOR()));
 }
 
+METHOD(freeze)
+{
+    PARSE_NONE;
+    RETURN_OBJ(php_ds_immutable_vector_create_clone(THIS_DS_VECTOR()));
+}
+
 METHOD(get)
 {
     PARSE_LONG(index);
@@ -100,6 +118,12 @@ METHOD(insert)
     ds_vector_insert_va(THIS_DS_VECTOR(), index, argc, argv);
 }
 
+METHOD(insertAll)
+{
+    PARSE_LONG_AND_ZVAL(index, values);
+    ds_vector_insert_all(THIS_DS_VECTOR(), index, values);
+}
+
 METHOD(isEmpty)
 {
     PARSE_NONE;
@@ -119,7 +143,7 @@ METHOD(join)
 METHOD(jsonSerialize)
 {
     PARSE_NONE;
-    ds_vector_to_array(THIS_DS_VECTOR(), return_value);
+    ds_vector_to_array_cached(THIS_DS_VECTOR(), return_value);
 }
 
 METHOD(last)
@@ -170,6 +194,24 @@ METHOD(remove)
     ds_vector_remove(THIS_DS_VECTOR(), index, return_value);
 }
 
+METHOD(removeIf)
+{
+    PARSE_CALLABLE();
+    ds_vector_remove_if(THIS_DS_VECTOR(), FCI_ARGS);
+}
+
+METHOD(removeRange)
+{
+    PARSE_LONG_AND_LONG(index, length);
+    ds_vector_remove_range(THIS_DS_VECTOR(), index, length);
+}
+
+METHOD(retain)
+{
+    PARSE_CALLABLE();
+    ds_vector_retain(THIS_DS_VECTOR(), FCI_ARGS);
+}
+
 METHOD(reverse)
 {
     PARSE_NONE;
@@ -213,6 +255,20 @@ METHOD(slice)
     }
 }
 
+METHOD(splice)
+{
+    ds_vector_t *vector = THIS_DS_VECTOR();
+
+    PARSE_LONG_OPTIONAL_LONG_OPTIONAL_ZVAL(index, length, length_is_null, values);
+
+    // Splice to the end if a length isn't given.
+    if (length_is_null) {
+        length = vector->size;
+    }
+
+    RETURN_DS_VECTOR(ds_vector_splice(vector, index, length, values));
+}
+
 METHOD(sort)
 {
     ds_vector_t *vector = THIS_DS_VECTOR();
@@ -248,7 +304,7 @@ METHOD(sum)
 METHOD(toArray)
 {
     PARSE_NONE;
-    ds_vector_to_array(THIS_DS_VECTOR(), return_value);
+    ds_vector_to_array_cached(THIS_DS_VECTOR(), return_value);
 }
 
 METHOD(unshift)
@@ -257,12 +313,111 @@ METHOD(unshift)
     ds_vector_unshift_va(THIS_DS_VECTOR(), argc, argv);
 }
 
+METHOD(stream)
+{
+    PARSE_NONE;
+    RETURN_DS_STREAM(ds_stream(DS_STREAM_SOURCE_VECTOR, ds_vector_clone(THIS_DS_VECTOR())));
+}
+
+METHOD(toBinary)
+{
+    PARSE_NONE;
+    RETURN_STR(ds_binary_encode_vector(THIS_DS_VECTOR()));
+}
+
+METHOD(fromBinary)
+{
+    PARSE_STRING();
+    RETURN_DS_VECTOR(ds_binary_decode_vector(str, len));
+}
+
+METHOD(writeTo)
+{
+    PARSE_STREAM();
+    ds_binary_encode_vector_to(THIS_DS_VECTOR(), stream);
+}
+
+METHOD(readFrom)
+{
+    PARSE_STREAM();
+    RETURN_DS_VECTOR(ds_binary_decode_vector_from(stream));
+}
+
+METHOD(toMappedFile)
+{
+    PARSE_PATH();
+    ds_mapped_write_vector(THIS_DS_VECTOR(), path);
+}
+
+METHOD(mapFile)
+{
+    PARSE_PATH();
+    RETURN_DS_MAPPED(ds_mapped_open(path, DS_MAPPED_VECTOR));
+}
+
+METHOD(toJson)
+{
+    zend_string *json;
+    PARSE_OPTIONAL_LONG_OPTIONAL_LONG(options, 0, depth, DS_JSON_DEFAULT_DEPTH);
+
+    if ((json = ds_json_encode_vector(THIS_DS_VECTOR(), options, depth))) {
+        RETURN_STR(json);
+    }
+}
+
+METHOD(fromJson)
+{
+    PARSE_STRING_OPTIONAL_LONG(depth, DS_JSON_DEFAULT_DEPTH);
+    ds_json_decode(return_value, str, len, depth, php_ds_vector_ce);
+}
+
+METHOD(equals)
+{
+    PARSE_ZVAL(other);
+    RETURN_BOOL(php_ds_equals(getThis(), other));
+}
+
+#if PHP_VERSION_ID >= 70400
+METHOD(__serialize)
+{
+    PARSE_NONE;
+    php_ds_vector_magic_serialize(getThis(), return_value);
+}
+
+METHOD(__unserialize)
+{
+    PARSE_HASH(data);
+    php_ds_vector_magic_unserialize(getThis(), data);
+}
+#endif
+
 void php_ds_register_vector()
 {
     zend_class_entry ce;
 
     zend_function_entry methods[] = {
         PHP_DS_ME(Vector, __construct)
+#if PHP_VERSION_ID >= 70400
+        PHP_DS_ME(Vector, __serialize)
+        PHP_DS_ME(Vector, __unserialize)
+#endif
+        PHP_DS_ME(Vector, freeze)
+        PHP_DS_ME_STATIC(Vector, fromBinary)
+        PHP_DS_ME_STATIC(Vector, readFrom)
+        PHP_DS_ME(Vector, toMappedFile)
+        PHP_DS_ME_STATIC(Vector, mapFile)
+        PHP_DS_ME(Vector, toJson)
+        PHP_DS_ME_STATIC(Vector, fromJson)
+        PHP_DS_ME(Vector, equals)
+        PHP_DS_ME(Vector, insertAll)
+        PHP_DS_ME(Vector, removeIf)
+        PHP_DS_ME(Vector, removeRange)
+        PHP_DS_ME(Vector, retain)
+        PHP_DS_ME(Vector, shrinkToFit)
+        PHP_DS_ME(Vector, splice)
+        PHP_DS_ME(Vector, stream)
+        PHP_DS_ME(Vector, toBinary)
+        PHP_DS_ME(Vector, writeTo)
 
         PHP_DS_SEQUENCE_ME_LIST(Vector)
         PHP_DS_COLLECTION_ME_LIST(Vector)
@@ -8,6 +8,28 @@
 extern zend_class_entry *php_ds_vector_ce;
 
 ARGINFO_OPTIONAL_ZVAL(Vector___construct, values);
+ARGINFO_NONE_RETURN_DS(Vector_freeze, ImmutableVector);
+ARGINFO_CALLABLE(Vector_retain, callback);
+ARGINFO_LONG_ZVAL(Vector_insertAll, index, values);
+ARGINFO_CALLABLE(Vector_removeIf, callback);
+ARGINFO_LONG_LONG(Vector_removeRange, index, length);
+ARGINFO_NONE(Vector_shrinkToFit);
+ARGINFO_LONG_OPTIONAL_LONG_OPTIONAL_ZVAL_RETURN_DS(Vector_splice, index, length, values, Vector);
+ARGINFO_NONE_RETURN_DS(Vector_stream, Stream);
+ARGINFO_NONE_RETURN_STRING(Vector_toBinary);
+ARGINFO_STRING_RETURN_DS(Vector_fromBinary, data, Vector);
+ARGINFO_ZVAL(Vector_writeTo, stream);
+ARGINFO_ZVAL_RETURN_DS(Vector_readFrom, stream, Vector);
+ARGINFO_STRING(Vector_toMappedFile, path);
+ARGINFO_STRING_RETURN_DS(Vector_mapFile, path, MappedVector);
+ARGINFO_OPTIONAL_LONG_OPTIONAL_LONG_RETURN_STRING(Vector_toJson, options, depth);
+ARGINFO_STRING_OPTIONAL_LONG_RETURN_DS(Vector_fromJson, json, depth, Vector);
+ARGINFO_ZVAL_RETURN_BOOL(Vector_equals, other);
+
+#if PHP_VERSION_ID >= 70400
+ARGINFO_NONE_RETURN_ARRAY(Vector___serialize);
+ARGINFO_ARRAY(Vector___unserialize, data);
+#endif
 
 void php_ds_register_vector();
 
@@ -1,6 +1,16 @@
 #include "php_common_handlers.h"
 #include "zend_smart_str.h"
 
+#if PHP_VERSION_ID >= 70300
+#define DS_IS_RECURSIVE(z)         Z_IS_RECURSIVE_P(z)
+#define DS_PROTECT_RECURSION(z)    Z_PROTECT_RECURSION_P(z)
+#define DS_UNPROTECT_RECURSION(z)  Z_UNPROTECT_RECURSION_P(z)
+#else
+#define DS_IS_RECURSIVE(z)         (Z_OBJ_APPLY_COUNT_P(z) > 0)
+#define DS_PROTECT_RECURSION(z)    Z_OBJ_INC_APPLY_COUNT_P(z)
+#define DS_UNPROTECT_RECURSION(z)  Z_OBJ_DEC_APPLY_COUNT_P(z)
+#endif
+
 int php_ds_default_cast_object(zval *obj, zval *return_value, int type)
 {
     switch (type) {
@@ -23,3 +33,39 @@ int php_ds_default_cast_object(zval *obj, zval *return_value, int type)
 
     return FAILURE;
 }
+
+bool php_ds_objects_equal(zval *obj, zval *other, php_ds_equals_t equals)
+{
+    bool result;
+
+    if (Z_OBJ_P(obj) == Z_OBJ_P(other)) {
+        return true;
+    }
+
+    if (Z_OBJCE_P(obj) != Z_OBJCE_P(other)) {
+        return false;
+    }
+
+    if (DS_IS_RECURSIVE(obj)) {
+        zend_error_noreturn(E_ERROR, "Nesting level too deep - recursive dependency?");
+    }
+
+    DS_PROTECT_RECURSION(obj);
+    result = equals(obj, other);
+    DS_UNPROTECT_RECURSION(obj);
+
+    return result;
+}
+
+bool php_ds_equals(zval *obj, zval *other)
+{
+    if (Z_TYPE_P(other) != IS_OBJECT) {
+        return false;
+    }
+
+    if (Z_OBJ_HT_P(obj)->compare_objects != Z_OBJ_HT_P(other)->compare_objects) {
+        return false;
+    }
+
+    return Z_OBJ_HT_P(obj)->compare_objects(obj, other) == 0 && ! EG(exception);
+}
@@ -2,10 +2,28 @@
 #define PHP_COMMON_HANDLERS_H
 
 #include "php.h"
+#include "../../common.h"
 
 /**
  * Default object cast handler.
  */
 int php_ds_default_cast_object(zval *obj, zval *return_value, int type);
 
+/**
+ * Compares the internal structures of two objects of the same class.
+ */
+typedef bool (*php_ds_equals_t)(zval *obj, zval *other);
+
+/**
+ * Determines if two objects are equal using the given comparison, which is
+ * only called when both are of the same class. Guards against recursion.
+ */
+bool php_ds_objects_equal(zval *obj, zval *other, php_ds_equals_t equals);
+
+/**
+ * Determines if an object is equal to another value using the object's
+ * compare handler, which is what == would do.
+ */
+bool php_ds_equals(zval *obj, zval *other);
+
 #endif
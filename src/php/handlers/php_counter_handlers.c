@@ -0,0 +1,101 @@
+#include "php_common_handlers.h"
+#include "php_counter_handlers.h"
+#include "../../ds/ds_counter.h"
+#include "../objects/php_counter.h"
+#include "../objects/php_pair.h"
+
+zend_object_handlers php_ds_counter_handlers;
+
+static int php_ds_counter_count_elements(zval *obj, zend_long *count)
+{
+    *count = DS_COUNTER_SIZE(Z_DS_COUNTER_P(obj));
+    return SUCCESS;
+}
+
+static void php_ds_counter_free_object(zend_object *object)
+{
+    php_ds_counter_t *obj = (php_ds_counter_t*) object;
+    zend_object_std_dtor(&obj->std);
+    ds_counter_free(obj->counter);
+}
+
+/**
+ * Values can be objects, so they are shown as pairs like the keys of a map.
+ */
+static HashTable *php_ds_counter_get_debug_info(zval *obj, int *is_temp)
+{
+    ds_counter_t *counter = Z_DS_COUNTER_P(obj);
+    HashTable    *array;
+
+    zval *value;
+    zval *count;
+
+    zval pair;
+
+    *is_temp = 1;
+
+    ALLOC_HASHTABLE(array);
+    zend_hash_init(array, DS_COUNTER_SIZE(counter), NULL, ZVAL_PTR_DTOR, 0);
+
+    DS_HTABLE_FOREACH_KEY_VALUE(counter->table, value, count) {
+        ZVAL_DS_PAIR(&pair, ds_pair_ex(value, count));
+        zend_hash_next_index_insert(array, &pair);
+    }
+    DS_HTABLE_FOREACH_END();
+
+    return array;
+}
+
+static zend_object *php_ds_counter_clone_obj(zval *obj)
+{
+    return php_ds_counter_create_clone(Z_DS_COUNTER_P(obj));
+}
+
+static HashTable *php_ds_counter_get_gc(zval *obj, zval **gc_data, int *gc_count)
+{
+    ds_counter_t *counter = Z_DS_COUNTER_P(obj);
+
+    // A shared table is reported through its object, see php_ds_map_get_gc.
+    if (counter->table->refs) {
+        *gc_data  = DS_SHARED_BUFFER_GC(counter->table->refs);
+        *gc_count = 1;
+
+    } else if (DS_COUNTER_IS_EMPTY(counter)) {
+        *gc_data  = NULL;
+        *gc_count = 0;
+
+    } else {
+        *gc_data  = (zval*) counter->table->buckets;
+        *gc_count = (int)   counter->table->next * 2;
+    }
+
+    return NULL;
+}
+
+static bool php_ds_counter_equals(zval *obj, zval *other)
+{
+    ds_counter_t *counter = Z_DS_COUNTER_P(obj);
+    ds_counter_t *another = Z_DS_COUNTER_P(other);
+
+    return counter->total == another->total && ds_htable_equals(counter->table, another->table, true);
+}
+
+static int php_ds_counter_compare_objects(zval *obj, zval *other)
+{
+    return php_ds_objects_equal(obj, other, php_ds_counter_equals) ? 0 : 1;
+}
+
+void php_ds_register_counter_handlers()
+{
+    memcpy(&php_ds_counter_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+
+    php_ds_counter_handlers.offset = 0; // XtOffsetOf(php_ds_counter_t, std);
+
+    php_ds_counter_handlers.cast_object     = php_ds_default_cast_object;
+    php_ds_counter_handlers.compare_objects = php_ds_counter_compare_objects;
+    php_ds_counter_handlers.clone_obj       = php_ds_counter_clone_obj;
+    php_ds_counter_handlers.count_elements  = php_ds_counter_count_elements;
+    php_ds_counter_handlers.free_obj        = php_ds_counter_free_object;
+    php_ds_counter_handlers.get_debug_info  = php_ds_counter_get_debug_info;
+    php_ds_counter_handlers.get_gc          = php_ds_counter_get_gc;
+}
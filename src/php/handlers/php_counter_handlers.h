@@ -0,0 +1,10 @@
+#ifndef DS_COUNTER_HANDLERS_H
+#define DS_COUNTER_HANDLERS_H
+
+#include "php.h"
+
+extern zend_object_handlers php_ds_counter_handlers;
+
+void php_ds_register_counter_handlers();
+
+#endif
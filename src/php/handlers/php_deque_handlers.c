@@ -27,6 +27,11 @@ static zval *php_ds_deque_read_dimension(zval *obj, zval *offset, int type, zval
         return NULL;
     }
 
+    // Access by reference could change the value, so we have to separate.
+    if (type != BP_VAR_R) {
+        DS_DEQUE_SEPARATE(deque);
+    }
+
     // Access the value at the given index.
     value = ds_deque_get(deque, Z_LVAL_P(offset));
 
@@ -97,6 +102,10 @@ static void php_ds_deque_free_object(zend_object *object)
     php_ds_deque_t *obj = (php_ds_deque_t*) object;
     zend_object_std_dtor(&obj->std);
     ds_deque_free(obj->deque);
+
+    if (obj->gc_data) {
+        efree(obj->gc_data);
+    }
 }
 
 static HashTable *php_ds_deque_get_debug_info(zval *obj, int *is_temp)
@@ -118,14 +127,51 @@ static zend_object *php_ds_deque_clone_obj(zval *obj)
 
 static HashTable *php_ds_deque_get_gc(zval *obj, zval **gc_data, int *gc_count)
 {
-    ds_deque_t *deque = Z_DS_DEQUE_P(obj);
+    php_ds_deque_t *intern = (php_ds_deque_t *) Z_OBJ_P(obj);
+    ds_deque_t *deque = intern->deque;
+
+    // A shared buffer is reported through the object that holds it, see
+    // php_ds_vector_get_gc. Unused positions are undefined, so a buffer that
+    // wraps around can be reported as a whole.
+    zval     *values = deque->refs ? DS_SHARED_BUFFER_GC(deque->refs) : deque->buffer;
+    zend_long size   = deque->refs ? 1
+        : (deque->head == 0 ? deque->size : deque->capacity);
+
+    // The array snapshot holds references of its own, so it's reported too,
+    // after the values in a buffer that the object keeps for the next time.
+    if (Z_TYPE(deque->snapshot) == IS_ARRAY) {
+        if (intern->gc_size < size + 1) {
+            intern->gc_size = (int) size + 1;
+            intern->gc_data = safe_erealloc(intern->gc_data, intern->gc_size, sizeof(zval), 0);
+        }
+
+        if (size > 0) {
+            memcpy(intern->gc_data, values, size * sizeof(zval));
+        }
+
+        ZVAL_COPY_VALUE(&intern->gc_data[size], &deque->snapshot);
 
-    *gc_data  = deque->buffer;
-    *gc_count = (int) (deque->head == 0 ? deque->size : deque->capacity);
+        *gc_data  = intern->gc_data;
+        *gc_count = (int) size + 1;
+
+    } else {
+        *gc_data  = size > 0 ? values : NULL;
+        *gc_count = (int) size;
+    }
 
     return NULL;
 }
 
+static bool php_ds_deque_equals(zval *obj, zval *other)
+{
+    return ds_deque_equals(Z_DS_DEQUE_P(obj), Z_DS_DEQUE_P(other));
+}
+
+static int php_ds_deque_compare_objects(zval *obj, zval *other)
+{
+    return php_ds_objects_equal(obj, other, php_ds_deque_equals) ? 0 : 1;
+}
+
 void php_ds_register_deque_handlers()
 {
     memcpy(&php_deque_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
@@ -136,6 +182,7 @@ void php_ds_register_deque_handlers()
     php_deque_handlers.free_obj         = php_ds_deque_free_object;
     php_deque_handlers.get_gc           = php_ds_deque_get_gc;
     php_deque_handlers.cast_object      = php_ds_default_cast_object;
+    php_deque_handlers.compare_objects  = php_ds_deque_compare_objects;
     php_deque_handlers.clone_obj        = php_ds_deque_clone_obj;
     php_deque_handlers.get_debug_info   = php_ds_deque_get_debug_info;
     php_deque_handlers.count_elements   = php_ds_deque_count_elements;
@@ -0,0 +1,93 @@
+#include "php_immutable_map_handlers.h"
+#include "php_map_handlers.h"
+#include "php_common_handlers.h"
+#include "../../ds/ds_map.h"
+#include "../objects/php_immutable_map.h"
+
+zend_object_handlers php_immutable_map_handlers;
+
+static zval *php_ds_immutable_map_read_dimension(zval *obj, zval *offset, int type, zval *rv)
+{
+    // Access by reference, eg. $map[$a][$b] = $c, could change the value.
+    if (type != BP_VAR_R && type != BP_VAR_IS) {
+        MUTABILITY_NOT_ALLOWED();
+        return NULL;
+    }
+
+    return php_map_handlers.read_dimension(obj, offset, type, rv);
+}
+
+static void php_ds_immutable_map_write_dimension(zval *obj, zval *offset, zval *value)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static void php_ds_immutable_map_unset_dimension(zval *obj, zval *offset)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static void php_ds_immutable_map_free_object(zend_object *object)
+{
+    php_ds_immutable_map_t *intern = (php_ds_immutable_map_t*) object;
+    zval_ptr_dtor(&intern->array);
+
+    if (intern->gc_data) {
+        efree(intern->gc_data);
+    }
+
+    php_map_handlers.free_obj(object);
+}
+
+static HashTable *php_ds_immutable_map_get_gc(zval *obj, zval **gc_data, int *gc_size)
+{
+    php_ds_immutable_map_t *intern = Z_DS_IMMUTABLE_MAP_OBJ_P(obj);
+
+    zval *values;
+    int size;
+
+    php_map_handlers.get_gc(obj, &values, &size);
+
+    // The cached array holds references of its own, so it's reported too,
+    // after the buckets in a buffer that the object keeps for the next time.
+    if (Z_TYPE(intern->array) == IS_ARRAY) {
+        if (intern->gc_size < size + 1) {
+            intern->gc_size = size + 1;
+            intern->gc_data = safe_erealloc(intern->gc_data, intern->gc_size, sizeof(zval), 0);
+        }
+
+        if (size > 0) {
+            memcpy(intern->gc_data, values, size * sizeof(zval));
+        }
+
+        ZVAL_COPY_VALUE(&intern->gc_data[size], &intern->array);
+
+        *gc_data = intern->gc_data;
+        *gc_size = size + 1;
+
+    } else {
+        *gc_data = values;
+        *gc_size = size;
+    }
+
+    return NULL;
+}
+
+static zend_object *php_ds_immutable_map_clone_obj(zval *obj)
+{
+    return php_ds_immutable_map_create_clone(Z_DS_MAP_P(obj));
+}
+
+void php_ds_register_immutable_map_handlers()
+{
+    // Everything that doesn't change the map is shared with Map,
+    // so the map handlers must be registered first.
+    memcpy(&php_immutable_map_handlers, &php_map_handlers, sizeof(zend_object_handlers));
+
+    php_immutable_map_handlers.free_obj           = php_ds_immutable_map_free_object;
+    php_immutable_map_handlers.clone_obj          = php_ds_immutable_map_clone_obj;
+    php_immutable_map_handlers.get_gc             = php_ds_immutable_map_get_gc;
+    php_immutable_map_handlers.read_dimension     = php_ds_immutable_map_read_dimension;
+    php_immutable_map_handlers.write_dimension    = php_ds_immutable_map_write_dimension;
+    php_immutable_map_handlers.unset_dimension    = php_ds_immutable_map_unset_dimension;
+}
@@ -0,0 +1,10 @@
+#ifndef PHP_DS_IMMUTABLE_MAP_HANDLERS_H
+#define PHP_DS_IMMUTABLE_MAP_HANDLERS_H
+
+#include "php.h"
+
+extern zend_object_handlers php_immutable_map_handlers;
+
+void php_ds_register_immutable_map_handlers();
+
+#endif
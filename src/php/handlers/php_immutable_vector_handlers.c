@@ -0,0 +1,46 @@
+#include "php_common_handlers.h"
+#include "php_vector_handlers.h"
+#include "php_immutable_vector_handlers.h"
+
+#include "../objects/php_immutable_vector.h"
+#include "../../ds/ds_vector.h"
+
+zend_object_handlers php_immutable_vector_handlers;
+
+static zval *php_ds_immutable_vector_read_dimension(zval *obj, zval *offset, int type, zval *return_value)
+{
+    // Access by reference, eg. $vector[$a][$b] = $c, could change the value.
+    if (type != BP_VAR_R && type != BP_VAR_IS) {
+        MUTABILITY_NOT_ALLOWED();
+        return NULL;
+    }
+
+    return php_vector_handlers.read_dimension(obj, offset, type, return_value);
+}
+
+static void php_ds_immutable_vector_write_dimension(zval *obj, zval *offset, zval *value)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static void php_ds_immutable_vector_unset_dimension(zval *obj, zval *offset)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static zend_object *php_ds_immutable_vector_clone_obj(zval *obj)
+{
+    return php_ds_immutable_vector_create_clone(Z_DS_VECTOR_P(obj));
+}
+
+void php_register_immutable_vector_handlers()
+{
+    // Everything that doesn't change the vector is shared with Vector,
+    // so the vector handlers must be registered first.
+    memcpy(&php_immutable_vector_handlers, &php_vector_handlers, sizeof(zend_object_handlers));
+
+    php_immutable_vector_handlers.clone_obj        = php_ds_immutable_vector_clone_obj;
+    php_immutable_vector_handlers.read_dimension   = php_ds_immutable_vector_read_dimension;
+    php_immutable_vector_handlers.write_dimension  = php_ds_immutable_vector_write_dimension;
+    php_immutable_vector_handlers.unset_dimension  = php_ds_immutable_vector_unset_dimension;
+}
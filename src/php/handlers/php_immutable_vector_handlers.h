@@ -0,0 +1,10 @@
+#ifndef PHP_DS_IMMUTABLE_VECTOR_HANDLERS_H
+#define PHP_DS_IMMUTABLE_VECTOR_HANDLERS_H
+
+#include "php.h"
+
+extern zend_object_handlers php_immutable_vector_handlers;
+
+void php_register_immutable_vector_handlers();
+
+#endif
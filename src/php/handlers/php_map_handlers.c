@@ -25,6 +25,11 @@ static zval *php_ds_map_read_dimension(zval *obj, zval *offset, int type, zval *
             }
         }
 
+        // Access by reference could change the value, so we have to separate.
+        if (type != BP_VAR_R) {
+            ds_htable_separate(map->table);
+        }
+
         // Get the value from the map.
         value = ds_map_get(map, offset, NULL);
 
@@ -98,8 +103,14 @@ static HashTable *php_ds_map_get_gc(zval *obj, zval **gc_data, int *gc_size)
 {
     ds_map_t *map = Z_DS_MAP_P(obj);
 
-    if (DS_MAP_IS_EMPTY(map)) {
-        *gc_data  = NULL;
+    // A shared table is reported through the object that holds it, because
+    // its buckets would otherwise be counted once for every owner.
+    if (map->table->refs) {
+        *gc_data = DS_SHARED_BUFFER_GC(map->table->refs);
+        *gc_size = 1;
+
+    } else if (DS_MAP_IS_EMPTY(map)) {
+        *gc_data = NULL;
         *gc_size = 0;
 
     } else {
@@ -110,6 +121,16 @@ static HashTable *php_ds_map_get_gc(zval *obj, zval **gc_data, int *gc_size)
     return NULL;
 }
 
+static bool php_ds_map_equals(zval *obj, zval *other)
+{
+    return ds_htable_equals(Z_DS_MAP_P(obj)->table, Z_DS_MAP_P(other)->table, true);
+}
+
+static int php_ds_map_compare_objects(zval *obj, zval *other)
+{
+    return php_ds_objects_equal(obj, other, php_ds_map_equals) ? 0 : 1;
+}
+
 void php_ds_register_map_handlers()
 {
     memcpy(&php_map_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
@@ -126,5 +147,6 @@ void php_ds_register_map_handlers()
     php_map_handlers.has_dimension      = php_ds_map_has_dimension;
     php_map_handlers.unset_dimension    = php_ds_map_unset_dimension;
     php_map_handlers.cast_object        = php_ds_default_cast_object;
+    php_map_handlers.compare_objects    = php_ds_map_compare_objects;
     // php_map_handlers.get_properties      = ds_map_get_properties;
 }
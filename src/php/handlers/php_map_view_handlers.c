@@ -0,0 +1,59 @@
+#include "php_common_handlers.h"
+#include "php_map_view_handlers.h"
+
+#include "../objects/php_map_view.h"
+#include "../../ds/ds_map_view.h"
+
+zend_object_handlers php_map_view_handlers;
+
+static void php_ds_map_view_free_object(zend_object *object)
+{
+    php_ds_map_view_t *obj = (php_ds_map_view_t *) object;
+    zend_object_std_dtor(&obj->std);
+    ds_map_view_free(obj->view);
+}
+
+static int php_ds_map_view_count_elements(zval *obj, zend_long *count)
+{
+    *count = DS_MAP_VIEW_SIZE(Z_DS_MAP_VIEW_P(obj));
+    return SUCCESS;
+}
+
+static HashTable *php_ds_map_view_get_debug_info(zval *obj, int *is_temp)
+{
+    zval arr;
+
+    *is_temp = 1;
+
+    ds_map_view_to_array(Z_DS_MAP_VIEW_P(obj), &arr);
+    return Z_ARRVAL(arr);
+}
+
+static zend_object *php_ds_map_view_clone_obj(zval *obj)
+{
+    return php_ds_map_view_create_clone(Z_DS_MAP_VIEW_P(obj));
+}
+
+static HashTable *php_ds_map_view_get_gc(zval *obj, zval **gc_data, int *gc_count)
+{
+    // The values are reported by the map, which the view only refers to.
+    *gc_data  = &Z_DS_MAP_VIEW_P(obj)->map;
+    *gc_count = 1;
+
+    return NULL;
+}
+
+void php_register_map_view_handlers()
+{
+    memcpy(&php_map_view_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+
+    php_map_view_handlers.offset = XtOffsetOf(php_ds_map_view_t, std);
+
+    php_map_view_handlers.dtor_obj        = zend_objects_destroy_object;
+    php_map_view_handlers.free_obj        = php_ds_map_view_free_object;
+    php_map_view_handlers.count_elements  = php_ds_map_view_count_elements;
+    php_map_view_handlers.get_debug_info  = php_ds_map_view_get_debug_info;
+    php_map_view_handlers.get_gc          = php_ds_map_view_get_gc;
+    php_map_view_handlers.clone_obj       = php_ds_map_view_clone_obj;
+    php_map_view_handlers.cast_object     = php_ds_default_cast_object;
+}
@@ -0,0 +1,10 @@
+#ifndef PHP_DS_MAP_VIEW_HANDLERS_H
+#define PHP_DS_MAP_VIEW_HANDLERS_H
+
+#include "php.h"
+
+extern zend_object_handlers php_map_view_handlers;
+
+void php_register_map_view_handlers();
+
+#endif
@@ -0,0 +1,144 @@
+#include "php_common_handlers.h"
+#include "php_mapped_handlers.h"
+
+#include "../objects/php_mapped.h"
+#include "../../ds/ds_mapped.h"
+
+zend_object_handlers php_mapped_handlers;
+
+/**
+ * Boxes the value of an index or a key, returning false if there isn't one.
+ */
+static bool php_ds_mapped_find(ds_mapped_t *mapped, zval *offset, zval *return_value)
+{
+    if (mapped->type == DS_MAPPED_MAP) {
+        return ds_mapped_lookup(mapped, offset, return_value);
+    }
+
+    if (Z_TYPE_P(offset) != IS_LONG || Z_LVAL_P(offset) < 0 || Z_LVAL_P(offset) >= mapped->size) {
+        return false;
+    }
+
+    ds_mapped_get_value(mapped, Z_LVAL_P(offset), return_value);
+    return true;
+}
+
+static zval *php_ds_mapped_read_dimension(zval *obj, zval *offset, int type, zval *rv)
+{
+    ds_mapped_t *mapped = Z_DS_MAPPED_P(obj);
+
+    if (offset == NULL) {
+        ARRAY_ACCESS_PUSH_NOT_SUPPORTED();
+        return NULL;
+    }
+
+    // Access by reference, eg. $mapped[$a][$b] = $c, could change the value.
+    if (type != BP_VAR_R && type != BP_VAR_IS) {
+        MUTABILITY_NOT_ALLOWED();
+        return NULL;
+    }
+
+    ZVAL_DEREF(offset);
+
+    if (mapped->type == DS_MAPPED_VECTOR && type == BP_VAR_R && Z_TYPE_P(offset) != IS_LONG) {
+        INTEGER_INDEX_REQUIRED(offset);
+        return NULL;
+    }
+
+    if (php_ds_mapped_find(mapped, offset, rv)) {
+        return rv;
+    }
+
+    // `??`
+    if (type == BP_VAR_IS) {
+        return &EG(uninitialized_zval);
+    }
+
+    if (mapped->type == DS_MAPPED_VECTOR) {
+        INDEX_OUT_OF_RANGE(Z_LVAL_P(offset), mapped->size);
+    } else {
+        KEY_NOT_FOUND();
+    }
+
+    return NULL;
+}
+
+static void php_ds_mapped_write_dimension(zval *obj, zval *offset, zval *value)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static void php_ds_mapped_unset_dimension(zval *obj, zval *offset)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static int php_ds_mapped_has_dimension(zval *obj, zval *offset, int check_empty)
+{
+    zval value;
+    int result;
+
+    ZVAL_DEREF(offset);
+
+    if ( ! php_ds_mapped_find(Z_DS_MAPPED_P(obj), offset, &value)) {
+        return 0;
+    }
+
+    result = ds_zval_isset(&value, check_empty);
+    zval_ptr_dtor(&value);
+
+    return result;
+}
+
+static int php_ds_mapped_count_elements(zval *obj, zend_long *count)
+{
+    *count = DS_MAPPED_SIZE(Z_DS_MAPPED_P(obj));
+    return SUCCESS;
+}
+
+static void php_ds_mapped_free_object(zend_object *object)
+{
+    php_ds_mapped_t *obj = (php_ds_mapped_t *) object;
+    zend_object_std_dtor(&obj->std);
+    ds_mapped_free(obj->mapped);
+}
+
+static HashTable *php_ds_mapped_get_debug_info(zval *obj, int *is_temp)
+{
+    zval arr;
+
+    *is_temp = 1;
+
+    ds_mapped_to_array(Z_DS_MAPPED_P(obj), &arr);
+    return Z_ARRVAL(arr);
+}
+
+static HashTable *php_ds_mapped_get_gc(zval *obj, zval **gc_data, int *gc_count)
+{
+    // Mapped values are only scalars and strings, so there's nothing to collect.
+    *gc_data  = NULL;
+    *gc_count = 0;
+
+    return NULL;
+}
+
+void php_register_mapped_handlers()
+{
+    memcpy(&php_mapped_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+
+    php_mapped_handlers.offset = XtOffsetOf(php_ds_mapped_t, std);
+
+    // A mapping can't be copied, and there's no reason to since it can't change.
+    php_mapped_handlers.clone_obj        = NULL;
+
+    php_mapped_handlers.dtor_obj         = zend_objects_destroy_object;
+    php_mapped_handlers.free_obj         = php_ds_mapped_free_object;
+    php_mapped_handlers.get_gc           = php_ds_mapped_get_gc;
+    php_mapped_handlers.get_debug_info   = php_ds_mapped_get_debug_info;
+    php_mapped_handlers.count_elements   = php_ds_mapped_count_elements;
+    php_mapped_handlers.read_dimension   = php_ds_mapped_read_dimension;
+    php_mapped_handlers.write_dimension  = php_ds_mapped_write_dimension;
+    php_mapped_handlers.has_dimension    = php_ds_mapped_has_dimension;
+    php_mapped_handlers.unset_dimension  = php_ds_mapped_unset_dimension;
+    php_mapped_handlers.cast_object      = php_ds_default_cast_object;
+}
@@ -0,0 +1,10 @@
+#ifndef PHP_DS_MAPPED_HANDLERS_H
+#define PHP_DS_MAPPED_HANDLERS_H
+
+#include "php.h"
+
+extern zend_object_handlers php_mapped_handlers;
+
+void php_register_mapped_handlers();
+
+#endif
@@ -0,0 +1,345 @@
+#include "php_opcode_handlers.h"
+
+#include "zend_compile.h"
+#include "zend_execute.h"
+
+#include "../objects/php_vector.h"
+#include "../objects/php_deque.h"
+#include "../objects/php_map.h"
+#include "../classes/php_vector_ce.h"
+#include "../classes/php_deque_ce.h"
+#include "../classes/php_map_ce.h"
+
+#if PHP_VERSION_ID >= 70300
+#define DS_OP_CONSTANT(opline, node) RT_CONSTANT(opline, node)
+#else
+#define DS_OP_CONSTANT(opline, node) EX_CONSTANT(node)
+#endif
+
+/**
+ * Handlers that were registered for each opcode before ours, if any.
+ */
+static user_opcode_handler_t php_ds_previous_handlers[256];
+
+static int php_ds_opcode_dispatch(zend_execute_data *execute_data)
+{
+    user_opcode_handler_t previous = php_ds_previous_handlers[EX(opline)->opcode];
+
+    if (previous) {
+        return previous(execute_data);
+    }
+
+    return ZEND_USER_OPCODE_DISPATCH;
+}
+
+/**
+ * Returns an operand, or NULL if it isn't a type that we handle. Compiled
+ * variables are dereferenced, and temporaries have to be freed after use.
+ */
+static zend_always_inline zval *php_ds_get_operand(
+    zend_execute_data   *execute_data,
+    const zend_op       *opline,
+    zend_uchar           type,
+    znode_op             node
+) {
+    zval *operand;
+
+    switch (type) {
+        case IS_CONST:
+            return DS_OP_CONSTANT(opline, node);
+
+        case IS_TMP_VAR:
+            return EX_VAR(node.var);
+
+        case IS_CV:
+            operand = EX_VAR(node.var);
+            ZVAL_DEREF(operand);
+            return Z_TYPE_P(operand) == IS_UNDEF ? NULL : operand;
+
+        default:
+            return NULL;
+    }
+}
+
+static zend_always_inline void php_ds_free_operand(
+    zend_execute_data   *execute_data,
+    zend_uchar           type,
+    znode_op             node
+) {
+    if (type == IS_TMP_VAR) {
+        zval_ptr_dtor_nogc(EX_VAR(node.var));
+    }
+}
+
+/**
+ * Returns the container of a dimension opcode if it's a compiled variable
+ * that holds an object, which is where collections are used in tight loops.
+ */
+static zend_always_inline zval *php_ds_get_container(zend_execute_data *execute_data, const zend_op *opline)
+{
+    zval *container;
+
+    if (opline->op1_type != IS_CV) {
+        return NULL;
+    }
+
+    container = EX_VAR(opline->op1.var);
+    ZVAL_DEREF(container);
+
+    return Z_TYPE_P(container) == IS_OBJECT ? container : NULL;
+}
+
+/**
+ * Finds the value at an offset of a Vector, Deque or Map, which is NULL if
+ * there isn't one. Returns false if the container or the type of the offset
+ * isn't handled here, so that nothing is thrown and no user code is called.
+ */
+static zend_always_inline bool php_ds_find_dimension(zval *container, zval *offset, zval **value)
+{
+    zend_class_entry *ce = Z_OBJCE_P(container);
+
+    if (ce == php_ds_vector_ce) {
+        ds_vector_t *vector = Z_DS_VECTOR_P(container);
+
+        if (Z_TYPE_P(offset) != IS_LONG) {
+            return false;
+        }
+
+        *value = Z_LVAL_P(offset) >= 0 && Z_LVAL_P(offset) < vector->size
+            ? ds_vector_get(vector, Z_LVAL_P(offset))
+            : NULL;
+
+        return true;
+    }
+
+    if (ce == php_ds_deque_ce) {
+        ds_deque_t *deque = Z_DS_DEQUE_P(container);
+
+        if (Z_TYPE_P(offset) != IS_LONG) {
+            return false;
+        }
+
+        *value = Z_LVAL_P(offset) >= 0 && Z_LVAL_P(offset) < deque->size
+            ? ds_deque_get(deque, Z_LVAL_P(offset))
+            : NULL;
+
+        return true;
+    }
+
+    if (ce == php_ds_map_ce) {
+        ds_htable_bucket_t *bucket;
+
+        if (Z_TYPE_P(offset) != IS_LONG && Z_TYPE_P(offset) != IS_STRING) {
+            return false;
+        }
+
+        bucket = ds_htable_lookup_by_key(Z_DS_MAP_P(container)->table, offset);
+        *value = bucket ? &bucket->value : NULL;
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * $c[$i] and $c[$i] ?? ...
+ */
+static int php_ds_fetch_dim_handler(zend_execute_data *execute_data)
+{
+    const zend_op *opline = EX(opline);
+
+    zval *container;
+    zval *offset;
+    zval *value;
+
+    if ( ! (container = php_ds_get_container(execute_data, opline))) {
+        return php_ds_opcode_dispatch(execute_data);
+    }
+
+    offset = php_ds_get_operand(execute_data, opline, opline->op2_type, opline->op2);
+
+    if ( ! offset || ! php_ds_find_dimension(container, offset, &value)) {
+        return php_ds_opcode_dispatch(execute_data);
+    }
+
+    if (value) {
+        ZVAL_DEREF(value);
+        ZVAL_COPY(EX_VAR(opline->result.var), value);
+
+    } else if (opline->opcode == ZEND_FETCH_DIM_IS) {
+        ZVAL_NULL(EX_VAR(opline->result.var));
+
+    } else {
+        // Leave it to the object handler to throw.
+        return php_ds_opcode_dispatch(execute_data);
+    }
+
+    php_ds_free_operand(execute_data, opline->op2_type, opline->op2);
+
+    EX(opline) = opline + 1;
+    return ZEND_USER_OPCODE_CONTINUE;
+}
+
+/**
+ * isset($c[$i]) and empty($c[$i])
+ */
+static int php_ds_isset_isempty_dim_handler(zend_execute_data *execute_data)
+{
+    const zend_op *opline = EX(opline);
+
+    zval *container;
+    zval *offset;
+    zval *value;
+    bool  result;
+
+    if ( ! (container = php_ds_get_container(execute_data, opline))) {
+        return php_ds_opcode_dispatch(execute_data);
+    }
+
+    offset = php_ds_get_operand(execute_data, opline, opline->op2_type, opline->op2);
+
+    if ( ! offset || ! php_ds_find_dimension(container, offset, &value)) {
+        return php_ds_opcode_dispatch(execute_data);
+    }
+
+    if (value) {
+        ZVAL_DEREF(value);
+    }
+
+    if (opline->extended_value & ZEND_ISEMPTY) {
+        result = ! ds_zval_isset(value, 1);
+    } else {
+        result = ds_zval_isset(value, 0);
+    }
+
+    php_ds_free_operand(execute_data, opline->op2_type, opline->op2);
+
+    // Checking whether a value is empty can call a cast handler.
+    if (UNEXPECTED(EG(exception))) {
+        return ZEND_USER_OPCODE_CONTINUE;
+    }
+
+    ZVAL_BOOL(EX_VAR(opline->result.var), result);
+
+    EX(opline) = opline + 1;
+    return ZEND_USER_OPCODE_CONTINUE;
+}
+
+/**
+ * $c[$i] = ... and $c[] = ..., where the value is the operand of the
+ * OP_DATA that follows.
+ */
+static int php_ds_assign_dim_handler(zend_execute_data *execute_data)
+{
+    const zend_op *opline = EX(opline);
+    const zend_op *data   = opline + 1;
+
+    zend_class_entry *ce;
+
+    zval *container;
+    zval *offset = NULL;
+    zval *value;
+
+    if ( ! (container = php_ds_get_container(execute_data, opline))) {
+        return php_ds_opcode_dispatch(execute_data);
+    }
+
+    if ( ! (value = php_ds_get_operand(execute_data, data, data->op1_type, data->op1))) {
+        return php_ds_opcode_dispatch(execute_data);
+    }
+
+    if (opline->op2_type != IS_UNUSED) {
+        offset = php_ds_get_operand(execute_data, opline, opline->op2_type, opline->op2);
+
+        if ( ! offset) {
+            return php_ds_opcode_dispatch(execute_data);
+        }
+    }
+
+    ce = Z_OBJCE_P(container);
+
+    if (ce == php_ds_vector_ce) {
+        if (offset == NULL) {
+            ds_vector_push(Z_DS_VECTOR_P(container), value);
+
+        } else if (Z_TYPE_P(offset) == IS_LONG) {
+            ds_vector_set(Z_DS_VECTOR_P(container), Z_LVAL_P(offset), value);
+
+        } else {
+            return php_ds_opcode_dispatch(execute_data);
+        }
+
+    } else if (ce == php_ds_deque_ce) {
+        if (offset == NULL) {
+            ds_deque_push(Z_DS_DEQUE_P(container), value);
+
+        } else if (Z_TYPE_P(offset) == IS_LONG) {
+            ds_deque_set(Z_DS_DEQUE_P(container), Z_LVAL_P(offset), value);
+
+        } else {
+            return php_ds_opcode_dispatch(execute_data);
+        }
+
+    } else if (ce == php_ds_map_ce) {
+        if (offset && (Z_TYPE_P(offset) == IS_LONG || Z_TYPE_P(offset) == IS_STRING)) {
+            ds_htable_put(Z_DS_MAP_P(container)->table, offset, value);
+
+        } else {
+            return php_ds_opcode_dispatch(execute_data);
+        }
+
+    } else {
+        return php_ds_opcode_dispatch(execute_data);
+    }
+
+    // An index out of range throws, and so can the destructor of a value
+    // that was replaced. The engine has already moved to the exception.
+    if (UNEXPECTED(EG(exception))) {
+        php_ds_free_operand(execute_data, opline->op2_type, opline->op2);
+        php_ds_free_operand(execute_data, data->op1_type, data->op1);
+        return ZEND_USER_OPCODE_CONTINUE;
+    }
+
+    if (opline->result_type != IS_UNUSED) {
+        ZVAL_COPY(EX_VAR(opline->result.var), value);
+    }
+
+    php_ds_free_operand(execute_data, opline->op2_type, opline->op2);
+    php_ds_free_operand(execute_data, data->op1_type, data->op1);
+
+    EX(opline) = opline + 2;
+    return ZEND_USER_OPCODE_CONTINUE;
+}
+
+static void php_ds_set_opcode_handler(zend_uchar opcode, user_opcode_handler_t handler)
+{
+    php_ds_previous_handlers[opcode] = zend_get_user_opcode_handler(opcode);
+    zend_set_user_opcode_handler(opcode, handler);
+}
+
+static void php_ds_reset_opcode_handler(zend_uchar opcode, user_opcode_handler_t handler)
+{
+    // Another extension might have chained its own handler after ours.
+    if (zend_get_user_opcode_handler(opcode) == handler) {
+        zend_set_user_opcode_handler(opcode, php_ds_previous_handlers[opcode]);
+    }
+
+    php_ds_previous_handlers[opcode] = NULL;
+}
+
+void php_ds_register_opcode_handlers()
+{
+    php_ds_set_opcode_handler(ZEND_FETCH_DIM_R,           php_ds_fetch_dim_handler);
+    php_ds_set_opcode_handler(ZEND_FETCH_DIM_IS,          php_ds_fetch_dim_handler);
+    php_ds_set_opcode_handler(ZEND_ISSET_ISEMPTY_DIM_OBJ, php_ds_isset_isempty_dim_handler);
+    php_ds_set_opcode_handler(ZEND_ASSIGN_DIM,            php_ds_assign_dim_handler);
+}
+
+void php_ds_unregister_opcode_handlers()
+{
+    php_ds_reset_opcode_handler(ZEND_FETCH_DIM_R,           php_ds_fetch_dim_handler);
+    php_ds_reset_opcode_handler(ZEND_FETCH_DIM_IS,          php_ds_fetch_dim_handler);
+    php_ds_reset_opcode_handler(ZEND_ISSET_ISEMPTY_DIM_OBJ, php_ds_isset_isempty_dim_handler);
+    php_ds_reset_opcode_handler(ZEND_ASSIGN_DIM,            php_ds_assign_dim_handler);
+}
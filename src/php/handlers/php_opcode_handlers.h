@@ -0,0 +1,18 @@
+#ifndef PHP_DS_OPCODE_HANDLERS_H
+#define PHP_DS_OPCODE_HANDLERS_H
+
+#include "php.h"
+
+/**
+ * User opcode handlers for reads, writes and isset of $vector[$i],
+ * $deque[$i] and $map[$key], which skip the generic object handler path.
+ * Anything that isn't a simple case is passed on to a handler that was
+ * registered before, or to the engine.
+ *
+ * These replace the engine's specialized handlers for the same opcodes on
+ * arrays too, so they are only registered when ds.opcode_handlers is on.
+ */
+void php_ds_register_opcode_handlers();
+void php_ds_unregister_opcode_handlers();
+
+#endif
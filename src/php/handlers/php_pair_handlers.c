@@ -151,6 +151,16 @@ static HashTable *php_ds_pair_get_gc(zval *obj, zval **gc_data, int *gc_count)
     return NULL;
 }
 
+static bool php_ds_pair_equals(zval *obj, zval *other)
+{
+    return ds_pair_equals(Z_DS_PAIR_P(obj), Z_DS_PAIR_P(other));
+}
+
+static int php_ds_pair_compare_objects(zval *obj, zval *other)
+{
+    return php_ds_objects_equal(obj, other, php_ds_pair_equals) ? 0 : 1;
+}
+
 void php_ds_register_pair_handlers()
 {
     memcpy(&php_pair_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
@@ -162,6 +172,7 @@ void php_ds_register_pair_handlers()
     php_pair_handlers.free_obj                = php_ds_pair_free_object;
     php_pair_handlers.clone_obj               = php_ds_pair_clone_object;
     php_pair_handlers.cast_object             = php_ds_default_cast_object;
+    php_pair_handlers.compare_objects         = php_ds_pair_compare_objects;
     php_pair_handlers.get_debug_info          = php_ds_pair_get_debug_info;
     php_pair_handlers.count_elements          = php_ds_pair_count_elements;
 
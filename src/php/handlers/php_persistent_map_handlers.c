@@ -0,0 +1,125 @@
+#include "php_common_handlers.h"
+#include "php_persistent_map_handlers.h"
+
+#include "../objects/php_persistent_map.h"
+#include "../../ds/ds_persistent_map.h"
+
+zend_object_handlers php_persistent_map_handlers;
+
+static zval *php_ds_persistent_map_read_dimension(zval *obj, zval *offset, int type, zval *rv)
+{
+    ds_persistent_map_t *map = Z_DS_PERSISTENT_MAP_P(obj);
+
+    if (offset == NULL) {
+        ARRAY_ACCESS_PUSH_NOT_SUPPORTED();
+        return NULL;
+    }
+
+    // Access by reference, eg. $map[$a][$b] = $c, could change the value.
+    if (type != BP_VAR_R && type != BP_VAR_IS) {
+        MUTABILITY_NOT_ALLOWED();
+        return NULL;
+    }
+
+    // Dereference the offset if it's a reference.
+    ZVAL_DEREF(offset);
+
+    // `??`
+    if (type == BP_VAR_IS) {
+        ds_htable_bucket_t *entry = ds_persistent_map_lookup(map, offset);
+
+        if ( ! entry || ! ds_zval_isset(&entry->value, 0)) {
+            return &EG(uninitialized_zval);
+        }
+
+        return &entry->value;
+    }
+
+    return ds_persistent_map_get(map, offset, NULL);
+}
+
+static void php_ds_persistent_map_write_dimension(zval *obj, zval *offset, zval *value)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static int php_ds_persistent_map_has_dimension(zval *obj, zval *offset, int check_empty)
+{
+    ds_htable_bucket_t *entry;
+
+    ZVAL_DEREF(offset);
+
+    entry = ds_persistent_map_lookup(Z_DS_PERSISTENT_MAP_P(obj), offset);
+    return entry && ds_zval_isset(&entry->value, check_empty);
+}
+
+static void php_ds_persistent_map_unset_dimension(zval *obj, zval *offset)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static int php_ds_persistent_map_count_elements(zval *obj, zend_long *count)
+{
+    *count = DS_PERSISTENT_MAP_SIZE(Z_DS_PERSISTENT_MAP_P(obj));
+    return SUCCESS;
+}
+
+static void php_ds_persistent_map_free_object(zend_object *object)
+{
+    php_ds_persistent_map_t *obj = (php_ds_persistent_map_t *) object;
+    zend_object_std_dtor(&obj->std);
+    ds_persistent_map_free(obj->map);
+
+    if (obj->gc_data) {
+        efree(obj->gc_data);
+    }
+}
+
+static HashTable *php_ds_persistent_map_get_debug_info(zval *obj, int *is_temp)
+{
+    zval arr;
+
+    *is_temp = 1;
+
+    ds_persistent_map_to_array(Z_DS_PERSISTENT_MAP_P(obj), &arr);
+    return Z_ARRVAL(arr);
+}
+
+static zend_object *php_ds_persistent_map_clone_obj(zval *obj)
+{
+    return php_ds_persistent_map_create_clone(Z_DS_PERSISTENT_MAP_P(obj));
+}
+
+static HashTable *php_ds_persistent_map_get_gc(zval *obj, zval **gc_data, int *gc_count)
+{
+    php_ds_persistent_map_t *intern = (php_ds_persistent_map_t *) Z_OBJ_P(obj);
+    int count = 0;
+
+    // Nodes that are shared with another version are not reported, because
+    // their entries would otherwise be counted once for every version.
+    ds_persistent_map_gather(intern->map, &intern->gc_data, &intern->gc_size, &count);
+
+    *gc_data  = count > 0 ? intern->gc_data : NULL;
+    *gc_count = count;
+
+    return NULL;
+}
+
+void php_register_persistent_map_handlers()
+{
+    memcpy(&php_persistent_map_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+
+    php_persistent_map_handlers.offset = XtOffsetOf(php_ds_persistent_map_t, std);
+
+    php_persistent_map_handlers.dtor_obj         = zend_objects_destroy_object;
+    php_persistent_map_handlers.free_obj         = php_ds_persistent_map_free_object;
+    php_persistent_map_handlers.get_gc           = php_ds_persistent_map_get_gc;
+    php_persistent_map_handlers.clone_obj        = php_ds_persistent_map_clone_obj;
+    php_persistent_map_handlers.cast_object      = php_ds_default_cast_object;
+    php_persistent_map_handlers.get_debug_info   = php_ds_persistent_map_get_debug_info;
+    php_persistent_map_handlers.count_elements   = php_ds_persistent_map_count_elements;
+    php_persistent_map_handlers.read_dimension   = php_ds_persistent_map_read_dimension;
+    php_persistent_map_handlers.write_dimension  = php_ds_persistent_map_write_dimension;
+    php_persistent_map_handlers.has_dimension    = php_ds_persistent_map_has_dimension;
+    php_persistent_map_handlers.unset_dimension  = php_ds_persistent_map_unset_dimension;
+}
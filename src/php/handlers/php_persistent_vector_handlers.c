@@ -0,0 +1,123 @@
+#include "php_common_handlers.h"
+#include "php_persistent_vector_handlers.h"
+
+#include "../objects/php_persistent_vector.h"
+#include "../../ds/ds_persistent_vector.h"
+
+zend_object_handlers php_persistent_vector_handlers;
+
+static zval *php_ds_persistent_vector_read_dimension(zval *obj, zval *offset, int type, zval *return_value)
+{
+    ds_persistent_vector_t *vector = Z_DS_PERSISTENT_VECTOR_P(obj);
+
+    // Access by reference, eg. $vector[$a][$b] = $c, could change the value.
+    if (type != BP_VAR_R && type != BP_VAR_IS) {
+        MUTABILITY_NOT_ALLOWED();
+        return NULL;
+    }
+
+    // Dereference the offset if it's a reference.
+    ZVAL_DEREF(offset);
+
+    // `??`
+    if (type == BP_VAR_IS) {
+        if (Z_TYPE_P(offset) != IS_LONG || ! ds_persistent_vector_isset(vector, Z_LVAL_P(offset), 0)) {
+            return &EG(uninitialized_zval);
+        }
+    }
+
+    // Enforce strict integer index.
+    if (Z_TYPE_P(offset) != IS_LONG) {
+        INTEGER_INDEX_REQUIRED(offset);
+        return NULL;
+    }
+
+    return ds_persistent_vector_get(vector, Z_LVAL_P(offset));
+}
+
+static void php_ds_persistent_vector_write_dimension(zval *obj, zval *offset, zval *value)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static int php_ds_persistent_vector_has_dimension(zval *obj, zval *offset, int check_empty)
+{
+    ZVAL_DEREF(offset);
+
+    if (Z_TYPE_P(offset) != IS_LONG) {
+        return 0;
+    }
+
+    return ds_persistent_vector_isset(Z_DS_PERSISTENT_VECTOR_P(obj), Z_LVAL_P(offset), check_empty);
+}
+
+static void php_ds_persistent_vector_unset_dimension(zval *obj, zval *offset)
+{
+    MUTABILITY_NOT_ALLOWED();
+}
+
+static int php_ds_persistent_vector_count_elements(zval *obj, zend_long *count)
+{
+    *count = DS_PERSISTENT_VECTOR_SIZE(Z_DS_PERSISTENT_VECTOR_P(obj));
+    return SUCCESS;
+}
+
+static void php_ds_persistent_vector_free_object(zend_object *object)
+{
+    php_ds_persistent_vector_t *obj = (php_ds_persistent_vector_t *) object;
+    zend_object_std_dtor(&obj->std);
+    ds_persistent_vector_free(obj->vector);
+
+    if (obj->gc_data) {
+        efree(obj->gc_data);
+    }
+}
+
+static HashTable *php_ds_persistent_vector_get_debug_info(zval *obj, int *is_temp)
+{
+    zval arr;
+
+    *is_temp = 1;
+
+    ds_persistent_vector_to_array(Z_DS_PERSISTENT_VECTOR_P(obj), &arr);
+    return Z_ARRVAL(arr);
+}
+
+static zend_object *php_ds_persistent_vector_clone_obj(zval *obj)
+{
+    return php_ds_persistent_vector_create_clone(Z_DS_PERSISTENT_VECTOR_P(obj));
+}
+
+static HashTable *php_ds_persistent_vector_get_gc(zval *obj, zval **gc_data, int *gc_count)
+{
+    php_ds_persistent_vector_t *intern = (php_ds_persistent_vector_t *) Z_OBJ_P(obj);
+    int count = 0;
+
+    // Nodes that are shared with another version are not reported, because
+    // their values would otherwise be counted once for every version.
+    ds_persistent_vector_gather(intern->vector, &intern->gc_data, &intern->gc_size, &count);
+
+    *gc_data  = count > 0 ? intern->gc_data : NULL;
+    *gc_count = count;
+
+    return NULL;
+}
+
+void php_register_persistent_vector_handlers()
+{
+    memcpy(&php_persistent_vector_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+
+    php_persistent_vector_handlers.offset = XtOffsetOf(php_ds_persistent_vector_t, std);
+
+    php_persistent_vector_handlers.dtor_obj         = zend_objects_destroy_object;
+    php_persistent_vector_handlers.free_obj         = php_ds_persistent_vector_free_object;
+    php_persistent_vector_handlers.get_gc           = php_ds_persistent_vector_get_gc;
+    php_persistent_vector_handlers.clone_obj        = php_ds_persistent_vector_clone_obj;
+    php_persistent_vector_handlers.cast_object      = php_ds_default_cast_object;
+    php_persistent_vector_handlers.get_debug_info   = php_ds_persistent_vector_get_debug_info;
+    php_persistent_vector_handlers.count_elements   = php_ds_persistent_vector_count_elements;
+    php_persistent_vector_handlers.read_dimension   = php_ds_persistent_vector_read_dimension;
+    php_persistent_vector_handlers.write_dimension  = php_ds_persistent_vector_write_dimension;
+    php_persistent_vector_handlers.has_dimension    = php_ds_persistent_vector_has_dimension;
+    php_persistent_vector_handlers.unset_dimension  = php_ds_persistent_vector_unset_dimension;
+}
@@ -0,0 +1,10 @@
+#ifndef PHP_DS_PERSISTENT_VECTOR_HANDLERS_H
+#define PHP_DS_PERSISTENT_VECTOR_HANDLERS_H
+
+#include "php.h"
+
+extern zend_object_handlers php_persistent_vector_handlers;
+
+void php_register_persistent_vector_handlers();
+
+#endif
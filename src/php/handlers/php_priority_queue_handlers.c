@@ -44,7 +44,13 @@ static HashTable *php_ds_priority_queue_get_gc(zval *object, zval **gc_data, int
 {
     php_ds_priority_queue_t *obj = (php_ds_priority_queue_t *) Z_OBJ_P(object);
 
-    if (DS_PRIORITY_QUEUE_IS_EMPTY(obj->queue)) {
+    // A shared buffer is reported through the object that holds it, because
+    // its nodes would otherwise be counted once for every owner.
+    if (obj->queue->refs) {
+        *gc_data = DS_SHARED_BUFFER_GC(obj->queue->refs);
+        *gc_size = 1;
+
+    } else if (DS_PRIORITY_QUEUE_IS_EMPTY(obj->queue)) {
         *gc_data = NULL;
         *gc_size = 0;
 
@@ -56,6 +62,16 @@ static HashTable *php_ds_priority_queue_get_gc(zval *object, zval **gc_data, int
     return NULL;
 }
 
+static bool php_ds_priority_queue_equals(zval *obj, zval *other)
+{
+    return ds_priority_queue_equals(Z_DS_PRIORITY_QUEUE_P(obj), Z_DS_PRIORITY_QUEUE_P(other));
+}
+
+static int php_ds_priority_queue_compare_objects(zval *obj, zval *other)
+{
+    return php_ds_objects_equal(obj, other, php_ds_priority_queue_equals) ? 0 : 1;
+}
+
 void php_ds_register_priority_queue_handlers()
 {
     memcpy(&php_priority_queue_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
@@ -66,6 +82,7 @@ void php_ds_register_priority_queue_handlers()
     php_priority_queue_handlers.free_obj          = php_ds_priority_queue_free_object;
     php_priority_queue_handlers.clone_obj         = php_ds_priority_queue_clone_obj;
     php_priority_queue_handlers.cast_object       = php_ds_default_cast_object;
+    php_priority_queue_handlers.compare_objects   = php_ds_priority_queue_compare_objects;
     php_priority_queue_handlers.get_debug_info    = php_ds_priority_queue_get_debug_info;
     php_priority_queue_handlers.count_elements    = php_ds_priority_queue_count_elements;
 }
@@ -1,5 +1,4 @@
 #include "php_common_handlers.h"
-#include "php_deque_handlers.h"
 
 #include "../objects/php_queue.h"
 #include "../../ds/ds_queue.h"
@@ -23,6 +22,10 @@ static void php_ds_queue_free_object(zend_object *object)
     php_ds_queue_t *queue = (php_ds_queue_t*) object;
     zend_object_std_dtor(&queue->std);
     ds_queue_free(queue->queue);
+
+    if (queue->gc_data) {
+        efree(queue->gc_data);
+    }
 }
 
 static int php_ds_queue_count_elements(zval *obj, zend_long *count)
@@ -49,15 +52,54 @@ static HashTable *php_ds_queue_get_debug_info(zval *obj, int *is_temp)
 
 static HashTable *php_ds_queue_get_gc(zval *obj, zval **gc_data, int *gc_count)
 {
-    ds_queue_t *queue = Z_DS_QUEUE_P(obj);
-    ds_deque_t *deque = queue->deque;
-
-    *gc_data  = deque->buffer;
-    *gc_count = deque->head == 0 ? deque->size : deque->capacity;
+    php_ds_queue_t *intern = (php_ds_queue_t *) Z_OBJ_P(obj);
+    ds_queue_t *queue = intern->queue;
+
+    // Shared blocks are reported through the object that holds them, see
+    // php_ds_vector_get_gc.
+    if (queue->refs) {
+        *gc_data  = DS_SHARED_BUFFER_GC(queue->refs);
+        *gc_count = 1;
+
+    } else if (QUEUE_IS_EMPTY(queue)) {
+        *gc_data  = NULL;
+        *gc_count = 0;
+
+    } else {
+        zval *value;
+        zval *dst;
+
+        // The values are spread across blocks, so they are gathered into a
+        // buffer that the object keeps for the next time.
+        if (intern->gc_size < QUEUE_SIZE(queue)) {
+            intern->gc_size = (int) QUEUE_SIZE(queue);
+            intern->gc_data = safe_erealloc(intern->gc_data, intern->gc_size, sizeof(zval), 0);
+        }
+
+        dst = intern->gc_data;
+
+        DS_QUEUE_FOREACH(queue, value) {
+            ZVAL_COPY_VALUE(dst++, value);
+        }
+        DS_QUEUE_FOREACH_END();
+
+        *gc_data  = intern->gc_data;
+        *gc_count = (int) QUEUE_SIZE(queue);
+    }
 
     return NULL;
 }
 
+static bool php_ds_queue_equals(zval *obj, zval *other)
+{
+    return ds_queue_equals(Z_DS_QUEUE_P(obj), Z_DS_QUEUE_P(other));
+}
+
+static int php_ds_queue_compare_objects(zval *obj, zval *other)
+{
+    return php_ds_objects_equal(obj, other, php_ds_queue_equals) ? 0 : 1;
+}
+
 void php_ds_register_queue_handlers()
 {
     memcpy(&php_queue_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
@@ -69,6 +111,7 @@ void php_ds_register_queue_handlers()
     php_queue_handlers.free_obj          = php_ds_queue_free_object;
     php_queue_handlers.clone_obj         = php_ds_queue_clone_obj;
     php_queue_handlers.cast_object       = php_ds_default_cast_object;
+    php_queue_handlers.compare_objects   = php_ds_queue_compare_objects;
     php_queue_handlers.get_debug_info    = php_ds_queue_get_debug_info;
     php_queue_handlers.count_elements    = php_ds_queue_count_elements;
     php_queue_handlers.write_dimension   = php_ds_queue_write_dimension;
@@ -71,7 +71,12 @@ static HashTable *php_ds_set_get_gc(zval *obj, zval **gc_data, int *gc_count)
 {
     ds_set_t *set = Z_DS_SET_P(obj);
 
-    if (DS_SET_IS_EMPTY(set)) {
+    // A shared table is reported through its object, see php_ds_map_get_gc.
+    if (set->table->refs) {
+        *gc_data  = DS_SHARED_BUFFER_GC(set->table->refs);
+        *gc_count = 1;
+
+    } else if (DS_SET_IS_EMPTY(set)) {
         *gc_data  = NULL;
         *gc_count = 0;
 
@@ -83,6 +88,16 @@ static HashTable *php_ds_set_get_gc(zval *obj, zval **gc_data, int *gc_count)
     return NULL;
 }
 
+static bool php_ds_set_equals(zval *obj, zval *other)
+{
+    return ds_htable_equals(Z_DS_SET_P(obj)->table, Z_DS_SET_P(other)->table, false);
+}
+
+static int php_ds_set_compare_objects(zval *obj, zval *other)
+{
+    return php_ds_objects_equal(obj, other, php_ds_set_equals) ? 0 : 1;
+}
+
 void php_ds_register_set_handlers()
 {
     memcpy(&php_ds_set_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
@@ -90,6 +105,7 @@ void php_ds_register_set_handlers()
     php_ds_set_handlers.offset = 0; // XtOffsetOf(php_ds_set_t, std);
 
     php_ds_set_handlers.cast_object     = php_ds_default_cast_object;
+    php_ds_set_handlers.compare_objects = php_ds_set_compare_objects;
     php_ds_set_handlers.clone_obj       = php_ds_set_clone_obj;
     php_ds_set_handlers.count_elements  = php_ds_set_count_elements;
     php_ds_set_handlers.free_obj        = php_ds_set_free_object;
@@ -50,12 +50,29 @@ static HashTable *php_ds_stack_get_gc(zval *obj, zval **gc_data, int *gc_count)
 {
     ds_stack_t *stack = Z_DS_STACK_P(obj);
 
-    *gc_data  = (zval*) stack->vector->buffer;
-    *gc_count = (int)   stack->vector->size;
+    // A shared buffer is reported through its object, see php_ds_vector_get_gc.
+    if (stack->vector->refs) {
+        *gc_data  = DS_SHARED_BUFFER_GC(stack->vector->refs);
+        *gc_count = 1;
+
+    } else {
+        *gc_data  = (zval*) stack->vector->buffer;
+        *gc_count = (int)   stack->vector->size;
+    }
 
     return NULL;
 }
 
+static bool php_ds_stack_equals(zval *obj, zval *other)
+{
+    return ds_vector_equals(Z_DS_STACK_P(obj)->vector, Z_DS_STACK_P(other)->vector);
+}
+
+static int php_ds_stack_compare_objects(zval *obj, zval *other)
+{
+    return php_ds_objects_equal(obj, other, php_ds_stack_equals) ? 0 : 1;
+}
+
 void php_register_ds_stack_handlers()
 {
     memcpy(&php_ds_stack_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
@@ -67,6 +84,7 @@ void php_register_ds_stack_handlers()
     php_ds_stack_handlers.free_obj          = php_ds_stack_free_object;
     php_ds_stack_handlers.clone_obj         = php_ds_stack_clone_obj;
     php_ds_stack_handlers.cast_object       = php_ds_default_cast_object;
+    php_ds_stack_handlers.compare_objects   = php_ds_stack_compare_objects;
     php_ds_stack_handlers.get_debug_info    = php_ds_stack_get_debug_info;
     php_ds_stack_handlers.count_elements    = php_ds_stack_count_elements;
     php_ds_stack_handlers.write_dimension   = php_ds_stack_write_dimension;
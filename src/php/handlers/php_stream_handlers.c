@@ -0,0 +1,193 @@
+#include "php_common_handlers.h"
+#include "php_stream_handlers.h"
+
+#include "../objects/php_stream.h"
+#include "../../ds/ds_stream.h"
+
+zend_object_handlers php_stream_handlers;
+
+static void php_ds_stream_free_object(zend_object *object)
+{
+    php_ds_stream_t *obj = (php_ds_stream_t *) object;
+    zend_object_std_dtor(&obj->std);
+    ds_stream_free(obj->stream);
+
+    if (obj->gc_data) {
+        efree(obj->gc_data);
+    }
+}
+
+static zend_object *php_ds_stream_clone_obj(zval *obj)
+{
+    return php_ds_stream_create_clone(Z_DS_STREAM_P(obj));
+}
+
+/**
+ * Returns the most values that a stream's source could report to the GC. A
+ * shared buffer is reported through its object, see php_ds_vector_get_gc.
+ * The values of a persistent source are gathered separately.
+ */
+static zend_long php_ds_stream_gc_source_size(ds_stream_source_t *source)
+{
+    switch (source->type) {
+        case DS_STREAM_SOURCE_VECTOR:
+        case DS_STREAM_SOURCE_VECTOR_REVERSED: {
+            ds_vector_t *vector = source->collection.vector;
+            return (vector->refs ? 1 : vector->size) + 1;
+        }
+
+        case DS_STREAM_SOURCE_DEQUE: {
+            ds_deque_t *deque = source->collection.deque;
+            return (deque->refs ? 1 : deque->size) + 1;
+        }
+
+        case DS_STREAM_SOURCE_QUEUE: {
+            ds_queue_t *queue = source->collection.queue;
+            return queue->refs ? 1 : queue->size;
+        }
+
+        case DS_STREAM_SOURCE_PAIRS:
+        case DS_STREAM_SOURCE_KEYS: {
+            ds_htable_t *table = source->collection.table;
+            return table->refs ? 1 : table->next * 2;
+        }
+
+        case DS_STREAM_SOURCE_PERSISTENT_VECTOR:
+        case DS_STREAM_SOURCE_PERSISTENT_MAP:
+            return 0;
+    }
+
+    return 0;
+}
+
+static HashTable *php_ds_stream_get_gc(zval *obj, zval **gc_data, int *gc_count)
+{
+    php_ds_stream_t    *intern = (php_ds_stream_t *) Z_OBJ_P(obj);
+    ds_stream_t        *stream = intern->stream;
+    ds_stream_source_t *source = stream->source;
+    ds_stream_stage_t  *stage;
+
+    zend_long size  = stream->size;
+    zend_long count = 0;
+    zval     *value;
+
+    // Streams that were derived from each other share their source and their
+    // first stages, which would otherwise be counted once for every stream.
+    // Only what this stream holds alone is reported: the stages after the
+    // last shared stage, and the source if no other stream shares it.
+    if (source->refs == 1) {
+        size += php_ds_stream_gc_source_size(source);
+    }
+
+    if (intern->gc_size < size) {
+        intern->gc_size = (int) size;
+        intern->gc_data = safe_erealloc(intern->gc_data, intern->gc_size, sizeof(zval), 0);
+    }
+
+    // The callbacks of skip and take stages are undefined.
+    for (stage = stream->last; stage && stage->refs == 1; stage = stage->prev) {
+        ZVAL_COPY_VALUE(&intern->gc_data[count++], &stage->fci.function_name);
+    }
+
+    if (source->refs > 1) {
+        *gc_data  = count > 0 ? intern->gc_data : NULL;
+        *gc_count = (int) count;
+        return NULL;
+    }
+
+    switch (source->type) {
+        case DS_STREAM_SOURCE_VECTOR:
+        case DS_STREAM_SOURCE_VECTOR_REVERSED: {
+            ds_vector_t *vector = source->collection.vector;
+
+            if (vector->refs) {
+                ZVAL_COPY_VALUE(&intern->gc_data[count++], DS_SHARED_BUFFER_GC(vector->refs));
+            } else {
+                DS_VECTOR_FOREACH(vector, value) {
+                    ZVAL_COPY_VALUE(&intern->gc_data[count++], value);
+                }
+                DS_VECTOR_FOREACH_END();
+            }
+
+            ZVAL_COPY_VALUE(&intern->gc_data[count++], &vector->snapshot);
+            break;
+        }
+
+        case DS_STREAM_SOURCE_DEQUE: {
+            ds_deque_t *deque = source->collection.deque;
+
+            if (deque->refs) {
+                ZVAL_COPY_VALUE(&intern->gc_data[count++], DS_SHARED_BUFFER_GC(deque->refs));
+            } else {
+                DS_DEQUE_FOREACH(deque, value) {
+                    ZVAL_COPY_VALUE(&intern->gc_data[count++], value);
+                }
+                DS_DEQUE_FOREACH_END();
+            }
+
+            ZVAL_COPY_VALUE(&intern->gc_data[count++], &deque->snapshot);
+            break;
+        }
+
+        case DS_STREAM_SOURCE_QUEUE: {
+            ds_queue_t *queue = source->collection.queue;
+
+            if (queue->refs) {
+                ZVAL_COPY_VALUE(&intern->gc_data[count++], DS_SHARED_BUFFER_GC(queue->refs));
+            } else {
+                DS_QUEUE_FOREACH(queue, value) {
+                    ZVAL_COPY_VALUE(&intern->gc_data[count++], value);
+                }
+                DS_QUEUE_FOREACH_END();
+            }
+            break;
+        }
+
+        // A bucket is a key and a value, and deleted buckets are undefined.
+        case DS_STREAM_SOURCE_PAIRS:
+        case DS_STREAM_SOURCE_KEYS: {
+            ds_htable_t *table = source->collection.table;
+
+            if (table->refs) {
+                ZVAL_COPY_VALUE(&intern->gc_data[count++], DS_SHARED_BUFFER_GC(table->refs));
+            } else if (table->next > 0) {
+                memcpy(&intern->gc_data[count], table->buckets, table->next * 2 * sizeof(zval));
+                count += table->next * 2;
+            }
+            break;
+        }
+
+        // These grow the buffer as needed.
+        case DS_STREAM_SOURCE_PERSISTENT_VECTOR: {
+            int gathered = (int) count;
+            ds_persistent_vector_gather(source->collection.persistent_vector, &intern->gc_data, &intern->gc_size, &gathered);
+            count = gathered;
+            break;
+        }
+
+        case DS_STREAM_SOURCE_PERSISTENT_MAP: {
+            int gathered = (int) count;
+            ds_persistent_map_gather(source->collection.persistent_map, &intern->gc_data, &intern->gc_size, &gathered);
+            count = gathered;
+            break;
+        }
+    }
+
+    *gc_data  = count > 0 ? intern->gc_data : NULL;
+    *gc_count = (int) count;
+
+    return NULL;
+}
+
+void php_register_stream_handlers()
+{
+    memcpy(&php_stream_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+
+    php_stream_handlers.offset = XtOffsetOf(php_ds_stream_t, std);
+
+    php_stream_handlers.dtor_obj     = zend_objects_destroy_object;
+    php_stream_handlers.free_obj     = php_ds_stream_free_object;
+    php_stream_handlers.get_gc       = php_ds_stream_get_gc;
+    php_stream_handlers.clone_obj    = php_ds_stream_clone_obj;
+    php_stream_handlers.cast_object  = php_ds_default_cast_object;
+}
@@ -0,0 +1,10 @@
+#ifndef PHP_DS_STREAM_HANDLERS_H
+#define PHP_DS_STREAM_HANDLERS_H
+
+#include "php.h"
+
+extern zend_object_handlers php_stream_handlers;
+
+void php_register_stream_handlers();
+
+#endif
@@ -27,6 +27,11 @@ static zval *php_ds_vector_read_dimension(zval *obj, zval *offset, int type, zva
         return NULL;
     }
 
+    // Access by reference could change the value, so we have to separate.
+    if (type != BP_VAR_R) {
+        DS_VECTOR_SEPARATE(vector);
+    }
+
     // Access the value at the given index.
     value = ds_vector_get(vector, Z_LVAL_P(offset));
 
@@ -101,6 +106,10 @@ static void php_ds_vector_free_object(zend_object *object)
     php_ds_vector_t *obj = (php_ds_vector_t*) object;
     zend_object_std_dtor(&obj->std);
     ds_vector_free(obj->vector);
+
+    if (obj->gc_data) {
+        efree(obj->gc_data);
+    }
 }
 
 static HashTable *php_ds_vector_get_debug_info(zval *obj, int *is_temp)
@@ -121,14 +130,49 @@ static zend_object *php_ds_vector_clone_obj(zval *obj)
 
 static HashTable *php_ds_vector_get_gc(zval *obj, zval **gc_data, int *gc_count)
 {
-    ds_vector_t *vector = Z_DS_VECTOR_P(obj);
+    php_ds_vector_t *intern = (php_ds_vector_t *) Z_OBJ_P(obj);
+    ds_vector_t *vector = intern->vector;
+
+    // A shared buffer is reported once, through the object that holds it,
+    // because its values would otherwise be counted once for every owner.
+    zval     *values = vector->refs ? DS_SHARED_BUFFER_GC(vector->refs) : vector->buffer;
+    zend_long size   = vector->refs ? 1 : vector->size;
+
+    // The array snapshot holds references of its own, so it's reported too,
+    // after the values in a buffer that the object keeps for the next time.
+    if (Z_TYPE(vector->snapshot) == IS_ARRAY) {
+        if (intern->gc_size < size + 1) {
+            intern->gc_size = (int) size + 1;
+            intern->gc_data = safe_erealloc(intern->gc_data, intern->gc_size, sizeof(zval), 0);
+        }
+
+        if (size > 0) {
+            memcpy(intern->gc_data, values, size * sizeof(zval));
+        }
+
+        ZVAL_COPY_VALUE(&intern->gc_data[size], &vector->snapshot);
 
-    *gc_data  = vector->buffer;
-    *gc_count = (int) vector->size;
+        *gc_data  = intern->gc_data;
+        *gc_count = (int) size + 1;
+
+    } else {
+        *gc_data  = size > 0 ? values : NULL;
+        *gc_count = (int) size;
+    }
 
     return NULL;
 }
 
+static bool php_ds_vector_equals(zval *obj, zval *other)
+{
+    return ds_vector_equals(Z_DS_VECTOR_P(obj), Z_DS_VECTOR_P(other));
+}
+
+static int php_ds_vector_compare_objects(zval *obj, zval *other)
+{
+    return php_ds_objects_equal(obj, other, php_ds_vector_equals) ? 0 : 1;
+}
+
 void php_register_vector_handlers()
 {
     memcpy(&php_vector_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
@@ -140,6 +184,7 @@ void php_register_vector_handlers()
     php_vector_handlers.get_gc           = php_ds_vector_get_gc;
     php_vector_handlers.clone_obj        = php_ds_vector_clone_obj;
     php_vector_handlers.cast_object      = php_ds_default_cast_object;
+    php_vector_handlers.compare_objects  = php_ds_vector_compare_objects;
     php_vector_handlers.get_debug_info   = php_ds_vector_get_debug_info;
     php_vector_handlers.count_elements   = php_ds_vector_count_elements;
     php_vector_handlers.read_dimension   = php_ds_vector_read_dimension;
@@ -0,0 +1,14 @@
+#include "../../common.h"
+
+#include "../../ds/ds_counter.h"
+#include "../../ds/ds_htable.h"
+#include "../objects/php_counter.h"
+
+#include "php_counter_iterator.h"
+#include "php_htable_iterator.h"
+
+zend_object_iterator *php_ds_counter_get_iterator(zend_class_entry *ce, zval *obj, int by_ref)
+{
+    ds_htable_t *table = Z_DS_COUNTER_P(obj)->table;
+    return php_ds_htable_get_assoc_iterator_ex(ce, obj, by_ref, table);
+}
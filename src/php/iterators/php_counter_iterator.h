@@ -0,0 +1,11 @@
+#ifndef DS_COUNTER_ITERATOR_H
+#define DS_COUNTER_ITERATOR_H
+
+#include "php.h"
+
+/**
+ * Iterates over values and their counts, as keys and values.
+ */
+zend_object_iterator *php_ds_counter_get_iterator(zend_class_entry *ce, zval *obj, int by_ref);
+
+#endif
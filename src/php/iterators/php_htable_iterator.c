@@ -1,6 +1,7 @@
 #include "../../common.h"
 
 #include "../../ds/ds_htable.h"
+#include "../objects/php_pair.h"
 #include "php_htable_iterator.h"
 
 static ds_htable_bucket_t *find_starting_bucket(ds_htable_t *table)
@@ -26,12 +27,28 @@ static void php_ds_htable_iterator_dtor(zend_object_iterator *iter)
     DTOR_AND_UNDEF(&iterator->intern.data);
 }
 
+/**
+ * A change could have moved or freed the current bucket, so a guarded
+ * iterator stops and throws rather than continuing from it.
+ */
+static inline bool php_ds_htable_iterator_changed(ds_htable_iterator_t *iterator)
+{
+    return iterator->guarded && iterator->changes != iterator->table->changes;
+}
+
 static int php_ds_htable_iterator_valid(zend_object_iterator *iter)
 {
     ds_htable_iterator_t *iterator = (ds_htable_iterator_t *) iter;
     uint32_t size                  = iterator->table->size;
     uint32_t position              = iterator->position;
 
+    if (php_ds_htable_iterator_changed(iterator)) {
+        if ( ! EG(exception)) {
+            MODIFIED_DURING_ITERATION();
+        }
+        return FAILURE;
+    }
+
     return position < size ? SUCCESS : FAILURE;
 }
 
@@ -75,21 +92,13 @@ static zval *php_ds_htable_iterator_get_current_pair(zend_object_iterator *iter)
     ds_htable_bucket_t   *bucket   = iterator->bucket;
 
     if ( ! DS_HTABLE_BUCKET_DELETED(bucket)) {
+        zval *pair = &iterator->intern.data;
 
-        zval *key = &bucket->key;
-        zval *val = &bucket->value;
-
-        zval *arr = &iterator->intern.data;
-
-        Z_TRY_ADDREF_P(key);
-        Z_TRY_ADDREF_P(val);
-
-        array_init_size(arr, 2);
+        // Release the pair of the previous iteration.
+        DTOR_AND_UNDEF(pair);
+        ZVAL_DS_PAIR(pair, ds_pair_ex(&bucket->key, &bucket->value));
 
-        add_next_index_zval(arr, key);
-        add_next_index_zval(arr, val);
-
-        return arr;
+        return pair;
     }
 
     return NULL;
@@ -104,6 +113,10 @@ static void php_ds_htable_iterator_move_forward(zend_object_iterator *iter)
 {
     ds_htable_iterator_t *iterator = (ds_htable_iterator_t *) iter;
 
+    if (php_ds_htable_iterator_changed(iterator)) {
+        return;
+    }
+
     if (++iterator->position < iterator->table->size) {
         do {
             ++iterator->bucket;
@@ -117,6 +130,7 @@ static void php_ds_htable_iterator_rewind(zend_object_iterator *iter)
 
     iterator->position = 0;
     iterator->bucket   = find_starting_bucket(iterator->table);
+    iterator->changes  = iterator->table->changes;
 }
 
 static zend_object_iterator_funcs php_ds_htable_get_value_iterator_funcs = {
@@ -229,3 +243,13 @@ zend_object_iterator *php_ds_htable_get_assoc_iterator_ex(
     return php_ds_htable_create_htable_iterator(
         obj, table, &php_ds_htable_get_assoc_iterator_funcs, by_ref);
 }
+
+void php_ds_htable_iterator_guard(zend_object_iterator *iterator)
+{
+    ds_htable_iterator_t *guarded = (ds_htable_iterator_t *) iterator;
+
+    if (guarded) {
+        guarded->guarded = true;
+        guarded->changes = guarded->table->changes;
+    }
+}
@@ -11,6 +11,8 @@ typedef struct ds_htable_iterator {
     ds_htable_bucket_t      *bucket;
     ds_htable_t             *table;
     zend_object             *obj;
+    zend_ulong               changes;   // Changes to the table when rewound
+    bool                     guarded;   // Whether a change ends the iteration
 
 } ds_htable_iterator_t;
 
@@ -19,4 +21,10 @@ zend_object_iterator *php_ds_htable_get_key_iterator_ex  (zend_class_entry *ce,
 zend_object_iterator *php_ds_htable_get_pair_iterator_ex (zend_class_entry *ce, zval *obj, int by_ref, ds_htable_t *h);
 zend_object_iterator *php_ds_htable_get_assoc_iterator_ex(zend_class_entry *ce, zval *obj, int by_ref, ds_htable_t *h);
 
+/**
+ * Makes an iterator throw if the table is changed while it's being iterated,
+ * for tables that are not owned by the iterated object, eg. that of a view.
+ */
+void php_ds_htable_iterator_guard(zend_object_iterator *iterator);
+
 #endif
@@ -0,0 +1,32 @@
+#include "../../common.h"
+
+#include "../../ds/ds_map_view.h"
+#include "../../ds/ds_htable.h"
+#include "../objects/php_map_view.h"
+
+#include "php_map_view_iterator.h"
+#include "php_htable_iterator.h"
+
+zend_object_iterator *php_ds_map_view_get_iterator(zend_class_entry *ce, zval *obj, int by_ref)
+{
+    ds_map_view_t *view = Z_DS_MAP_VIEW_P(obj);
+    zend_object_iterator *iterator;
+
+    switch (view->type) {
+        case DS_MAP_VIEW_KEYS:
+            iterator = php_ds_htable_get_key_iterator_ex(ce, obj, by_ref, view->table);
+            break;
+
+        case DS_MAP_VIEW_VALUES:
+            iterator = php_ds_htable_get_value_iterator_ex(ce, obj, by_ref, view->table);
+            break;
+
+        default:
+            iterator = php_ds_htable_get_pair_iterator_ex(ce, obj, by_ref, view->table);
+            break;
+    }
+
+    // The table belongs to the map, which could be changed during the loop.
+    php_ds_htable_iterator_guard(iterator);
+    return iterator;
+}
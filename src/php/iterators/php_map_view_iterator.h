@@ -0,0 +1,11 @@
+#ifndef DS_MAP_VIEW_ITERATOR_H
+#define DS_MAP_VIEW_ITERATOR_H
+
+#include "php.h"
+
+/**
+ * Iterates over the keys, values or pairs of a view, with integer keys.
+ */
+zend_object_iterator *php_ds_map_view_get_iterator(zend_class_entry *ce, zval *obj, int by_ref);
+
+#endif
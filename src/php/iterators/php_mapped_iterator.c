@@ -0,0 +1,93 @@
+#include "../../common.h"
+
+#include "../../ds/ds_mapped.h"
+#include "../objects/php_mapped.h"
+#include "php_mapped_iterator.h"
+
+static void php_ds_mapped_iterator_dtor(zend_object_iterator *iter)
+{
+    php_ds_mapped_iterator_t *iterator = (php_ds_mapped_iterator_t *) iter;
+
+    DTOR_AND_UNDEF(&iterator->current);
+    OBJ_RELEASE(iterator->object);
+}
+
+static int php_ds_mapped_iterator_valid(zend_object_iterator *iter)
+{
+    php_ds_mapped_iterator_t *iterator = (php_ds_mapped_iterator_t *) iter;
+
+    return iterator->position < iterator->mapped->size ? SUCCESS : FAILURE;
+}
+
+static zval *php_ds_mapped_iterator_get_current_data(zend_object_iterator *iter)
+{
+    php_ds_mapped_iterator_t *iterator = (php_ds_mapped_iterator_t *) iter;
+
+    if (Z_ISUNDEF(iterator->current)) {
+        ds_mapped_get_value(iterator->mapped, iterator->position, &iterator->current);
+    }
+
+    return &iterator->current;
+}
+
+static void php_ds_mapped_iterator_get_current_key(zend_object_iterator *iter, zval *key)
+{
+    php_ds_mapped_iterator_t *iterator = (php_ds_mapped_iterator_t *) iter;
+
+    ds_mapped_get_key(iterator->mapped, iterator->position, key);
+}
+
+static void php_ds_mapped_iterator_move_forward(zend_object_iterator *iter)
+{
+    php_ds_mapped_iterator_t *iterator = (php_ds_mapped_iterator_t *) iter;
+
+    DTOR_AND_UNDEF(&iterator->current);
+    iterator->position++;
+}
+
+static void php_ds_mapped_iterator_rewind(zend_object_iterator *iter)
+{
+    php_ds_mapped_iterator_t *iterator = (php_ds_mapped_iterator_t *) iter;
+
+    DTOR_AND_UNDEF(&iterator->current);
+    iterator->position = 0;
+}
+
+static zend_object_iterator_funcs php_ds_mapped_iterator_funcs = {
+    php_ds_mapped_iterator_dtor,
+    php_ds_mapped_iterator_valid,
+    php_ds_mapped_iterator_get_current_data,
+    php_ds_mapped_iterator_get_current_key,
+    php_ds_mapped_iterator_move_forward,
+    php_ds_mapped_iterator_rewind
+};
+
+zend_object_iterator *php_ds_mapped_get_iterator(zend_class_entry *ce, zval *obj, int by_ref)
+{
+    php_ds_mapped_iterator_t *iterator;
+
+    if (by_ref) {
+        ITERATION_BY_REF_NOT_SUPPORTED();
+        return NULL;
+    }
+
+    iterator = ecalloc(1, sizeof(php_ds_mapped_iterator_t));
+
+    zend_iterator_init((zend_object_iterator*) iterator);
+
+    iterator->intern.funcs  = &php_ds_mapped_iterator_funcs;
+    iterator->mapped        = Z_DS_MAPPED_P(obj);
+    iterator->object        = Z_OBJ_P(obj);
+    iterator->position      = 0;
+
+    ZVAL_UNDEF(&iterator->current);
+
+    // Keep the object, and so the mapping, alive while it's being iterated.
+#if PHP_VERSION_ID >= 70300
+    GC_ADDREF(iterator->object);
+#else
+    ++GC_REFCOUNT(iterator->object);
+#endif
+
+    return (zend_object_iterator *) iterator;
+}
@@ -0,0 +1,21 @@
+#ifndef DS_MAPPED_ITERATOR_H
+#define DS_MAPPED_ITERATOR_H
+
+#include "php.h"
+#include "../../ds/ds_mapped.h"
+
+typedef struct php_ds_mapped_iterator {
+    zend_object_iterator     intern;
+    zend_object             *object;
+    ds_mapped_t             *mapped;
+    zend_long                position;
+    zval                     current;   // Boxed value at the current position
+} php_ds_mapped_iterator_t;
+
+/**
+ * Iterates over the indexes and values of a mapped vector, or the keys and
+ * values of a mapped map. Each value is boxed when it's reached.
+ */
+zend_object_iterator *php_ds_mapped_get_iterator(zend_class_entry *ce, zval *obj, int by_ref);
+
+#endif
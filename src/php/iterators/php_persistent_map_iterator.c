@@ -0,0 +1,90 @@
+#include "../../common.h"
+
+#include "../../ds/ds_persistent_map.h"
+#include "../objects/php_persistent_map.h"
+#include "php_persistent_map_iterator.h"
+
+static void php_ds_persistent_map_iterator_dtor(zend_object_iterator *iter)
+{
+    php_ds_persistent_map_iterator_t *iterator = (php_ds_persistent_map_iterator_t *) iter;
+
+    OBJ_RELEASE(iterator->object);
+}
+
+static int php_ds_persistent_map_iterator_valid(zend_object_iterator *iter)
+{
+    php_ds_persistent_map_iterator_t *iterator = (php_ds_persistent_map_iterator_t *) iter;
+
+    return iterator->bucket ? SUCCESS : FAILURE;
+}
+
+static zval *php_ds_persistent_map_iterator_get_current_data(zend_object_iterator *iter)
+{
+    php_ds_persistent_map_iterator_t *iterator = (php_ds_persistent_map_iterator_t *) iter;
+
+    return &iterator->bucket->value;
+}
+
+static void php_ds_persistent_map_iterator_get_current_key(zend_object_iterator *iter, zval *key)
+{
+    php_ds_persistent_map_iterator_t *iterator = (php_ds_persistent_map_iterator_t *) iter;
+
+    ZVAL_COPY(key, &iterator->bucket->key);
+}
+
+static void php_ds_persistent_map_iterator_move_forward(zend_object_iterator *iter)
+{
+    php_ds_persistent_map_iterator_t *iterator = (php_ds_persistent_map_iterator_t *) iter;
+
+    iterator->bucket = ds_persistent_map_cursor_next(&iterator->cursor);
+    iterator->position++;
+}
+
+static void php_ds_persistent_map_iterator_rewind(zend_object_iterator *iter)
+{
+    php_ds_persistent_map_iterator_t *iterator = (php_ds_persistent_map_iterator_t *) iter;
+
+    ds_persistent_map_cursor_rewind(&iterator->cursor, iterator->map);
+
+    iterator->bucket   = ds_persistent_map_cursor_next(&iterator->cursor);
+    iterator->position = 0;
+}
+
+static zend_object_iterator_funcs php_ds_persistent_map_iterator_funcs = {
+    php_ds_persistent_map_iterator_dtor,
+    php_ds_persistent_map_iterator_valid,
+    php_ds_persistent_map_iterator_get_current_data,
+    php_ds_persistent_map_iterator_get_current_key,
+    php_ds_persistent_map_iterator_move_forward,
+    php_ds_persistent_map_iterator_rewind
+};
+
+zend_object_iterator *php_ds_persistent_map_get_iterator(zend_class_entry *ce, zval *obj, int by_ref)
+{
+    php_ds_persistent_map_iterator_t *iterator;
+
+    if (by_ref) {
+        ITERATION_BY_REF_NOT_SUPPORTED();
+        return NULL;
+    }
+
+    iterator = ecalloc(1, sizeof(php_ds_persistent_map_iterator_t));
+
+    zend_iterator_init((zend_object_iterator*) iterator);
+
+    iterator->intern.funcs  = &php_ds_persistent_map_iterator_funcs;
+    iterator->map           = Z_DS_PERSISTENT_MAP_P(obj);
+    iterator->object        = Z_OBJ_P(obj);
+
+    php_ds_persistent_map_iterator_rewind((zend_object_iterator *) iterator);
+
+    // Add a reference to the object so that it doesn't get collected when
+    // the iterated object is implict, eg. foreach ($obj->getInstance() as $value){ ... }
+#if PHP_VERSION_ID >= 70300
+    GC_ADDREF(iterator->object);
+#else
+    ++GC_REFCOUNT(iterator->object);
+#endif
+
+    return (zend_object_iterator *) iterator;
+}
@@ -0,0 +1,18 @@
+#ifndef DS_PERSISTENT_MAP_ITERATOR_H
+#define DS_PERSISTENT_MAP_ITERATOR_H
+
+#include "php.h"
+#include "../../ds/ds_persistent_map.h"
+
+typedef struct php_ds_persistent_map_iterator {
+    zend_object_iterator         intern;
+    zend_object                 *object;
+    ds_persistent_map_t         *map;
+    ds_persistent_map_cursor_t   cursor;
+    ds_htable_bucket_t          *bucket;    // Current entry, or NULL at the end
+    zend_long                    position;
+} php_ds_persistent_map_iterator_t;
+
+zend_object_iterator *php_ds_persistent_map_get_iterator(zend_class_entry *ce, zval *obj, int by_ref);
+
+#endif
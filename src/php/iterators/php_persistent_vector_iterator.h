@@ -0,0 +1,17 @@
+#ifndef DS_PERSISTENT_VECTOR_ITERATOR_H
+#define DS_PERSISTENT_VECTOR_ITERATOR_H
+
+#include "php.h"
+#include "../../ds/ds_persistent_vector.h"
+
+typedef struct php_ds_persistent_vector_iterator {
+    zend_object_iterator             intern;
+    zend_object                     *object;
+    ds_persistent_vector_t          *vector;
+    ds_persistent_vector_node_t     *leaf;      // Leaf of the current position
+    zend_long                        position;
+} php_ds_persistent_vector_iterator_t;
+
+zend_object_iterator *php_ds_persistent_vector_get_iterator(zend_class_entry *ce, zval *obj, int by_ref);
+
+#endif
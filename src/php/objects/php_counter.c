@@ -0,0 +1,105 @@
+#include "../handlers/php_counter_handlers.h"
+#include "../classes/php_counter_ce.h"
+
+#include "php_counter.h"
+
+zend_object *php_ds_counter_create_object_ex(ds_counter_t *counter)
+{
+    php_ds_counter_t *obj = ecalloc(1, sizeof(php_ds_counter_t));
+    zend_object_std_init(&obj->std, php_ds_counter_ce);
+    obj->std.handlers = &php_ds_counter_handlers;
+    obj->counter = counter;
+    return &obj->std;
+}
+
+zend_object *php_ds_counter_create_object(zend_class_entry *ce)
+{
+    return php_ds_counter_create_object_ex(ds_counter());
+}
+
+zend_object *php_ds_counter_create_clone(ds_counter_t *counter)
+{
+    return php_ds_counter_create_object_ex(ds_counter_clone(counter));
+}
+
+int php_ds_counter_serialize(zval *object, unsigned char **buffer, size_t *length, zend_serialize_data *data)
+{
+    return ds_htable_serialize(Z_DS_COUNTER_P(object)->table, buffer, length, data);
+}
+
+int php_ds_counter_unserialize(zval *object, zend_class_entry *ce, const unsigned char *buffer, size_t length, zend_unserialize_data *data)
+{
+    ds_counter_t *counter = ds_counter();
+
+    if (ds_htable_unserialize(counter->table, buffer, length, data) == FAILURE) {
+        ds_counter_free(counter);
+        return FAILURE;
+    }
+
+    if ( ! ds_counter_recount(counter)) {
+        ds_counter_free(counter);
+        UNSERIALIZE_ERROR();
+        return FAILURE;
+    }
+
+    ZVAL_DS_COUNTER(object, counter);
+    return SUCCESS;
+}
+
+#if PHP_VERSION_ID >= 70400
+/**
+ * Values can be objects, so a counter is represented by its values and
+ * counts in turn, in the same way as a map.
+ */
+void php_ds_counter_magic_serialize(zval *object, zval *return_value)
+{
+    ds_htable_t *table = Z_DS_COUNTER_P(object)->table;
+
+    zval *key;
+    zval *value;
+
+    array_init_size(return_value, table->size * 2);
+
+    DS_HTABLE_FOREACH_KEY_VALUE(table, key, value) {
+        Z_TRY_ADDREF_P(key);
+        add_next_index_zval(return_value, key);
+        add_next_index_zval(return_value, value);
+    }
+    DS_HTABLE_FOREACH_END();
+}
+
+void php_ds_counter_magic_unserialize(zval *object, HashTable *data)
+{
+    ds_counter_t *counter = Z_DS_COUNTER_P(object);
+
+    zval *key = NULL;
+    zval *count;
+
+    if (zend_hash_num_elements(data) % 2 != 0) {
+        UNSERIALIZE_ERROR();
+        return;
+    }
+
+    ds_counter_clear(counter);
+    ds_counter_allocate(counter, zend_hash_num_elements(data) / 2);
+
+    ZEND_HASH_FOREACH_VAL(data, count) {
+        ZVAL_DEREF(count);
+
+        if (key == NULL) {
+            key = count;
+            continue;
+        }
+
+        if (Z_TYPE_P(count) != IS_LONG || Z_LVAL_P(count) <= 0) {
+            ds_counter_clear(counter);
+            UNSERIALIZE_ERROR();
+            return;
+        }
+
+        ds_counter_add(counter, key, Z_LVAL_P(count));
+        key = NULL;
+    }
+    ZEND_HASH_FOREACH_END();
+}
+#endif
@@ -0,0 +1,38 @@
+#ifndef PHP_DS_COUNTER_H
+#define PHP_DS_COUNTER_H
+
+#include "../../ds/ds_counter.h"
+
+#define Z_DS_COUNTER(z)   (((php_ds_counter_t*)(Z_OBJ(z)))->counter)
+#define Z_DS_COUNTER_P(z) Z_DS_COUNTER(*z)
+#define THIS_DS_COUNTER() Z_DS_COUNTER_P(getThis())
+
+#define ZVAL_DS_COUNTER(z, counter) ZVAL_OBJ(z, php_ds_counter_create_object_ex(counter))
+
+#define RETURN_DS_COUNTER(c)                    \
+do {                                            \
+    ds_counter_t *_c = c;                       \
+    if (_c) {                                   \
+        ZVAL_DS_COUNTER(return_value, _c);      \
+    } else {                                    \
+        ZVAL_NULL(return_value);                \
+    }                                           \
+    return;                                     \
+} while(0)
+
+typedef struct _php_ds_counter_t {
+    zend_object     std;
+    ds_counter_t   *counter;
+} php_ds_counter_t;
+
+zend_object *php_ds_counter_create_object_ex(ds_counter_t *counter);
+zend_object *php_ds_counter_create_object(zend_class_entry *ce);
+zend_object *php_ds_counter_create_clone(ds_counter_t *counter);
+
+PHP_DS_SERIALIZE_FUNCIONS(php_ds_counter);
+
+#if PHP_VERSION_ID >= 70400
+PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(php_ds_counter);
+#endif
+
+#endif
@@ -83,3 +83,25 @@ error:
     UNSERIALIZE_ERROR();
     return FAILURE;
 }
+
+#if PHP_VERSION_ID >= 70400
+void php_ds_deque_magic_serialize(zval *object, zval *return_value)
+{
+    ds_deque_to_array(Z_DS_DEQUE_P(object), return_value);
+}
+
+void php_ds_deque_magic_unserialize(zval *object, HashTable *data)
+{
+    ds_deque_t *deque = Z_DS_DEQUE_P(object);
+    zval *value;
+
+    ds_deque_clear(deque);
+    ds_deque_allocate(deque, zend_hash_num_elements(data));
+
+    ZEND_HASH_FOREACH_VAL(data, value) {
+        ZVAL_DEREF(value);
+        ds_deque_push(deque, value);
+    }
+    ZEND_HASH_FOREACH_END();
+}
+#endif
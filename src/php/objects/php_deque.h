@@ -27,6 +27,8 @@ do {                                        \
 typedef struct php_ds_deque {
     zend_object  std;
     ds_deque_t  *deque;
+    zval        *gc_data;   // Values gathered with the snapshot for the GC
+    int          gc_size;   // Length of the gc buffer
 } php_ds_deque_t;
 
 /**
@@ -46,4 +48,8 @@ zend_object *php_ds_deque_create_clone(ds_deque_t *deque);
 
 PHP_DS_SERIALIZE_FUNCIONS(php_ds_deque);
 
+#if PHP_VERSION_ID >= 70400
+PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(php_ds_deque);
+#endif
+
 #endif
@@ -0,0 +1,63 @@
+#include "../handlers/php_immutable_map_handlers.h"
+#include "../classes/php_immutable_map_ce.h"
+
+#include "php_immutable_map.h"
+
+zend_object *php_ds_immutable_map_create_object_ex(ds_map_t *map)
+{
+    php_ds_immutable_map_t *obj = ecalloc(1, sizeof(php_ds_immutable_map_t));
+    zend_object_std_init(&obj->std, php_ds_immutable_map_ce);
+    obj->std.handlers = &php_immutable_map_handlers;
+    obj->map = map;
+    obj->constructed = true;
+    ZVAL_UNDEF(&obj->array);
+
+    return &obj->std;
+}
+
+zend_object *php_ds_immutable_map_create_object(zend_class_entry *ce)
+{
+    zend_object *obj = php_ds_immutable_map_create_object_ex(ds_map());
+
+    // Values can still be set by the constructor.
+    ((php_ds_immutable_map_t *) obj)->constructed = false;
+    return obj;
+}
+
+zend_object *php_ds_immutable_map_create_clone(ds_map_t *map)
+{
+    return php_ds_immutable_map_create_object_ex(ds_map_clone(map));
+}
+
+void php_ds_immutable_map_to_array(php_ds_immutable_map_t *obj, zval *return_value)
+{
+    if (Z_ISUNDEF(obj->array)) {
+        ds_map_to_array(obj->map, return_value);
+
+        // Don't cache an array that is incomplete because of an error.
+        if ( ! EG(exception)) {
+            ZVAL_COPY(&obj->array, return_value);
+        }
+        return;
+    }
+
+    ZVAL_COPY(return_value, &obj->array);
+}
+
+int php_ds_immutable_map_serialize(zval *object, unsigned char **buffer, size_t *length, zend_serialize_data *data)
+{
+    return ds_htable_serialize(Z_DS_MAP_P(object)->table, buffer, length, data);
+}
+
+int php_ds_immutable_map_unserialize(zval *object, zend_class_entry *ce, const unsigned char *buffer, size_t length, zend_unserialize_data *data)
+{
+    ds_map_t *map = ds_map();
+
+    if (ds_htable_unserialize(map->table, buffer, length, data) == FAILURE) {
+        ds_map_free(map);
+        return FAILURE;
+    }
+
+    ZVAL_DS_IMMUTABLE_MAP(object, map);
+    return SUCCESS;
+}
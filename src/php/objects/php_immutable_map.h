@@ -0,0 +1,46 @@
+#ifndef PHP_DS_IMMUTABLE_MAP_H
+#define PHP_DS_IMMUTABLE_MAP_H
+
+#include "../../ds/ds_map.h"
+#include "php_map.h"
+
+#define Z_DS_IMMUTABLE_MAP_OBJ_P(z) ((php_ds_immutable_map_t *) Z_OBJ_P(z))
+
+#define ZVAL_DS_IMMUTABLE_MAP(z, m) ZVAL_OBJ(z, php_ds_immutable_map_create_object_ex(m))
+
+#define RETURN_DS_IMMUTABLE_MAP(m)                  \
+do {                                                \
+    ds_map_t *_m = m;                               \
+    if (_m) {                                       \
+        ZVAL_DS_IMMUTABLE_MAP(return_value, _m);    \
+    } else {                                        \
+        ZVAL_NULL(return_value);                    \
+    }                                               \
+    return;                                         \
+} while(0)
+
+/**
+ * Starts with the same members as php_ds_map_t, so that Z_DS_MAP and the map
+ * iterator and handlers work for both.
+ */
+typedef struct _php_ds_immutable_map_t {
+    zend_object  std;
+    ds_map_t    *map;
+    zval         array;         // Cached result of toArray, or undef
+    zval        *gc_data;       // Buckets gathered with the array for the GC
+    int          gc_size;       // Length of the gathered buffer
+    bool         constructed;   // Values may only be set once
+} php_ds_immutable_map_t;
+
+zend_object *php_ds_immutable_map_create_object_ex(ds_map_t *map);
+zend_object *php_ds_immutable_map_create_object(zend_class_entry *ce);
+zend_object *php_ds_immutable_map_create_clone(ds_map_t *map);
+
+/**
+ * Creates the array of the map on first use, then returns it every time.
+ */
+void php_ds_immutable_map_to_array(php_ds_immutable_map_t *obj, zval *return_value);
+
+PHP_DS_SERIALIZE_FUNCIONS(php_ds_immutable_map);
+
+#endif
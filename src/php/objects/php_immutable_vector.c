@@ -0,0 +1,49 @@
+#include "../handlers/php_immutable_vector_handlers.h"
+#include "../classes/php_vector_ce.h"
+#include "../classes/php_immutable_vector_ce.h"
+
+#include "php_immutable_vector.h"
+
+zend_object *php_ds_immutable_vector_create_object_ex(ds_vector_t *vector)
+{
+    php_ds_immutable_vector_t *obj = ecalloc(1, sizeof(php_ds_immutable_vector_t));
+    zend_object_std_init(&obj->std, php_ds_immutable_vector_ce);
+    obj->std.handlers = &php_immutable_vector_handlers;
+    obj->vector = vector;
+    obj->constructed = true;
+
+    return &obj->std;
+}
+
+zend_object *php_ds_immutable_vector_create_object(zend_class_entry *ce)
+{
+    zend_object *obj = php_ds_immutable_vector_create_object_ex(ds_vector());
+
+    // Values can still be set by the constructor.
+    ((php_ds_immutable_vector_t *) obj)->constructed = false;
+    return obj;
+}
+
+zend_object *php_ds_immutable_vector_create_clone(ds_vector_t *vector)
+{
+    return php_ds_immutable_vector_create_object_ex(ds_vector_clone(vector));
+}
+
+int php_ds_immutable_vector_serialize(zval *object, unsigned char **buffer, size_t *length, zend_serialize_data *data)
+{
+    return php_ds_vector_serialize(object, buffer, length, data);
+}
+
+int php_ds_immutable_vector_unserialize(zval *object, zend_class_entry *ce, const unsigned char *buffer, size_t length, zend_unserialize_data *data)
+{
+    zval vector;
+
+    if (php_ds_vector_unserialize(&vector, php_ds_vector_ce, buffer, length, data) == FAILURE) {
+        return FAILURE;
+    }
+
+    // The clone takes over the buffer when the vector is released.
+    ZVAL_DS_IMMUTABLE_VECTOR(object, ds_vector_clone(Z_DS_VECTOR(vector)));
+    zval_ptr_dtor(&vector);
+    return SUCCESS;
+}
@@ -0,0 +1,38 @@
+#ifndef PHP_DS_IMMUTABLE_VECTOR_H
+#define PHP_DS_IMMUTABLE_VECTOR_H
+
+#include "../../ds/ds_vector.h"
+#include "php_vector.h"
+
+#define ZVAL_DS_IMMUTABLE_VECTOR(z, v) ZVAL_OBJ(z, php_ds_immutable_vector_create_object_ex(v))
+
+#define RETURN_DS_IMMUTABLE_VECTOR(v)               \
+do {                                                \
+    ds_vector_t *_v = v;                            \
+    if (_v) {                                       \
+        ZVAL_DS_IMMUTABLE_VECTOR(return_value, _v); \
+    } else {                                        \
+        ZVAL_NULL(return_value);                    \
+    }                                               \
+    return;                                         \
+} while(0)
+
+/**
+ * Starts with the same members as php_ds_vector_t, so that Z_DS_VECTOR and
+ * the vector iterator and handlers work for both.
+ */
+typedef struct php_ds_immutable_vector {
+    zend_object      std;
+    ds_vector_t     *vector;
+    zval            *gc_data;
+    int              gc_size;
+    bool             constructed;   // Values may only be set once
+} php_ds_immutable_vector_t;
+
+zend_object *php_ds_immutable_vector_create_object_ex(ds_vector_t *vector);
+zend_object *php_ds_immutable_vector_create_object(zend_class_entry *ce);
+zend_object *php_ds_immutable_vector_create_clone(ds_vector_t *vector);
+
+PHP_DS_SERIALIZE_FUNCIONS(php_ds_immutable_vector);
+
+#endif
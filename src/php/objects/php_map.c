@@ -77,3 +77,56 @@ int php_ds_map_unserialize(zval *object, zend_class_entry *ce, const unsigned ch
     ZVAL_DS_MAP(object, map);
     return SUCCESS;
 }
+
+#if PHP_VERSION_ID >= 70400
+/**
+ * Keys can be objects, so a map is represented by its keys and values in
+ * turn rather than by an array that uses the keys.
+ */
+void php_ds_map_magic_serialize(zval *object, zval *return_value)
+{
+    ds_htable_t *table = Z_DS_MAP_P(object)->table;
+
+    zval *key;
+    zval *value;
+
+    array_init_size(return_value, table->size * 2);
+
+    DS_HTABLE_FOREACH_KEY_VALUE(table, key, value) {
+        Z_TRY_ADDREF_P(key);
+        Z_TRY_ADDREF_P(value);
+        add_next_index_zval(return_value, key);
+        add_next_index_zval(return_value, value);
+    }
+    DS_HTABLE_FOREACH_END();
+}
+
+void php_ds_map_magic_unserialize(zval *object, HashTable *data)
+{
+    ds_map_t *map = Z_DS_MAP_P(object);
+
+    zval *key = NULL;
+    zval *value;
+
+    if (zend_hash_num_elements(data) % 2 != 0) {
+        UNSERIALIZE_ERROR();
+        return;
+    }
+
+    ds_map_clear(map);
+    ds_map_allocate(map, zend_hash_num_elements(data) / 2);
+
+    ZEND_HASH_FOREACH_VAL(data, value) {
+        ZVAL_DEREF(value);
+
+        if (key == NULL) {
+            key = value;
+            continue;
+        }
+
+        ds_htable_put(map->table, key, value);
+        key = NULL;
+    }
+    ZEND_HASH_FOREACH_END();
+}
+#endif
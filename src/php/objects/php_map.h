@@ -34,4 +34,8 @@ HashTable *ds_map_pairs_to_php_hashtable(ds_map_t *map);
 
 PHP_DS_SERIALIZE_FUNCIONS(php_ds_map);
 
+#if PHP_VERSION_ID >= 70400
+PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(php_ds_map);
+#endif
+
 #endif
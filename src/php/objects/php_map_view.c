@@ -0,0 +1,36 @@
+#include "../iterators/php_map_view_iterator.h"
+#include "../handlers/php_map_view_handlers.h"
+#include "../classes/php_map_view_ce.h"
+
+#include "php_map.h"
+#include "php_map_view.h"
+
+zend_object *php_ds_map_view_create_object_ex(ds_map_view_t *view)
+{
+    php_ds_map_view_t *obj = ecalloc(1, sizeof(php_ds_map_view_t));
+    zend_object_std_init(&obj->std, php_ds_map_view_ce);
+    obj->std.handlers = &php_map_view_handlers;
+    obj->view = view;
+
+    return &obj->std;
+}
+
+zend_object *php_ds_map_view_create_object(zend_class_entry *ce)
+{
+    zend_object *obj;
+    zval map;
+
+    // Views are created by maps, so one created directly is of an empty map.
+    ZVAL_DS_MAP(&map, ds_map());
+
+    obj = php_ds_map_view_create_object_ex(
+        ds_map_view(DS_MAP_VIEW_KEYS, &map, Z_DS_MAP(map)->table));
+
+    zval_ptr_dtor(&map);
+    return obj;
+}
+
+zend_object *php_ds_map_view_create_clone(ds_map_view_t *view)
+{
+    return php_ds_map_view_create_object_ex(ds_map_view_clone(view));
+}
@@ -0,0 +1,32 @@
+#ifndef PHP_DS_MAP_VIEW_H
+#define PHP_DS_MAP_VIEW_H
+
+#include "../../ds/ds_map_view.h"
+
+#define Z_DS_MAP_VIEW(z)   (((php_ds_map_view_t*)(Z_OBJ(z)))->view)
+#define Z_DS_MAP_VIEW_P(z) Z_DS_MAP_VIEW(*z)
+#define THIS_DS_MAP_VIEW() Z_DS_MAP_VIEW_P(getThis())
+
+#define ZVAL_DS_MAP_VIEW(z, v) ZVAL_OBJ(z, php_ds_map_view_create_object_ex(v))
+
+#define RETURN_DS_MAP_VIEW(v)                   \
+do {                                            \
+    ds_map_view_t *_v = v;                      \
+    if (_v) {                                   \
+        ZVAL_DS_MAP_VIEW(return_value, _v);     \
+    } else {                                    \
+        ZVAL_NULL(return_value);                \
+    }                                           \
+    return;                                     \
+} while(0)
+
+typedef struct _php_ds_map_view_t {
+    zend_object      std;
+    ds_map_view_t   *view;
+} php_ds_map_view_t;
+
+zend_object *php_ds_map_view_create_object_ex(ds_map_view_t *view);
+zend_object *php_ds_map_view_create_object(zend_class_entry *ce);
+zend_object *php_ds_map_view_create_clone(ds_map_view_t *view);
+
+#endif
@@ -0,0 +1,31 @@
+#include "../iterators/php_mapped_iterator.h"
+#include "../handlers/php_mapped_handlers.h"
+#include "../classes/php_mapped_vector_ce.h"
+#include "../classes/php_mapped_map_ce.h"
+
+#include "php_mapped.h"
+
+zend_object *php_ds_mapped_create_object_ex(ds_mapped_t *mapped)
+{
+    php_ds_mapped_t *obj = ecalloc(1, sizeof(php_ds_mapped_t));
+
+    zend_object_std_init(&obj->std, mapped->type == DS_MAPPED_VECTOR
+        ? php_ds_mapped_vector_ce
+        : php_ds_mapped_map_ce);
+
+    obj->std.handlers = &php_mapped_handlers;
+    obj->mapped = mapped;
+
+    return &obj->std;
+}
+
+zend_object *php_ds_mapped_vector_create_object(zend_class_entry *ce)
+{
+    // Mapped vectors are created by mapping a file, so one created directly is empty.
+    return php_ds_mapped_create_object_ex(ds_mapped_empty(DS_MAPPED_VECTOR));
+}
+
+zend_object *php_ds_mapped_map_create_object(zend_class_entry *ce)
+{
+    return php_ds_mapped_create_object_ex(ds_mapped_empty(DS_MAPPED_MAP));
+}
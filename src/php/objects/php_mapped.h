@@ -0,0 +1,36 @@
+#ifndef PHP_DS_MAPPED_H
+#define PHP_DS_MAPPED_H
+
+#include "../../ds/ds_mapped.h"
+
+#define Z_DS_MAPPED(z)   (((php_ds_mapped_t*)(Z_OBJ(z)))->mapped)
+#define Z_DS_MAPPED_P(z) Z_DS_MAPPED(*z)
+#define THIS_DS_MAPPED() Z_DS_MAPPED_P(getThis())
+
+#define ZVAL_DS_MAPPED(z, m) ZVAL_OBJ(z, php_ds_mapped_create_object_ex(m))
+
+#define RETURN_DS_MAPPED(m)                 \
+do {                                        \
+    ds_mapped_t *_m = m;                    \
+    if (_m) {                               \
+        ZVAL_DS_MAPPED(return_value, _m);   \
+    } else {                                \
+        ZVAL_NULL(return_value);            \
+    }                                       \
+    return;                                 \
+} while(0)
+
+/**
+ * Ds\MappedVector and Ds\MappedMap share this object, and differ only by
+ * the type of their file.
+ */
+typedef struct _php_ds_mapped_t {
+    zend_object      std;
+    ds_mapped_t     *mapped;
+} php_ds_mapped_t;
+
+zend_object *php_ds_mapped_create_object_ex(ds_mapped_t *mapped);
+zend_object *php_ds_mapped_vector_create_object(zend_class_entry *ce);
+zend_object *php_ds_mapped_map_create_object(zend_class_entry *ce);
+
+#endif
@@ -74,3 +74,39 @@ error:
     UNSERIALIZE_ERROR();
     return FAILURE;
 }
+
+#if PHP_VERSION_ID >= 70400
+void php_ds_pair_magic_serialize(zval *object, zval *return_value)
+{
+    ds_pair_t *pair = Z_DS_PAIR_P(object);
+
+    array_init_size(return_value, 2);
+
+    Z_TRY_ADDREF(pair->key);
+    Z_TRY_ADDREF(pair->value);
+    add_next_index_zval(return_value, &pair->key);
+    add_next_index_zval(return_value, &pair->value);
+}
+
+void php_ds_pair_magic_unserialize(zval *object, HashTable *data)
+{
+    ds_pair_t *pair = Z_DS_PAIR_P(object);
+
+    zval *key   = zend_hash_index_find(data, 0);
+    zval *value = zend_hash_index_find(data, 1);
+
+    if (key == NULL || value == NULL || zend_hash_num_elements(data) != 2) {
+        UNSERIALIZE_ERROR();
+        return;
+    }
+
+    ZVAL_DEREF(key);
+    ZVAL_DEREF(value);
+
+    zval_ptr_dtor(&pair->key);
+    zval_ptr_dtor(&pair->value);
+
+    ZVAL_COPY(&pair->key, key);
+    ZVAL_COPY(&pair->value, value);
+}
+#endif
@@ -31,4 +31,8 @@ zend_object *php_ds_pair_create_clone(ds_pair_t *pair);
 
 PHP_DS_SERIALIZE_FUNCIONS(php_ds_pair);
 
+#if PHP_VERSION_ID >= 70400
+PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(php_ds_pair);
+#endif
+
 #endif
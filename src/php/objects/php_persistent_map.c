@@ -0,0 +1,95 @@
+#include "../handlers/php_persistent_map_handlers.h"
+#include "../classes/php_persistent_map_ce.h"
+
+#include "php_persistent_map.h"
+
+zend_object *php_ds_persistent_map_create_object_ex(ds_persistent_map_t *map)
+{
+    php_ds_persistent_map_t *obj = ecalloc(1, sizeof(php_ds_persistent_map_t));
+    zend_object_std_init(&obj->std, php_ds_persistent_map_ce);
+    obj->std.handlers = &php_persistent_map_handlers;
+    obj->map = map;
+    obj->constructed = true;
+
+    return &obj->std;
+}
+
+zend_object *php_ds_persistent_map_create_object(zend_class_entry *ce)
+{
+    zend_object *obj = php_ds_persistent_map_create_object_ex(ds_persistent_map());
+
+    // Values can still be set by the constructor.
+    ((php_ds_persistent_map_t *) obj)->constructed = false;
+    return obj;
+}
+
+zend_object *php_ds_persistent_map_create_clone(ds_persistent_map_t *map)
+{
+    return php_ds_persistent_map_create_object_ex(ds_persistent_map_clone(map));
+}
+
+int php_ds_persistent_map_serialize(zval *object, unsigned char **buffer, size_t *length, zend_serialize_data *data)
+{
+    ds_persistent_map_t *map = Z_DS_PERSISTENT_MAP_P(object);
+
+    php_serialize_data_t serialize_data = (php_serialize_data_t) data;
+    PHP_VAR_SERIALIZE_INIT(serialize_data);
+
+    if (DS_PERSISTENT_MAP_IS_EMPTY(map)) {
+        SERIALIZE_SET_ZSTR(ZSTR_EMPTY_ALLOC());
+
+    } else {
+        zval *key, *value;
+        smart_str buf = {0};
+
+        DS_PERSISTENT_MAP_FOREACH_KEY_VALUE(map, key, value) {
+            php_var_serialize(&buf, key, &serialize_data);
+            php_var_serialize(&buf, value, &serialize_data);
+        }
+        DS_PERSISTENT_MAP_FOREACH_END();
+
+        smart_str_0(&buf);
+        SERIALIZE_SET_ZSTR(buf.s);
+        zend_string_release(buf.s);
+    }
+
+    PHP_VAR_SERIALIZE_DESTROY(serialize_data);
+    return SUCCESS;
+}
+
+int php_ds_persistent_map_unserialize(zval *obj, zend_class_entry *ce, const unsigned char *buffer, size_t length, zend_unserialize_data *data)
+{
+    ds_persistent_map_t *map = ds_persistent_map();
+
+    php_unserialize_data_t unserialize_data = (php_unserialize_data_t) data;
+
+    const unsigned char *pos = buffer;
+    const unsigned char *end = buffer + length;
+
+    PHP_VAR_UNSERIALIZE_INIT(unserialize_data);
+
+    while (pos != end) {
+        zval *key   = var_tmp_var(&unserialize_data);
+        zval *value = var_tmp_var(&unserialize_data);
+
+        if ( ! php_var_unserialize(key, &pos, end, &unserialize_data)) {
+            goto error;
+        }
+
+        if ( ! php_var_unserialize(value, &pos, end, &unserialize_data)) {
+            goto error;
+        }
+
+        ds_persistent_map_put(map, key, value);
+    }
+
+    ZVAL_DS_PERSISTENT_MAP(obj, map);
+    PHP_VAR_UNSERIALIZE_DESTROY(unserialize_data);
+    return SUCCESS;
+
+error:
+    ds_persistent_map_free(map);
+    PHP_VAR_UNSERIALIZE_DESTROY(unserialize_data);
+    UNSERIALIZE_ERROR();
+    return FAILURE;
+}
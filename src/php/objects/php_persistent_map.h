@@ -0,0 +1,37 @@
+#ifndef PHP_DS_PERSISTENT_MAP_H
+#define PHP_DS_PERSISTENT_MAP_H
+
+#include "../../ds/ds_persistent_map.h"
+
+#define Z_DS_PERSISTENT_MAP(z)   (((php_ds_persistent_map_t*)(Z_OBJ(z)))->map)
+#define Z_DS_PERSISTENT_MAP_P(z) Z_DS_PERSISTENT_MAP(*z)
+#define THIS_DS_PERSISTENT_MAP() Z_DS_PERSISTENT_MAP_P(getThis())
+
+#define ZVAL_DS_PERSISTENT_MAP(z, m) ZVAL_OBJ(z, php_ds_persistent_map_create_object_ex(m))
+
+#define RETURN_DS_PERSISTENT_MAP(m)                 \
+do {                                                \
+    ds_persistent_map_t *_m = m;                    \
+    if (_m) {                                       \
+        ZVAL_DS_PERSISTENT_MAP(return_value, _m);   \
+    } else {                                        \
+        ZVAL_NULL(return_value);                    \
+    }                                               \
+    return;                                         \
+} while(0)
+
+typedef struct php_ds_persistent_map {
+    zend_object              std;
+    ds_persistent_map_t     *map;
+    zval                    *gc_data;       // Values gathered for the GC
+    int                      gc_size;       // Length of the gc buffer
+    bool                     constructed;   // Values may only be set once
+} php_ds_persistent_map_t;
+
+zend_object *php_ds_persistent_map_create_object_ex(ds_persistent_map_t *map);
+zend_object *php_ds_persistent_map_create_object(zend_class_entry *ce);
+zend_object *php_ds_persistent_map_create_clone(ds_persistent_map_t *map);
+
+PHP_DS_SERIALIZE_FUNCIONS(php_ds_persistent_map);
+
+#endif
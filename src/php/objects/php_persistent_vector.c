@@ -0,0 +1,89 @@
+#include "../handlers/php_persistent_vector_handlers.h"
+#include "../classes/php_persistent_vector_ce.h"
+
+#include "php_persistent_vector.h"
+
+zend_object *php_ds_persistent_vector_create_object_ex(ds_persistent_vector_t *vector)
+{
+    php_ds_persistent_vector_t *obj = ecalloc(1, sizeof(php_ds_persistent_vector_t));
+    zend_object_std_init(&obj->std, php_ds_persistent_vector_ce);
+    obj->std.handlers = &php_persistent_vector_handlers;
+    obj->vector = vector;
+    obj->constructed = true;
+
+    return &obj->std;
+}
+
+zend_object *php_ds_persistent_vector_create_object(zend_class_entry *ce)
+{
+    zend_object *obj = php_ds_persistent_vector_create_object_ex(ds_persistent_vector());
+
+    // Values can still be set by the constructor.
+    ((php_ds_persistent_vector_t *) obj)->constructed = false;
+    return obj;
+}
+
+zend_object *php_ds_persistent_vector_create_clone(ds_persistent_vector_t *vector)
+{
+    return php_ds_persistent_vector_create_object_ex(ds_persistent_vector_clone(vector));
+}
+
+int php_ds_persistent_vector_serialize(zval *object, unsigned char **buffer, size_t *length, zend_serialize_data *data)
+{
+    ds_persistent_vector_t *vector = Z_DS_PERSISTENT_VECTOR_P(object);
+
+    php_serialize_data_t serialize_data = (php_serialize_data_t) data;
+    PHP_VAR_SERIALIZE_INIT(serialize_data);
+
+    if (DS_PERSISTENT_VECTOR_IS_EMPTY(vector)) {
+        SERIALIZE_SET_ZSTR(ZSTR_EMPTY_ALLOC());
+
+    } else {
+        zval *value;
+        smart_str buf = {0};
+
+        DS_PERSISTENT_VECTOR_FOREACH(vector, value) {
+            php_var_serialize(&buf, value, &serialize_data);
+        }
+        DS_PERSISTENT_VECTOR_FOREACH_END();
+
+        smart_str_0(&buf);
+        SERIALIZE_SET_ZSTR(buf.s);
+        zend_string_release(buf.s);
+    }
+
+    PHP_VAR_SERIALIZE_DESTROY(serialize_data);
+    return SUCCESS;
+}
+
+int php_ds_persistent_vector_unserialize(zval *obj, zend_class_entry *ce, const unsigned char *buffer, size_t length, zend_unserialize_data *data)
+{
+    ds_persistent_vector_t *vector = ds_persistent_vector();
+
+    php_unserialize_data_t unserialize_data = (php_unserialize_data_t) data;
+
+    const unsigned char *pos = buffer;
+    const unsigned char *end = buffer + length;
+
+    PHP_VAR_UNSERIALIZE_INIT(unserialize_data);
+
+    while (pos != end) {
+        zval *value = var_tmp_var(&unserialize_data);
+
+        if ( ! php_var_unserialize(value, &pos, end, &unserialize_data)) {
+            goto error;
+        }
+
+        ds_persistent_vector_push(vector, value);
+    }
+
+    ZVAL_DS_PERSISTENT_VECTOR(obj, vector);
+    PHP_VAR_UNSERIALIZE_DESTROY(unserialize_data);
+    return SUCCESS;
+
+error:
+    ds_persistent_vector_free(vector);
+    PHP_VAR_UNSERIALIZE_DESTROY(unserialize_data);
+    UNSERIALIZE_ERROR();
+    return FAILURE;
+}
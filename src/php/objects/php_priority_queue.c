@@ -100,3 +100,66 @@ error:
     UNSERIALIZE_ERROR();
     return FAILURE;
 }
+
+#if PHP_VERSION_ID >= 70400
+/**
+ * Values and priorities in turn, in the order that they would be polled, so
+ * that pushing them in order preserves insertion order for equal priorities.
+ */
+void php_ds_priority_queue_magic_serialize(zval *object, zval *return_value)
+{
+    ds_priority_queue_t *queue = Z_DS_PRIORITY_QUEUE_P(object);
+
+    ds_priority_queue_node_t *nodes;
+    ds_priority_queue_node_t *pos;
+    ds_priority_queue_node_t *end;
+
+    array_init_size(return_value, queue->size * 2);
+
+    if (queue->size == 0) {
+        return;
+    }
+
+    nodes = ds_priority_queue_create_sorted_buffer(queue);
+    pos   = nodes;
+    end   = nodes + queue->size;
+
+    for (; pos < end; ++pos) {
+        Z_TRY_ADDREF(pos->value);
+        Z_TRY_ADDREF(pos->priority);
+        add_next_index_zval(return_value, &pos->value);
+        add_next_index_zval(return_value, &pos->priority);
+    }
+
+    efree(nodes);
+}
+
+void php_ds_priority_queue_magic_unserialize(zval *object, HashTable *data)
+{
+    ds_priority_queue_t *queue = Z_DS_PRIORITY_QUEUE_P(object);
+
+    zval *value = NULL;
+    zval *entry;
+
+    if (zend_hash_num_elements(data) % 2 != 0) {
+        UNSERIALIZE_ERROR();
+        return;
+    }
+
+    ds_priority_queue_clear(queue);
+    ds_priority_queue_allocate(queue, zend_hash_num_elements(data) / 2);
+
+    ZEND_HASH_FOREACH_VAL(data, entry) {
+        ZVAL_DEREF(entry);
+
+        if (value == NULL) {
+            value = entry;
+            continue;
+        }
+
+        ds_priority_queue_push(queue, value, entry);
+        value = NULL;
+    }
+    ZEND_HASH_FOREACH_END();
+}
+#endif
@@ -35,4 +35,8 @@ zend_object *php_ds_priority_queue_create_clone(ds_priority_queue_t *queue);
 
 PHP_DS_SERIALIZE_FUNCIONS(php_ds_priority_queue);
 
+#if PHP_VERSION_ID >= 70400
+PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(php_ds_priority_queue);
+#endif
+
 #endif
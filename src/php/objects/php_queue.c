@@ -39,10 +39,10 @@ int php_ds_queue_serialize(zval *object, unsigned char **buffer, size_t *length,
         zval *value;
         smart_str buf = {0};
 
-        DS_DEQUE_FOREACH(queue->deque, value) {
+        DS_QUEUE_FOREACH(queue, value) {
             php_var_serialize(&buf, value, &serialize_data);
         }
-        DS_DEQUE_FOREACH_END();
+        DS_QUEUE_FOREACH_END();
 
         smart_str_0(&buf);
         SERIALIZE_SET_ZSTR(buf.s);
@@ -84,3 +84,25 @@ error:
     UNSERIALIZE_ERROR();
     return FAILURE;
 }
+
+#if PHP_VERSION_ID >= 70400
+void php_ds_queue_magic_serialize(zval *object, zval *return_value)
+{
+    ds_queue_to_array(Z_DS_QUEUE_P(object), return_value);
+}
+
+void php_ds_queue_magic_unserialize(zval *object, HashTable *data)
+{
+    ds_queue_t *queue = Z_DS_QUEUE_P(object);
+    zval *value;
+
+    ds_queue_clear(queue);
+    ds_queue_allocate(queue, zend_hash_num_elements(data));
+
+    ZEND_HASH_FOREACH_VAL(data, value) {
+        ZVAL_DEREF(value);
+        ds_queue_push_one(queue, value);
+    }
+    ZEND_HASH_FOREACH_END();
+}
+#endif
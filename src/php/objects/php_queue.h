@@ -24,6 +24,8 @@ do {                                        \
 typedef struct _php_ds_queue_t {
     zend_object    std;
     ds_queue_t    *queue;
+    zval          *gc_data;     // Values gathered from the blocks for the GC
+    int            gc_size;     // Length of the gc buffer
 } php_ds_queue_t;
 
 zend_object *php_ds_queue_create_object_ex(ds_queue_t *queue);
@@ -32,4 +34,8 @@ zend_object *php_ds_queue_create_clone(ds_queue_t *queue);
 
 PHP_DS_SERIALIZE_FUNCIONS(php_ds_queue);
 
+#if PHP_VERSION_ID >= 70400
+PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(php_ds_queue);
+#endif
+
 #endif
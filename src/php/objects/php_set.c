@@ -83,3 +83,25 @@ error:
     UNSERIALIZE_ERROR();
     return FAILURE;
 }
+
+#if PHP_VERSION_ID >= 70400
+void php_ds_set_magic_serialize(zval *object, zval *return_value)
+{
+    ds_set_to_array(Z_DS_SET_P(object), return_value);
+}
+
+void php_ds_set_magic_unserialize(zval *object, HashTable *data)
+{
+    ds_set_t *set = Z_DS_SET_P(object);
+    zval *value;
+
+    ds_set_clear(set);
+    ds_set_allocate(set, zend_hash_num_elements(data));
+
+    ZEND_HASH_FOREACH_VAL(data, value) {
+        ZVAL_DEREF(value);
+        ds_set_add(set, value);
+    }
+    ZEND_HASH_FOREACH_END();
+}
+#endif
@@ -31,4 +31,8 @@ zend_object *php_ds_set_create_clone(ds_set_t *set);
 
 PHP_DS_SERIALIZE_FUNCIONS(php_ds_set);
 
+#if PHP_VERSION_ID >= 70400
+PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(php_ds_set);
+#endif
+
 #endif
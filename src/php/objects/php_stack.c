@@ -83,3 +83,26 @@ error:
     UNSERIALIZE_ERROR();
     return FAILURE;
 }
+
+#if PHP_VERSION_ID >= 70400
+void php_ds_stack_magic_serialize(zval *object, zval *return_value)
+{
+    // Bottom to top, so that pushing the values in order restores the stack.
+    ds_vector_to_array(Z_DS_STACK_P(object)->vector, return_value);
+}
+
+void php_ds_stack_magic_unserialize(zval *object, HashTable *data)
+{
+    ds_stack_t *stack = Z_DS_STACK_P(object);
+    zval *value;
+
+    ds_stack_clear(stack);
+    ds_stack_allocate(stack, zend_hash_num_elements(data));
+
+    ZEND_HASH_FOREACH_VAL(data, value) {
+        ZVAL_DEREF(value);
+        ds_stack_push(stack, value);
+    }
+    ZEND_HASH_FOREACH_END();
+}
+#endif
@@ -31,4 +31,8 @@ zend_object *php_ds_stack_create_clone(ds_stack_t *stack);
 
 PHP_DS_SERIALIZE_FUNCIONS(php_ds_stack);
 
+#if PHP_VERSION_ID >= 70400
+PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(php_ds_stack);
+#endif
+
 #endif
@@ -0,0 +1,25 @@
+#include "../handlers/php_stream_handlers.h"
+#include "../classes/php_stream_ce.h"
+
+#include "php_stream.h"
+
+zend_object *php_ds_stream_create_object_ex(ds_stream_t *stream)
+{
+    php_ds_stream_t *obj = ecalloc(1, sizeof(php_ds_stream_t));
+    zend_object_std_init(&obj->std, php_ds_stream_ce);
+    obj->std.handlers = &php_stream_handlers;
+    obj->stream = stream;
+
+    return &obj->std;
+}
+
+zend_object *php_ds_stream_create_object(zend_class_entry *ce)
+{
+    // Streams are created by collections, so one created directly is empty.
+    return php_ds_stream_create_object_ex(ds_stream(DS_STREAM_SOURCE_VECTOR, ds_vector()));
+}
+
+zend_object *php_ds_stream_create_clone(ds_stream_t *stream)
+{
+    return php_ds_stream_create_object_ex(ds_stream_clone(stream));
+}
@@ -0,0 +1,34 @@
+#ifndef PHP_DS_STREAM_H
+#define PHP_DS_STREAM_H
+
+#include "../../ds/ds_stream.h"
+
+#define Z_DS_STREAM(z)   (((php_ds_stream_t*)(Z_OBJ(z)))->stream)
+#define Z_DS_STREAM_P(z) Z_DS_STREAM(*z)
+#define THIS_DS_STREAM() Z_DS_STREAM_P(getThis())
+
+#define ZVAL_DS_STREAM(z, s) ZVAL_OBJ(z, php_ds_stream_create_object_ex(s))
+
+#define RETURN_DS_STREAM(s)                 \
+do {                                        \
+    ds_stream_t *_s = s;                    \
+    if (_s) {                               \
+        ZVAL_DS_STREAM(return_value, _s);   \
+    } else {                                \
+        ZVAL_NULL(return_value);            \
+    }                                       \
+    return;                                 \
+} while(0)
+
+typedef struct php_ds_stream {
+    zend_object      std;
+    ds_stream_t     *stream;
+    zval            *gc_data;   // Callbacks and source values gathered for the GC
+    int              gc_size;   // Length of the gc buffer
+} php_ds_stream_t;
+
+zend_object *php_ds_stream_create_object_ex(ds_stream_t *stream);
+zend_object *php_ds_stream_create_object(zend_class_entry *ce);
+zend_object *php_ds_stream_create_clone(ds_stream_t *stream);
+
+#endif
@@ -83,3 +83,25 @@ error:
     UNSERIALIZE_ERROR();
     return FAILURE;
 }
+
+#if PHP_VERSION_ID >= 70400
+void php_ds_vector_magic_serialize(zval *object, zval *return_value)
+{
+    ds_vector_to_array(Z_DS_VECTOR_P(object), return_value);
+}
+
+void php_ds_vector_magic_unserialize(zval *object, HashTable *data)
+{
+    ds_vector_t *vector = Z_DS_VECTOR_P(object);
+    zval *value;
+
+    ds_vector_clear(vector);
+    ds_vector_allocate(vector, zend_hash_num_elements(data));
+
+    ZEND_HASH_FOREACH_VAL(data, value) {
+        ZVAL_DEREF(value);
+        ds_vector_push(vector, value);
+    }
+    ZEND_HASH_FOREACH_END();
+}
+#endif
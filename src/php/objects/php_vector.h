@@ -23,6 +23,8 @@ do {                                        \
 typedef struct php_ds_vector {
     zend_object      std;
     ds_vector_t     *vector;
+    zval            *gc_data;       // Values gathered with the snapshot for the GC
+    int              gc_size;       // Length of the gc buffer
 } php_ds_vector_t;
 
 zend_object *php_ds_vector_create_object_ex(ds_vector_t *vector);
@@ -31,4 +33,8 @@ zend_object *php_ds_vector_create_clone(ds_vector_t *vector);
 
 PHP_DS_SERIALIZE_FUNCIONS(php_ds_vector);
 
+#if PHP_VERSION_ID >= 70400
+PHP_DS_MAGIC_SERIALIZE_FUNCTIONS(php_ds_vector);
+#endif
+
 #endif
@@ -8,6 +8,7 @@ zend_fcall_info_cache fci_cache = empty_fcall_info_cache;
 #define PARSE_1(spec, a)        if (zend_parse_parameters_throw(ZEND_NUM_ARGS(), spec, a) == FAILURE) return
 #define PARSE_2(spec, a, b)     if (zend_parse_parameters_throw(ZEND_NUM_ARGS(), spec, a, b) == FAILURE) return
 #define PARSE_3(spec, a, b, c)  if (zend_parse_parameters_throw(ZEND_NUM_ARGS(), spec, a, b, c) == FAILURE) return
+#define PARSE_4(spec, a, b, c, d) if (zend_parse_parameters_throw(ZEND_NUM_ARGS(), spec, a, b, c, d) == FAILURE) return
 
 #define PARSE_NONE if (zend_parse_parameters_none() == FAILURE) return
 
@@ -25,6 +26,27 @@ char  *str; \
 size_t len; \
 PARSE_2("s", &str, &len)
 
+#define PARSE_STRING_OPTIONAL_LONG(l, d) \
+char  *str; \
+size_t len; \
+zend_long l = d; \
+PARSE_3("s|l", &str, &len, &l)
+
+#define PARSE_HASH(h) \
+HashTable *h = NULL; \
+PARSE_1("h", &h)
+
+#define PARSE_STREAM() \
+php_stream *stream; \
+zval *zstream; \
+PARSE_1("r", &zstream); \
+php_stream_from_zval(stream, zstream)
+
+#define PARSE_PATH() \
+char  *path; \
+size_t len; \
+PARSE_2("p", &path, &len)
+
 #define PARSE_CALLABLE_AND_OPTIONAL_ZVAL(v) \
 SETUP_CALLABLE_VARS(); \
 zval *v = NULL; \
@@ -34,6 +56,11 @@ PARSE_3("f|z", &fci, &fci_cache, &v)
 SETUP_CALLABLE_VARS(); \
 PARSE_2("f", &fci, &fci_cache)
 
+#define PARSE_ZVAL_AND_CALLABLE(z) \
+SETUP_CALLABLE_VARS(); \
+zval *z = NULL; \
+PARSE_3("zf", &z, &fci, &fci_cache)
+
 #define PARSE_LONG_AND_LONG(a, b) \
 zend_long a = 0; \
 zend_long b = 0; \
@@ -44,11 +71,23 @@ zend_long l = 0; \
 zval *z = NULL; \
 PARSE_2("lz", &l, &z)
 
+#define PARSE_LONG_OPTIONAL_LONG_OPTIONAL_ZVAL(a, b, b_is_null, z) \
+zend_long a = 0; \
+zend_long b = 0; \
+zend_bool b_is_null = 1; \
+zval *z = NULL; \
+PARSE_4("l|l!z!", &a, &b, &b_is_null, &z)
+
 #define PARSE_ZVAL_AND_LONG(z, l) \
 zval *z = NULL; \
 zend_long l = 0; \
 PARSE_2("zl", &z, &l)
 
+#define PARSE_ZVAL_OPTIONAL_LONG(z, l, d) \
+zval *z = NULL; \
+zend_long l = d; \
+PARSE_2("z|l", &z, &l)
+
 #define PARSE_VARIADIC_ZVAL() \
 zval *argv = NULL; \
 int argc = 0; \
@@ -64,6 +103,16 @@ PARSE_3("l*", &_l, &argv, &argc)
 zend_long a = 0; \
 PARSE_1("l", &a)
 
+#define PARSE_OPTIONAL_NULLABLE_LONG(a, a_is_null) \
+zend_long a = 0; \
+zend_bool a_is_null = 1; \
+PARSE_2("|l!", &a, &a_is_null)
+
+#define PARSE_OPTIONAL_LONG_OPTIONAL_LONG(a, da, b, db) \
+zend_long a = da; \
+zend_long b = db; \
+PARSE_2("|ll", &a, &b)
+
 #define PARSE_COMPARE_CALLABLE() \
 DSG(user_compare_fci) = empty_fcall_info; \
 DSG(user_compare_fci_cache) = empty_fcall_info_cache; \